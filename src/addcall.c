@@ -48,6 +48,7 @@
 #include "log_utils.h"
 #include "paccdx.h"
 #include "score.h"
+#include "score_journal.h"
 #include "searchcallarray.h"
 #include "setcontest.h"
 #include "tlf.h"
@@ -180,20 +181,27 @@ int addcall(struct qso_t *qso) {
 
     /* qso's per band  */
     if (!(CONTEST_IS(ARRLDX_USA)
-	    && ((countrynr == w_cty) || (countrynr == ve_cty))))
+	    && ((countrynr == w_cty) || (countrynr == ve_cty)))) {
+	JOURNAL(qsos_per_band[qso->bandindex]);
 	qsos_per_band[qso->bandindex]++;
+    }
 
 
     if (add_ok) {
+	JOURNAL_WORKED(worked[station].band);
 	worked[station].band |= inxes[qso->bandindex];	/* worked on band */
 
 	if (pfxnumcntidx < 0) {
 	    if (cty != 0 && (countries[cty] & inxes[qso->bandindex]) == 0) {
+		JOURNAL(countries[cty]);
+		JOURNAL(countryscore[qso->bandindex]);
 		countries[cty] |= inxes[qso->bandindex];
 		countryscore[qso->bandindex]++;
 		new_cty = cty;
 	    }
 	    if (zone != 0 && (zones[zone] & inxes[qso->bandindex]) == 0) {
+		JOURNAL(zones[zone]);
+		JOURNAL(zonescore[qso->bandindex]);
 		zones[zone] |= inxes[qso->bandindex];
 		zonescore[qso->bandindex]++;
 		new_zone = zone;
@@ -201,6 +209,9 @@ int addcall(struct qso_t *qso) {
 	} else {
 	    if ((pfxnummulti[pfxnumcntidx].qsos[pxnr] & inxes[qso->bandindex])
 		    == 0) {
+		JOURNAL(pfxnummulti[pfxnumcntidx].qsos[pxnr]);
+		JOURNAL(countryscore[qso->bandindex]);
+		JOURNAL(zonescore[qso->bandindex]);
 		pfxnummulti[pfxnumcntidx].qsos[pxnr] |= inxes[qso->bandindex];
 		addcallarea = 1;
 		countryscore[qso->bandindex]++;
@@ -290,25 +301,34 @@ int addcall2(void) {
 
     if (add_ok) {
 
+	JOURNAL(qsos_per_band[bandinx]);
 	qsos_per_band[bandinx]++;
 
+	JOURNAL_WORKED(worked[station].band);
 	worked[station].band |= inxes[bandinx];	/* worked on this band */
 
 	if (excl_add_veto2 == 0) {
 
 	    if (pfxnumcntidx < 0) {
 		if (cty != 0 && (countries[cty] & inxes[bandinx]) == 0) {
+		    JOURNAL(countries[cty]);
+		    JOURNAL(countryscore[bandinx]);
 		    countries[cty] |= inxes[bandinx];
 		    countryscore[bandinx]++;
 //                  new_cty = cty;
 		}
 		if (zone != 0 && (zones[zone] & inxes[bandinx]) == 0) {
+		    JOURNAL(zones[zone]);
+		    JOURNAL(zonescore[bandinx]);
 		    zones[zone] |= inxes[bandinx];
 		    zonescore[bandinx]++;
 //                  new_zone = zone;
 		}
 	    } else {
 		if ((pfxnummulti[pfxnumcntidx].qsos[pxnr] & inxes[bandinx]) == 0) {
+		    JOURNAL(pfxnummulti[pfxnumcntidx].qsos[pxnr]);
+		    JOURNAL(zonescore[bandinx]);
+		    JOURNAL(countryscore[bandinx]);
 		    pfxnummulti[pfxnumcntidx].qsos[pxnr] |= inxes[bandinx];
 		    addcallarea = 1;
 		    zonescore[bandinx]++;
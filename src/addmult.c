@@ -30,7 +30,10 @@
 #include <unistd.h>
 
 #include "addmult.h"
+#include "alias_matcher.h"
 #include "globalvars.h"		// Includes glib.h and tlf.h
+#include "mult_registry.h"
+#include "score_journal.h"
 #include "setcontest.h"
 #include "tlf_curses.h"
 #include "utils.h"
@@ -38,6 +41,8 @@
 
 
 GPtrArray *mults_possible;
+static alias_matcher_t *alias_matcher = NULL;	/* over mults_possible */
+static pthread_mutex_t alias_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 /*
  * \return	      - index in mults[] array if new mult or new on band
@@ -139,8 +144,8 @@ int check_mult(struct qso_t *qso) {
 /* -------------------------------------------------------------------*/
 
 void addmult_lan(void) {
-    int i;
-    int matching_len = 0, idx = -1;
+    unsigned int matching_len;
+    int idx;
     char ssexchange[21];
     char stripped_comment[21];
     char multi_call[20];
@@ -152,14 +157,8 @@ void addmult_lan(void) {
     if (CONTEST_IS(ARRL_SS)) {
 	g_strlcpy(ssexchange, lan_logline + 54, 21);
 
-	/* check all possible mults for match and remember the longest one */
-	for (i = 0; i < get_mult_count(); i++) {
-	    int len = get_matching_length(ssexchange, i);
-	    if (len > matching_len) {
-		matching_len = len;
-		idx = i;
-	    }
-	}
+	/* look for the longest matching mult */
+	idx = get_best_mult_index(ssexchange, &matching_len);
 
 	if (idx >= 0) {
 	    remember_multi(get_mult(idx), bandinx, MULT_ALL, check_only);
@@ -218,22 +217,45 @@ int get_mult_count(void) {
     return mults_possible != NULL ? mults_possible->len : 0;
 }
 
-/* get best matching length of name or aliaslist of mult 'n' in 'str' */
-unsigned int get_matching_length(char *str, unsigned int n) {
-    unsigned len = 0;
+/* build the matcher for names and aliases of all possible mults */
+static alias_matcher_t *build_alias_matcher(void) {
+    alias_matcher_t *matcher = alias_matcher_new();
 
-    if (strstr(str, get_mult(n)) != NULL) {
-	len = strlen(get_mult(n));
+    for (int i = 0; i < get_mult_count(); i++) {
+	alias_matcher_add(matcher, get_mult(i), i);
+	for (GSList *l = get_aliases(i); l != NULL; l = l->next) {
+	    alias_matcher_add(matcher, l->data, i);
+	}
     }
+    alias_matcher_build(matcher);
+    return matcher;
+}
 
-    for (int i = 0; i < g_slist_length(get_aliases(n)); i++) {
-	char *tmp = g_slist_nth_data(get_aliases(n), i);
-	if (strstr(str, tmp) != NULL) {
-	    if (strlen(tmp) >= len)
-		len = strlen(tmp);
+/* matcher for the current possible mults, may run in rescoring threads */
+static alias_matcher_t *get_alias_matcher(void) {
+    alias_matcher_t *matcher = g_atomic_pointer_get(&alias_matcher);
+
+    if (matcher == NULL) {
+	pthread_mutex_lock(&alias_mutex);
+	matcher = alias_matcher;
+	if (matcher == NULL) {
+	    matcher = build_alias_matcher();
+	    g_atomic_pointer_set(&alias_matcher, matcher);
 	}
+	pthread_mutex_unlock(&alias_mutex);
     }
-    return len;
+    return matcher;
+}
+
+/* drop the matcher after changes to the possible mults */
+static void drop_alias_matcher(void) {
+    alias_matcher_free(alias_matcher);
+    alias_matcher = NULL;
+}
+
+/* get best matching length of name or aliaslist of mult 'n' in 'str' */
+unsigned int get_matching_length(char *str, unsigned int n) {
+    return alias_matcher_longest_of(get_alias_matcher(), str, n);
 }
 
 /* get mult index for exact match */
@@ -241,16 +263,16 @@ int get_exact_mult_index(char *str) {
     if (str == NULL) {
 	return -1;
     }
-    int len = strlen(str);
-    if (len == 0) {
-	return -1;
-    }
-    for (int i = 0; i < get_mult_count(); i++) {
-	if (get_matching_length(str, i) == len) {
-	    return i;
-	}
-    }
-    return -1;
+    return alias_matcher_exact(get_alias_matcher(), str);
+}
+
+/* get index of the mult with the longest name or alias found in 'str'
+ * and the length of the match */
+int get_best_mult_index(char *str, unsigned int *len) {
+    int index = -1;
+
+    *len = alias_matcher_longest(get_alias_matcher(), str, &index);
+    return (*len > 0) ? index : -1;
 }
 
 /* function to free mults_possible entries */
@@ -285,6 +307,8 @@ void add_mult_line(char *line) {
     char *mult = NULL;
     int index = -1;
 
+    drop_alias_matcher();
+
     list = g_strsplit(line, ":", 2);
     mult = g_strstrip(list[0]);
 
@@ -343,6 +367,7 @@ int init_and_load_multipliers(void) {
 	/* free old array if exists */
 	g_ptr_array_free(mults_possible, TRUE);
     }
+    drop_alias_matcher();
     mults_possible = g_ptr_array_new_with_free_func(free_possible_mult);
 
 
@@ -383,10 +408,14 @@ int init_and_load_multipliers(void) {
     /* do not rely on the order in the mult file but sort it here */
     g_ptr_array_sort(mults_possible, (GCompareFunc)cmp_size);
 
+    alias_matcher = build_alias_matcher();
+
     return get_mult_count();
 }
 
 
+static mult_registry_t worked_mults = MULT_REGISTRY(multis, nr_multis);
+
 /** initialize mults scoring
  *
  * empties multis[] array, set the number of multis and multscore per band to 0.
@@ -394,17 +423,13 @@ int init_and_load_multipliers(void) {
 void init_mults() {
     int n;
 
-    for (n = 0; n < MAX_MULTS; n++) {
-	multis[n].name[0] = '\0';
-	multis[n].band = 0;
-    }
-
-    nr_multis = 0;
+    mult_registry_clear(&worked_mults);
 
     for (n = 0; n < NBANDS; n++)
 	multscore[n] = 0;
 }
 
+/* serializes changes to multis[], lookups need no lock */
 static pthread_mutex_t mult_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 /** register worked multiplier and check if its new
@@ -422,50 +447,40 @@ static pthread_mutex_t mult_mutex = PTHREAD_MUTEX_INITIALIZER;
  *			(-1 if multiplier is an empty string or not new)
  */
 int remember_multi(char *multiplier, int band, int mult_mode, bool check_only) {
-    /* search multbuffer in mults array */
-    bool found = false;
-    int index = -1;
     if (multiplier == NULL || *multiplier == '\0' || mult_mode == MULT_NONE)
 	return -1;      /* ignore if empty string or disabled */
 
-    pthread_mutex_lock(&mult_mutex);
-
-    for (int i = 0; i < nr_multis; i++) {
-	/* already in list? */
-	if (strcmp(multis[i].name, multiplier) == 0) {
-	    found = 1;
-
-	    /* new band? check if mult is per band */
-	    if ((multis[i].band & inxes[band]) == 0) {
-
-		if (!check_only) {
-		    // update band even if not strictly needed
-		    multis[i].band |= inxes[band];
-		}
-
-		if (mult_mode == MULT_BAND) {
-		    index = i;  // new band
-		}
-	    }
-
-	    break;
+    if (check_only) {
+	int i = mult_registry_find(&worked_mults, multiplier);
+	if (i < 0) {
+	    return nr_multis;   /* would become a new entry */
 	}
+	if (mult_mode == MULT_BAND
+		&& (g_atomic_int_get(&multis[i].band) & inxes[band]) == 0) {
+	    return i;
+	}
+	return -1;
     }
 
-    // found && index < 0: not new mult
-    // found && index >= 0: existing mult on a new band
-    // !found: new mult
+    pthread_mutex_lock(&mult_mutex);
 
-    if (!found) {
-	index = nr_multis;  /* not found, add new multi */
+    int index = -1;
+    int i = mult_registry_find(&worked_mults, multiplier);
+
+    if (i < 0) {
+	index = mult_registry_add(&worked_mults, multiplier);   /* new mult */
+    } else if ((multis[i].band & inxes[band]) == 0) {
+	if (mult_mode == MULT_BAND) {
+	    index = i;  /* existing mult on a new band */
+	} else {
+	    // update band even if not strictly needed
+	    mult_registry_add_bands(&worked_mults, i, inxes[band]);
+	}
     }
 
-    if (index >= 0 && !check_only) {
-	if (!found) {   // new mult
-	    strcpy(multis[index].name, multiplier);
-	    nr_multis++;
-	}
-	multis[index].band |= inxes[band];
+    if (index >= 0) {
+	JOURNAL(multscore[band]);
+	mult_registry_add_bands(&worked_mults, index, inxes[band]);
 	multscore[band]++;
     }
 
@@ -473,3 +488,16 @@ int remember_multi(char *multiplier, int band, int mult_mode, bool check_only) {
 
     return index;
 }
+
+
+/** add a multiplier worked on 'bands', e.g. when restoring a saved
+ * scoring state; multscore[] is not touched */
+void restore_multi(const char *multiplier, int bands) {
+    pthread_mutex_lock(&mult_mutex);
+    int i = mult_registry_find(&worked_mults, multiplier);
+    if (i < 0) {
+	i = mult_registry_add(&worked_mults, multiplier);
+    }
+    mult_registry_add_bands(&worked_mults, i, bands);
+    pthread_mutex_unlock(&mult_mutex);
+}
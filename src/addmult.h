@@ -42,8 +42,10 @@ char *get_mult(int n);
 int get_mult_count(void);
 unsigned int get_matching_length(char *str, unsigned int n);
 int get_exact_mult_index(char *str);
+int get_best_mult_index(char *str, unsigned int *len);
 int init_and_load_multipliers(void);
 int remember_multi(char *multiplier, int band, int mult_mode, bool check_only);
+void restore_multi(const char *multiplier, int bands);
 void init_mults();
 
 #endif /* ADDMULT_H */
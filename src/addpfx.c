@@ -29,38 +29,20 @@
 #include <glib.h>
 #include "tlf.h"
 #include "bands.h"
+#include "mult_registry.h"
+#include "score_journal.h"
 
-#define MAX_PFX_LEN 5
-
-unsigned int nr_of_px = 0;
+static mults_t *prefixes_worked = NULL;
+static int nr_of_px = 0;
 unsigned int nr_of_px_ab = 0;
 
-
-struct {
-    char pfx[MAX_PFX_LEN + 1];
-    int bands;
-} prefixes_worked[MAX_CALLS];
+static mult_registry_t worked_pfxs = MULT_REGISTRY(prefixes_worked, nr_of_px);
 
 unsigned int pfxs_per_band[NBANDS] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
 
-/** lookup worked prefix and return index in prefixes_worked[] or
- * -1 if not found
- */
-static int find_worked_pfx(char *prefix) {
-    int found = -1;
-
-    for (int i = 0; i < nr_of_px; i++) {
-	if (strcmp(prefix, prefixes_worked[i].pfx) == 0) {
-	    found = i;
-	    break;
-	}
-    }
-
-    return found;
-}
 
 bool pfx_is_new(char *prefix) {
-    return (find_worked_pfx(prefix) == -1);
+    return (mult_registry_find(&worked_pfxs, prefix) == -1);
 }
 
 
@@ -68,12 +50,12 @@ bool pfx_is_new_on(char *prefix, int bandindex) {
     int index;
     int worked_bands;
 
-    index = find_worked_pfx(prefix);
+    index = mult_registry_find(&worked_pfxs, prefix);
 
     if (index == -1)
 	return true;
 
-    worked_bands = prefixes_worked[index].bands;
+    worked_bands = g_atomic_int_get(&prefixes_worked[index].band);
     if ((worked_bands & inxes[bandindex]) == 0)
 	return true;
 
@@ -83,33 +65,29 @@ bool pfx_is_new_on(char *prefix, int bandindex) {
 
 int add_pfx(char *pxstr, unsigned int bandindex) {
     extern bool pfxmultab;
-    int q = 0, found = 0, bandfound = 0;
-
-    prefixes_worked[nr_of_px].pfx[0] = '\0';
-    prefixes_worked[nr_of_px].bands = 0;
-
-    for (q = 0; q <= nr_of_px; q++) {
-
-	if (strcmp(pxstr, prefixes_worked[q].pfx) == 0) {
-	    /* pfx already worked */
-	    found = 1;
-	    if (prefixes_worked[q].bands & inxes[bandindex]) {
-		bandfound = 1;
-	    } else {
-		/* pfx new on band */
-		prefixes_worked[q].bands |= inxes[bandindex];
-		nr_of_px_ab++;
-		pfxs_per_band[bandindex]++;
-	    }
-	    break;
+    int found = 0, bandfound = 0;
+
+    int q = mult_registry_find(&worked_pfxs, pxstr);
+
+    if (q >= 0) {
+	/* pfx already worked */
+	found = 1;
+	if (prefixes_worked[q].band & inxes[bandindex]) {
+	    bandfound = 1;
+	} else {
+	    /* pfx new on band */
+	    JOURNAL(nr_of_px_ab);
+	    JOURNAL(pfxs_per_band[bandindex]);
+	    mult_registry_add_bands(&worked_pfxs, q, inxes[bandindex]);
+	    nr_of_px_ab++;
+	    pfxs_per_band[bandindex]++;
 	}
-    }
-
-    if (found != 1) {
+    } else {
 	/* new pfx */
-	g_strlcpy(prefixes_worked[nr_of_px].pfx, pxstr, MAX_PFX_LEN + 1);
-	prefixes_worked[nr_of_px].bands |= inxes[bandindex];
-	nr_of_px++;
+	JOURNAL(nr_of_px_ab);
+	JOURNAL(pfxs_per_band[bandindex]);
+	q = mult_registry_add(&worked_pfxs, pxstr);
+	mult_registry_add_bands(&worked_pfxs, q, inxes[bandindex]);
 	nr_of_px_ab++;
 	pfxs_per_band[bandindex]++;
     }
@@ -140,10 +118,37 @@ unsigned int GetNrOfPfx_OnBand(unsigned int bandindex) {
 }
 
 
+/** worked prefix number 'index' and the bands it was worked on
+ *
+ * \return the prefix or NULL if index is out of range */
+const char *get_worked_pfx(unsigned int index, int *bands) {
+    if (index >= nr_of_px)
+	return NULL;
+
+    *bands = prefixes_worked[index].band;
+    return prefixes_worked[index].name;
+}
+
+
+/** append a prefix worked on 'bands' to the list, e.g. when restoring
+ * a saved scoring state */
+void restore_worked_pfx(const char *pxstr, int bands) {
+    int index = mult_registry_add(&worked_pfxs, pxstr);
+    mult_registry_add_bands(&worked_pfxs, index, bands);
+
+    for (int i = 0; i < NBANDS; i++) {
+	if (bands & inxes[i]) {
+	    nr_of_px_ab++;
+	    pfxs_per_band[i]++;
+	}
+    }
+}
+
+
 void InitPfx() {
     int i;
 
-    nr_of_px = 0;
+    mult_registry_clear(&worked_pfxs);
     nr_of_px_ab = 0;
 
     for (i = 0; i < NBANDS; i++) {
@@ -29,6 +29,8 @@ int add_pfx(char *pxstr, unsigned int bandindex);
 unsigned int GetNrOfPfx_once();
 unsigned int GetNrOfPfx_multiband();
 unsigned int GetNrOfPfx_OnBand(unsigned int bandindex);
+const char *get_worked_pfx(unsigned int index, int *bands);
+void restore_worked_pfx(const char *pxstr, int bands);
 void InitPfx();
 
 #endif /* ADDPFX_H */
@@ -0,0 +1,285 @@
+/*
+ * Tlf - contest logging program for amateur radio operators
+ * Copyright (C) 2026 The Tlf developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+/* ------------------------------------------------------------
+ *        Aho-Corasick matcher for multiplier names and aliases
+ *
+ *   All patterns go into one trie. Its transitions are completed to
+ *   a DFA (missing ones follow the failure links), so a lookup makes
+ *   exactly one table step per character of the searched string.
+ *   Characters not used in any pattern share one column which leads
+ *   back to the root.
+ *
+ *   Every node knows the longest pattern ending in it, directly or
+ *   further down its failure chain, so the longest match needs no
+ *   walks along the chain.
+ *
+ *--------------------------------------------------------------*/
+
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "alias_matcher.h"
+
+typedef struct {
+    int fail;		/* node of the longest proper suffix */
+    int dict;		/* next node with ids on the failure chain or -1 */
+    int depth;		/* length of the string leading here */
+    GArray *ids;	/* ids of the pattern ending here (ascending) */
+    int best_len;	/* longest pattern ending here, 0 if none */
+    int best_id;	/* smallest id of that pattern */
+} ac_node_t;
+
+struct alias_matcher {
+    GPtrArray *patterns;	/* collected patterns until built */
+    GArray *pattern_ids;
+    guchar column[256];		/* character -> column, 0 if unused */
+    int width;			/* columns per node */
+    GArray *nodes;		/* ac_node_t, root is node 0 */
+    GArray *next;		/* transitions, 'width' ints per node */
+};
+
+
+#define NODE(m, n)	g_array_index((m)->nodes, ac_node_t, (n))
+#define NEXT(m, n, c)	g_array_index((m)->next, int, (n) * (m)->width + (c))
+
+
+alias_matcher_t *alias_matcher_new(void) {
+    alias_matcher_t *matcher = g_new0(alias_matcher_t, 1);
+
+    matcher->patterns = g_ptr_array_new_with_free_func(g_free);
+    matcher->pattern_ids = g_array_new(FALSE, FALSE, sizeof(int));
+    matcher->nodes = g_array_new(FALSE, TRUE, sizeof(ac_node_t));
+    matcher->next = g_array_new(FALSE, FALSE, sizeof(int));
+    return matcher;
+}
+
+void alias_matcher_free(alias_matcher_t *matcher) {
+    if (matcher == NULL) {
+	return;
+    }
+
+    for (int i = 0; i < matcher->nodes->len; i++) {
+	if (NODE(matcher, i).ids != NULL) {
+	    g_array_free(NODE(matcher, i).ids, TRUE);
+	}
+    }
+    g_array_free(matcher->nodes, TRUE);
+    g_array_free(matcher->next, TRUE);
+    g_ptr_array_free(matcher->patterns, TRUE);
+    g_array_free(matcher->pattern_ids, TRUE);
+    g_free(matcher);
+}
+
+/** add 'pattern' for 'id', takes effect with alias_matcher_build() */
+void alias_matcher_add(alias_matcher_t *matcher, const char *pattern,
+		       int id) {
+    if (*pattern == '\0') {
+	return;		/* matches everywhere with length 0 */
+    }
+    g_ptr_array_add(matcher->patterns, g_strdup(pattern));
+    g_array_append_val(matcher->pattern_ids, id);
+}
+
+
+static int new_node(alias_matcher_t *matcher, int depth) {
+    ac_node_t node = { .dict = -1, .depth = depth };
+    int missing = -1;
+
+    g_array_append_val(matcher->nodes, node);
+    for (int c = 0; c < matcher->width; c++) {
+	g_array_append_val(matcher->next, missing);
+    }
+    return matcher->nodes->len - 1;
+}
+
+static void add_id(ac_node_t *node, int id) {
+    if (node->ids == NULL) {
+	node->ids = g_array_new(FALSE, FALSE, sizeof(int));
+    }
+
+    int i = node->ids->len;
+    while (i > 0 && g_array_index(node->ids, int, i - 1) > id) {
+	i--;
+    }
+    if (i > 0 && g_array_index(node->ids, int, i - 1) == id) {
+	return;
+    }
+    g_array_insert_val(node->ids, i, id);
+}
+
+static void insert(alias_matcher_t *matcher, const guchar *pattern, int id) {
+    int node = 0;
+
+    for (int depth = 1; *pattern != '\0'; pattern++, depth++) {
+	int c = matcher->column[*pattern];
+	if (NEXT(matcher, node, c) < 0) {
+	    int child = new_node(matcher, depth);
+	    NEXT(matcher, node, c) = child;
+	}
+	node = NEXT(matcher, node, c);
+    }
+    add_id(&NODE(matcher, node), id);
+}
+
+/* set the failure link of 'child' of 'parent' reached by column 'c' */
+static void link_node(alias_matcher_t *matcher, int parent, int c, int child) {
+    ac_node_t *node = &NODE(matcher, child);
+    int fail = (parent == 0) ? 0 : NEXT(matcher, NODE(matcher, parent).fail, c);
+    ac_node_t *suffix = &NODE(matcher, fail);
+
+    node->fail = fail;
+    node->dict = (suffix->ids != NULL) ? fail : suffix->dict;
+    if (node->ids != NULL) {
+	node->best_len = node->depth;
+	node->best_id = g_array_index(node->ids, int, 0);
+    } else {
+	node->best_len = suffix->best_len;
+	node->best_id = suffix->best_id;
+    }
+}
+
+/** build the automaton from the patterns added so far */
+void alias_matcher_build(alias_matcher_t *matcher) {
+    int nr_columns = 1;
+
+    memset(matcher->column, 0, sizeof(matcher->column));
+    for (int i = 0; i < matcher->patterns->len; i++) {
+	const guchar *p = g_ptr_array_index(matcher->patterns, i);
+	for (; *p != '\0'; p++) {
+	    if (matcher->column[*p] == 0) {
+		matcher->column[*p] = nr_columns++;
+	    }
+	}
+    }
+
+    matcher->width = nr_columns;
+    g_array_set_size(matcher->nodes, 0);
+    g_array_set_size(matcher->next, 0);
+    new_node(matcher, 0);
+    for (int i = 0; i < matcher->patterns->len; i++) {
+	insert(matcher, g_ptr_array_index(matcher->patterns, i),
+	       g_array_index(matcher->pattern_ids, int, i));
+    }
+
+    /* breadth first, so the failure chain is done before the node */
+    GQueue queue = G_QUEUE_INIT;
+    g_queue_push_tail(&queue, GINT_TO_POINTER(0));
+    while (!g_queue_is_empty(&queue)) {
+	int parent = GPOINTER_TO_INT(g_queue_pop_head(&queue));
+	for (int c = 0; c < matcher->width; c++) {
+	    int child = NEXT(matcher, parent, c);
+	    if (child < 0) {
+		NEXT(matcher, parent, c) = (parent == 0) ? 0 :
+					   NEXT(matcher, NODE(matcher, parent).fail, c);
+		continue;
+	    }
+	    link_node(matcher, parent, c, child);
+	    g_queue_push_tail(&queue, GINT_TO_POINTER(child));
+	}
+    }
+}
+
+
+static int step(const alias_matcher_t *matcher, int node, guchar ch) {
+    return g_array_index(matcher->next, int,
+			 node * matcher->width + matcher->column[ch]);
+}
+
+/** longest pattern found in 'str'
+ *
+ * \param id - set to the smallest id having a pattern of that length
+ * \return length of the pattern, 0 if none found
+ */
+unsigned int alias_matcher_longest(const alias_matcher_t *matcher,
+				   const char *str, int *id) {
+    int node = 0;
+    int len = 0;
+
+    if (matcher->width == 0) {
+	return 0;
+    }
+
+    for (const guchar *p = (const guchar *)str; *p != '\0'; p++) {
+	node = step(matcher, node, *p);
+	const ac_node_t *n = &NODE(matcher, node);
+	if (n->best_len > len || (n->best_len == len && len > 0
+				  && n->best_id < *id)) {
+	    len = n->best_len;
+	    *id = n->best_id;
+	}
+    }
+    return len;
+}
+
+static bool has_id(const ac_node_t *node, int id) {
+    for (int i = 0; i < node->ids->len; i++) {
+	if (g_array_index(node->ids, int, i) == id) {
+	    return true;
+	}
+    }
+    return false;
+}
+
+/** longest pattern for 'id' found in 'str', 0 if none */
+unsigned int alias_matcher_longest_of(const alias_matcher_t *matcher,
+				      const char *str, int id) {
+    int node = 0;
+    int len = 0;
+
+    if (matcher->width == 0) {
+	return 0;
+    }
+
+    for (const guchar *p = (const guchar *)str; *p != '\0'; p++) {
+	node = step(matcher, node, *p);
+	int match = (NODE(matcher, node).ids != NULL) ? node :
+		    NODE(matcher, node).dict;
+	/* the chain gets shorter, the first hit is the longest one */
+	for (; match >= 0 && NODE(matcher, match).depth > len;
+		match = NODE(matcher, match).dict) {
+	    if (has_id(&NODE(matcher, match), id)) {
+		len = NODE(matcher, match).depth;
+		break;
+	    }
+	}
+    }
+    return len;
+}
+
+/** smallest id with a pattern equal to 'str', -1 if none */
+int alias_matcher_exact(const alias_matcher_t *matcher, const char *str) {
+    int node = 0;
+    int len = strlen(str);
+
+    if (matcher->width == 0 || len == 0) {
+	return -1;
+    }
+
+    for (const guchar *p = (const guchar *)str; *p != '\0'; p++) {
+	node = step(matcher, node, *p);
+    }
+
+    const ac_node_t *n = &NODE(matcher, node);
+    if (n->depth != len || n->ids == NULL) {
+	return -1;
+    }
+    return g_array_index(n->ids, int, 0);
+}
@@ -0,0 +1,39 @@
+/*
+ * Tlf - contest logging program for amateur radio operators
+ * Copyright (C) 2026 The Tlf developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+
+#ifndef ALIAS_MATCHER_H
+#define ALIAS_MATCHER_H
+
+#include <glib.h>
+
+/* finds names and aliases of multipliers in a string, see alias_matcher.c */
+typedef struct alias_matcher alias_matcher_t;
+
+alias_matcher_t *alias_matcher_new(void);
+void alias_matcher_free(alias_matcher_t *matcher);
+void alias_matcher_add(alias_matcher_t *matcher, const char *pattern, int id);
+void alias_matcher_build(alias_matcher_t *matcher);
+unsigned int alias_matcher_longest(const alias_matcher_t *matcher,
+				   const char *str, int *id);
+unsigned int alias_matcher_longest_of(const alias_matcher_t *matcher,
+				      const char *str, int id);
+int alias_matcher_exact(const alias_matcher_t *matcher, const char *str);
+
+#endif /* ALIAS_MATCHER_H */
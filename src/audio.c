@@ -37,6 +37,7 @@
 
 #include "clear_display.h"
 #include "err_utils.h"
+#include "gettxinfo.h"
 #include "globalvars.h"
 #include "ignore_unused.h"
 #include "keystroke_names.h"
@@ -424,7 +425,7 @@ void *play_thread(void *ptr) {
     /* CAT PTT wanted and available, use it. */
     if (rigptt == CAT_PTT_USE) {
 	/* Request PTT On */
-	rigptt |= CAT_PTT_ON;
+	set_rig_ptt(true);
     } else {		/* Fall back to netkeyer interface */
 	netkeyer(K_PTT, "1");	// ptt on
     }
@@ -436,7 +437,7 @@ void *play_thread(void *ptr) {
     /* CAT PTT wanted, available, and active. */
     if (rigptt == (CAT_PTT_USE | CAT_PTT_ACTIVE)) {
 	/* Request PTT Off */
-	rigptt |= CAT_PTT_OFF;
+	set_rig_ptt(false);
     } else {		/* Fall back to netkeyer interface */
 	netkeyer(K_PTT, "0");	// ptt off
     }
@@ -20,8 +20,12 @@
 
 
 #include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
 
 #include "background_process.h"
@@ -29,17 +33,22 @@
 #include "err_utils.h"
 #include "fldigixmlrpc.h"
 #include "get_time.h"
-#include "gettxinfo.h"
+#include "ignore_unused.h"
+#include "lan_seq.h"
 #include "lancode.h"
+#include "log_index.h"
 #include "log_to_disk.h"
 #include "qsonr_to_str.h"
 #include "qtc_log.h"
 #include "qtcutil.h"
 #include "qtcvars.h"
+#include "redraw.h"
 #include "rtty.h"
 #include "splitscreen.h"
 #include "tlf.h"
-#include "write_keyer.h"
+
+#define FLDIGI_POLL_INTERVAL	100	/* ms */
+#define CLUSTER_POLL_INTERVAL	100	/* ms */
 
 // don't start until we know what we are doing
 static bool stop_backgrnd_process = true;
@@ -48,10 +57,199 @@ static pthread_mutex_t stop_backgrnd_process_mutex = PTHREAD_MUTEX_INITIALIZER;
 static pthread_cond_t start_backgrnd_process_cond = PTHREAD_COND_INITIALIZER;
 static pthread_cond_t backgrnd_process_stopped_cond = PTHREAD_COND_INITIALIZER;
 
+static const char *source_names[BG_SOURCE_COUNT] = {
+    [BG_SOURCE_LAN] = "lan",
+    [BG_SOURCE_CLUSTER] = "cluster",
+    [BG_SOURCE_RTTY] = "rtty",
+    [BG_SOURCE_NOTIFY] = "notify",
+    [BG_SOURCE_FLDIGI_TIMER] = "fldigi",
+    [BG_SOURCE_CLUSTER_TIMER] = "cluster poll",
+    [BG_SOURCE_REDRAW_TIMER] = "redraw",
+};
+
+static gint wakeup_count[BG_SOURCE_COUNT];
+
+/* pipe used by other threads to wake up the background process */
+static int wakeup_pipe[2] = {-1, -1};
+static pthread_once_t wakeup_pipe_once = PTHREAD_ONCE_INIT;
+
+typedef struct {
+    bg_source_t source;
+    int interval;	/* ms */
+    double due;		/* ms, monotonic clock */
+} bg_timer_t;
+
+static bg_timer_t timers[] = {
+    {BG_SOURCE_FLDIGI_TIMER, FLDIGI_POLL_INTERVAL, 0},
+    {BG_SOURCE_CLUSTER_TIMER, CLUSTER_POLL_INTERVAL, 0},
+    {BG_SOURCE_REDRAW_TIMER, 0, 0},	/* interval set from FRAME_RATE */
+};
+
+/* cluster fd reported a hangup (e.g. FIFO writer gone), poll it by timer */
+static bool cluster_hangup = false;
+
+/* messages read from the LAN but not handled yet */
+static lan_message_t lan_queue[LAN_RECV_BATCH];
+static int lan_queued = 0;
+static int lan_next = 0;
+
+
+static void init_wakeup_pipe(void) {
+    if (pipe(wakeup_pipe) != 0) {
+	wakeup_pipe[0] = wakeup_pipe[1] = -1;
+	return;
+    }
+    fcntl(wakeup_pipe[0], F_SETFL, O_NONBLOCK);
+    fcntl(wakeup_pipe[1], F_SETFL, O_NONBLOCK);
+}
+
+/** wake up the background process
+ *
+ * To be called from other threads after requesting work from the
+ * background process (cw simulator, ...) */
+void background_wakeup(void) {
+    pthread_once(&wakeup_pipe_once, init_wakeup_pipe);
+
+    if (wakeup_pipe[1] >= 0) {
+	char c = 0;
+	/* a full pipe means a wakeup is pending anyway */
+	IGNORE(write(wakeup_pipe[1], &c, 1));
+    }
+}
+
+static void drain_wakeup_pipe(void) {
+    char buf[64];
+
+    while (read(wakeup_pipe[0], buf, sizeof(buf)) > 0)
+	;
+}
+
+/** number of wakeups of the background process caused by source */
+int background_wakeup_count(bg_source_t source) {
+    return g_atomic_int_get(&wakeup_count[source]);
+}
+
+const char *background_source_name(bg_source_t source) {
+    return source_names[source];
+}
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static bool rtty_active(void) {
+    return (trxmode == DIGIMODE && digikeyer != NO_KEYER);
+}
+
+static bool timer_active(bg_source_t source) {
+    switch (source) {
+	case BG_SOURCE_FLDIGI_TIMER:
+	    return (digikeyer == FLDIGI && fldigi_isenabled() && trx_control);
+	case BG_SOURCE_CLUSTER_TIMER:
+	    return (packetinterface != 0
+		    && (packet_fd() < 0 || cluster_hangup));
+	case BG_SOURCE_REDRAW_TIMER:
+	    return redraw_background_pending();
+	default:
+	    return false;
+    }
+}
+
+static int add_fd(struct pollfd *fds, int *nfds, int fd) {
+    if (fd < 0) {
+	return -1;
+    }
+    fds[*nfds].fd = fd;
+    fds[*nfds].events = POLLIN;
+    fds[*nfds].revents = 0;
+    return (*nfds)++;
+}
+
+static bool fd_ready(struct pollfd *fds, int index) {
+    return (index >= 0 && (fds[index].revents & (POLLIN | POLLERR)) != 0);
+}
+
+/* wait until one of the sources has work to do or a timer is due
+ * and mark these sources in ready[]. Does not block if 'nowait' is set. */
+static void wait_for_events(bool *ready, bool nowait) {
+    struct pollfd fds[4];
+    int nfds = 0;
+
+    pthread_once(&wakeup_pipe_once, init_wakeup_pipe);
+
+    int notify_idx = add_fd(fds, &nfds, wakeup_pipe[0]);
+    int lan_idx = add_fd(fds, &nfds,
+			 lan_active ? lan_socket_descriptor : -1);
+    int cluster_idx = add_fd(fds, &nfds,
+			     (packetinterface != 0 && !cluster_hangup) ?
+			     packet_fd() : -1);
+    int rtty_idx = add_fd(fds, &nfds,
+			  rtty_active() ? controller_fd() : -1);
+
+    /* timeout until next active timer is due */
+    double now = now_ms();
+    int timeout = -1;
+    for (int i = 0; i < LEN(timers); i++) {
+	if (!timer_active(timers[i].source)) {
+	    continue;
+	}
+	int t = (timers[i].due > now ? (int)(timers[i].due - now) + 1 : 0);
+	if (timeout < 0 || t < timeout) {
+	    timeout = t;
+	}
+    }
+    if (nowait) {
+	timeout = 0;
+    }
+
+    if (poll(fds, nfds, timeout) < 0 && errno != EINTR) {
+	usleep(10000);		/* should not happen, avoid busy loop */
+    }
+
+    ready[BG_SOURCE_NOTIFY] = fd_ready(fds, notify_idx);
+    ready[BG_SOURCE_LAN] = fd_ready(fds, lan_idx);
+    ready[BG_SOURCE_CLUSTER] = fd_ready(fds, cluster_idx);
+    ready[BG_SOURCE_RTTY] = fd_ready(fds, rtty_idx);
+
+    if (cluster_idx >= 0 && !ready[BG_SOURCE_CLUSTER]
+	    && (fds[cluster_idx].revents & POLLHUP)) {
+	cluster_hangup = true;
+    }
+
+    now = now_ms();
+    for (int i = 0; i < LEN(timers); i++) {
+	if (timer_active(timers[i].source) && timers[i].due <= now) {
+	    ready[timers[i].source] = true;
+	}
+    }
+
+    for (int i = 0; i < BG_SOURCE_COUNT; i++) {
+	if (ready[i]) {
+	    g_atomic_int_inc(&wakeup_count[i]);
+	}
+    }
+
+    if (ready[BG_SOURCE_NOTIFY]) {
+	drain_wakeup_pipe();
+    }
+}
+
+/* restart timer of 'source' after its work is done */
+static void restart_timer(bg_source_t source) {
+    for (int i = 0; i < LEN(timers); i++) {
+	if (timers[i].source == source) {
+	    timers[i].due = now_ms() + timers[i].interval;
+	}
+    }
+}
+
 void stop_background_process(void) {
     pthread_mutex_lock(&stop_backgrnd_process_mutex);
     assert(!stop_backgrnd_process);
     stop_backgrnd_process = true;
+    background_wakeup();
     pthread_cond_wait(&backgrnd_process_stopped_cond, &stop_backgrnd_process_mutex);
     pthread_mutex_unlock(&stop_backgrnd_process_mutex);
 }
@@ -73,29 +271,187 @@ static void background_process_wait(void) {
     pthread_mutex_unlock(&stop_backgrnd_process_mutex);
 }
 
-void *background_process(void *ptr) {
+static void debug_lan_message(const lan_message_t *msg) {
+    char debugbuffer[160];
+    FILE *fp;
 
-    char *prmessage;
-    static int lantimesync = 0;
-    static int fldigi_rpc_cnt = 0;
+    if ((fp = fopen("debuglog", "a")) == NULL) {
+	printf("store_qso.c: Error opening debug file.\n");
+    } else {
+	format_time(debugbuffer, sizeof(debugbuffer), "%H:%M:%S-");
+	fputs(debugbuffer, fp);
+	fputc(msg->node, fp);
+	fputc(msg->opcode, fp);
+	fputs(msg->data, fp);
+	fputs("\n", fp);
+	fclose(fp);
+    }
+}
 
+/* act on a message from another node */
+static void handle_lan_message(const lan_message_t *msg) {
+    static int lantimesync = 0;
+    lan_message_t inner;
+    char *prmessage;
     int n;
 
-    char debugbuffer[160];
-    FILE *fp;
+    if (landebug) {
+	debug_lan_message(msg);
+    }
 
-    while (1) {
+    if (msg->node == thisnode) {
+	TLF_LOG_WARN("%s", "Warning: NODE ID CONFLICT ?! You should use another ID! ");
+	return;
+    }
 
-	background_process_wait();
+    switch (msg->opcode) {
+
+	case LOGENTRY:
+
+	    if (msg->catchup && log_index_has_line(msg->data))
+		break;		/* logged before our restart */
+	    log_to_disk(msg);
+	    break;
+
+	case QTCRENTRY:
+
+	    store_qtc((char *)msg->data, RECV, QTC_RECV_LOG);
+	    break;
+
+	case QTCSENTRY:
+
+	    store_qtc((char *)msg->data, SEND, QTC_SENT_LOG);
+	    break;
+
+	case QTCFLAG:
+
+	    parse_qtc_flagline((char *)msg->data);
+	    break;
+
+	case CLUSTERMSG:
+	    prmessage = g_strndup(msg->data, 80);
+	    if (strstr(prmessage, my.call) != NULL) {	// alert for cluster messages
+		TLF_LOG_INFO(prmessage);
+	    }
+
+	    addtext(prmessage);
+	    g_free(prmessage);
+	    break;
+	case TLFSPOT:
+	    prmessage = g_strndup(msg->data, 80);
+	    lanspotflg = true;
+	    addtext(prmessage);
+	    lanspotflg = false;
+	    g_free(prmessage);
+	    break;
+	case TLFMSG:
+	    for (int t = 0; t < 4; t++)
+		strcpy(talkarray[t], talkarray[t + 1]);
+
+	    talkarray[4][0] = msg->node;
+	    talkarray[4][1] = ':';
+	    talkarray[4][2] = '\0';
+	    g_strlcat(talkarray[4], msg->data, sizeof(talkarray[4]));
+	    TLF_LOG_INFO(" MSG from %s", talkarray[4]);
+	    break;
+	case FREQMSG:
+	    if ((msg->node >= 'A') && (msg->node <= 'A' + MAXNODES)) {
+		node_frequencies[msg->node - 'A'] = atof(msg->data) * 1000.0;
+	    }
+	    break;
+	case INCQSONUM:
+
+	    n = atoi(msg->data);
+
+	    if (highqsonr < n)
+		highqsonr = n;
 
-	usleep(10000);
+	    if ((qsonum <= n) && (n > 0)) {
+		qsonum = highqsonr + 1;
+		qsonr_to_str(qsonrstr, qsonum);
+	    }
+	    break;
+
+	case SEQENTRY:
+	case SEQSTATUS:
+	case SEQREQUEST:
+	    if (lan_seq_receive(msg, &inner))
+		handle_lan_message(&inner);
+	    break;
+
+	case TIMESYNC:
+	    if ((msg->node >= 'A') && (msg->node <= 'A' + MAXNODES)) {
+		time_t lantime = atoi(msg->data);
+
+		time_t delta = lantime - (get_time() - timecorr);
+
+		if (lantimesync == 1) {
+		    timecorr = (4 * timecorr + delta) / 5;
+		} else {
+		    timecorr = delta;
+		    lantimesync = 1;
+		}
+	    }
+	    break;
+    }
+}
+
+/* read all pending messages from the LAN and handle them
+ *
+ * Messages already read are kept in lan_queue if the background process
+ * gets stopped meanwhile, they are handled after restart. */
+static void handle_lan_messages(void) {
+    while (!stop_backgrnd_process) {
+	if (lan_next == lan_queued) {
+	    lan_next = 0;
+	    lan_queued = lan_recv(lan_queue, LAN_RECV_BATCH);
+	    if (lan_queued <= 0) {
+		lan_queued = 0;
+		return;		/* no more messages */
+	    }
+	}
 
-	if (packetinterface != 0) {
-	    receive_packet();
+	handle_lan_message(&lan_queue[lan_next++]);
 
+	if (lan_next == lan_queued) {
+	    lan_next = lan_queued = 0;
 	}
+    }
+}
 
-	if (trxmode == DIGIMODE && digikeyer != NO_KEYER)
+void *background_process(void *ptr) {
+
+    bool cluster_pending = false;	/* more telnet lines may be buffered */
+
+    for (int i = 0; i < LEN(timers); i++) {
+	if (timers[i].source == BG_SOURCE_REDRAW_TIMER)
+	    timers[i].interval = redraw_interval();
+    }
+
+    while (1) {
+
+	background_process_wait();
+
+	bool ready[BG_SOURCE_COUNT] = { false };
+	wait_for_events(ready, cluster_pending);
+
+	if (packetinterface != 0 && (ready[BG_SOURCE_CLUSTER]
+				     || ready[BG_SOURCE_CLUSTER_TIMER]
+				     || cluster_pending)) {
+	    int received = receive_packet();
+	    cluster_pending = (received > 0);
+	    if (ready[BG_SOURCE_CLUSTER_TIMER]) {
+		cluster_hangup = false;		/* try waiting on fd again */
+		restart_timer(BG_SOURCE_CLUSTER_TIMER);
+	    }
+	    if (received < 0) {
+		cluster_hangup = true;	/* retry from the timer */
+	    }
+	} else {
+	    cluster_pending = false;
+	}
+
+	if (rtty_active() && ready[BG_SOURCE_RTTY])
 	    rx_rtty();
 
 	/*
@@ -104,150 +460,35 @@ void *background_process(void *ptr) {
 	 * this function helps to show the correct freq of the RIG: reads
 	 * the carrier value from Fldigi, and stores in a variable; then
 	 * it readable by fldigi_get_carrier()
-	 * only need at every 2nd cycle
+	 * called every FLDIGI_POLL_INTERVAL ms
 	 * see fldigixmlrpc.[ch]
 	 *
 	 * There are two addition routines
 	 *   fldigi_get_log_call() reads the callsign, if user clicks to a string in Fldigi's RX window
 	 *   fldigi_get_log_serial_number() reads the exchange
 	 */
-	if (digikeyer == FLDIGI && fldigi_isenabled() && trx_control) {
-	    if (fldigi_rpc_cnt == 0) {
-		fldigi_xmlrpc_get_carrier();
-		fldigi_get_log_call();
-		fldigi_get_log_serial_number();
-	    }
-	    fldigi_rpc_cnt = 1 - fldigi_rpc_cnt;
+	if (ready[BG_SOURCE_FLDIGI_TIMER]) {
+	    fldigi_xmlrpc_get_carrier();
+	    fldigi_get_log_call();
+	    fldigi_get_log_serial_number();
+	    restart_timer(BG_SOURCE_FLDIGI_TIMER);
+	}
+
+	/* draw frames which were held back by the redraw scheduler,
+	 * the input loop takes care of the user interface areas */
+	if (ready[BG_SOURCE_REDRAW_TIMER]) {
+	    redraw_flush_background();
+	    restart_timer(BG_SOURCE_REDRAW_TIMER);
 	}
 
 	if (!stop_backgrnd_process) {
-	    write_keyer();
 	    cqww_simulator();
 	}
 
-	if (lan_active) {
-	    if (lan_message[0] == '\0') {
-
-		if (lan_recv() >= 0) {
-		    lan_message[strlen(lan_message) - 1] = '\0';
-		}
-	    }
-
-	    if (landebug && strlen(lan_message) > 2) {
-		if ((fp = fopen("debuglog", "a")) == NULL) {
-		    printf("store_qso.c: Error opening debug file.\n");
-		} else {
-		    format_time(debugbuffer, sizeof(debugbuffer), "%H:%M:%S-");
-		    fputs(debugbuffer, fp);
-		    fputs(lan_message, fp);
-		    fputs("\n", fp);
-		    fclose(fp);
-		}
-	    }
-	    if ((*lan_message != '\0') && (lan_message[0] == thisnode)) {
-		TLF_LOG_WARN("%s", "Warning: NODE ID CONFLICT ?! You should use another ID! ");
-	    }
-
-	    if ((*lan_message != '\0')
-		    && (lan_message[0] != thisnode)
-		    && !stop_backgrnd_process) {
-
-		switch (lan_message[1]) {
-
-		    case LOGENTRY:
-
-			log_to_disk(true);
-			break;
-
-		    case QTCRENTRY:
-
-			store_qtc(lan_message + 2, RECV, QTC_RECV_LOG);
-			break;
-
-		    case QTCSENTRY:
-
-			store_qtc(lan_message + 2, SEND, QTC_SENT_LOG);
-			break;
-
-		    case QTCFLAG:
-
-			parse_qtc_flagline(lan_message + 2);
-			break;
-
-		    case CLUSTERMSG:
-			prmessage = g_strndup(lan_message + 2, 80);
-			if (strstr(prmessage, my.call) != NULL) {	// alert for cluster messages
-			    TLF_LOG_INFO(prmessage);
-			}
-
-			addtext(prmessage);
-			g_free(prmessage);
-			break;
-		    case TLFSPOT:
-			prmessage = g_strndup(lan_message + 2, 80);
-			lanspotflg = true;
-			addtext(prmessage);
-			lanspotflg = false;
-			g_free(prmessage);
-			break;
-		    case TLFMSG:
-			for (int t = 0; t < 4; t++)
-			    strcpy(talkarray[t], talkarray[t + 1]);
-
-			talkarray[4][0] = lan_message[0];
-			talkarray[4][1] = ':';
-			talkarray[4][2] = '\0';
-			g_strlcat(talkarray[4], lan_message + 2,
-				  sizeof(talkarray[4]));
-			TLF_LOG_INFO(" MSG from %s", talkarray[4]);
-			break;
-		    case FREQMSG:
-			if ((lan_message[0] >= 'A')
-				&& (lan_message[0] <= 'A' + MAXNODES)) {
-			    node_frequencies[lan_message[0] - 'A'] =
-				atof(lan_message + 2) * 1000.0;
-			    break;
-			}
-		    case INCQSONUM:
-
-			n = atoi(lan_message + 2);
-
-			if (highqsonr < n)
-			    highqsonr = n;
-
-			if ((qsonum <= n) && (n > 0)) {
-			    qsonum = highqsonr + 1;
-			    qsonr_to_str(qsonrstr, qsonum);
-			}
-			lan_message[0] = '\0';
-
-		    case TIMESYNC:
-			if ((lan_message[0] >= 'A')
-				&& (lan_message[0] <= 'A' + MAXNODES)) {
-			    time_t lantime = atoi(lan_message + 2);
-
-			    time_t delta = lantime - (get_time() - timecorr);
-
-			    if (lantimesync == 1) {
-				timecorr = (4 * timecorr + delta) / 5;
-			    } else {
-				timecorr = delta;
-				lantimesync = 1;
-			    }
-
-			    break;
-			}
-		}
-
-		lan_message[0] = '\0';
-		lan_message[1] = '\0';
-
-	    }
-
+	if (lan_active && (ready[BG_SOURCE_LAN] || lan_queued > 0)) {
+	    handle_lan_messages();
 	}
 
-	gettxinfo();		/* get freq info from TRX */
-
     }
 
 }
@@ -22,8 +22,23 @@
 #ifndef BACKGROUND_PROCESS_H
 #define BACKGROUND_PROCESS_H
 
+/* sources which wake up the background process */
+typedef enum {
+    BG_SOURCE_LAN,
+    BG_SOURCE_CLUSTER,
+    BG_SOURCE_RTTY,
+    BG_SOURCE_NOTIFY,		/* background_wakeup() */
+    BG_SOURCE_FLDIGI_TIMER,
+    BG_SOURCE_CLUSTER_TIMER,	/* cluster without pollable fd */
+    BG_SOURCE_REDRAW_TIMER,	/* pending screen redraw */
+    BG_SOURCE_COUNT
+} bg_source_t;
+
 void *background_process(void *);
 void stop_background_process(void);
 void start_background_process(void);
+void background_wakeup(void);
+int background_wakeup_count(bg_source_t source);
+const char *background_source_name(bg_source_t source);
 
 #endif /* end of include guard: BACKGROUND_PROCESS_H */
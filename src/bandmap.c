@@ -27,9 +27,12 @@
 #include <math.h>
 
 #include "bandmap.h"
+#include "cluster_spots.h"
 #include "qtcutil.h"
 #include "qtcvars.h"		// Includes globalvars.h
+#include "redraw.h"
 #include "searchcallarray.h"
+#include "score_journal.h"
 #include "searchlog.h"
 #include "setcontest.h"
 #include "tlf_curses.h"
@@ -48,6 +51,8 @@
 #define SPOT_FREQ_WIDTH 7
 #define SPOT_CALL_WIDTH SPOT_COLUMN_WIDTH-SPOT_FREQ_WIDTH-4     // 3 spaces before and 1 after call
 
+#define SPOT_KEY_SIZE 64		/* call, band and mode */
+
 #define DISTANCE(x, y) \
     ( x < y ? y - x : x -y )
 
@@ -60,14 +65,45 @@
 
 pthread_mutex_t bm_mutex = PTHREAD_MUTEX_INITIALIZER;
 
-/** \brief sorted list of all recent DX spots
+/** \brief all recent DX spots sorted by frequency
+ */
+GSequence *allspots = NULL;
+
+/** \brief position of a spot in 'allspots' by call, band and mode
  */
-GList *allspots = NULL;
+static GHashTable *spot_index = NULL;
 
 /** \brief sorted list of filtered spots
+ *
+ * Shares the spots with 'allspots'. It is brought up to date by
+ * filter_spots(), incrementally if neither the filter settings nor
+ * the scoring state have changed.
  */
 GPtrArray *spots;
 
+/** \brief copies of the spots in 'spots' as drawn by bandmap_show()
+ *
+ * The background thread updates shared spots under bm_mutex, so the
+ * display works on copies taken under the lock.
+ */
+static GArray *shown_spots = NULL;
+
+/** \brief new or moved spots not yet placed in 'spots'
+ */
+static GPtrArray *pending = NULL;
+
+/* everything 'spots' depends on besides the spots themselves */
+typedef struct {
+    bm_config_t config;
+    int bandinx;
+    int trxmode;
+    bool iscontest;
+    unsigned int generation;
+} view_key_t;
+
+static view_key_t view_key;
+static bool view_valid = false;
+
 
 bm_config_t bm_config = {
     1,	/* show all bands */
@@ -84,6 +120,45 @@ char *qtc_format(char *call);
 gint cmp_freq(spot *a, spot *b);
 void free_spot(spot *data);
 spot *copy_spot(spot *data);
+static GSequenceIter *insert_spot(spot *entry);
+
+static spot *new_spot() {
+    spot *entry = g_new0(spot, 1);
+    entry->refs = 1;
+    return entry;
+}
+
+static spot *ref_spot(spot *data) {
+    g_atomic_int_inc(&data->refs);
+    return data;
+}
+
+/* remember spot to be placed in the filtered view */
+static void spot_moved(spot *data) {
+    if (!data->moved) {
+	data->moved = true;
+	g_ptr_array_add(pending, ref_spot(data));
+    }
+}
+
+static gint cmp_spot_freq(gconstpointer a, gconstpointer b, gpointer unused) {
+    return cmp_freq((spot *)a, (spot *)b);
+}
+
+/* key for spot_index */
+static char *spot_key(char *key, const char *call, int band, int mode) {
+    snprintf(key, SPOT_KEY_SIZE, "%s %d %d", call, band, mode);
+    return key;
+}
+
+static void init_spot_containers() {
+    if (allspots != NULL)
+	return;
+
+    allspots = g_sequence_new((GDestroyNotify)free_spot);
+    spot_index = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+    pending = g_ptr_array_new_with_free_func((GDestroyNotify)free_spot);
+}
 
 /*
  * write bandmap spots to a file
@@ -92,7 +167,7 @@ void bmdata_write_file() {
 
     FILE *fp;
     spot *sp;
-    GList *found;
+    GSequenceIter *iter;
     struct timeval tv;
 
     if ((fp = fopen(".bmdata.dat", "w")) == NULL) {
@@ -106,15 +181,17 @@ void bmdata_write_file() {
 
     pthread_mutex_lock(&bm_mutex);
 
-    found = allspots;
+    init_spot_containers();
+
     fprintf(fp, "%d\n", (int)tv.tv_sec);
-    while (found != NULL) {
-	sp = found->data;
+    for (iter = g_sequence_get_begin_iter(allspots);
+	    !g_sequence_iter_is_end(iter);
+	    iter = g_sequence_iter_next(iter)) {
+	sp = g_sequence_get(iter);
 	fprintf(fp, "%s;%d;%d;%d;%c;%u;%d;%d;%d;%s\n",
 		sp->call, sp->freq, sp->mode, sp->band,
 		sp->node, sp->timeout, sp->dupe, sp->cqzone,
 		sp->ctynr, g_strchomp(sp->pfx));
-	found = found->next;
     }
 
     pthread_mutex_unlock(&bm_mutex);
@@ -145,7 +222,7 @@ void bmdata_read_file() {
 		timediff = 0;
 
 	    while (fgets(line, 50, fp)) {
-		spot *entry = g_new0(spot, 1);
+		spot *entry = new_spot();
 		fc = 0;
 		token = strtok(line, ";");
 		while (token != NULL) {
@@ -176,7 +253,7 @@ void bmdata_read_file() {
 		}
 		if (entry->timeout > timediff) {
 		    entry->timeout -= timediff;	/* remaining time */
-		    allspots = g_list_insert_sorted(allspots, entry, (GCompareFunc)cmp_freq);
+		    insert_spot(entry);
 		} else {
 		    free_spot(entry);
 		}
@@ -203,6 +280,7 @@ void bm_init() {
     init_pair(CB_OLD, COLOR_YELLOW, COLOR_WHITE);
 
     spots = g_ptr_array_new_full(128, (GDestroyNotify)free_spot);
+    init_spot_containers();
 
     bmdata_read_file();
 
@@ -230,37 +308,16 @@ int freq2mode(freq_t freq, int band) {
 /** \brief add DX spot message to bandmap
  *
  * check if cluster message is a dx spot,
- * if so split it into pieces and insert in spot list */
+ * if so insert it in spot list */
 void bm_add(char *s) {
-    char *line;
-    char *call;
-    char node = ' ';
+    cluster_spot_t spot;
 
-    line = g_strdup(s);
-    if (strncmp(line, "DX de ", 6) != 0) {
-	g_free(line);
-	return;
-    }
-
-    if ((call = strtok(line + 26, " \t")) == NULL) {
-	g_free(line);
-	return;
-    }
-
-    if (strncmp(line + 6, "TLF-", 4) == 0)
-	node = line[10];		/* get sending node id */
-
-    bandmap_addspot(call, atof(line + 16) * 1000, node);
-    g_free(line);
+    if (parse_cluster_line(s, &spot))
+	bandmap_addspot(spot.call, spot.freq, spot.node);
 }
 
 
-/* compare functions to search in list */
-gint	cmp_call(spot *ldata, char *call) {
-
-    return g_strcmp0(ldata->call, call);
-}
-
+/* compare function to sort spots */
 gint	cmp_freq(spot *a, spot *b) {
     unsigned int af = a->freq;
     unsigned int bf = b->freq;
@@ -270,13 +327,44 @@ gint	cmp_freq(spot *a, spot *b) {
     return 0;
 }
 
-/* free an allocated spot */
+/* release an allocated spot, frees it with the last reference */
 void free_spot(spot *data) {
+    if (!g_atomic_int_dec_and_test(&data->refs))
+	return;
+
     g_free(data->call);
     g_free(data->pfx);
     g_free(data);
 }
 
+/* drop a spot from 'allspots' and free it */
+static void remove_spot(GSequenceIter *iter) {
+    spot *data = g_sequence_get(iter);
+    char key[SPOT_KEY_SIZE];
+
+    g_hash_table_remove(spot_index,
+			spot_key(key, data->call, data->band, data->mode));
+    data->dropped = true;	/* views may still hold it */
+    g_sequence_remove(iter);
+}
+
+/* add a spot to 'allspots', replaces a spot of that call on same band
+ * and mode */
+static GSequenceIter *insert_spot(spot *entry) {
+    char key[SPOT_KEY_SIZE];
+    GSequenceIter *old;
+
+    spot_key(key, entry->call, entry->band, entry->mode);
+    old = g_hash_table_lookup(spot_index, key);
+    if (old != NULL)
+	remove_spot(old);
+
+    GSequenceIter *iter = g_sequence_insert_sorted(allspots, entry,
+			  cmp_spot_freq, NULL);
+    g_hash_table_insert(spot_index, g_strdup(key), iter);
+    return iter;
+}
+
 /** add a new spot to bandmap data
  * \param call  	the call to add
  * \param freq 		on which frequency heard
@@ -292,14 +380,15 @@ void bandmap_addspot(char *call, freq_t freq, char node) {
      *   remember all other frequencies exactly
      *   but display only rounded to 100 Hz - sort exact
      */
-    GList *found;
+    GSequenceIter *found;
+    spot *data;
+    char key[SPOT_KEY_SIZE];
     int band;
     char mode;
     dxcc_data *dxccdata;
     int dxccindex;
-    int wi;
+    worked_t wentry;
     char *lastexch;
-    struct ie_list *current_ie;
 
     /* add only HF spots */
     if (freq > 30000000)
@@ -314,36 +403,30 @@ void bandmap_addspot(char *call, freq_t freq, char node) {
     /* acquire bandmap mutex */
     pthread_mutex_lock(&bm_mutex);
 
+    init_spot_containers();
+
     /* look if call is already on list in that mode and band */
     /* each call is allowed in every combination of band and mode
      * but only once */
-    found = g_list_find_custom(allspots, call, (GCompareFunc)cmp_call);
-
-    while (found != NULL) {
-
-	/* if same band and mode -> found spot already in list */
-	if (((spot *)found->data)->band == band &&
-		((spot *)found->data)->mode == mode)
-	    break;
-
-	found = g_list_find_custom(found->next, call, (GCompareFunc)cmp_call);
-    }
+    found = g_hash_table_lookup(spot_index, spot_key(key, call, band, mode));
 
     /* if already in list on that band and mode
      * 		-> set timeout to SPOT_NEW, and set new freq and reporting node
-     *   		if freq has changed enough sort list anew by freq
+     *   		if freq has changed enough move it to its new place
      */
     if (found) {
-	((spot *)found->data)->timeout = SPOT_NEW;
-	((spot *)found->data)->node = node;
-	if (DISTANCE(((spot *)found->data)->freq, freq) > TOLERANCE) {
-	    ((spot *)found->data)->freq = freq;
-	    allspots = g_list_sort(allspots, (GCompareFunc)cmp_freq);
+	data = g_sequence_get(found);
+	data->timeout = SPOT_NEW;
+	data->node = node;
+	if (DISTANCE(data->freq, freq) > TOLERANCE) {
+	    data->freq = freq;
+	    g_sequence_sort_changed(found, cmp_spot_freq, NULL);
+	    spot_moved(data);
 	}
     } else {
 	/* if not in list already -> prepare new entry and
-	 * insert in list at correct freq */
-	spot *entry = g_new(spot, 1);
+	 * insert it at correct freq */
+	spot *entry = new_spot();
 	entry -> call = g_strdup(call);
 	entry -> freq = freq;
 	entry -> mode = mode;
@@ -356,21 +439,12 @@ void bandmap_addspot(char *call, freq_t freq, char node) {
 	dxccindex = getctynr(entry->call);
 	if (CONTEST_IS(CQWW)) {
 	    // check if the callsign exists in worked list
-	    wi = lookup_worked(call);
-	    if (wi >= 0) {
-		lastexch = g_strdup(worked[wi].exchange);
+	    if (copy_worked(call, &wentry)) {
+		lastexch = g_strdup(wentry.exchange);
 	    }
 
-	    if (lastexch == NULL && main_ie_list != NULL) {
-		current_ie = main_ie_list;
-
-		while (current_ie) {
-		    if (strcmp(call, current_ie->call) == 0) {
-			lastexch = g_strdup(current_ie->exchange);
-			break;
-		    }
-		    current_ie = current_ie->next;
-		}
+	    if (lastexch == NULL) {
+		lastexch = g_strdup(ie_lookup_exchange(main_ie_list, call));
 	    }
 	}
 	if (dxccindex > 0) {
@@ -387,26 +461,21 @@ void bandmap_addspot(char *call, freq_t freq, char node) {
 	    entry -> ctynr = 0;
 	    entry -> pfx = g_strdup("");
 	}
-	allspots = g_list_insert_sorted(allspots, entry, (GCompareFunc)cmp_freq);
-	/* lookup where it is */
-	found = g_list_find(allspots, entry);
+	found = insert_spot(entry);
+	spot_moved(entry);
     }
 
     /* check that spot is unique on freq +/- TOLERANCE Hz,
      * drop other entries if needed */
-    if (found->prev &&
-	    (DISTANCE(((spot *)(found->prev)->data)->freq, freq) < TOLERANCE)) {
-	spot *olddata;
-	olddata = found->prev->data;
-	allspots = g_list_remove_link(allspots, found->prev);
-	free_spot(olddata);
+    if (!g_sequence_iter_is_begin(found)) {
+	GSequenceIter *prev = g_sequence_iter_prev(found);
+	if (DISTANCE(((spot *)g_sequence_get(prev))->freq, freq) < TOLERANCE)
+	    remove_spot(prev);
     }
-    if (found->next &&
-	    (DISTANCE(((spot *)(found->next)->data)->freq, freq) < TOLERANCE)) {
-	spot *olddata;
-	olddata = found->next->data;
-	allspots = g_list_remove_link(allspots, found->next);
-	free_spot(olddata);
+    GSequenceIter *next = g_sequence_iter_next(found);
+    if (!g_sequence_iter_is_end(next) &&
+	    (DISTANCE(((spot *)g_sequence_get(next))->freq, freq) < TOLERANCE)) {
+	remove_spot(next);
     }
 
 
@@ -424,18 +493,19 @@ void bandmap_age() {
 
     pthread_mutex_lock(&bm_mutex);
 
-    GList *list = allspots;
+    init_spot_containers();
+
+    GSequenceIter *iter = g_sequence_get_begin_iter(allspots);
 
-    while (list) {
-	spot *data = list->data;
-	GList *temp = list;
-	list = list->next;
+    while (!g_sequence_iter_is_end(iter)) {
+	spot *data = g_sequence_get(iter);
+	GSequenceIter *temp = iter;
+	iter = g_sequence_iter_next(iter);
 	if (data->timeout) {
 	    data->timeout--;
 	}
 	if (data->timeout == 0) {
-	    allspots = g_list_remove_link(allspots, temp);
-	    free_spot(data);
+	    remove_spot(temp);
 	}
     }
 
@@ -473,9 +543,9 @@ bool bm_isdupe(char *call, int band) {
     if (IsWarcIndex(band))
 	return false;
 
-    int found = lookup_worked(call);
+    worked_t entry;
 
-    if (found == -1)		/* new call */
+    if (!copy_worked(call, &entry))	/* new call */
 	return false;
 
     if (qtcdirection > 0) {
@@ -488,8 +558,8 @@ bool bm_isdupe(char *call, int band) {
 	}
     }
 
-    if (worked[found].band & inxes[band]) {
-	return worked_in_current_minitest_period(found);
+    if (entry.band & inxes[band]) {
+	return entry_in_current_minitest_period(&entry);
     }
 
     return false;
@@ -594,7 +664,7 @@ void show_spot(spot *data) {
     printw("%7.1f%c", (data->freq / 1000.),
 	   (data->node == thisnode ? '*' : data->node));
 
-    if (bm_ismulti(data)) {
+    if (data->multi) {
 	attrset(COLOR_PAIR(CB_NORMAL));
 	printw("M");
 	attrset(COLOR_PAIR(CB_DUPE) | A_BOLD);
@@ -616,7 +686,7 @@ void show_spot_on_qrg(spot *data) {
 
     printw("%7.1f%c%c ", (data->freq / 1000.),
 	   (data->node == thisnode ? '*' : data->node),
-	   bm_ismulti(data) ? 'M' : ' ');
+	   data->multi ? 'M' : ' ');
 
     char *temp = format_spot(data);
     printw("%-12s", temp);
@@ -668,59 +738,157 @@ static bool mode_matches(spot *data) {
     return (data->mode == trxmode);
 }
 
+/* dupe state depends on time or QTCs as well, never cache it */
+static bool dupe_is_volatile() {
+    return minitest != 0 || qtcdirection > 0;
+}
+
+/* recompute dupe and multi state only if scoring has changed since */
+static void update_flags(spot *data, unsigned int generation) {
+    if (data->generation != generation || dupe_is_volatile())
+	data->dupe = bm_isdupe(data->call, data->band);
+
+    if (data->generation != generation)
+	data->multi = bm_ismulti(data);
+
+    data->generation = generation;
+}
+
+/* check if spot passes the filter settings */
+static bool spot_visible(spot *data, unsigned int generation) {
+
+    update_flags(data, generation);
+
+    /* ignore spots on WARC bands if in contest mode */
+    if (iscontest && IsWarcIndex(data->band))
+	return false;
+
+    /* ignore dupes if not forced */
+    if (data->dupe && !bm_config.showdupes)
+	return false;
+
+    /* Ignore non-multis if we want to show only multis */
+    if (!data->multi && bm_config.onlymults)
+	return false;
+
+    /* if spot is allband or allmode is set or band or mode matches
+     * than show it */
+    return (bm_config.allband || band_matches(data)) &&
+	   (bm_config.allmode || mode_matches(data));
+}
+
+static void get_view_key(view_key_t *key) {
+    memset(key, 0, sizeof(*key));
+    key->config = bm_config;
+    key->bandinx = bandinx;
+    key->trxmode = trxmode;
+    key->iscontest = iscontest;
+    key->generation = score_generation();
+}
+
+/* insert spot into 'spots' keeping it sorted by frequency */
+static void view_insert(spot *data) {
+    guint low = 0, high = spots->len;
+
+    while (low < high) {
+	guint mid = (low + high) / 2;
+	if (((spot *)g_ptr_array_index(spots, mid))->freq <= data->freq)
+	    low = mid + 1;
+	else
+	    high = mid;
+    }
+    g_ptr_array_insert(spots, low, ref_spot(data));
+}
+
+/* prepare 'spots' anew from all spots */
+static void rebuild_view(unsigned int generation) {
+    GSequenceIter *iter;
+
+    g_ptr_array_set_size(spots, 0);
+
+    for (iter = g_sequence_get_begin_iter(allspots);
+	    !g_sequence_iter_is_end(iter);
+	    iter = g_sequence_iter_next(iter)) {
+	spot *data = g_sequence_get(iter);
+
+	data->moved = false;
+	if (spot_visible(data, generation))
+	    g_ptr_array_add(spots, ref_spot(data));
+    }
+}
+
+/* apply changes since last filter_spots() to 'spots' */
+static void update_view(unsigned int generation) {
+
+    /* drop removed spots and the ones to be placed anew */
+    for (int i = spots->len - 1; i >= 0; i--) {
+	spot *data = g_ptr_array_index(spots, i);
+	if (data->dropped || data->moved)
+	    g_ptr_array_remove_index(spots, i);
+    }
+
+    for (int i = 0; i < pending->len; i++) {
+	spot *data = g_ptr_array_index(pending, i);
+
+	if (data->dropped || !data->moved)
+	    continue;
+
+	data->moved = false;
+	if (spot_visible(data, generation))
+	    view_insert(data);
+    }
+}
+
 /*
- * filter 'allspots' list according to settings and prepare 'spots' array with
- * selected spots
+ * filter 'allspots' according to settings and bring 'spots' array with
+ * selected spots up to date
  */
 void filter_spots() {
-    GList *list;
-    spot *data;
-    bool dupe, multi;
+    view_key_t key;
+
     /* acquire mutex
      * do not add new spots to allspots during
      * - aging and
      * - filtering
      * furthermore do not allow call lookup as long as
-     * filtered spot array is build anew */
+     * filtered spot array is updated */
 
     pthread_mutex_lock(&bm_mutex);
 
-    if (spots)
-	g_ptr_array_free(spots, TRUE);		/* free spot array */
-						/* allocate new one */
-    spots = g_ptr_array_new_full(128, (GDestroyNotify)free_spot);
+    init_spot_containers();
+    if (spots == NULL)
+	spots = g_ptr_array_new_full(128, (GDestroyNotify)free_spot);
 
+    get_view_key(&key);
 
-    for (list = allspots; list; list = list->next)	{
-	data = list->data;
-
-	/* check and mark spot as dupe */
-	dupe = bm_isdupe(data->call, data->band);
-	data -> dupe = dupe;
+    if (!view_valid || dupe_is_volatile()
+	    || memcmp(&key, &view_key, sizeof(key)) != 0) {
+	rebuild_view(key.generation);
+	view_key = key;
+	view_valid = true;
+    } else {
+	update_view(key.generation);
+    }
+    g_ptr_array_set_size(pending, 0);
 
-	/* ignore spots on WARC bands if in contest mode */
-	if (iscontest && IsWarcIndex(data->band))
-	    continue;
+    pthread_mutex_unlock(&bm_mutex);
+}
 
-	/* ignore dupes if not forced */
-	if (dupe && !bm_config.showdupes)
-	    continue;
+/* copy the spots in 'spots' to 'shown_spots' */
+static void copy_view() {
 
-	/* Ignore non-multis if we want to show only multis */
-	multi = bm_ismulti(data);
-	if (!multi && bm_config.onlymults)
-	    continue;
+    pthread_mutex_lock(&bm_mutex);
 
-	/* if spot is allband or allmode is set or band or mode matches
-	 * than add to the filtered 'spot' array
-	 */
-	if ((bm_config.allband || band_matches(data)) &&
-		(bm_config.allmode || mode_matches(data))) {
+    if (shown_spots == NULL)
+	shown_spots = g_array_new(FALSE, FALSE, sizeof(spot));
 
-	    spot *copy = copy_spot(data);
-	    g_ptr_array_add(spots, copy);
-	}
+    /* shallow copies, 'spots' keeps the call and pfx strings alive */
+    g_array_set_size(shown_spots, spots->len);
+    for (int i = 0; i < spots->len; i++) {
+	g_array_index(shown_spots, spot, i) =
+	    *(spot *)g_ptr_array_index(spots, i);
     }
+
     pthread_mutex_unlock(&bm_mutex);
 }
 
@@ -766,6 +934,7 @@ void bandmap_show() {
 
     bm_init();
     filter_spots();
+    copy_view();
 
     /* afterwards display filtered list around own QRG +/- some offset
      * (offset gets reset if we change frequency */
@@ -807,8 +976,8 @@ void bandmap_show() {
     const freq_t centerfrequency = bm_get_center(bandinx, trxmode);
 
     /* calc number of spots below your current QRG */
-    for (i = 0; i < spots->len; i++) {
-	data = g_ptr_array_index(spots, i);
+    for (i = 0; i < shown_spots->len; i++) {
+	data = &g_array_index(shown_spots, spot, i);
 
 	if (data->freq <= centerfrequency - TOLERANCE)
 	    below_qrg++;
@@ -817,8 +986,8 @@ void bandmap_show() {
     }
 
     /* check if current QRG is on a spot */
-    if (below_qrg < spots->len) {
-	data = g_ptr_array_index(spots, below_qrg);
+    if (below_qrg < shown_spots->len) {
+	data = &g_array_index(shown_spots, spot, below_qrg);
 
 	if (!(data->freq > centerfrequency + TOLERANCE))
 	    on_qrg = 1;
@@ -827,7 +996,7 @@ void bandmap_show() {
     /* calc the index into the spot array of the first spot to show */
     {
 	unsigned int max_below;
-	unsigned int above_qrg = spots->len - below_qrg - on_qrg;
+	unsigned int above_qrg = shown_spots->len - below_qrg - on_qrg;
 
 	if (above_qrg < ((NR_SPOTS - 1) / 2)) {
 	    max_below = NR_SPOTS - above_qrg - 1;
@@ -838,8 +1007,8 @@ void bandmap_show() {
     }
 
     /* calculate the index+1 of the last spot to show */
-    stopindex  = (spots->len < startindex + NR_SPOTS - (1 - on_qrg))
-		 ? spots->len
+    stopindex  = (shown_spots->len < startindex + NR_SPOTS - (1 - on_qrg))
+		 ? shown_spots->len
 		 : (startindex + NR_SPOTS - (1 - on_qrg));
 
     /* correct calculations if we have no rig frequency to show */
@@ -849,14 +1018,14 @@ void bandmap_show() {
 	} else {
 	    stopindex += 1;
 	}
-	if (spots->len < stopindex)
-	    stopindex = spots->len;
+	if (shown_spots->len < stopindex)
+	    stopindex = shown_spots->len;
     }
 
     /* show spots below QRG */
     for (i = startindex; i < below_qrg; i++) {
 	move(bm_y, bm_x);
-	show_spot(g_ptr_array_index(spots, i));
+	show_spot(&g_array_index(shown_spots, spot, i));
 	next_spot_position(&bm_y, &bm_x);
     }
 
@@ -868,7 +1037,7 @@ void bandmap_show() {
 	if (!on_qrg) {
 	    printw("%7.1f   %s", centerfrequency / 1000.0,  "============");
 	} else {
-	    show_spot_on_qrg(g_ptr_array_index(spots, below_qrg));
+	    show_spot_on_qrg(&g_array_index(shown_spots, spot, below_qrg));
 	}
 	next_spot_position(&bm_y, &bm_x);
     }
@@ -876,14 +1045,14 @@ void bandmap_show() {
     /* show spots above QRG */
     for (i = below_qrg + on_qrg; i < stopindex; i++) {
 	move(bm_y, bm_x);
-	show_spot(g_ptr_array_index(spots, i));
+	show_spot(&g_array_index(shown_spots, spot, i));
 	next_spot_position(&bm_y, &bm_x);
     }
 
     attroff(A_BOLD);
     move(cury, curx);			/* reset cursor */
 
-    refreshp();
+    redraw_request(REDRAW_BANDMAP);
 }
 
 
@@ -931,7 +1100,7 @@ void bm_menu() {
 spot *copy_spot(spot *data) {
     spot *result = NULL;
 
-    result = g_new0(spot, 1);
+    result = new_spot();
     result -> call = g_strdup(data -> call);
     result -> freq = data -> freq;
     result -> mode = data -> mode;
@@ -942,6 +1111,7 @@ spot *copy_spot(spot *data) {
     result -> cqzone = data -> cqzone;
     result -> ctynr = data -> ctynr;
     result -> pfx = g_strdup(data -> pfx);
+    result -> multi = data -> multi;
 
     return result;
 }
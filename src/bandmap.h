@@ -35,6 +35,12 @@ typedef struct {
     int 	cqzone;	/* CQ zone */
     int 	ctynr;	/* Country nr */
     char 	*pfx; /* prefix */
+    /* internal state of bandmap */
+    int		refs;	/* spot is shared between bandmap and its views */
+    bool	multi;
+    unsigned int generation;	/* score_generation() of dupe and multi */
+    bool	moved;	/* new or moved, not yet placed in filtered view */
+    bool	dropped;	/* removed from bandmap */
 } spot;
 
 #define SPOT_NEW	(bm_config.lifetime)
@@ -60,7 +66,7 @@ enum {
     CB_MULTI
 };
 
-/* free an allocated spot */
+/* release an allocated spot */
 void free_spot(spot *data);
 
 /*
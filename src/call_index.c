@@ -0,0 +1,352 @@
+/*
+ * Tlf - contest logging program for amateur radio operators
+ * Copyright (C) 2026 The Tlf developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+/* ------------------------------------------------------------
+ *        Substring index over calls
+ *
+ *   Keeps posting lists of all 2- and 3-character substrings (grams)
+ *   of the indexed calls. Grams at the start of a call get a second
+ *   entry with their own key, so calls starting with a given string
+ *   are found without looking at the others.
+ *
+ *   A lookup only visits the calls in the shortest posting list of
+ *   the searched string.
+ *
+ *   Near misses (calls one character wrong, missing or extra) are
+ *   checked with the bit-parallel edit distance of Myers in the form
+ *   given by Hyyroe, one 64 bit word holds all columns of the call.
+ *   Only calls containing the first or the second half of the call
+ *   unchanged are candidates, as a single edit leaves one of them intact.
+ *
+ *--------------------------------------------------------------*/
+
+
+#include <string.h>
+
+#include "call_index.h"
+
+#define GRAM_START	(1u << 24)	/* gram at the start of a call */
+
+struct call_index {
+    GPtrArray *calls;		/* id -> call, not owned */
+    GHashTable *postings;	/* gram -> GArray of ids */
+};
+
+
+/* key for the gram of length n (2 or 3) at s */
+static guint gram_key(const char *s, int n, bool start) {
+    guint key = ((guchar)s[0] << 16) | ((guchar)s[1] << 8);
+
+    if (n == 3) {
+	key |= (guchar)s[2];
+    }
+    return key | (start ? GRAM_START : 0);
+}
+
+static void free_posting(gpointer list) {
+    g_array_free(list, TRUE);
+}
+
+static void add_posting(call_index_t *index, guint key, guint id) {
+    GArray *list = g_hash_table_lookup(index->postings, GUINT_TO_POINTER(key));
+
+    if (list == NULL) {
+	list = g_array_sized_new(FALSE, FALSE, sizeof(guint), 4);
+	g_hash_table_insert(index->postings, GUINT_TO_POINTER(key), list);
+    }
+
+    /* a gram may occur more than once in a call */
+    if (list->len > 0 && g_array_index(list, guint, list->len - 1) == id) {
+	return;
+    }
+    g_array_append_val(list, id);
+}
+
+static GArray *get_posting(const call_index_t *index, guint key) {
+    return g_hash_table_lookup(index->postings, GUINT_TO_POINTER(key));
+}
+
+
+call_index_t *call_index_new(void) {
+    call_index_t *index = g_new0(call_index_t, 1);
+
+    index->calls = g_ptr_array_new();
+    index->postings = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+					    NULL, free_posting);
+    return index;
+}
+
+void call_index_free(call_index_t *index) {
+    if (index == NULL) {
+	return;
+    }
+    g_ptr_array_free(index->calls, TRUE);
+    g_hash_table_destroy(index->postings);
+    g_free(index);
+}
+
+void call_index_clear(call_index_t *index) {
+    g_ptr_array_set_size(index->calls, 0);
+    g_hash_table_remove_all(index->postings);
+}
+
+/** add a call to the index
+ *
+ * The call is not copied and has to stay valid until the index
+ * gets cleared or freed.
+ *
+ * \return id of the call, ids are counted up from 0
+ */
+guint call_index_add(call_index_t *index, const char *call) {
+    guint id = index->calls->len;
+    int len = strlen(call);
+
+    g_ptr_array_add(index->calls, (gpointer)call);
+
+    for (int i = 0; i + 2 <= len; i++) {
+	add_posting(index, gram_key(call + i, 2, false), id);
+	if (i + 3 <= len) {
+	    add_posting(index, gram_key(call + i, 3, false), id);
+	}
+    }
+    if (len >= 2) {
+	add_posting(index, gram_key(call, 2, true), id);
+    }
+    if (len >= 3) {
+	add_posting(index, gram_key(call, 3, true), id);
+    }
+
+    return id;
+}
+
+guint call_index_size(const call_index_t *index) {
+    return index->calls->len;
+}
+
+#define CALL_AT(index, id) ((const char *) g_ptr_array_index(index->calls, id))
+
+/* search all calls, only used for strings shorter than a gram */
+static void lookup_all(const call_index_t *index, const char *part,
+		       call_index_func func, gpointer data) {
+    size_t len = strlen(part);
+
+    for (guint id = 0; id < index->calls->len; id++) {
+	if (strncmp(CALL_AT(index, id), part, len) == 0
+		&& func(CALL_AT(index, id), id, data)) {
+	    return;
+	}
+    }
+    for (guint id = 0; id < index->calls->len; id++) {
+	const char *call = CALL_AT(index, id);
+	if (strncmp(call, part, len) != 0 && strstr(call, part) != NULL
+		&& func(call, id, data)) {
+	    return;
+	}
+    }
+}
+
+/* shortest posting list for the grams of length n in part,
+ * NULL if one of them has no entries */
+static GArray *shortest_posting(const call_index_t *index, const char *part,
+				int n) {
+    GArray *list = NULL;
+    int len = strlen(part);
+
+    for (int i = 0; i + n <= len; i++) {
+	GArray *l = get_posting(index, gram_key(part + i, n, false));
+	if (l == NULL) {
+	    return NULL;	/* no call has this gram */
+	}
+	if (list == NULL || l->len < list->len) {
+	    list = l;
+	}
+    }
+    return list;
+}
+
+/** find all calls containing 'part'
+ *
+ * Calls func for the calls starting with 'part' first and then for the
+ * ones containing it somewhere else, each group in the order the calls
+ * were added. Stops as soon as func returns true.
+ */
+void call_index_lookup(const call_index_t *index, const char *part,
+		       call_index_func func, gpointer data) {
+    int len = strlen(part);
+
+    if (len < 2) {
+	lookup_all(index, part, func, data);
+	return;
+    }
+
+    int n = (len < 3 ? 2 : 3);
+
+    /* starts with */
+    GArray *list = get_posting(index, gram_key(part, n, true));
+    for (guint i = 0; list != NULL && i < list->len; i++) {
+	const char *call = CALL_AT(index, g_array_index(list, guint, i));
+	if (strncmp(call, part, len) == 0
+		&& func(call, g_array_index(list, guint, i), data)) {
+	    return;
+	}
+    }
+
+    /* contains, go through the shortest posting list of all grams */
+    list = shortest_posting(index, part, n);
+    if (list == NULL) {
+	return;
+    }
+
+    for (guint i = 0; i < list->len; i++) {
+	const char *call = CALL_AT(index, g_array_index(list, guint, i));
+	if (strncmp(call, part, len) != 0 && strstr(call, part) != NULL
+		&& func(call, g_array_index(list, guint, i), data)) {
+	    return;
+	}
+    }
+}
+
+/** append the ids of all calls containing 'part' to 'ids'
+ *
+ * Unlike call_index_lookup() the ids are in the order the calls
+ * were added.
+ */
+void call_index_find(const call_index_t *index, const char *part,
+		     GArray *ids) {
+    int len = strlen(part);
+
+    if (len < 2) {
+	for (guint id = 0; id < index->calls->len; id++) {
+	    if (strstr(CALL_AT(index, id), part) != NULL) {
+		g_array_append_val(ids, id);
+	    }
+	}
+	return;
+    }
+
+    GArray *list = shortest_posting(index, part, (len < 3 ? 2 : 3));
+    for (guint i = 0; list != NULL && i < list->len; i++) {
+	guint id = g_array_index(list, guint, i);
+	if (strstr(CALL_AT(index, id), part) != NULL) {
+	    g_array_append_val(ids, id);
+	}
+    }
+}
+
+
+/* bit mask of positions in 'call' for each character */
+static void prepare_peq(guint64 peq[256], const char *call, int m) {
+    memset(peq, 0, 256 * sizeof(guint64));
+    for (int i = 0; i < m; i++) {
+	peq[(guchar)call[i]] |= G_GUINT64_CONSTANT(1) << i;
+    }
+}
+
+/* edit distance between the call described by peq/m and 'text' */
+static int distance(const guint64 peq[256], int m, const char *text) {
+    guint64 pv = ~G_GUINT64_CONSTANT(0);
+    guint64 mv = 0;
+    const guint64 last = G_GUINT64_CONSTANT(1) << (m - 1);
+    int score = m;
+
+    for (; *text != '\0'; text++) {
+	guint64 eq = peq[(guchar)*text];
+	guint64 xv = eq | mv;
+	guint64 xh = (((eq & pv) + pv) ^ pv) | eq;
+	guint64 ph = mv | ~(xh | pv);
+	guint64 mh = pv & xh;
+
+	if (ph & last) {
+	    score++;
+	} else if (mh & last) {
+	    score--;
+	}
+
+	ph = (ph << 1) | 1;
+	mh <<= 1;
+	pv = mh | ~(xv | ph);
+	mv = ph & xv;
+    }
+    return score;
+}
+
+/** edit distance (Levenshtein) between two calls
+ *
+ * 'a' must not be longer than NEAR_MAX_LEN characters
+ */
+int call_distance(const char *a, const char *b) {
+    guint64 peq[256];
+    int m = strlen(a);
+
+    if (m == 0) {
+	return strlen(b);
+    }
+    prepare_peq(peq, a, m);
+    return distance(peq, m, b);
+}
+
+static gint cmp_id(gconstpointer a, gconstpointer b) {
+    guint id_a = *(const guint *)a;
+    guint id_b = *(const guint *)b;
+
+    return (id_a > id_b) - (id_a < id_b);
+}
+
+/** append the ids of all calls with edit distance 1 to 'call' to 'ids'
+ *
+ * The ids are in the order the calls were added. Calls shorter than
+ * NEAR_MIN_LEN or longer than NEAR_MAX_LEN have no near misses.
+ */
+void call_index_near(const call_index_t *index, const char *call,
+		     GArray *ids) {
+    char half[NEAR_MAX_LEN + 1];
+    guint64 peq[256];
+    int m = strlen(call);
+
+    if (m < NEAR_MIN_LEN || m > NEAR_MAX_LEN) {
+	return;
+    }
+
+    GArray *candidates = g_array_new(FALSE, FALSE, sizeof(guint));
+
+    g_strlcpy(half, call, m / 2 + 1);
+    call_index_find(index, half, candidates);
+    call_index_find(index, call + m / 2, candidates);
+    g_array_sort(candidates, cmp_id);
+
+    prepare_peq(peq, call, m);
+
+    for (guint i = 0; i < candidates->len; i++) {
+	guint id = g_array_index(candidates, guint, i);
+	if (i > 0 && id == g_array_index(candidates, guint, i - 1)) {
+	    continue;	/* found via both halves */
+	}
+
+	const char *text = CALL_AT(index, id);
+	int n = strlen(text);
+	if (n < m - 1 || n > m + 1) {
+	    continue;
+	}
+	if (distance(peq, m, text) == 1) {
+	    g_array_append_val(ids, id);
+	}
+    }
+
+    g_array_free(candidates, TRUE);
+}
@@ -0,0 +1,50 @@
+/*
+ * Tlf - contest logging program for amateur radio operators
+ * Copyright (C) 2026 The Tlf developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+
+#ifndef CALL_INDEX_H
+#define CALL_INDEX_H
+
+#include <stdbool.h>
+#include <glib.h>
+
+/* substring index over a list of calls */
+typedef struct call_index call_index_t;
+
+/* called for each match, returns true to stop the lookup */
+typedef bool (*call_index_func)(const char *call, guint id, gpointer data);
+
+call_index_t *call_index_new(void);
+void call_index_free(call_index_t *index);
+void call_index_clear(call_index_t *index);
+guint call_index_add(call_index_t *index, const char *call);
+guint call_index_size(const call_index_t *index);
+void call_index_lookup(const call_index_t *index, const char *part,
+		       call_index_func func, gpointer data);
+void call_index_find(const call_index_t *index, const char *part,
+		     GArray *ids);
+
+#define NEAR_MIN_LEN	4	/* shortest call to look for near misses */
+#define NEAR_MAX_LEN	32	/* longest call to look for near misses */
+
+int call_distance(const char *a, const char *b);
+void call_index_near(const call_index_t *index, const char *call,
+		     GArray *ids);
+
+#endif /* CALL_INDEX_H */
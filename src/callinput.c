@@ -76,6 +76,7 @@
 #include "time_update.h"
 #include "trx_memory.h"
 #include "ui_utils.h"
+#include "write_keyer.h"
 #include "showzones.h"
 #include "bands.h"
 #include "fldigixmlrpc.h"
@@ -92,7 +93,6 @@ void handle_memory_operation(memory_op_t op);
 void tune() {
     int count;
     int count2;
-    gchar *buff;
 
     count2 = tune_seconds;
     while (count2 > 0) {
@@ -102,9 +102,7 @@ void tune() {
 	    count = count2;
 	}
 	count2 -= count;
-	buff = g_strdup_printf("%d", count);
-	netkeyer(K_TUNE, buff);	// cw on
-	g_free(buff);
+	keyer_tune(count);	// cw on
 
 	count = count * 4;    // sleeping 1/4 second units between keypress-checks
 	while (count > 0) {
@@ -117,7 +115,7 @@ void tune() {
 	}
     }
 
-    netkeyer(K_ABORT, "");	// cw abort
+    keyer_abort();	// cw abort
 }
 
 
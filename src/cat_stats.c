@@ -0,0 +1,208 @@
+/*
+ * Tlf - contest logging program for amateur radio operators
+ * Copyright (C) 2026 The Tlf developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+/* ------------------------------------------------------------
+ *  Latency and error statistics of the CAT link
+ *
+ *  Usage around a hamlib call:
+ *
+ *	double start = cat_stats_start();
+ *	retval = rig_get_freq(my_rig, RIG_VFO_CURR, &rigfreq);
+ *	cat_stats_record(CAT_GET_FREQ, start, retval);
+ *--------------------------------------------------------------*/
+
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <glib.h>
+#include <hamlib/rig.h>
+
+#include "cat_stats.h"
+
+
+const int cat_bucket_limits[CAT_BUCKETS - 1] = {
+    1, 2, 5, 10, 20, 50, 100, 200, 500, 1000
+};
+
+static const char *op_names[CAT_OP_COUNT] = {
+    [CAT_GET_FREQ] = "get_freq",
+    [CAT_SET_FREQ] = "set_freq",
+    [CAT_GET_MODE] = "get_mode",
+    [CAT_SET_MODE] = "set_mode",
+    [CAT_SET_PTT] = "set_ptt",
+};
+
+static pthread_mutex_t stats_mutex = PTHREAD_MUTEX_INITIALIZER;
+static cat_op_stats_t stats[CAT_OP_COUNT];
+static unsigned int polls = 0;
+static double first_poll, last_poll;	/* ms */
+
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+/** \return start time of a rig call for cat_stats_record() */
+double cat_stats_start(void) {
+    return now_ms();
+}
+
+/** account for a rig call which started at 'start' */
+void cat_stats_record(cat_op_t op, double start, int retval) {
+    cat_stats_add(op, now_ms() - start, retval);
+}
+
+/** account for a rig call which took 'ms' milliseconds */
+void cat_stats_add(cat_op_t op, double ms, int retval) {
+    int bucket = 0;
+
+    while (bucket < CAT_BUCKETS - 1 && ms >= cat_bucket_limits[bucket])
+	bucket++;
+
+    pthread_mutex_lock(&stats_mutex);
+    cat_op_stats_t *s = &stats[op];
+    s->calls++;
+    if (retval == -RIG_ETIMEOUT)
+	s->timeouts++;
+    else if (retval != RIG_OK)
+	s->errors++;
+    s->total_ms += ms;
+    if (ms > s->max_ms)
+	s->max_ms = ms;
+    s->buckets[bucket]++;
+    pthread_mutex_unlock(&stats_mutex);
+}
+
+/** count a completed poll of the rig */
+void cat_stats_poll(void) {
+    double now = now_ms();
+
+    pthread_mutex_lock(&stats_mutex);
+    if (polls == 0)
+	first_poll = now;
+    last_poll = now;
+    polls++;
+    pthread_mutex_unlock(&stats_mutex);
+}
+
+void cat_stats_get(cat_op_t op, cat_op_stats_t *result) {
+    pthread_mutex_lock(&stats_mutex);
+    *result = stats[op];
+    pthread_mutex_unlock(&stats_mutex);
+}
+
+/** \return average number of polls per second, 0 if not known yet */
+double cat_stats_poll_rate(void) {
+    double rate = 0.0;
+
+    pthread_mutex_lock(&stats_mutex);
+    if (polls > 1 && last_poll > first_poll)
+	rate = (polls - 1) * 1000.0 / (last_poll - first_poll);
+    pthread_mutex_unlock(&stats_mutex);
+    return rate;
+}
+
+void cat_stats_reset(void) {
+    pthread_mutex_lock(&stats_mutex);
+    memset(stats, 0, sizeof(stats));
+    polls = 0;
+    pthread_mutex_unlock(&stats_mutex);
+}
+
+const char *cat_op_name(cat_op_t op) {
+    return op_names[op];
+}
+
+/** format the statistics as text lines of at most 79 characters
+ *
+ * \return NULL terminated array of lines, free with g_strfreev()
+ */
+char **cat_stats_report(void) {
+    GPtrArray *lines = g_ptr_array_new();
+    GString *line;
+    cat_op_stats_t s;
+
+    pthread_mutex_lock(&stats_mutex);
+    unsigned int n = polls;
+    pthread_mutex_unlock(&stats_mutex);
+
+    g_ptr_array_add(lines, g_strdup_printf("Rig polls: %u, %.1f per second",
+					   n, cat_stats_poll_rate()));
+    g_ptr_array_add(lines, g_strdup(""));
+    g_ptr_array_add(lines, g_strdup(
+			"operation      calls  errors timeouts   avg ms   max ms"));
+    for (int op = 0; op < CAT_OP_COUNT; op++) {
+	cat_stats_get(op, &s);
+	g_ptr_array_add(lines,
+			g_strdup_printf("%-10s %9u %7u %8u %8.1f %8.1f",
+					op_names[op], s.calls, s.errors,
+					s.timeouts,
+					s.calls > 0 ? s.total_ms / s.calls : 0.0,
+					s.max_ms));
+    }
+
+    g_ptr_array_add(lines, g_strdup(""));
+    line = g_string_new("latency ms");
+    for (int i = 0; i < CAT_BUCKETS - 1; i++) {
+	char label[8];
+	if (cat_bucket_limits[i] < 1000)
+	    sprintf(label, "<%d", cat_bucket_limits[i]);
+	else
+	    sprintf(label, "<%ds", cat_bucket_limits[i] / 1000);
+	g_string_append_printf(line, " %5s", label);
+    }
+    g_string_append(line, "  more");
+    g_ptr_array_add(lines, g_string_free(line, FALSE));
+
+    for (int op = 0; op < CAT_OP_COUNT; op++) {
+	cat_stats_get(op, &s);
+	line = g_string_new(NULL);
+	g_string_append_printf(line, "%-10s", op_names[op]);
+	for (int i = 0; i < CAT_BUCKETS; i++)
+	    g_string_append_printf(line, " %5u", s.buckets[i]);
+	g_ptr_array_add(lines, g_string_free(line, FALSE));
+    }
+
+    g_ptr_array_add(lines, NULL);
+    return (char **) g_ptr_array_free(lines, FALSE);
+}
+
+/** write the statistics to a file
+ *
+ * \return false if the file could not be written
+ */
+bool cat_stats_dump(const char *filename) {
+    FILE *fp = fopen(filename, "w");
+    if (fp == NULL)
+	return false;
+
+    char **lines = cat_stats_report();
+    for (char **l = lines; *l != NULL; l++) {
+	fputs(*l, fp);
+	fputc('\n', fp);
+    }
+    g_strfreev(lines);
+
+    return fclose(fp) == 0;
+}
@@ -0,0 +1,63 @@
+/*
+ * Tlf - contest logging program for amateur radio operators
+ * Copyright (C) 2026 The Tlf developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+
+#ifndef CAT_STATS_H
+#define CAT_STATS_H
+
+#include <stdbool.h>
+
+/* instrumented rig operations */
+typedef enum {
+    CAT_GET_FREQ,
+    CAT_SET_FREQ,
+    CAT_GET_MODE,
+    CAT_SET_MODE,
+    CAT_SET_PTT,
+    CAT_OP_COUNT
+} cat_op_t;
+
+/* upper bounds of the latency histogram buckets in ms,
+ * the last bucket collects all slower calls */
+#define CAT_BUCKETS 11
+extern const int cat_bucket_limits[CAT_BUCKETS - 1];
+
+typedef struct {
+    unsigned int calls;
+    unsigned int errors;	/* failed, but not timed out */
+    unsigned int timeouts;
+    double total_ms;
+    double max_ms;
+    unsigned int buckets[CAT_BUCKETS];
+} cat_op_stats_t;
+
+double cat_stats_start(void);
+void cat_stats_record(cat_op_t op, double start, int retval);
+void cat_stats_add(cat_op_t op, double ms, int retval);
+void cat_stats_poll(void);
+
+void cat_stats_get(cat_op_t op, cat_op_stats_t *stats);
+double cat_stats_poll_rate(void);
+void cat_stats_reset(void);
+
+const char *cat_op_name(cat_op_t op);
+char **cat_stats_report(void);
+bool cat_stats_dump(const char *filename);
+
+#endif /* CAT_STATS_H */
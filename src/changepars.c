@@ -32,6 +32,8 @@
 #include <unistd.h>
 
 #include "audio.h"
+#include "background_process.h"
+#include "cat_stats.h"
 #include "cqww_simulator.h"
 #include "changepars.h"
 #include "clear_display.h"
@@ -52,6 +54,7 @@
 #include "qtcvars.h"		// Includes globalvars.h
 #include "readcalls.h"
 #include "readqtccalls.h"
+#include "redraw.h"
 #include "rules.h"
 #include "scroll_log.h"
 #include "searchlog.h"
@@ -126,7 +129,7 @@ int changepars(void) {
     strcpy(parameters[43], "SCVOLUME");
     //strcpy(parameters[44], "SCAN");	/* 05jan18 no longer supported */
     strcpy(parameters[44], "");
-    strcpy(parameters[45], "");         //"DEBUG");
+    strcpy(parameters[45], "CAT");
     strcpy(parameters[46], "MINITERM");
     strcpy(parameters[47], "RTTY");
     strcpy(parameters[48], "SOUND");
@@ -444,6 +447,10 @@ int changepars(void) {
 		trxmode = DIGIMODE;
 	    break;
 	}
+	case 45: {		/* CAT */
+	    catinfo();
+	    break;
+	}
 	case 36: {		/* CLOFF  */
 	    cluster = FREQWINDOW;
 	    break;
@@ -512,7 +519,7 @@ int changepars(void) {
 	case 41: {		/* SYNC */
 	    if (strlen(synclogfile) > 0)
 		synclog(synclogfile);
-	    log_read_n_score();
+	    log_reread_n_score();
 	    scroll_log();
 	    clear_display();
 	    break;
@@ -698,6 +705,44 @@ void networkinfo(void) {
     mvprintw(14 + nodes, 10, "cty.dat    : %s",
 	     (cty_dat_version[0] != 0 ? cty_dat_version : "n/a"));
 
+    mvaddstr(16 + nodes, 10, "Wakeups    :");
+    for (int i = 0; i < BG_SOURCE_COUNT; i++) {
+	mvprintw(16 + nodes + i / 3, 23 + (i % 3) * 19, "%s %d",
+		 background_source_name(i), background_wakeup_count(i));
+    }
+
+    mvprintw(19 + nodes, 10, "Redraws    : %d frames (requests/drawn)",
+	     redraw_frames());
+    for (int i = 0; i < REDRAW_AREA_COUNT; i++) {
+	mvprintw(20 + nodes + i / 3, 23 + (i % 3) * 19, "%s %d/%d",
+		 redraw_area_name(i), redraw_requests(i), redraw_count(i));
+    }
+
+    refreshp();
+
+    mvaddstr(23, 22, " --- Press a key to continue --- ");
+    refreshp();
+
+    (void)key_get();
+
+    clear_display();
+    return;
+}
+
+/* -------------------------------------------------------------- */
+
+void catinfo(void) {
+
+    wipe_display();
+
+    mvaddstr(1, 10, "Rig link statistics");
+
+    char **lines = cat_stats_report();
+    for (int i = 0; lines[i] != NULL && 3 + i < 22; i++) {
+	mvaddstr(3 + i, 10, lines[i]);
+    }
+    g_strfreev(lines);
+
     refreshp();
 
     mvaddstr(23, 22, " --- Press a key to continue --- ");
@@ -24,6 +24,7 @@
 
 int changepars(void);
 void networkinfo(void);
+void catinfo(void);
 void multiplierinfo(void);
 
 
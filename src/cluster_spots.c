@@ -0,0 +1,206 @@
+/*
+ * Tlf - contest logging program for amateur radio operators
+ * Copyright (C) 2026 The Tlf developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+/* ------------------------------------------------------------
+ *
+ *  Ring of the latest cluster lines
+ *
+ *  Each line gets classified and, if it is a DX spot, split into its
+ *  fields once when it arrives. The cluster window, the xplanet
+ *  marker file and the bandmap work on the parsed records.
+ *--------------------------------------------------------------*/
+
+
+#include <ctype.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include "bands.h"
+#include "cluster_spots.h"
+#include "globalvars.h"
+
+
+static pthread_mutex_t spots_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static cluster_spot_t *ring = NULL;	/* allocated on first use */
+static int capacity = 0;
+static int head = 0;			/* slot for the next line */
+static int count = 0;
+
+
+static int classify(const char *line) {
+    if (strstr(line, "DX de") != NULL)
+	return CLUSTER_DX;
+    if (strstr(line, my.call) != NULL)
+	return CLUSTER_TALK;
+    if (strstr(line, "To ALL") != NULL)
+	return CLUSTER_ANNOUNCE;
+    if (strlen(line) > 20)
+	return CLUSTER_OTHER;
+    return CLUSTER_SHORT;
+}
+
+static void copy_field(char *dest, size_t size, const char *start,
+		       size_t len) {
+    if (len >= size)
+	len = size - 1;
+    memcpy(dest, start, len);
+    dest[len] = '\0';
+}
+
+/** parse a cluster line
+ *
+ * Spots are expected in the usual column layout:
+ *
+ *   DX de <spotter>:  <freq kHz>  <call>      <comment>               HHMMZ
+ *   0     6          16          26          39                       70
+ *
+ * \param line  the received line, only the first 81 characters are kept
+ * \param spot  record to fill
+ * \return true if the line is a DX spot
+ */
+bool parse_cluster_line(const char *line, cluster_spot_t *spot) {
+    const char *l = spot->line;
+    const char *p;
+    size_t len, n;
+
+    memset(spot, 0, sizeof(*spot));
+    g_strlcpy(spot->line, line, sizeof(spot->line));
+    spot->kind = classify(spot->line);
+    spot->band = BANDINDEX_OOB;
+    spot->minutes = -1;
+    spot->node = ' ';
+
+    len = strlen(l);
+    if (strncmp(l, "DX de ", 6) != 0 || len <= 26)
+	return false;
+
+    p = l + 26 + strspn(l + 26, " \t");
+    n = strcspn(p, " \t");
+    if (n == 0)
+	return false;
+    copy_field(spot->call, sizeof(spot->call), p, n);
+
+    copy_field(spot->spotter, sizeof(spot->spotter), l + 6,
+	       strcspn(l + 6, ": \t"));
+    if (strncmp(l + 6, "TLF-", 4) == 0)
+	spot->node = l[10];		/* sending node id */
+
+    spot->freq = atof(l + 16) * 1000;
+    spot->band = freq2band(spot->freq);
+
+    if (len > 39) {
+	copy_field(spot->comment, sizeof(spot->comment), l + 39,
+		   MIN(len, 70) - 39);
+	g_strstrip(spot->comment);
+    }
+
+    if (len >= 74 && isdigit(l[70]) && isdigit(l[71])
+	    && isdigit(l[72]) && isdigit(l[73])) {
+	spot->minutes = ((l[70] - '0') * 10 + l[71] - '0') * 60
+			+ (l[72] - '0') * 10 + l[73] - '0';
+    }
+
+    spot->is_spot = true;
+    return true;
+}
+
+/** parse a cluster line and store it as newest entry
+ *
+ * The oldest entry gets dropped if the ring is full. The capacity is
+ * taken from CLUSTER_SPOTS when the first line arrives.
+ *
+ * \param spot  receives the parsed record
+ */
+void cluster_spots_add(const char *line, cluster_spot_t *spot) {
+    parse_cluster_line(line, spot);
+
+    pthread_mutex_lock(&spots_mutex);
+
+    if (ring == NULL) {
+	capacity = CLAMP(cluster_spots_capacity,
+			 CLUSTER_SPOTS_MIN, CLUSTER_SPOTS_MAX);
+	ring = g_new(cluster_spot_t, capacity);
+	head = 0;
+	count = 0;
+    }
+
+    ring[head] = *spot;
+    head = (head + 1) % capacity;
+    if (count < capacity)
+	count++;
+
+    pthread_mutex_unlock(&spots_mutex);
+}
+
+/** drop all entries */
+void cluster_spots_clear(void) {
+    pthread_mutex_lock(&spots_mutex);
+    g_free(ring);
+    ring = NULL;
+    capacity = 0;
+    head = 0;
+    count = 0;
+    pthread_mutex_unlock(&spots_mutex);
+}
+
+int cluster_spots_count(void) {
+    int n;
+
+    pthread_mutex_lock(&spots_mutex);
+    n = count;
+    pthread_mutex_unlock(&spots_mutex);
+    return n;
+}
+
+/** copy the latest entries accepted by a filter
+ *
+ * The entries are visited from the newest to the oldest one until 'max'
+ * of them are accepted. 'keep' runs with the ring locked and must not
+ * add entries itself; NULL accepts every entry.
+ *
+ * \param dest  receives the accepted entries, oldest first
+ * \return number of entries copied
+ */
+int cluster_spots_select(cluster_spot_filter_t keep, void *data,
+			 cluster_spot_t *dest, int max) {
+    int n = 0;
+
+    pthread_mutex_lock(&spots_mutex);
+
+    for (int i = 1; i <= count && n < max; i++) {
+	const cluster_spot_t *spot = &ring[(head - i + capacity) % capacity];
+
+	if (keep == NULL || keep(spot, data))
+	    dest[n++] = *spot;
+    }
+
+    pthread_mutex_unlock(&spots_mutex);
+
+    for (int i = 0; i < n / 2; i++) {
+	cluster_spot_t tmp = dest[i];
+	dest[i] = dest[n - 1 - i];
+	dest[n - 1 - i] = tmp;
+    }
+
+    return n;
+}
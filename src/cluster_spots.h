@@ -0,0 +1,71 @@
+/*
+ * Tlf - contest logging program for amateur radio operators
+ * Copyright (C) 2026 The Tlf developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+
+#ifndef CLUSTER_SPOTS_H
+#define CLUSTER_SPOTS_H
+
+#include <stdbool.h>
+
+#include "tlf.h"
+
+#define CLUSTER_LINE_SIZE	82
+#define CLUSTER_SPOTS_MIN	200
+#define CLUSTER_SPOTS_MAX	100000
+#define CLUSTER_SPOTS_DEFAULT	1000
+
+/** kind of a cluster line
+ *
+ * The values follow the announce filter levels, a line is shown in the
+ * cluster window if its kind is not below 'announcefilter'.
+ */
+enum {
+    CLUSTER_SHORT = -1,		/* too short to be of interest */
+    CLUSTER_OTHER = FILTER_ALL,
+    CLUSTER_ANNOUNCE = FILTER_ANN,	/* 'To ALL' */
+    CLUSTER_TALK = FILTER_TALK,	/* addressed to us */
+    CLUSTER_DX = FILTER_DX,	/* 'DX de' */
+};
+
+/** one cluster line, parsed on arrival */
+typedef struct {
+    char line[CLUSTER_LINE_SIZE];	/* line as received */
+    int kind;
+    bool is_spot;		/* a 'DX de' spot, the fields below are valid */
+    char call[CALL_SIZE];
+    char spotter[CALL_SIZE];
+    char comment[32];
+    freq_t freq;		/* Hz */
+    int band;			/* band index or BANDINDEX_OOB */
+    int minutes;		/* UTC minute of day of the spot or -1 */
+    char node;			/* sending Tlf node or ' ' */
+} cluster_spot_t;
+
+typedef bool (*cluster_spot_filter_t)(const cluster_spot_t *spot,
+				      void *data);
+
+bool parse_cluster_line(const char *line, cluster_spot_t *spot);
+
+void cluster_spots_add(const char *line, cluster_spot_t *spot);
+void cluster_spots_clear(void);
+int cluster_spots_count(void);
+int cluster_spots_select(cluster_spot_filter_t keep, void *data,
+			 cluster_spot_t *dest, int max);
+
+#endif /* CLUSTER_SPOTS_H */
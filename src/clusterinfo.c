@@ -24,7 +24,6 @@
  *--------------------------------------------------------------*/
 
 
-#include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -33,6 +32,7 @@
 #include "bandmap.h"
 #include "bands.h"
 #include "clear_display.h"
+#include "cluster_spots.h"
 #include "dxcc.h"
 #include "err_utils.h"
 #include "get_time.h"
@@ -41,21 +41,24 @@
 #include "lancode.h"
 #include "nicebox.h"		// Includes curses.h
 #include "printcall.h"
-#include "splitscreen.h"
+#include "redraw.h"
 #include "setcontest.h"
+#include "trx_state.h"
 #include "ui_utils.h"
 
 #define MAXMINUTES 30
+#define XPLANET_SPOTS 8		/* number of spots shown via xplanet */
 
-char *bandmap[MAX_SPOTS];
-int spotarray[MAX_SPOTS];		/* Array of indices into spot_ptr */
-
-int getclusterinfo(void);
 void show_xplanet();
 
+/* keep lines passing the announce filter */
+static bool keep_announced(const cluster_spot_t *spot, void *data) {
+    return spot->kind >= announcefilter;
+}
+
 void clusterinfo(void) {
 
-    int f, j, k;
+    int f, j;
     char inputbuffer[160] = "";
 
 
@@ -69,7 +72,7 @@ void clusterinfo(void) {
 
 	for (int i = 14; i < LINES - 1; i++)
 	    clear_line(i);
-	refreshp();
+	redraw_request(REDRAW_CLUSTER);
     }
 
     if (cluster == MAP) {
@@ -81,9 +84,11 @@ void clusterinfo(void) {
 	for (f = 0; f < 8; f++)
 	    mvaddstr(15 + f, 4, "                           ");
 
-	if (trx_control)
-	    node_frequencies[thisnode - 'A'] = freq;
-	else
+	if (trx_control) {
+	    trx_state_t trx;
+	    trx_state_get(&trx);
+	    node_frequencies[thisnode - 'A'] = trx.freq;
+	} else
 	    node_frequencies[thisnode - 'A'] = atof(band[bandinx]);
 
 	for (f = 0; f < MAXNODES; f++) {
@@ -105,59 +110,70 @@ void clusterinfo(void) {
 	    mvaddstr(j, 1, inputbuffer);
 	}
 
+	int rows = LINES - 3 - 14;
 
-	/** \todo minimize lock time */
-	pthread_mutex_lock(&spot_ptr_mutex);
+	/* no room for the cluster window on small terminals */
+	if (rows > 0) {
+	    cluster_spot_t shown[rows];
+	    int n = cluster_spots_select(keep_announced, NULL, shown, rows);
 
-	k = getclusterinfo();
+	    for (j = 0; j < n; j++) {
+		g_strlcpy(inputbuffer, shown[j].line, 79);
 
-	if (k > (MAX_SPOTS - 1)) {
-	    k = MAX_SPOTS - 1;
-	}
+		if (strlen(inputbuffer) > 14) {
+		    mvaddstr(15 + j, 1, inputbuffer);
+		}
+	    }
 
-	k -= (LINES - 3 - 14) + 1;
-	if (k < 0)
-	    k = -1;
+	    nicebox(14, 0, rows, 78, "Cluster");
+	}
+	redraw_request(REDRAW_CLUSTER);
+    }
+    printcall();
+}
 
 
-	for (j = 15; j <= LINES - 3; j++) {
-	    k++;
-	    if (k < (MAX_SPOTS - 1) && spotarray[k] > -1) {
-		if (k > MAX_SPOTS - 1)
-		    k = MAX_SPOTS - 1;
+/* age of a spot in minutes (plus some slack for unsynced clocks) */
+static int spot_age(const cluster_spot_t *spot, int sysminutes) {
+    int timediff = (sysminutes - spot->minutes) + 5;
+    if (timediff + 30 < 0)
+	timediff += 1440;
+    return timediff;
+}
 
-		inputbuffer[0] = '\0';
+struct xplanet_filter {
+    int sysminutes;
+    int n;
+    char calls[XPLANET_SPOTS][CALL_SIZE];
+};
 
-		if (spotarray[k] >= 0 && spotarray[k] < MAX_SPOTS)
-		    g_strlcpy(inputbuffer, spot_ptr[spotarray[k]], 79);
-		else {
-		    TLF_LOG_INFO("error in packet table");
-		}
+/* keep recent spots outside the WARC bands, only the youngest per call */
+static bool keep_xplanet(const cluster_spot_t *spot, void *data) {
+    struct xplanet_filter *filter = data;
 
-		if (strlen(inputbuffer) > 14) {
-		    mvaddstr(j, 1, inputbuffer);
-		}
-	    }
-	}
+    if (!spot->is_spot || spot->minutes < 0
+	    || spot_age(spot, filter->sysminutes) > MAXMINUTES)
+	return false;
 
-	pthread_mutex_unlock(&spot_ptr_mutex);
+    if (!IS_ALL_BAND && IsWarcIndex(spot->band))
+	return false;
 
-	nicebox(14, 0, LINES - 3 - 14, 78, "Cluster");
-	refreshp();
+    for (int k = 0; k < filter->n; k++) {
+	if (strcmp(filter->calls[k], spot->call) == 0)
+	    return false;
     }
-    printcall();
-}
 
+    g_strlcpy(filter->calls[filter->n++], spot->call, CALL_SIZE);
+    return true;
+}
 
 void show_xplanet() {
 
-    int i = 0, j;
-    int sysminutes = 0;
-    int linepos;
-    int spot_age[MAX_SPOTS];
-    int spot_band[MAX_SPOTS];
+    int i, j;
+    cluster_spot_t spots[XPLANET_SPOTS];
+    struct xplanet_filter filter = { .n = 0 };
 
-    char callcopy[20];
+    char callcopy[CALL_SIZE];
     FILE *fp;
     dxcc_data *dx;
     static bool nofile = false;
@@ -174,124 +190,43 @@ void show_xplanet() {
 	return;
     }
 
-    memset(spot_age, '\0', sizeof(spot_age));
-    memset(spot_band, '\0', sizeof(spot_band));
-
-    for (i = 0; i < MAX_SPOTS; i++) {
-	if (bandmap[i] != NULL) {
-	    g_free(bandmap[i]);
-	    bandmap[i] = NULL;
-	}
-    }
-
-    /* parse log of cluster output and find DX announcements.
-     * Copy them to bandmap array and find spot_age and spot_band
-     */
-    sysminutes = get_minutes();
-    i = 0;
-
-    pthread_mutex_lock(&spot_ptr_mutex);
-
-    for (j = 0; j < nr_of_spots; j++) {
-	char thisline[83];
-	char spottime[6];
-	char spotcall[20];
-
-	g_strlcpy(thisline, spot_ptr[j], sizeof(thisline));
-	if (strncmp(thisline, "DX de ", 6) == 0 && strlen(thisline) >= 74) {
-	    int spotminutes;
-	    int timediff;
-
-	    g_strlcpy(spotcall, thisline + 26, 6);
-
-	    /* read and convert hours and minutes to spotminutes */
-	    spottime[0] = thisline[70];
-	    spottime[1] = thisline[71];
-	    spottime[2] = '\0';
-	    spotminutes = atoi(spottime);
-
-	    spottime[0] = thisline[72];
-	    spottime[1] = thisline[73];
-	    spottime[2] = '\0';
-	    spotminutes = 60 * spotminutes + atoi(spottime);
-
-	    timediff = (sysminutes - spotminutes) + 5;
-	    if (timediff + 30 < 0)
-		timediff += 1440;
-
-	    /* is spot recent? */
-	    if (timediff <= MAXMINUTES) {
-
-		/* look for duplicates already in bandmap
-		 * => kill older one and keep younger entry */
-		for (int k = 0; k < i; k++) {
-		    g_strlcpy(callcopy, bandmap[k] + 26, 6);
-
-		    if (strncmp(callcopy, spotcall, 4) == 0) {
-			bandmap[k][0] = 'd';
-			break;
-		    }
-		}
-
-		int band = freq2band(atof(thisline + 17) * 1000);
-		if (IS_ALL_BAND || !IsWarcIndex(band)) {
-		    bandmap[i] = g_strdup(thisline);
-		    spot_age[i] = timediff;
-		    spot_band[i] = band;
-		    i++;
-		}
-	    }
-	}
-    }
-
-    pthread_mutex_unlock(&spot_ptr_mutex);
-
-
-    /* show last 8 spots via xplanet */
-    linepos = (i < 8 ? 0 : i - 8);
-
-    for (j = linepos; j < linepos + 8; j++) {
-
-	if (bandmap[j] != NULL) {
-	    int lon;
-	    int lat;
-	    int ctynr;
-	    char *color;
-	    static char *bandcolor[NBANDS] = {"Red", "Magenta", "Cyan",
-					      "Yellow", "Cyan", "Blue",
-					      "Cyan", "White", "Cyan",
-					      "Green", NULL
-					     };
-
-	    strncpy(callcopy, bandmap[j] + 26, 16);	// call
-	    for (int m = 0; m < 16; m++) {
-		if (callcopy[m] == ' ') {
-		    callcopy[m] = '\0';
-		    break;
-		}	/* use strcspn? */
+    /* show last spots via xplanet */
+    filter.sysminutes = get_minutes();
+    i = cluster_spots_select(keep_xplanet, &filter, spots, XPLANET_SPOTS);
+
+    for (j = 0; j < i; j++) {
+	int lon;
+	int lat;
+	int ctynr;
+	char *color;
+	static char *bandcolor[NBANDS] = {"Red", "Magenta", "Cyan",
+					  "Yellow", "Cyan", "Blue",
+					  "Cyan", "White", "Cyan",
+					  "Green", NULL
+					 };
+
+	g_strlcpy(callcopy, spots[j].call, sizeof(callcopy));
+
+	ctynr = getctynr(callcopy);		// CTY of station
+
+	if (ctynr != 0) {
+	    /* show no callsign if MARKERDOTS */
+	    if (xplanet == MARKER_DOTS)
+		callcopy[0] = '\0';
+
+	    dx = dxcc_by_index(ctynr);
+	    lon = (int)(dx -> lon) * -1;
+	    lat = (int)(dx -> lat);
+
+	    if (spot_age(&spots[j], filter.sysminutes) > 15)
+		color = "Brown";	/* old spot */
+	    else {
+		color = bandcolor[spots[j].band];
 	    }
 
-	    ctynr = getctynr(callcopy);		// CTY of station
-
-	    if (ctynr != 0) {
-		/* show no callsign if MARKERDOTS */
-		if (xplanet == MARKER_DOTS)
-		    callcopy[0] = '\0';
-
-		dx = dxcc_by_index(ctynr);
-		lon = (int)(dx -> lon) * -1;
-		lat = (int)(dx -> lat);
-
-		if (spot_age[j] > 15)
-		    color = "Brown";	/* old spot */
-		else {
-		    color = bandcolor[spot_band[j]];
-		}
-
-		if (color != NULL) {
-		    fprintf(fp, "%4d   %4d   \"%s\"   color=%s\n",
-			    lat, lon, callcopy, color);
-		}
+	    if (color != NULL) {
+		fprintf(fp, "%4d   %4d   \"%s\"   color=%s\n",
+			lat, lon, callcopy, color);
 	    }
 	}
     }
@@ -308,52 +243,3 @@ void show_xplanet() {
     }
     fclose(fp);
 }
-
-
-/* ----------------------------------------------------*/
-
-int getclusterinfo(void) {
-
-    int i;
-    int si;
-
-    for (si = 0; si < (MAX_SPOTS - 2); si++)
-	spotarray[si] = -1;
-
-    i = 0;
-    si = 0;
-
-    while (1) {
-
-	if (strstr(spot_ptr[i], "DX de") != NULL) {
-	    spotarray[si] = i;
-	    si++;
-
-	} else if (strstr(spot_ptr[i], my.call) != NULL) {
-	    if ((announcefilter <= 2)) {
-		spotarray[si] = i;
-		si++;
-	    }
-
-	} else if (strstr(spot_ptr[i], "To ALL") != NULL) {
-	    if ((announcefilter <= 1)) {
-		spotarray[si] = i;
-		si++;
-	    }
-
-	} else if ((announcefilter == 0)
-		   && (strlen(spot_ptr[i]) > 20)) {
-	    spotarray[si] = i;
-	    si++;
-	}
-
-	i++;
-
-	if (i > (nr_of_spots - 1))
-	    break;
-    }
-
-    return si;
-}
-
-
@@ -20,6 +20,7 @@
 
 #include <string.h>
 
+#include "background_process.h"
 #include "cqww_simulator.h"
 #include "get_time.h"
 #include "getctydata.h"
@@ -59,6 +60,10 @@ void set_simulator_state(simstate_t s) {
     pthread_mutex_lock(&simulator_state_mutex);
     simulator_state = s;
     pthread_mutex_unlock(&simulator_state_mutex);
+
+    if (s != IDLE) {
+	background_wakeup();
+    }
 }
 
 const char *cw_tones[] = {
@@ -69,20 +74,16 @@ const char *cw_tones[] = {
 
 
 static char simulator_tone[5];
-static char tonecpy[5];
 
+/* tone changes go through the keyer queue to stay in order with the text */
 static void set_simulator_tone() {
-    strcpy(tonecpy, tonestr);
-    strcpy(tonestr, simulator_tone);
-    write_tone();
+    keyer_set_tone(simulator_tone);
 
-    sendmessage("  ");
-    write_keyer();      // two spaces delay
+    sendmessage("  ");  // two spaces delay
 }
 
 static void restore_tone() {
-    strcpy(tonestr, tonecpy);
-    write_tone();
+    keyer_set_tone(tonestr);
 }
 
 void cqww_simulator(void) {
@@ -110,7 +111,6 @@ void cqww_simulator(void) {
 	callnumber %= callmaster->len;
 
 	sendmessage(CALLMASTERARRAY(callnumber));
-	write_keyer();
 
 	repeat_count = 0;
 	restore_tone();
@@ -129,7 +129,6 @@ void cqww_simulator(void) {
 
 	char *str = g_strdup_printf("TU 5NN %s", cqzone);
 	sendmessage(str);
-	write_keyer();
 	g_free(str);
 	cqzone[0] = save;
 
@@ -154,7 +153,6 @@ void cqww_simulator(void) {
 				    CALLMASTERARRAY(callnumber),
 				    &"+++"[3 - slow]);
 	sendmessage(str);
-	write_keyer();
 	g_free(str);
 
 	restore_tone();
@@ -35,6 +35,7 @@
 #include "deleteqso.h"
 #include "err_utils.h"
 #include "ignore_unused.h"
+#include "log_writer.h"
 #include "printcall.h"
 #include "qtcutil.h"
 #include "qtcvars.h"		// Includes globalvars.h
@@ -144,11 +145,14 @@ void delete_qso(void) {
 
     if (toupper(key_get()) == 'Y') {
 
+	log_writer_flush();
 	if ((lfile = open(logfile, O_RDWR)) < 0) {
 
 	    TLF_LOG_WARN("I can not find the logfile...");
 	} else {
 
+	    bool truncated = false;
+
 	    fstat(lfile, &statbuf);
 
 	    if (statbuf.st_size >= LOGLINELEN) {
@@ -165,12 +169,16 @@ void delete_qso(void) {
 		    delete_last_qtcs(call, bandmode);
 		}
 		IGNORE(ftruncate(lfile, statbuf.st_size - LOGLINELEN));
+		truncated = true;
 	    }
 
 	    fsync(lfile);
 	    close(lfile);
 
-	    log_read_n_score();
+	    /* only take back the score of the deleted QSO */
+	    if (truncated) {
+		rescore_remove_qso(NR_QSOS - 1);
+	    }
 	}
 	scroll_log();
     }
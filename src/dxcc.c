@@ -18,12 +18,19 @@
  */
 
 
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include <glib.h>
+#include <glib/gstdio.h>
 #include <math.h>
 
 #include "dxcc.h"
@@ -36,6 +43,24 @@ int two_char_prefix_index[36 * 36];
 bool have_exact_matches;
 char cty_dat_version[12];   // VERyyyymmdd
 
+/* trie over all prefixes for longest prefix match
+ *
+ * Nodes are numbered, the root is node 0. The edges are kept in an
+ * open addressing table keyed by node and character code.
+ * For each node prefix_trie_index holds the index of the prefix ending
+ * there (the last one added, same as in hashed_prefix) or -1.
+ */
+typedef struct {
+    uint32_t key;	/* (node << 6 | code) + 1, 0 for unused slot */
+    int32_t child;
+} trie_edge;
+
+static trie_edge *trie_edges = NULL;
+static uint32_t trie_size = 0;		/* slots in trie_edges, power of 2 */
+static uint32_t trie_nr_edges = 0;
+static GArray *prefix_trie_index = NULL;
+static bool trie_usable;		/* false if a prefix has other chars */
+
 enum {
     TCPI_NONE = -1,
     TCPI_AMB = -2,
@@ -63,7 +88,113 @@ static void prefix_free(gpointer data) {
 }
 
 
+#define TRIE_INITIAL_SIZE 1024
+
+static void trie_init(void) {
+    g_free(trie_edges);
+    trie_size = TRIE_INITIAL_SIZE;
+    trie_edges = g_new0(trie_edge, trie_size);
+    trie_nr_edges = 0;
+
+    if (prefix_trie_index) {
+	g_array_free(prefix_trie_index, TRUE);
+    }
+    prefix_trie_index = g_array_new(FALSE, FALSE, sizeof(int32_t));
+    int32_t none = -1;
+    g_array_append_val(prefix_trie_index, none);	/* root */
+    trie_usable = true;
+}
+
+/* code of character in the trie, 0 if not in the alphabet */
+static inline int trie_code(char c) {
+    if (c >= '0' && c <= '9') {
+	return 1 + c - '0';
+    }
+    if (c >= 'A' && c <= 'Z') {
+	return 11 + c - 'A';
+    }
+    if (c == '/') {
+	return 37;
+    }
+    return 0;
+}
+
+static inline uint32_t trie_slot(uint32_t key) {
+    return (key * 2654435761u) & (trie_size - 1);
+}
+
+/* child of node for character code, -1 if none */
+static inline int32_t trie_child(int32_t node, int code) {
+    uint32_t key = (((uint32_t)node << 6) | code) + 1;
+
+    for (uint32_t i = trie_slot(key); trie_edges[i].key != 0;
+	    i = (i + 1) & (trie_size - 1)) {
+	if (trie_edges[i].key == key) {
+	    return trie_edges[i].child;
+	}
+    }
+    return -1;
+}
+
+static void trie_put(uint32_t key, int32_t child) {
+    uint32_t i = trie_slot(key);
+
+    while (trie_edges[i].key != 0) {
+	i = (i + 1) & (trie_size - 1);
+    }
+    trie_edges[i].key = key;
+    trie_edges[i].child = child;
+}
+
+/* keep load factor below 1/2 */
+static void trie_grow(void) {
+    trie_edge *old = trie_edges;
+    uint32_t old_size = trie_size;
+
+    trie_size *= 2;
+    trie_edges = g_new0(trie_edge, trie_size);
+    for (uint32_t i = 0; i < old_size; i++) {
+	if (old[i].key != 0) {
+	    trie_put(old[i].key, old[i].child);
+	}
+    }
+    g_free(old);
+}
+
+static void trie_add(const char *pfx, int index) {
+    int32_t node = 0;
+
+    if (!trie_usable) {
+	return;
+    }
+
+    for (const char *p = pfx; *p != '\0'; p++) {
+	int code = trie_code(*p);
+	if (code == 0) {
+	    trie_usable = false;	/* use hashed lookup instead */
+	    return;
+	}
+
+	int32_t child = trie_child(node, code);
+	if (child < 0) {
+	    if (2 * (trie_nr_edges + 1) > trie_size) {
+		trie_grow();
+	    }
+	    child = prefix_trie_index->len;
+	    int32_t none = -1;
+	    g_array_append_val(prefix_trie_index, none);
+	    trie_put((((uint32_t)node << 6) | code) + 1, child);
+	    trie_nr_edges++;
+	}
+	node = child;
+    }
+
+    g_array_index(prefix_trie_index, int32_t, node) = index;
+}
+
 void prefix_init(void) {
+    trie_init();
+
     if (hashed_prefix) {
 	g_hash_table_destroy(hashed_prefix);
     }
@@ -134,22 +265,12 @@ int find_full_match(const char *call) {
 }
 
 
-/* search for the best mach of 'call' in pfx table */
-int find_best_match(const char *call) {
+/* search for the best match of 'call' by stepwise shortening it,
+ * used if the trie can not hold all prefixes */
+static int find_best_match_hashed(const char *call) {
     void *value;
     int w = -1;
 
-    if (call == NULL)
-	return w;
-
-    /* first check if it has a unique 2-char prefix */
-    if (strlen(call) >= 2) {
-	int key = prefix_hash_key(call);
-	if (two_char_prefix_index[key] >= 0) {
-	    return two_char_prefix_index[key];
-	}
-    }
-
     /* first try full match */
     if (lookup_hashed_prefix(call, &value)) {
 	w = GPOINTER_TO_INT(value);
@@ -175,6 +296,52 @@ int find_best_match(const char *call) {
     return w;
 }
 
+/* search for the best mach of 'call' in pfx table
+ *
+ * A full match may be an entry which requires an exact match,
+ * otherwise the longest prefix of 'call' which does not is used.
+ */
+int find_best_match(const char *call) {
+    int w = -1;
+
+    if (call == NULL)
+	return w;
+
+    /* first check if it has a unique 2-char prefix */
+    if (call[0] != '\0' && call[1] != '\0') {
+	int key = prefix_hash_key(call);
+	if (two_char_prefix_index[key] >= 0) {
+	    return two_char_prefix_index[key];
+	}
+    }
+
+    if (!trie_usable) {
+	return find_best_match_hashed(call);
+    }
+
+    /* walk down the trie, remember last prefix not requiring exact match */
+    int32_t node = 0;
+    for (const char *p = call; *p != '\0'; p++) {
+	int code = trie_code(*p);
+	if (code == 0 || (node = trie_child(node, code)) < 0) {
+	    return w;
+	}
+
+	int idx = g_array_index(prefix_trie_index, int32_t, node);
+	if (idx < 0) {
+	    continue;
+	}
+	if (p[1] == '\0') {
+	    return idx;		/* full match */
+	}
+	if (!prefix_by_index(idx)->exact) {
+	    w = idx;
+	}
+    }
+
+    return w;
+}
+
 
 /* add a new DXCC prefix description */
 void prefix_add(char *pfxstr) {
@@ -248,6 +415,7 @@ void prefix_add(char *pfxstr) {
     g_hash_table_insert(hashed_prefix,
 			new_prefix->pfx,
 			GINT_TO_POINTER(index));
+    trie_add(new_prefix->pfx, index);
 
     /* build 2-char prefix hash */
     if (strlen(pfxstr) >= 2) {
@@ -329,6 +497,282 @@ void dxcc_add(char *dxcc_line) {
     g_ptr_array_add(dxcc, new_dxcc);
 }
 
+/* ------------------------------------------------------------
+ *   binary cache of the dxcc and prefix tables
+ *
+ *   The cache file holds a header, the dxcc_data and prefix_data
+ *   records and a pool with all strings. In the file, the string
+ *   pointers of the records hold offsets into the pool. After
+ *   mapping the file the offsets are turned into pointers again and
+ *   the records are used in place.
+ *
+ *   The cache belongs to a cty.dat with given size and contents and
+ *   to the record layout of this build. All cty.dat files share one
+ *   cache, a different one replaces it.
+ *--------------------------------------------------------------*/
+
+#define CTY_CACHE_MAGIC   "TLFCTY\0"
+#define CTY_CACHE_FORMAT  2
+#define CTY_DIGEST_SIZE   32	/* SHA-256 */
+
+/* identifies cty.dat and the layout of the records */
+typedef struct {
+    char magic[8];
+    uint32_t format;
+    uint32_t byte_order;	/* 0x01020304 in host order */
+    uint32_t dxcc_size;		/* sizeof(dxcc_data) */
+    uint32_t prefix_size;	/* sizeof(prefix_data) */
+    int64_t file_size;		/* of cty.dat */
+    uint8_t digest[CTY_DIGEST_SIZE];	/* of cty.dat contents */
+} cty_cache_key;
+
+typedef struct {
+    cty_cache_key key;
+    char version[12];		/* cty_dat_version */
+    uint32_t nr_dxcc;
+    uint32_t nr_prefix;
+    uint32_t pool_size;
+    uint32_t have_exact_matches;
+    int32_t two_char_prefix_index[36 * 36];
+} cty_cache_header;
+
+static void *cache_map = NULL;
+static size_t cache_map_size = 0;
+
+static void release_cache(void) {
+    if (cache_map != NULL) {
+	munmap(cache_map, cache_map_size);
+	cache_map = NULL;
+	cache_map_size = 0;
+    }
+}
+
+/** \return true if the tables were loaded from the binary cache */
+bool dxcc_cached(void) {
+    return cache_map != NULL;
+}
+
+/* fill in the key for cty.dat 'filename'
+ * \return false if it can not be read */
+static bool get_cache_key(cty_cache_key *key, const char *filename) {
+    gchar *contents;
+    gsize len;
+    gsize digest_len = sizeof(key->digest);
+
+    if (!g_file_get_contents(filename, &contents, &len, NULL)) {
+	return false;
+    }
+
+    memset(key, 0, sizeof(*key));
+    memcpy(key->magic, CTY_CACHE_MAGIC, sizeof(key->magic));
+    key->format = CTY_CACHE_FORMAT;
+    key->byte_order = 0x01020304;
+    key->dxcc_size = sizeof(dxcc_data);
+    key->prefix_size = sizeof(prefix_data);
+    key->file_size = len;
+
+    GChecksum *checksum = g_checksum_new(G_CHECKSUM_SHA256);
+    g_checksum_update(checksum, (const guchar *)contents, len);
+    g_checksum_get_digest(checksum, key->digest, &digest_len);
+    g_checksum_free(checksum);
+    g_free(contents);
+
+    return true;
+}
+
+/* turn pool offset into pointer, NULL if out of range */
+static char *pool_string(char *pool, uint32_t pool_size, char *offset) {
+    uintptr_t off = (uintptr_t)offset;
+
+    return (off < pool_size ? pool + off : NULL);
+}
+
+/* the index is TCPI_NONE, TCPI_AMB or the number of a prefix */
+static bool two_char_index_valid(const cty_cache_header *header) {
+    for (int i = 0; i < 36 * 36; i++) {
+	int32_t index = header->two_char_prefix_index[i];
+	if (index < 0 ? (index != TCPI_NONE && index != TCPI_AMB)
+		: (uint32_t)index >= header->nr_prefix) {
+	    return false;
+	}
+    }
+    return true;
+}
+
+/* use cache file if it belongs to cty.dat described by 'key' */
+static bool read_cache(const char *cachefile, const cty_cache_key *key) {
+    struct stat cache_st;
+
+    int fd = g_open(cachefile, O_RDONLY, 0);
+    if (fd < 0) {
+	return false;
+    }
+    if (fstat(fd, &cache_st) != 0
+	    || cache_st.st_size < sizeof(cty_cache_header)) {
+	close(fd);
+	return false;
+    }
+
+    size_t size = cache_st.st_size;
+    char *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+	return false;
+    }
+
+    cty_cache_header *header = (cty_cache_header *)map;
+
+    size_t records = sizeof(*header)
+		     + (size_t)header->nr_dxcc * sizeof(dxcc_data)
+		     + (size_t)header->nr_prefix * sizeof(prefix_data);
+
+    if (memcmp(&header->key, key, sizeof(*key)) != 0
+	    || memchr(header->version, '\0', sizeof(header->version)) == NULL
+	    || header->nr_dxcc == 0 || header->pool_size == 0
+	    || records + header->pool_size != size
+	    || map[size - 1] != '\0'
+	    || !two_char_index_valid(header)) {
+	munmap(map, size);
+	return false;	/* stale or broken */
+    }
+
+    dxcc_data *dx = (dxcc_data *)(map + sizeof(*header));
+    prefix_data *pfx = (prefix_data *)(dx + header->nr_dxcc);
+    char *pool = map + records;
+    uint32_t pool_size = header->pool_size;
+
+    for (uint32_t i = 0; i < header->nr_dxcc; i++) {
+	dx[i].countryname = pool_string(pool, pool_size, dx[i].countryname);
+	dx[i].continent = pool_string(pool, pool_size, dx[i].continent);
+	dx[i].pfx = pool_string(pool, pool_size, dx[i].pfx);
+	if (!dx[i].countryname || !dx[i].continent || !dx[i].pfx) {
+	    munmap(map, size);
+	    return false;
+	}
+    }
+    for (uint32_t i = 0; i < header->nr_prefix; i++) {
+	pfx[i].pfx = pool_string(pool, pool_size, pfx[i].pfx);
+	pfx[i].continent = pool_string(pool, pool_size, pfx[i].continent);
+	if (!pfx[i].pfx || !pfx[i].continent
+		|| pfx[i].dxcc_ctynr < 0 || pfx[i].dxcc_ctynr >= header->nr_dxcc) {
+	    munmap(map, size);
+	    return false;
+	}
+    }
+
+    /* records live in the mapping, so no free function */
+    dxcc_init();
+    prefix_init();
+    release_cache();
+    g_ptr_array_set_free_func(dxcc, NULL);
+    g_ptr_array_set_free_func(prefix, NULL);
+
+    for (uint32_t i = 0; i < header->nr_dxcc; i++) {
+	g_ptr_array_add(dxcc, &dx[i]);
+    }
+    for (uint32_t i = 0; i < header->nr_prefix; i++) {
+	g_ptr_array_add(prefix, &pfx[i]);
+	g_hash_table_insert(hashed_prefix, pfx[i].pfx, GINT_TO_POINTER(i));
+	trie_add(pfx[i].pfx, i);
+    }
+    memcpy(two_char_prefix_index, header->two_char_prefix_index,
+	   sizeof(two_char_prefix_index));
+    have_exact_matches = header->have_exact_matches;
+    g_strlcpy(cty_dat_version, header->version, sizeof(cty_dat_version));
+
+    cache_map = map;
+    cache_map_size = size;
+    return true;
+}
+
+/* add string to pool, return its offset as pointer */
+static char *pool_add(GString *pool, const char *str) {
+    uintptr_t off = pool->len;
+
+    g_string_append_len(pool, str, strlen(str) + 1);
+    return (char *)off;
+}
+
+/* write loaded tables to cache file, errors are ignored */
+static void write_cache(const char *cachefile, const cty_cache_key *key) {
+    cty_cache_header header;
+    GString *pool = g_string_new(NULL);
+
+    memset(&header, 0, sizeof(header));
+    header.key = *key;
+    g_strlcpy(header.version, cty_dat_version, sizeof(header.version));
+    header.nr_dxcc = dxcc_count();
+    header.nr_prefix = prefix_count();
+    header.have_exact_matches = have_exact_matches;
+    memcpy(header.two_char_prefix_index, two_char_prefix_index,
+	   sizeof(two_char_prefix_index));
+
+    dxcc_data *dx = g_new(dxcc_data, header.nr_dxcc);
+    for (uint32_t i = 0; i < header.nr_dxcc; i++) {
+	dx[i] = *dxcc_by_index(i);
+	dx[i].countryname = pool_add(pool, dx[i].countryname);
+	dx[i].continent = pool_add(pool, dx[i].continent);
+	dx[i].pfx = pool_add(pool, dx[i].pfx);
+    }
+    prefix_data *pfx = g_new(prefix_data, header.nr_prefix);
+    for (uint32_t i = 0; i < header.nr_prefix; i++) {
+	pfx[i] = *prefix_by_index(i);
+	pfx[i].pfx = pool_add(pool, pfx[i].pfx);
+	pfx[i].continent = pool_add(pool, pfx[i].continent);
+    }
+    header.pool_size = pool->len;
+
+    /* write to temporary file and rename it, so readers never see
+     * a partly written cache */
+    char *dir = g_path_get_dirname(cachefile);
+    char *tmpfile = g_strconcat(cachefile, ".tmp", NULL);
+    FILE *fp = NULL;
+
+    if (g_mkdir_with_parents(dir, 0755) == 0
+	    && (fp = g_fopen(tmpfile, "wb")) != NULL) {
+	bool ok = fwrite(&header, sizeof(header), 1, fp) == 1
+		  && fwrite(dx, sizeof(dxcc_data), header.nr_dxcc, fp)
+		  == header.nr_dxcc
+		  && fwrite(pfx, sizeof(prefix_data), header.nr_prefix, fp)
+		  == header.nr_prefix
+		  && fwrite(pool->str, 1, pool->len, fp) == pool->len;
+	ok = (fclose(fp) == 0) && ok;
+	if (!ok || g_rename(tmpfile, cachefile) != 0) {
+	    g_unlink(tmpfile);
+	}
+    }
+
+    g_free(tmpfile);
+    g_free(dir);
+    g_free(pfx);
+    g_free(dx);
+    g_string_free(pool, TRUE);
+}
+
+/** load cty database from filename using a binary cache
+ *
+ * Uses 'cachefile' if it was written for the same contents of
+ * 'filename', otherwise parses 'filename' and writes a new cache.
+ */
+int load_ctydata_cached(char *filename, char *cachefile) {
+    cty_cache_key key;
+
+    if (!get_cache_key(&key, filename)) {
+	return -1;
+    }
+
+    if (read_cache(cachefile, &key)) {
+	return 0;
+    }
+
+    if (load_ctydata(filename) != 0) {
+	return -1;
+    }
+
+    write_cache(cachefile, &key);
+    return 0;
+}
+
 /** load cty database from filename */
 int load_ctydata(char *filename) {
     FILE *fd;
@@ -340,6 +784,7 @@ int load_ctydata(char *filename) {
 
     dxcc_init();
     prefix_init();
+    release_cache();
 
     // set default for empty country == country nr 0
     dxcc_add("Not Specified        :    --:  --:  --:  -00.00:    00.00:     0.0:     :");
@@ -72,4 +72,6 @@ dxcc_data *dxcc_by_index(unsigned int index);
 void dxcc_add(char *dxcc_line);
 
 int load_ctydata(char *filename);
+int load_ctydata_cached(char *filename, char *cachefile);
+bool dxcc_cached(void);
 #endif 	/* DXCC_H */
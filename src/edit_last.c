@@ -35,6 +35,7 @@
 #include "logview.h"
 #include "readcalls.h"
 #include "log_utils.h"
+#include "log_writer.h"
 #include "scroll_log.h"
 #include "tlf_curses.h"
 #include "ui_utils.h"
@@ -75,6 +76,7 @@ static field_t fields[] = {
 
 static char editbuffer[LOGLINELEN + 1];
 static bool changed, needs_rescore;
+static int first_changed;     // index of first changed QSO
 static int editline;
 static int field_index;
 static field_t *current_field;  // points to fields[field_index]
@@ -128,6 +130,7 @@ static void putback_qso(int nr, char *buffer) {
     assert(strlen(buffer) == (LOGLINELEN - 1));
     assert(nr < NR_QSOS);
 
+    log_writer_flush();
     if ((fp = fopen(logfile, "r+")) == NULL) {
 	TLF_LOG_WARN("Can not open logfile...");
     } else {
@@ -139,8 +142,12 @@ static void putback_qso(int nr, char *buffer) {
 
 	struct qso_t *qso = parse_qso(buffer);
 	struct qso_t *old_qso = g_ptr_array_index(qso_array, nr);
+	/* keep scoring journal, it is needed to take back the old score */
+	qso->journal = old_qso->journal;
+	old_qso->journal = NULL;
 	g_ptr_array_index(qso_array, nr) = qso;
 	free_qso(old_qso);
+	qso_array_changed();
     }
 }
 
@@ -168,8 +175,12 @@ static void check_store_and_get_next_line(int direction) {
     }
     unhighlight_line(editline, editbuffer);
     if (changed) {
-        putback_qso(NR_QSOS - (NR_LINES - editline), editbuffer);
+        int nr = NR_QSOS - (NR_LINES - editline);
+        putback_qso(nr, editbuffer);
         needs_rescore = true;
+        if (nr < first_changed) {
+            first_changed = nr;
+        }
         changed = false;
     }
     if (direction != 0) {
@@ -202,6 +213,7 @@ void edit_last(void) {
     get_qso(NR_QSOS - (NR_LINES - editline), editbuffer);
     changed = false;
     needs_rescore = false;
+    first_changed = NR_QSOS;
 
     while (true) {
 	highlight_line(editline, editbuffer, b);
@@ -313,7 +325,7 @@ void edit_last(void) {
     check_store_and_get_next_line(0);
 
     if (needs_rescore) {
-	log_read_n_score();
+	rescore_from(first_changed);
     }
 
     scroll_log();
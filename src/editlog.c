@@ -36,6 +36,7 @@
 #include "err_utils.h"
 #include "globalvars.h"
 #include "ignore_unused.h"
+#include "log_writer.h"
 #include "readqtccalls.h"
 #include "readcalls.h"
 #include "scroll_log.h"
@@ -73,10 +74,11 @@ void edit(char *filename) {
 void logedit(void) {
 
     stop_background_process();
+    log_writer_flush();
     edit(logfile);
     checklogfile();
 
-    log_read_n_score();
+    log_reread_n_score();
 
     start_background_process();
 
@@ -26,6 +26,7 @@
 #include "getctydata.h"
 #include "globalvars.h"
 #include "initial_exchange.h"
+#include "searchcallarray.h"
 #include "tlf.h"
 #include "tlf_curses.h"
 #include "ui_utils.h"
@@ -103,13 +104,14 @@ static int nr_of_bands(int x) {
  * count the number of stations worked on 5 or 6 band (including G4FOC)
  */
 static void count_56_banders() {
+    worked_t entry;
     int i, nr;
 
     five_banders = 0;
     six_banders = 0;
 
-    for (i = 0; i < nr_worked; i++) {
-	nr = nr_of_bands(worked[i].band);
+    for (i = 0; copy_worked_at(i, &entry); i++) {
+	nr = nr_of_bands(entry.band);
 	if (nr >= 5) 			/* sixbanders are also fivebanders */
 	    five_banders++;
 	if (nr == 6)
@@ -120,12 +122,13 @@ static void count_56_banders() {
 
 static int search_g4foc_in_callarray(void) {
 
+    worked_t entry;
     int found = -1;
     int i;
 
-    for (i = 0; i < nr_worked; i++) {
+    for (i = 0; copy_worked_at(i, &entry); i++) {
 
-	if (g_regex_match_simple("^G(|[A-Z])4FOC(|/.*)", worked[i].call,
+	if (g_regex_match_simple("^G(|[A-Z])4FOC(|/.*)", entry.call,
 				 G_REGEX_CASELESS, (GRegexMatchFlags)0)) {
 	    found = i;
 	    break;
@@ -156,12 +159,13 @@ static int get_nr_cont() {
 
     GHashTable *cont;
     dxcc_data *data;
+    worked_t entry;
     int nr, i;
 
     cont = g_hash_table_new(g_str_hash, g_str_equal);
 
-    for (i = 0; i < nr_worked; i++) {
-	data = dxcc_by_index(worked[i].ctyinfo->dxcc_ctynr);
+    for (i = 0; copy_worked_at(i, &entry); i++) {
+	data = dxcc_by_index(entry.ctyinfo->dxcc_ctynr);
 
 	g_hash_table_replace(cont, data->continent, data->continent);
     }
@@ -178,13 +182,14 @@ static int get_nr_cont() {
  */
 int foc_total_score() {
 
+    worked_t entry;
     int points;
 
     /* first find Gx4FOC in call array and see how often we worked him */
     g4foc_index = search_g4foc_in_callarray();
 
-    if (g4foc_index != -1)
-	g4foc_count = nr_of_bands(worked[g4foc_index].band);
+    if (copy_worked_at(g4foc_index, &entry))
+	g4foc_count = nr_of_bands(entry.band);
     else
 	g4foc_count = 0;
 
@@ -233,17 +238,14 @@ void foc_show_scoring(int start_column) {
 static GTree *build_country_list(struct ie_list *main_ie_list) {
     GTree *tree;
     int j;
-    struct ie_list *list_head = main_ie_list;
 
     tree = g_tree_new_full((GCompareDataFunc)g_ascii_strcasecmp, NULL, g_free,
 			   NULL);
 
-    while (list_head) {
-	j = getctydata(list_head->call);
+    for (int i = 0; i < ie_list_size(main_ie_list); i++) {
+	j = getctydata((char *)ie_list_entry(main_ie_list, i)->call);
 	g_tree_insert(tree, g_strdup(dxcc_by_index(j)->pfx),
 		      GINT_TO_POINTER(countries[j]));
-
-	list_head = list_head->next;
     }
 
     return tree;
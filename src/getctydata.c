@@ -29,17 +29,25 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include "dxcc.h"
+#include "getctydata.h"
 #include "getpx.h"
 #include "globalvars.h"		// Includes glib.h and tlf.h
 #include "setcontest.h"
 
+/* check if call of length len ends with suffix */
+static bool has_suffix(const char *call, size_t len, const char *suffix) {
+    size_t n = strlen(suffix);
+
+    return len >= n && memcmp(call + len - n, suffix, n) == 0;
+}
+
 /* check for calls which have no assigned country and no assigned zone,
  * e.g. airborn mobile /AM or maritime mobile /MM
  */
 int location_unknown(const char *call) {
+    size_t len = strlen(call);
 
-    return g_regex_match_simple("/AM$|/MM$", call,
-				(GRegexCompileFlags)0, (GRegexMatchFlags)0);
+    return has_suffix(call, len, "/AM") || has_suffix(call, len, "/MM");
 }
 
 
@@ -60,87 +68,104 @@ void change_area(char *call, char area) {
 }
 
 
-/* prepare and check callsign and look it up in dxcc data base
+/* normalize a call containing a '/' at position loc
  *
- * returns index in data base or -1 if not found
- * if normalized_call ptr is not NULL returns a copy of the normalized call
- * e.g. DL1XYZ/PA gives PA/DL1XYZ
- * caller has to free the copy after use
+ * - a shorter 2nd part is a prefix and moves to the front,
+ *   sets *abnormal_call (DL1XYZ/PA -> PA/DL1XYZ)
+ * - a single character suffix is dropped, a digit replaces the call
+ *   area (DL1XYZ/P -> DL1XYZ, K2ND/4 -> K4ND)
+ * - a longer suffix replaces the call
+ * - otherwise a prefix of up to 4 characters is kept (PA/DJ0LN/P -> PA)
  */
-int getpfxindex(char *checkcallptr, char **normalized_call) {
-    char checkcall[17] = "";
-    char strippedcall[17] = "";
-
-    if (checkcallptr == NULL) {
-	return -1;
+static void normalize_call(char *checkcall, size_t len, size_t loc,
+			   bool *abnormal_call) {
+    size_t len1 = loc;			/* 1st part before '/' */
+    size_t len2 = len - loc - 1;	/* 2nd part after '/' */
+    const char *suffix = "";
+    size_t suffix_len = 0;
+
+    if (len2 < len1 && len2 > 1) {
+	char swapped[CALL_BUFFER_SIZE];
+
+	memcpy(swapped, checkcall + loc + 1, len2);
+	swapped[len2] = '/';
+	memcpy(swapped + len2 + 1, checkcall, len1);
+	swapped[len] = '\0';
+	memcpy(checkcall, swapped, len + 1);
+
+	*abnormal_call = true;
+	loc = strcspn(checkcall, "/");
     }
 
-    int w = 0, abnormal_call = 0;
-    size_t loc;
-
-    g_strlcpy(strippedcall, checkcallptr, sizeof(strippedcall));
-
-    if (strstr(strippedcall, "/QRP") ==
-	    (strippedcall + strlen(strippedcall) - 4))
-	/* drop QRP suffix */
-	strippedcall[strlen(strippedcall) - 4] = '\0';
-
-    /* go out if /MM, /AM or similar */
-    if (location_unknown(strippedcall))
-	strippedcall[0] = '\0';
-
-    g_strlcpy(checkcall, strippedcall, sizeof(checkcall));
-
-    loc = strcspn(checkcall, "/");
-
-    if (loc != strlen(checkcall)) {		/* found a '/' */
-	char checkbuffer[17] = "";
-	char call1[17];
-	char call2[17];
-
-	strncpy(call1, checkcall, loc);		/* 1st part before '/' */
-	call1[loc] = '\0';
-	strcpy(call2, checkcall + loc + 1);	/* 2nd part after '/' */
+    if (loc > 3) {
+	/* the suffix stays in place even if the call gets cut below */
+	suffix = checkcall + loc + 1;
+	suffix_len = len - loc - 1;
 
-	if (strlen(call2) < strlen(call1)
-		&& strlen(call2) > 1) {
-	    strcpy(checkcall, call2);
-	    g_strlcat(checkcall, "/", sizeof(checkcall));
-	    g_strlcat(checkcall, call1, sizeof(checkcall));
-	    abnormal_call = 1;
-	    loc = strcspn(checkcall, "/");
+	if (suffix_len == 1) {
+	    checkcall[loc] = '\0';
+	    len = loc;
 	}
+	loc = strcspn(checkcall, "/");
+    }
 
-	if (loc > 3) {
+    if (loc < len && loc < 5)
+	checkcall[loc] = '\0';		/*  "PA/DJ0LN/P   */
 
-	    strncpy(checkbuffer, (checkcall + loc + 1),
-		    (strlen(checkcall) + 1) - loc);
+    if (suffix_len == 1 && isdigit(suffix[0])) {	/*  /3 */
+	change_area(checkcall, suffix[0]);
+    } else if (suffix_len > 1) {
+	memmove(checkcall, suffix, suffix_len + 1);
+    }
+}
 
-	    if (strlen(checkbuffer) == 1)
-		checkcall[loc] = '\0';
-	    loc = strcspn(checkcall, "/");
-	}
 
-	if (loc != strlen(checkcall)) {
+/* prepare and check callsign and look it up in dxcc data base
+ *
+ * Works on copies of at most CALL_BUFFER_SIZE - 1 characters and does
+ * not allocate memory.
+ *
+ * returns index in data base or -1 if not found
+ * if normalized_call is not NULL it gets a copy of the normalized call,
+ * e.g. DL1XYZ/PA gives PA. It has to hold CALL_BUFFER_SIZE characters.
+ */
+int getpfxindex(char *checkcallptr, char *normalized_call) {
+    char checkcall[CALL_BUFFER_SIZE];
+    char strippedcall[CALL_BUFFER_SIZE];
+    bool abnormal_call = false;
+    int w;
 
-	    if (loc < 5)
-		checkcall[loc] = '\0';	/*  "PA/DJ0LN/P   */
-	}
+    if (checkcallptr == NULL) {
+	return -1;
+    }
 
-	/* ------------------------------------------------------------ */
+    size_t len = strnlen(checkcallptr, sizeof(strippedcall) - 1);
+    memcpy(strippedcall, checkcallptr, len);
+    strippedcall[len] = '\0';
 
-	if ((strlen(checkbuffer) == 1) && isdigit(checkbuffer[0])) {	/*  /3 */
+    if (has_suffix(strippedcall, len, "/QRP")) {
+	/* drop QRP suffix */
+	len -= 4;
+	strippedcall[len] = '\0';
+    }
 
-	    change_area(checkcall, checkbuffer[0]);
+    /* go out if /MM, /AM or similar */
+    if (has_suffix(strippedcall, len, "/AM")
+	    || has_suffix(strippedcall, len, "/MM")) {
+	len = 0;
+	strippedcall[0] = '\0';
+    }
 
-	} else if (strlen(checkbuffer) > 1)
-	    strcpy(checkcall, checkbuffer);
+    memcpy(checkcall, strippedcall, len + 1);
 
+    const char *slash = memchr(checkcall, '/', len);
+    if (slash != NULL) {
+	normalize_call(checkcall, len, slash - checkcall, &abnormal_call);
     }
 
     /* -------------check full call exceptions first...--------------------- */
 
-    if (abnormal_call == 1) {
+    if (abnormal_call) {
 	w = find_full_match(strippedcall);
     } else {
 	w = find_best_match(strippedcall);
@@ -152,7 +177,7 @@ int getpfxindex(char *checkcallptr, char **normalized_call) {
     }
 
     if (normalized_call != NULL)
-	*normalized_call = strdup(checkcall);
+	strcpy(normalized_call, checkcall);
 
     return w;
 }
@@ -180,17 +205,12 @@ int getctynr(char *call) {
  *
  * side effect: set up various global variables
  */
-static int getctydata_internal(char *call, bool get_country) {
-    char *normalized_call = NULL;
-
-    int w = getpfxindex(call, &normalized_call);
-
+/* fill the global country data from prefix entry 'w' */
+static int set_ctydata(int w, char *normalized_call, bool get_country) {
     if (CONTEST_IS(WPX) || pfxmult)
 	/* needed for wpx and other pfx contests */
 	getpx(normalized_call);
 
-    free(normalized_call);
-
     // fill global variables
     prefix_data *pfx = prefix_by_index(w);
     countrynr = pfx->dxcc_ctynr;
@@ -204,6 +224,13 @@ static int getctydata_internal(char *call, bool get_country) {
     return get_country ? countrynr : w;
 }
 
+static int getctydata_internal(char *call, bool get_country) {
+    char normalized_call[CALL_BUFFER_SIZE];
+
+    int w = getpfxindex(call, normalized_call);
+    return set_ctydata(w, normalized_call, get_country);
+}
+
 int getctydata(char *call) {
     return getctydata_internal(call, true);
 }
@@ -211,3 +238,9 @@ int getctydata(char *call) {
 int getctydata_pfx(char *call) {
     return getctydata_internal(call, false);
 }
+
+/* same as getctydata() for a call looked up before by getpfxindex(),
+ * so that the lookup can be done in another thread */
+int getctydata_by_index(int index, char *normalized_call) {
+    return set_ctydata(index, normalized_call, true);
+}
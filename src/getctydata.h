@@ -23,10 +23,15 @@
 
 #include "dxcc.h"
 
+/* size of the call buffers used for dxcc lookup */
+#define CALL_BUFFER_SIZE 17
+
+int getpfxindex(char *checkcallptr, char *normalized_call);
 prefix_data *getctyinfo(char *call);
 int getctynr(char *call);
 int getctydata(char *call);
 int getctydata_pfx(char *call);
+int getctydata_by_index(int index, char *normalized_call);
 
 
 #endif /* end of include guard: GETCTYDATA_H */
@@ -555,8 +555,8 @@ static void checkexchange_cqww(struct qso_t *qso, bool interactive) {
 	"\\s*";
 
     static GRegex *regex = NULL;
-    if (regex == NULL) {
-	regex = g_regex_new(PATTERN, 0, 0, NULL);
+    if (g_once_init_enter(&regex)) {	// may run in rescoring threads
+	g_once_init_leave(&regex, g_regex_new(PATTERN, 0, 0, NULL));
     }
 
     int zone = 0;
@@ -613,8 +613,8 @@ static void checkexchange_arrlss(struct qso_t *qso, bool interactive) {
 	"\\s*";
     ;
     static GRegex *regex = NULL;
-    if (regex == NULL) {
-	regex = g_regex_new(PATTERN, 0, 0, NULL);
+    if (g_once_init_enter(&regex)) {
+	g_once_init_leave(&regex, g_regex_new(PATTERN, 0, 0, NULL));
     }
 
     qso->section[0] = 0;
@@ -694,8 +694,8 @@ static void checkexchange_serial_section(struct qso_t *qso, bool interactive) {
 	"\\s*";
     ;
     static GRegex *regex = NULL;
-    if (regex == NULL) {
-	regex = g_regex_new(PATTERN, 0, 0, NULL);
+    if (g_once_init_enter(&regex)) {
+	g_once_init_leave(&regex, g_regex_new(PATTERN, 0, 0, NULL));
     }
 
     qso->section[0] = 0;
@@ -761,8 +761,8 @@ static void checkexchange_sectn_mult(struct qso_t *qso, bool interactive) {
 	"\\s*";
     ;
     static GRegex *regex = NULL;
-    if (regex == NULL) {
-	regex = g_regex_new(PATTERN, 0, 0, NULL);
+    if (g_once_init_enter(&regex)) {
+	g_once_init_leave(&regex, g_regex_new(PATTERN, 0, 0, NULL));
     }
 
     qso->section[0] = 0;
@@ -20,6 +20,14 @@
 /* ------------------------------------------------------------
  *      get trx info
  *
+ *  All hamlib commands of the rig control (frequency and mode
+ *  changes, PTT and polling) run in a thread of their own, so a slow
+ *  CAT link does not hold up the background process.
+ *
+ *  Requests are not kept in order but collected per kind: PTT is
+ *  switched first, then only the latest frequency request is
+ *  executed and the rig gets polled, then mode and RIT changes
+ *  follow.
  *--------------------------------------------------------------*/
 
 
@@ -28,6 +36,7 @@
 #include <pthread.h>
 
 #include "bands.h"
+#include "cat_stats.h"
 #include "cw_utils.h"
 #include "err_utils.h"
 #include "fldigixmlrpc.h"
@@ -36,8 +45,8 @@
 #include "hamlib_keyer.h"
 #include "tlf.h"
 #include "tlf_curses.h"
+#include "trx_state.h"
 #include "callinput.h"
-#include "bands.h"
 
 #include <hamlib/rig.h>
 
@@ -47,45 +56,92 @@
 #define TLF_DEFAULT_PASSBAND RIG_PASSBAND_NORMAL
 #endif
 
-/* output frequency to rig or other rig-related request
+#define RIG_POLL_INTERVAL	200	/* ms */
+
+/* pending requests, protected by request_mutex */
+static freq_t outfreq = 0;		/* latest frequency, 0 if none */
+static freq_t mode_request = 0;		/* SETCWMODE, SETSSBMODE, SETDIGIMODE */
+static bool rit_request = false;
+static int coalesced = 0;		/* frequencies replaced before use */
+
+static pthread_mutex_t request_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t request_cond = PTHREAD_COND_INITIALIZER;
+
+static pthread_t rig_thread;
+static bool running = false;
+static bool stop_requested = false;
+
+static double next_poll = 0.0;		/* seconds, see get_current_seconds() */
+
+static double get_current_seconds();
+static void handle_trx_bandswitch(const freq_t freq);
+
+/** request a new frequency or other rig-related action
  *
  * possible values:
- *  0 - poll rig
  *  SETCWMODE
  *  SETSSBMODE
  *  RESETRIT
  *  SETDIGIMODE
- *  else - set rig frequency
+ *  else - set rig frequency, 0 drops a pending frequency request
  *
+ * A frequency request replaces a pending one which was not executed
+ * yet, same for the mode requests.
  */
-static freq_t outfreq = 0;
-
-static pthread_mutex_t outfreq_mutex = PTHREAD_MUTEX_INITIALIZER;
-
-static double get_current_seconds();
-static void handle_trx_bandswitch(const freq_t freq);
-
 void set_outfreq(freq_t hertz) {
     if (!trx_control) {
 	hertz = 0;      // no rig control, ignore request
     }
-    pthread_mutex_lock(&outfreq_mutex);
-    outfreq = hertz;
-    pthread_mutex_unlock(&outfreq_mutex);
+    pthread_mutex_lock(&request_mutex);
+    if (hertz == SETCWMODE || hertz == SETSSBMODE || hertz == SETDIGIMODE) {
+	mode_request = hertz;
+    } else if (hertz == RESETRIT) {
+	rit_request = true;
+    } else {
+	if (outfreq != 0 && hertz != 0)
+	    coalesced++;
+	outfreq = hertz;
+    }
+    pthread_cond_signal(&request_cond);
+    pthread_mutex_unlock(&request_mutex);
 }
 
+/** \return pending frequency request, 0 if none */
 freq_t get_outfreq() {
-    return outfreq;
-}
-
-static freq_t get_and_reset_outfreq() {
-    pthread_mutex_lock(&outfreq_mutex);
+    pthread_mutex_lock(&request_mutex);
     freq_t f = outfreq;
-    outfreq = 0.0;
-    pthread_mutex_unlock(&outfreq_mutex);
+    pthread_mutex_unlock(&request_mutex);
     return f;
 }
 
+/** \return number of frequency requests replaced by a newer one */
+int get_coalesced_outfreq() {
+    pthread_mutex_lock(&request_mutex);
+    int n = coalesced;
+    pthread_mutex_unlock(&request_mutex);
+    return n;
+}
+
+/** request switching CAT PTT on or off */
+void set_rig_ptt(bool on) {
+    pthread_mutex_lock(&request_mutex);
+    rigptt |= (on ? CAT_PTT_ON : CAT_PTT_OFF);
+    pthread_cond_signal(&request_cond);
+    pthread_mutex_unlock(&request_mutex);
+}
+
+static bool ptt_requested() {
+    return rigptt == (CAT_PTT_USE | CAT_PTT_ON)
+	   || rigptt == (CAT_PTT_USE | CAT_PTT_ACTIVE | CAT_PTT_OFF);
+}
+
+static bool requests_pending() {
+    if (!trx_control)
+	return false;
+    return ptt_requested() || outfreq != 0 || mode_request != 0
+	   || rit_request;
+}
+
 static rmode_t get_ssb_mode() {
     // LSB below 14 MHz, USB above it
     return (freq < bandcorner[BANDINDEX_20][0] ? RIG_MODE_LSB : RIG_MODE_USB);
@@ -96,172 +152,233 @@ static pbwidth_t get_cw_bandwidth() {
     return (cw_bandwidth > 0 ? cw_bandwidth : TLF_DEFAULT_PASSBAND);
 }
 
+static void publish_state() {
+    trx_state_t state = {
+	.freq = freq,
+	.mode = rigmode,
+	.bandinx = bandinx,
+	.ptt = (rigptt & CAT_PTT_ACTIVE) != 0,
+    };
+    trx_state_publish(&state);
+}
 
-void gettxinfo(void) {
 
-    freq_t rigfreq;
-    vfo_t vfo;
-    pbwidth_t bwidth;
-    int retval;
-    int retvalmode;
-    int fldigi_shift_freq;
+static void switch_ptt(void) {
+    ptt_t ptt;
 
-    static double last_freq_time = 0.0;
-    static int oldbandinx;
-
-    if (!trx_control)
-	return;
+    pthread_mutex_lock(&request_mutex);
 
     /* CAT PTT wanted, available, inactive, and PTT On requested
      */
     if (rigptt == (CAT_PTT_USE | CAT_PTT_ON)) {
-	pthread_mutex_lock(&rig_lock);
-	retval = rig_set_ptt(my_rig, RIG_VFO_CURR, RIG_PTT_ON);
-	pthread_mutex_unlock(&rig_lock);
+	ptt = RIG_PTT_ON;
 
-	/* Set PTT active bit. */
+	/* Set PTT active bit, clear PTT On requested bit. */
 	rigptt |= CAT_PTT_ACTIVE;
-
-	/* Clear PTT On requested bit. */
 	rigptt &= ~CAT_PTT_ON;
-    }
 
     /* CAT PTT wanted, available, active and PTT Off requested
      */
-    if (rigptt == (CAT_PTT_USE | CAT_PTT_ACTIVE | CAT_PTT_OFF)) {
-	pthread_mutex_lock(&rig_lock);
-	retval = rig_set_ptt(my_rig, RIG_VFO_CURR, RIG_PTT_OFF);
-	pthread_mutex_unlock(&rig_lock);
+    } else if (rigptt == (CAT_PTT_USE | CAT_PTT_ACTIVE | CAT_PTT_OFF)) {
+	ptt = RIG_PTT_OFF;
 
-	/* Clear PTT Off requested bit. */
-	rigptt &= ~CAT_PTT_OFF;
+	/* Clear PTT Off requested bit and PTT active bit. */
+	rigptt &= ~(CAT_PTT_OFF | CAT_PTT_ACTIVE);
 
-	/* Clear PTT active bit. */
-	rigptt &= ~CAT_PTT_ACTIVE;
+    } else {
+	pthread_mutex_unlock(&request_mutex);
+	return;
     }
 
-    freq_t reqf = get_and_reset_outfreq();  // get actual request
+    pthread_mutex_unlock(&request_mutex);
 
-    if (reqf == 0) {
+    pthread_mutex_lock(&rig_lock);
+    double start = cat_stats_start();
+    int retval = rig_set_ptt(my_rig, RIG_VFO_CURR, ptt);
+    cat_stats_record(CAT_SET_PTT, start, retval);
+    pthread_mutex_unlock(&rig_lock);
 
-	rigfreq = 0.0;
+    if (retval != RIG_OK) {
+	TLF_LOG_WARN("Problem with rig link: set ptt: %s", rigerror(retval));
+    }
+}
 
-	double now = get_current_seconds();
-	if (now < last_freq_time + 0.2) {
-	    return;   // last read-out was within 200 ms, skip this query
-	}
-	last_freq_time = now;
 
+static void poll_rig(void) {
+
+    freq_t rigfreq;
+    vfo_t vfo;
+    pbwidth_t bwidth;
+    int retval;
+    int retvalmode;
+    int fldigi_shift_freq;
+
+    static int oldbandinx;
+
+    rigfreq = 0.0;
+
+    pthread_mutex_lock(&rig_lock);
+    retval = rig_get_vfo(my_rig, &vfo); /* initialize RIG_VFO_CURR */
+    pthread_mutex_unlock(&rig_lock);
+
+    if (retval == RIG_OK || retval == -RIG_ENIMPL || retval == -RIG_ENAVAIL) {
 	pthread_mutex_lock(&rig_lock);
-	retval = rig_get_vfo(my_rig, &vfo); /* initialize RIG_VFO_CURR */
+	double start = cat_stats_start();
+	retval = rig_get_freq(my_rig, RIG_VFO_CURR, &rigfreq);
+	cat_stats_record(CAT_GET_FREQ, start, retval);
 	pthread_mutex_unlock(&rig_lock);
 
-	if (retval == RIG_OK || retval == -RIG_ENIMPL || retval == -RIG_ENAVAIL) {
+	if (trxmode == DIGIMODE && (digikeyer == GMFSK || digikeyer == FLDIGI)
+		&& retval == RIG_OK) {
+
 	    pthread_mutex_lock(&rig_lock);
-	    retval = rig_get_freq(my_rig, RIG_VFO_CURR, &rigfreq);
+	    start = cat_stats_start();
+	    retvalmode = rig_get_mode(my_rig, RIG_VFO_CURR, &rigmode, &bwidth);
+	    cat_stats_record(CAT_GET_MODE, start, retvalmode);
 	    pthread_mutex_unlock(&rig_lock);
 
-	    if (trxmode == DIGIMODE && (digikeyer == GMFSK || digikeyer == FLDIGI)
-		    && retval == RIG_OK) {
+	    if (retvalmode != RIG_OK) {
+		rigmode = RIG_MODE_NONE;
+	    }
+	}
+    }
 
+    if (trxmode == DIGIMODE && (digikeyer == GMFSK || digikeyer == FLDIGI)) {
+	rigfreq += (freq_t)fldigi_get_carrier();
+	if (rigmode == RIG_MODE_RTTY || rigmode == RIG_MODE_RTTYR) {
+	    fldigi_shift_freq = fldigi_get_shift_freq();
+	    if (fldigi_shift_freq != 0) {
 		pthread_mutex_lock(&rig_lock);
-		retvalmode = rig_get_mode(my_rig, RIG_VFO_CURR, &rigmode, &bwidth);
+		double start = cat_stats_start();
+		retval = rig_set_freq(my_rig, RIG_VFO_CURR,
+				      ((freq_t)rigfreq + (freq_t)fldigi_shift_freq));
+		cat_stats_record(CAT_SET_FREQ, start, retval);
 		pthread_mutex_unlock(&rig_lock);
-
-		if (retvalmode != RIG_OK) {
-		    rigmode = RIG_MODE_NONE;
-		}
 	    }
 	}
+    }
 
-	if (trxmode == DIGIMODE && (digikeyer == GMFSK || digikeyer == FLDIGI)) {
-	    rigfreq += (freq_t)fldigi_get_carrier();
-	    if (rigmode == RIG_MODE_RTTY || rigmode == RIG_MODE_RTTYR) {
-		fldigi_shift_freq = fldigi_get_shift_freq();
-		if (fldigi_shift_freq != 0) {
-		    pthread_mutex_lock(&rig_lock);
-		    retval = rig_set_freq(my_rig, RIG_VFO_CURR,
-					  ((freq_t)rigfreq + (freq_t)fldigi_shift_freq));
-		    pthread_mutex_unlock(&rig_lock);
-		}
-	    }
-	}
+    if (retval != RIG_OK || rigfreq < 0.1) {
+	freq = 0.0;
+	publish_state();
+	return;
+    }
 
-	if (retval != RIG_OK || rigfreq < 0.1) {
-	    freq = 0.0;
-	    return;
-	}
 
+    if (rigfreq >= bandcorner[0][0]) {
+	freq = rigfreq; // Hz
+    }
 
-	if (rigfreq >= bandcorner[0][0]) {
-	    freq = rigfreq; // Hz
-	}
+    bandinx = freq2band((unsigned int)freq);
 
-	bandinx = freq2band((unsigned int)freq);
+    bandfrequency[bandinx] = freq;
 
-	bandfrequency[bandinx] = freq;
+    if (bandinx != oldbandinx) {	// band change on trx
+	oldbandinx = bandinx;
+	handle_trx_bandswitch((int) freq);
+    }
 
-	if (bandinx != oldbandinx) {	// band change on trx
-	    oldbandinx = bandinx;
-	    handle_trx_bandswitch((int) freq);
-	}
+    publish_state();
 
-	/* read speed from rig */
-	if (cwkeyer == HAMLIB_KEYER) {
-	    int rig_cwspeed;
-	    retval = hamlib_keyer_get_speed(&rig_cwspeed);
+    /* read speed from rig */
+    if (cwkeyer == HAMLIB_KEYER) {
+	int rig_cwspeed;
+	retval = hamlib_keyer_get_speed(&rig_cwspeed);
 
-	    if (retval == RIG_OK) {
-		if (GetCWSpeed() != rig_cwspeed) { // FIXME: doesn't work if rig speed is between the values from CW_SPEEDS
-		    SetCWSpeed(rig_cwspeed);
+	if (retval == RIG_OK) {
+	    if (GetCWSpeed() != rig_cwspeed) { // FIXME: doesn't work if rig speed is between the values from CW_SPEEDS
+		SetCWSpeed(rig_cwspeed);
 
-		    attron(COLOR_PAIR(C_HEADER) | A_STANDOUT);
-		    mvprintw(0, 14, "%2u", GetCWSpeed());
-		}
-	    } else {
-		TLF_LOG_WARN("Problem with rig link: %s", rigerror(retval));
+		attron(COLOR_PAIR(C_HEADER) | A_STANDOUT);
+		mvprintw(0, 14, "%2u", GetCWSpeed());
 	    }
-	}
-
-    } else if (reqf == SETCWMODE) {
-
-	pthread_mutex_lock(&rig_lock);
-	retval = rig_set_mode(my_rig, RIG_VFO_CURR, RIG_MODE_CW, get_cw_bandwidth());
-	pthread_mutex_unlock(&rig_lock);
-
-	if (retval != RIG_OK) {
+	} else {
 	    TLF_LOG_WARN("Problem with rig link: %s", rigerror(retval));
 	}
+    }
+}
 
-    } else if (reqf == SETSSBMODE) {
 
-	pthread_mutex_lock(&rig_lock);
-	retval = rig_set_mode(my_rig, RIG_VFO_CURR, get_ssb_mode(),
-			      TLF_DEFAULT_PASSBAND);
-	pthread_mutex_unlock(&rig_lock);
+static void set_mode(freq_t request) {
+    rmode_t new_mode;
+    pbwidth_t width = TLF_DEFAULT_PASSBAND;
 
-	if (retval != RIG_OK) {
-	    TLF_LOG_WARN("Problem with rig link: %s", rigerror(retval));
-	}
-
-    } else if (reqf == SETDIGIMODE) {
-	rmode_t new_mode = digi_mode;
+    if (request == SETCWMODE) {
+	new_mode = RIG_MODE_CW;
+	width = get_cw_bandwidth();
+    } else if (request == SETSSBMODE) {
+	new_mode = get_ssb_mode();
+    } else {
+	new_mode = digi_mode;
 	if (new_mode == RIG_MODE_NONE) {
 	    if (digikeyer == FLDIGI)
 		new_mode = RIG_MODE_USB;
 	    else
 		new_mode = RIG_MODE_LSB;
 	}
+    }
+
+    pthread_mutex_lock(&rig_lock);
+    double start = cat_stats_start();
+    int retval = rig_set_mode(my_rig, RIG_VFO_CURR, new_mode, width);
+    cat_stats_record(CAT_SET_MODE, start, retval);
+    pthread_mutex_unlock(&rig_lock);
+
+    if (retval != RIG_OK) {
+	TLF_LOG_WARN("Problem with rig link: %s", rigerror(retval));
+    }
+}
+
+
+/** execute pending requests and poll the rig if it is due */
+void gettxinfo(void) {
+
+    int retval;
+
+    if (!trx_control) {
+	next_poll = get_current_seconds() + RIG_POLL_INTERVAL / 1000.0;
+	return;
+    }
+
+    switch_ptt();
+
+    pthread_mutex_lock(&request_mutex);
+    freq_t reqf = outfreq;
+    freq_t reqmode = mode_request;
+    bool reqrit = rit_request;
+    outfreq = mode_request = 0;
+    rit_request = false;
+    pthread_mutex_unlock(&request_mutex);
+
+    if (reqf != 0) {
+	// set rig frequency (or carrier) to `reqf'
+	reqf -= fldigi_get_carrier();
 	pthread_mutex_lock(&rig_lock);
-	retval = rig_set_mode(my_rig, RIG_VFO_CURR, new_mode,
-			      TLF_DEFAULT_PASSBAND);
+	double start = cat_stats_start();
+	retval = rig_set_freq(my_rig, RIG_VFO_CURR, (freq_t) reqf);
+	cat_stats_record(CAT_SET_FREQ, start, retval);
 	pthread_mutex_unlock(&rig_lock);
 
 	if (retval != RIG_OK) {
-	    TLF_LOG_WARN("Problem with rig link: %s", rigerror(retval));
+	    TLF_LOG_WARN("Problem with rig link: set frequency: %s", rigerror(retval));
 	}
+    }
+
+    /* poll at once after a frequency change, else every
+     * RIG_POLL_INTERVAL ms */
+    double now = get_current_seconds();
+    if (reqf != 0 || now >= next_poll) {
+	next_poll = now + RIG_POLL_INTERVAL / 1000.0;
+	poll_rig();
+	cat_stats_poll();
+    }
+
+    /* after polling, the SSB sideband depends on the new frequency */
+    if (reqmode != 0) {
+	set_mode(reqmode);
+    }
 
-    } else if (reqf == RESETRIT) {
+    if (reqrit) {
 	pthread_mutex_lock(&rig_lock);
 	retval = rig_set_rit(my_rig, RIG_VFO_CURR, 0);
 	pthread_mutex_unlock(&rig_lock);
@@ -269,20 +386,63 @@ void gettxinfo(void) {
 	if (retval != RIG_OK) {
 	    TLF_LOG_WARN("Problem with rig link: %s", rigerror(retval));
 	}
+    }
+}
 
-    } else {
-	// set rig frequency (or carrier) to `reqf'
-	reqf -= fldigi_get_carrier();
-	pthread_mutex_lock(&rig_lock);
-	retval = rig_set_freq(my_rig, RIG_VFO_CURR, (freq_t) reqf);
-	pthread_mutex_unlock(&rig_lock);
 
-	if (retval != RIG_OK) {
-	    TLF_LOG_WARN("Problem with rig link: set frequency: %s", rigerror(retval));
+static void *rig_thread_main(void *arg) {
+    pthread_mutex_lock(&request_mutex);
+
+    while (!stop_requested) {
+	if (!requests_pending()) {
+	    struct timespec deadline;
+	    deadline.tv_sec = (time_t) next_poll;
+	    deadline.tv_nsec = (long)((next_poll - deadline.tv_sec) * 1e9);
+	    pthread_cond_timedwait(&request_cond, &request_mutex, &deadline);
+	    if (stop_requested)
+		break;
 	}
+	pthread_mutex_unlock(&request_mutex);
+
+	gettxinfo();
 
+	pthread_mutex_lock(&request_mutex);
     }
 
+    pthread_mutex_unlock(&request_mutex);
+    return NULL;
+}
+
+/** start the rig control thread */
+void rig_thread_start(void) {
+    pthread_mutex_lock(&request_mutex);
+    if (!running) {
+	stop_requested = false;
+	if (pthread_create(&rig_thread, NULL, rig_thread_main, NULL) == 0) {
+	    running = true;
+	} else {
+	    perror("pthread_create: rig control");
+	}
+    }
+    pthread_mutex_unlock(&request_mutex);
+}
+
+/** stop the rig control thread after the current command */
+void rig_thread_stop(void) {
+    pthread_mutex_lock(&request_mutex);
+    if (!running || pthread_equal(pthread_self(), rig_thread)) {
+	pthread_mutex_unlock(&request_mutex);
+	return;
+    }
+    stop_requested = true;
+    pthread_cond_signal(&request_cond);
+    pthread_mutex_unlock(&request_mutex);
+
+    pthread_join(rig_thread, NULL);
+
+    pthread_mutex_lock(&request_mutex);
+    running = false;
+    pthread_mutex_unlock(&request_mutex);
 }
 
 
@@ -317,7 +477,9 @@ static void handle_trx_bandswitch(const freq_t freq) {
     }
 
     pthread_mutex_lock(&rig_lock);
+    double start = cat_stats_start();
     int retval = rig_set_mode(my_rig, RIG_VFO_CURR, mode, width);
+    cat_stats_record(CAT_SET_MODE, start, retval);
     pthread_mutex_unlock(&rig_lock);
 
     if (retval != RIG_OK) {
@@ -325,4 +487,3 @@ static void handle_trx_bandswitch(const freq_t freq) {
     }
 
 }
-
@@ -26,11 +26,17 @@
 #define RESETRIT    (-3)
 #define SETDIGIMODE (-4)
 
+#include <stdbool.h>
+
 #include <hamlib/rig.h>
 
 void set_outfreq(freq_t hertz);
 freq_t get_outfreq();
+int get_coalesced_outfreq();
+void set_rig_ptt(bool on);
 
 void gettxinfo(void);
+void rig_thread_start(void);
+void rig_thread_stop(void);
 
 #endif /* GETTXINFO_H */
@@ -21,7 +21,7 @@ extern GPtrArray *qso_array;		// array of parsed QSOs
 					// Than is_comment field in qso_t
 					// struct gets set
 
-extern mults_t multis[MAX_MULTS]; 	// array of multipliers worked so far
+extern mults_t *multis; 		// array of multipliers worked so far
 extern int nr_multis;			// number of entries in mults[]
 extern int multscore[NBANDS];		// number of multipliers worked per
 					// band; index is
@@ -32,7 +32,7 @@ extern int multscore[NBANDS];		// number of multipliers worked per
 
 extern int nr_worked;			// number of worked station
 					// entries in worked[]
-extern worked_t worked[MAX_CALLS]; 	// worked stations
+extern worked_t *worked; 		// worked stations, see init_worked()
 
 extern int countries[MAX_DATALINES];	// for every country, a bitfield
 					// indicating bands on which it has
@@ -43,6 +43,8 @@ extern int bandinx;			// band we're currently working on
 extern struct ie_list *main_ie_list;
 
 extern char logfile[];
+extern int log_sync_mode;
+extern int log_sync_interval;
 extern bool iscontest;
 
 extern bool country_mult;
@@ -173,6 +175,8 @@ extern bool bmautograb;
 extern bool serial_or_section;
 extern bool portable_x2;
 extern bool clusterlog;
+extern int cluster_spots_capacity;
+extern int frame_rate;
 extern bool sprint_mode;
 extern int timeoffset;
 extern bool keyer_backspace;
@@ -188,7 +192,6 @@ extern int dupe;
 extern int block_part;
 extern int miniterm;
 extern int announcefilter;
-extern int nr_of_spots;
 extern int fdSertnc;
 extern int commentfield;
 
@@ -219,13 +222,13 @@ extern char pr_hostaddress[];
 extern char synclogfile[];
 extern char exchange_list[40];
 extern char rttyoutput[];
-extern char spot_ptr[MAX_SPOTS][82];
 extern char lastmsg[];
 #ifdef HAVE_LIBXMLRPC
 extern char fldigi_url[50];
 #endif
 
 extern char *cabrillo;
+extern char *cat_stats_file;
 extern char *editor_cmd;
 extern char *rigportname;
 extern char *config_file;
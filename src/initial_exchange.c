@@ -20,13 +20,13 @@
 /* ------------------------------------------------------------------------------
  *      initial exchange.c
  *
- *  makes a linked list of calls and exchanges from comma separated file
+ *  reads calls and exchanges from comma separated file and indexes
+ *  them by call
  *
  *-------------------------------------------------------------------------------*/
 
 
 #include <stdio.h>
-#include <stdlib.h>
 #include <string.h>
 
 #include <glib.h>
@@ -34,21 +34,41 @@
 #include "initial_exchange.h"
 #include "startmsg.h"
 
+#define IE_REPORT_SIZE	10000	/* report load time for larger files */
+
 /**
-* 	Free linked list of all allocated entries pointed
-* 	to by 'head'.
+* 	Free all data of the initial exchange list
 */
 
-void free_ie_list(struct ie_list *head) {
-    struct ie_list *next;
-
-    while (head) {
-	next = head->next;
-	free(head);
-	head = next;
+void free_ie_list(struct ie_list *list) {
+    if (list == NULL) {
+	return;
     }
+    g_hash_table_destroy(list->by_call);
+    g_array_free(list->entries, TRUE);
+    g_free(list);
+}
+
+static void ie_list_abort(GArray *entries, FILE *fp, char *msg) {
+    g_array_free(entries, TRUE);
+    fclose(fp);
+    showmsg(msg);
 }
 
+/* build the index, entries must not change afterwards */
+static struct ie_list *index_entries(GArray *entries) {
+    struct ie_list *list = g_new(struct ie_list, 1);
+
+    list->entries = entries;
+    list->by_call = g_hash_table_new(g_str_hash, g_str_equal);
+
+    /* later entries for the same call replace earlier ones */
+    for (int i = 0; i < entries->len; i++) {
+	struct ie_entry *entry = &g_array_index(entries, struct ie_entry, i);
+	g_hash_table_insert(list->by_call, entry->call, entry);
+    }
+    return list;
+}
 
 struct ie_list *make_ie_list(char *file) {
 
@@ -56,10 +76,11 @@ struct ie_list *make_ie_list(char *file) {
     char inputbuffer[91];
     char *loc;
 
-    struct ie_list *ie_listhead = NULL;
-    struct ie_list *new;
+    GArray *entries;
+    struct ie_entry new;
     char *token;
     int linectr = 0;
+    gint64 start = g_get_monotonic_time();
 
     if ((fp = fopen(file, "r")) == NULL) {
 	showmsg("Cannot find initial exchange file");
@@ -68,6 +89,8 @@ struct ie_list *make_ie_list(char *file) {
 
     showstring("Using initial exchange file", file);
 
+    entries = g_array_new(FALSE, FALSE, sizeof(struct ie_entry));
+
     while (fgets(inputbuffer, 90, fp) != NULL) {
 
 	linectr++;
@@ -87,10 +110,8 @@ struct ie_list *make_ie_list(char *file) {
 	if (strlen(inputbuffer) > 80) {
 	    /* line to long */
 	    char msg[80];
-	    free_ie_list(ie_listhead);
-	    fclose(fp);
 	    sprintf(msg, "Line %d: too long", linectr);
-	    showmsg(msg);
+	    ie_list_abort(entries, fp, msg);
 	    return NULL;
 	}
 
@@ -99,23 +120,12 @@ struct ie_list *make_ie_list(char *file) {
 	if (loc == NULL) {
 	    /* no comma found */
 	    char msg[80];
-	    free_ie_list(ie_listhead);
-	    fclose(fp);
 	    sprintf(msg, "Line %d: no comma found", linectr);
-	    showmsg(msg);
+	    ie_list_abort(entries, fp, msg);
 	    return NULL;
 	}
 
 	// comma found, parse the line
-	new = malloc(sizeof(struct ie_list));
-
-	if (new == NULL) {
-	    free_ie_list(ie_listhead);
-	    fclose(fp);
-	    showmsg("Out of memory");
-	    return NULL;
-	}
-
 	*loc = '\0';	/* split the string into call and exchange */
 
 	token = strtok(inputbuffer, " \t"); 	/* callsign is first
@@ -124,17 +134,13 @@ struct ie_list *make_ie_list(char *file) {
 	if (token == NULL || strtok(NULL, " \t")) {
 	    /* 0 or >1 token before comma */
 	    char msg[80];
-	    free(new);
-	    free_ie_list(ie_listhead);
-	    fclose(fp);
 	    sprintf(msg, "Line %d: 0 or more than one token before comma",
 		    linectr);
-	    showmsg(msg);
+	    ie_list_abort(entries, fp, msg);
 	    return NULL;
 	}
 
-	strncpy(new->call, token, MAX_CALL_LENGTH);
-	new->call[MAX_CALL_LENGTH] = '\0';		/* proper termination */
+	g_strlcpy(new.call, token, sizeof(new.call));
 
 	// prepare exchange field
 	char *xchg = loc + 1;
@@ -143,18 +149,90 @@ struct ie_list *make_ie_list(char *file) {
 	    *loc = '\0';	/* terminate it at the 2nd comma */
 	}
 	g_strstrip(xchg);       // strip leading/trailing whitespace
-	strncpy(new->exchange, xchg, MAX_IE_LENGTH);
-	new->exchange[MAX_IE_LENGTH] = '\0';	/* proper termination */
+	g_strlcpy(new.exchange, xchg, sizeof(new.exchange));
 
-	/* prepend new entry to existing list */
-	new->next = ie_listhead;
-	ie_listhead = new;
+	g_array_append_val(entries, new);
 
     }
 
     fclose(fp);
 
-    return ie_listhead;
+    struct ie_list *list = index_entries(entries);
+
+    if (entries->len >= IE_REPORT_SIZE) {
+	char msg[80];
+	sprintf(msg, "%u initial exchange entries loaded in %d ms",
+		entries->len, (int)((g_get_monotonic_time() - start) / 1000));
+	showmsg(msg);
+    }
+
+    return list;
 }
 
 
+/** number of entries in the list */
+unsigned int ie_list_size(const struct ie_list *list) {
+    return list != NULL ? list->entries->len : 0;
+}
+
+/** entry 'n' in file order */
+const struct ie_entry *ie_list_entry(const struct ie_list *list,
+				     unsigned int n) {
+    return &g_array_index(list->entries, struct ie_entry, n);
+}
+
+static const struct ie_entry *lookup_entry(const struct ie_list *list,
+	const char *call) {
+    return g_hash_table_lookup(list->by_call, call);
+}
+
+/** exchange for exactly 'call' or NULL if not in the list
+ *
+ * If the call occurs more than once the last entry wins. */
+const char *ie_lookup_exchange(const struct ie_list *list, const char *call) {
+    const struct ie_entry *entry;
+
+    if (list == NULL || (entry = lookup_entry(list, call)) == NULL) {
+	return NULL;
+    }
+    return entry->exchange;
+}
+
+/** exchange for 'call' which may carry portable designators
+ *
+ * Looks up all parts of 'call' delimited by '/' or its ends, so
+ * "DL/EA0XYZ/P" finds an entry for "EA0XYZ" (or "DL/EA0XYZ"). If
+ * several parts are listed the one with the last entry wins.
+ * \return the exchange or NULL if not found
+ */
+const char *ie_lookup_portable(const struct ie_list *list, const char *call) {
+    const struct ie_entry *found = NULL;
+    char part[MAX_CALL_LENGTH + 1];
+    int len = strlen(call);
+
+    if (list == NULL) {
+	return NULL;
+    }
+
+    for (int from = 0; from < len; from++) {
+	if (from > 0 && call[from - 1] != '/') {
+	    continue;
+	}
+	for (int to = from + 1; to <= len && to - from <= MAX_CALL_LENGTH;
+		to++) {
+	    if (to < len && call[to] != '/') {
+		continue;
+	    }
+	    memcpy(part, call + from, to - from);
+	    part[to - from] = '\0';
+
+	    const struct ie_entry *entry = lookup_entry(list, part);
+	    /* entries are in file order */
+	    if (entry != NULL && (found == NULL || entry > found)) {
+		found = entry;
+	    }
+	}
+    }
+
+    return found != NULL ? found->exchange : NULL;
+}
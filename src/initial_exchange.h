@@ -25,23 +25,35 @@
 #ifndef INITIAL_EXCHANGE_H
 #define INITIAL_EXCHANGE_H
 
+#include <glib.h>
+
 #include "tlf.h"
 
 #define MAX_IE_LENGTH 30
 
 /** Dataelement for one initial entry item */
-struct ie_list {
-    struct ie_list *next;		/**< pointer to next element */
+struct ie_entry {
     char call[MAX_CALL_LENGTH + 1];	/**< call of the station */
     char exchange [MAX_IE_LENGTH + 1];	/**< initial exchange field */
 };
 
+/** Initial exchange data */
+struct ie_list {
+    GArray *entries;			/**< struct ie_entry in file order */
+    GHashTable *by_call;		/**< call -> its last entry */
+};
+
 /**
-*	Make linked list from initial exchange file.
+*	Read initial exchange file.
 *	File must be in CALL,EXCHANGE format.
-*	Returns pointer to the top of the list.
+*	Returns pointer to the data or NULL on errors.
 */
 struct ie_list *make_ie_list(char *file);
-void free_ie_list(struct ie_list *head);
+void free_ie_list(struct ie_list *list);
+unsigned int ie_list_size(const struct ie_list *list);
+const struct ie_entry *ie_list_entry(const struct ie_list *list,
+				     unsigned int n);
+const char *ie_lookup_exchange(const struct ie_list *list, const char *call);
+const char *ie_lookup_portable(const struct ie_list *list, const char *call);
 
 #endif /* INITIAL_EXCHANGE_H */
@@ -0,0 +1,323 @@
+/*
+ * Tlf - contest logging program for amateur radio operators
+ * Copyright (C) 2026 The Tlf developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+/* ------------------------------------------------------------
+ *        sequenced LAN messages
+ *
+ *   Log and QTC messages are numbered per node and session (epoch)
+ *   and wrapped into SEQENTRY datagrams. Each node keeps its own
+ *   messages, so that other nodes can ask for the ones they missed:
+ *
+ *   SEQENTRY   <epoch>:<seq>:<opcode><data>   a numbered message
+ *   SEQSTATUS  <epoch>:<last seq>             sent periodically
+ *   SEQREQUEST <node><epoch>:<from>:<to>      ask 'node' to resend
+ *
+ *   A receiver detects missing numbers either from the next message
+ *   or from the next status and requests them from the originating
+ *   node, at most LAN_CATCHUP_MAX at a time. Messages up to the
+ *   number known when we first hear of a node may predate our own
+ *   start, they get marked as 'catchup'.
+ *
+ *--------------------------------------------------------------*/
+
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include "globalvars.h"
+#include "lan_seq.h"
+#include "lancode.h"
+
+typedef struct {
+    guint64 epoch;		/* session of the node, 0 if not heard of */
+    unsigned int last;		/* all messages up to here were received */
+    unsigned int highest;	/* highest number received or announced */
+    unsigned int rejoin_upto;	/* messages up to here may predate our start */
+    GHashTable *received;	/* numbers above 'last' received already */
+    unsigned int requested_upto;
+    gint64 requested_at;
+} peer_t;
+
+static pthread_mutex_t seq_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* own messages, message n is stored at index n - 1 */
+static GPtrArray *history = NULL;
+static guint64 epoch = 0;
+
+static peer_t peers[MAXNODES];
+
+
+static void reset_peer(peer_t *peer) {
+    if (peer->received != NULL)
+	g_hash_table_destroy(peer->received);
+    memset(peer, 0, sizeof(*peer));
+}
+
+static void free_state(void) {
+    if (history != NULL) {
+	g_ptr_array_free(history, TRUE);
+	history = NULL;
+    }
+    for (int i = 0; i < MAXNODES; i++)
+	reset_peer(&peers[i]);
+}
+
+static void init_state(void) {
+    free_state();
+    history = g_ptr_array_new_with_free_func(g_free);
+    epoch = g_get_real_time();
+}
+
+/** start a new session
+ *
+ * Forgets own messages and everything known about other nodes.
+ */
+void lan_seq_init(void) {
+    pthread_mutex_lock(&seq_mutex);
+    init_state();
+    pthread_mutex_unlock(&seq_mutex);
+}
+
+void lan_seq_free(void) {
+    pthread_mutex_lock(&seq_mutex);
+    free_state();
+    epoch = 0;
+    pthread_mutex_unlock(&seq_mutex);
+}
+
+/* send own message number 'seq' (again) */
+static void send_entry(unsigned int seq) {
+    const char *datagram = g_ptr_array_index(history, seq - 1);
+
+    char *buffer = g_strdup_printf("%c%c%" G_GINT64_MODIFIER "x:%u:%s\n",
+				   thisnode, SEQENTRY, epoch, seq,
+				   datagram + 1);
+    lan_send(buffer);
+    g_free(buffer);
+}
+
+/** number and send a datagram as formatted by send_lan_message()
+ *
+ * The datagram is kept for later resend requests.
+ */
+void lan_seq_send(const char *datagram) {
+    if (!lan_active)
+	return;
+
+    pthread_mutex_lock(&seq_mutex);
+    if (history == NULL)
+	init_state();
+    g_ptr_array_add(history, g_strdup(datagram));
+    send_entry(history->len);
+    pthread_mutex_unlock(&seq_mutex);
+}
+
+/** tell other nodes how many messages we have sent in this session */
+void lan_seq_announce(void) {
+    pthread_mutex_lock(&seq_mutex);
+    if (history != NULL && history->len > 0) {
+	char *buffer = g_strdup_printf("%c%c%" G_GINT64_MODIFIER "x:%u\n",
+				       thisnode, SEQSTATUS, epoch,
+				       history->len);
+	lan_send(buffer);
+	g_free(buffer);
+    }
+    pthread_mutex_unlock(&seq_mutex);
+}
+
+/* look up state of 'node', start over if it has begun a new session
+ *
+ * 'known' is the number of messages the node has sent before.
+ * Returns NULL for unknown nodes and for messages from an older session.
+ */
+static peer_t *lookup_peer(char node, guint64 node_epoch, unsigned int known) {
+    int index = node - 'A';
+
+    if (index < 0 || index >= MAXNODES)
+	return NULL;
+
+    peer_t *peer = &peers[index];
+
+    if (node_epoch < peer->epoch)
+	return NULL;
+
+    if (node_epoch != peer->epoch) {
+	/* new session of an already known node is new to us as well */
+	bool first_contact = (peer->epoch == 0);
+
+	reset_peer(peer);
+	peer->epoch = node_epoch;
+	peer->received = g_hash_table_new(g_direct_hash, g_direct_equal);
+	peer->rejoin_upto = first_contact ? known : 0;
+    }
+
+    return peer;
+}
+
+/* ask originating node for the next missing messages */
+static void request_missing(peer_t *peer, char node) {
+    if (peer->highest <= peer->last)
+	return;
+
+    gint64 now = g_get_monotonic_time();
+
+    if (peer->last < peer->requested_upto
+	    && now - peer->requested_at < LAN_CATCHUP_RETRY * 1000)
+	return;		/* wait for the answer to the last request */
+
+    unsigned int to = MIN(peer->highest, peer->last + LAN_CATCHUP_MAX);
+
+    char *buffer = g_strdup_printf("%c%c%c%" G_GINT64_MODIFIER "x:%u:%u\n",
+				   thisnode, SEQREQUEST, node, peer->epoch,
+				   peer->last + 1, to);
+    lan_send(buffer);
+    g_free(buffer);
+
+    peer->requested_upto = to;
+    peer->requested_at = now;
+}
+
+static bool receive_entry(const lan_message_t *msg, lan_message_t *inner) {
+    guint64 node_epoch;
+    unsigned int seq;
+    int pos = 0;
+
+    if (sscanf(msg->data, "%" G_GINT64_MODIFIER "x:%u:%n",
+	       &node_epoch, &seq, &pos) != 2 || pos == 0 || seq == 0
+	    || msg->data[pos] == '\0')
+	return false;
+
+    peer_t *peer = lookup_peer(msg->node, node_epoch, seq - 1);
+    if (peer == NULL)
+	return false;
+
+    if (seq <= peer->last
+	    || g_hash_table_contains(peer->received, GUINT_TO_POINTER(seq)))
+	return false;	/* seen already */
+
+    peer->highest = MAX(peer->highest, seq);
+    if (seq == peer->last + 1) {
+	peer->last++;
+	while (g_hash_table_remove(peer->received,
+				   GUINT_TO_POINTER(peer->last + 1)))
+	    peer->last++;
+    } else {
+	g_hash_table_add(peer->received, GUINT_TO_POINTER(seq));
+    }
+
+    request_missing(peer, msg->node);
+
+    /* unwrap, the datagram had its last character dropped as usual */
+    inner->node = msg->node;
+    inner->opcode = msg->data[pos];
+    g_strlcpy(inner->data, msg->data + pos + 1, sizeof(inner->data));
+    int len = strlen(inner->data);
+    if (len > 0)
+	inner->data[len - 1] = '\0';
+    inner->catchup = (seq <= peer->rejoin_upto);
+
+    /* QTC lines from before our start can not be told from known ones */
+    if (inner->catchup
+	    && (inner->opcode == QTCRENTRY || inner->opcode == QTCSENTRY))
+	return false;
+
+    return true;
+}
+
+static void receive_status(const lan_message_t *msg) {
+    guint64 node_epoch;
+    unsigned int last;
+
+    if (sscanf(msg->data, "%" G_GINT64_MODIFIER "x:%u",
+	       &node_epoch, &last) != 2)
+	return;
+
+    peer_t *peer = lookup_peer(msg->node, node_epoch, last);
+    if (peer == NULL)
+	return;
+
+    peer->highest = MAX(peer->highest, last);
+    request_missing(peer, msg->node);
+}
+
+static void receive_request(const lan_message_t *msg) {
+    guint64 node_epoch;
+    unsigned int from, to;
+
+    if (msg->data[0] != thisnode || history == NULL)
+	return;
+
+    if (sscanf(msg->data + 1, "%" G_GINT64_MODIFIER "x:%u:%u",
+	       &node_epoch, &from, &to) != 3 || node_epoch != epoch
+	    || from == 0)
+	return;
+
+    to = MIN(to, history->len);
+    to = MIN(to, from + LAN_CATCHUP_MAX - 1);
+    for (unsigned int seq = from; seq <= to; seq++)
+	send_entry(seq);
+}
+
+/** handle SEQENTRY, SEQSTATUS and SEQREQUEST messages
+ *
+ * \param msg - the received message
+ * \param inner - gets the unwrapped message of a new SEQENTRY
+ * \return true if 'inner' has to be handled
+ */
+bool lan_seq_receive(const lan_message_t *msg, lan_message_t *inner) {
+    bool result = false;
+
+    pthread_mutex_lock(&seq_mutex);
+    switch (msg->opcode) {
+	case SEQENTRY:
+	    result = receive_entry(msg, inner);
+	    break;
+	case SEQSTATUS:
+	    receive_status(msg);
+	    break;
+	case SEQREQUEST:
+	    receive_request(msg);
+	    break;
+    }
+    pthread_mutex_unlock(&seq_mutex);
+
+    return result;
+}
+
+/** number of known but not yet received messages from 'node' */
+unsigned int lan_seq_missing(char node) {
+    int index = node - 'A';
+    unsigned int missing = 0;
+
+    if (index < 0 || index >= MAXNODES)
+	return 0;
+
+    pthread_mutex_lock(&seq_mutex);
+    const peer_t *peer = &peers[index];
+    if (peer->received != NULL) {
+	missing = peer->highest - peer->last
+		  - g_hash_table_size(peer->received);
+    }
+    pthread_mutex_unlock(&seq_mutex);
+
+    return missing;
+}
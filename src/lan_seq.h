@@ -0,0 +1,38 @@
+/*
+ * Tlf - contest logging program for amateur radio operators
+ * Copyright (C) 2026 The Tlf developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+
+#ifndef LAN_SEQ_H
+#define LAN_SEQ_H
+
+#include <stdbool.h>
+
+#include "lancode.h"
+
+#define LAN_CATCHUP_MAX 64	/* max. number of messages resent per request */
+#define LAN_CATCHUP_RETRY 1000	/* ms before a catch-up request is repeated */
+
+void lan_seq_init(void);
+void lan_seq_free(void);
+void lan_seq_send(const char *datagram);
+void lan_seq_announce(void);
+bool lan_seq_receive(const lan_message_t *msg, lan_message_t *inner);
+unsigned int lan_seq_missing(char node);
+
+#endif /* LAN_SEQ_H */
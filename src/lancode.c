@@ -19,6 +19,12 @@
  */
 
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE		/* for recvmmsg() */
+#endif
+
+#include <config.h>
+
 #include <errno.h>
 #include <fcntl.h>
 #include <netdb.h>
@@ -35,13 +41,13 @@
 #include "err_utils.h"
 #include "get_time.h"
 #include "globalvars.h"
+#include "lan_seq.h"
 #include "lancode.h"
 #include "tlf.h"
 #include "tlf_curses.h"
 
 
 int lan_socket_descriptor;
-char lan_message[256];
 //--------------------------------------
 int bc_socket_descriptor[MAXNODES];
 ssize_t bc_sendto_rc;
@@ -143,38 +149,90 @@ int lan_recv_close(void) {
     return 0;
 }
 
-int lan_recv(void) {
-    ssize_t lan_recv_rc;
-    struct sockaddr_in lan_sin;
-    unsigned int lan_sin_len = sizeof(lan_sin);
-    char lan_recv_message[256];
+/* split a received datagram into node, opcode and data */
+static bool parse_lan_message(char *buffer, int len, lan_message_t *msg) {
+    if (len < 2) {
+	return false;
+    }
 
-    if (!lan_active)
-	return 0;
+    /* drop last character (trailing newline for most messages) */
+    buffer[len - 1] = '\0';
 
-    lan_recv_message[0] = '\0';
+    msg->node = buffer[0];
+    msg->opcode = buffer[1];
+    msg->catchup = false;
+    g_strlcpy(msg->data, buffer + 2, sizeof(msg->data));
 
-    lan_recv_rc =
-	recvfrom(lan_socket_descriptor, lan_recv_message,
-		 sizeof(lan_recv_message), 0, (struct sockaddr *) &lan_sin,
-		 &lan_sin_len);
+    if (msg->opcode == CLUSTERMSG)
+	cl_send_inhibit = 1;	// this node does not send cluster info
 
-    if (lan_recv_rc == -1 && errno != EAGAIN) {
-	recv_error++;
-	return errno;
-    }
+    return true;
+}
 
-    errno = 0;			/* clear the error */
+/** receive pending messages from other nodes
+ *
+ * Reads up to 'max' (at most LAN_RECV_BATCH) datagrams at once without
+ * blocking.
+ * \return number of messages stored in 'msgs', -1 on error
+ */
+int lan_recv(lan_message_t *msgs, int max) {
+    char buffers[LAN_RECV_BATCH][LAN_MSG_SIZE];
+    int len[LAN_RECV_BATCH];
+    int n;
 
-    if (lan_recv_message[1] == CLUSTERMSG)
-	cl_send_inhibit = 1;	// this node does not send cluster info
+    if (!lan_active)
+	return 0;
 
-    if (lan_recv_rc > 0)
-	recv_packets++;
+    if (max > LAN_RECV_BATCH)
+	max = LAN_RECV_BATCH;
 
-    strcpy(lan_message, lan_recv_message);
+#ifdef HAVE_RECVMMSG
+    struct mmsghdr hdrs[LAN_RECV_BATCH];
+    struct iovec iov[LAN_RECV_BATCH];
 
-    return 0;
+    memset(hdrs, 0, sizeof(hdrs));
+    for (int i = 0; i < max; i++) {
+	iov[i].iov_base = buffers[i];
+	iov[i].iov_len = LAN_MSG_SIZE - 1;
+	hdrs[i].msg_hdr.msg_iov = &iov[i];
+	hdrs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    n = recvmmsg(lan_socket_descriptor, hdrs, max, MSG_DONTWAIT, NULL);
+    if (n == -1) {
+	if (errno == EAGAIN || errno == EWOULDBLOCK)
+	    return 0;
+	recv_error++;
+	return -1;
+    }
+    for (int i = 0; i < n; i++) {
+	len[i] = hdrs[i].msg_len;
+    }
+#else
+    for (n = 0; n < max; n++) {
+	ssize_t rc = recv(lan_socket_descriptor, buffers[n],
+			  LAN_MSG_SIZE - 1, MSG_DONTWAIT);
+	if (rc == -1) {
+	    if (errno == EAGAIN || errno == EWOULDBLOCK)
+		break;
+	    recv_error++;
+	    if (n == 0)
+		return -1;
+	    break;
+	}
+	len[n] = rc;
+    }
+#endif
+
+    int count = 0;
+    for (int i = 0; i < n; i++) {
+	if (len[i] > 0)
+	    recv_packets++;
+	if (parse_lan_message(buffers[i], len[i], &msgs[count]))
+	    count++;
+    }
+
+    return count;
 }
 
 // ----------------send routines --------------------------
@@ -236,7 +294,7 @@ int lan_send_close(void) {
     return 0;
 }
 
-static int lan_send(char *lanbuffer) {
+int lan_send(char *lanbuffer) {
 
     if (!lan_active)
 	return 0;
@@ -286,7 +344,7 @@ int send_lan_message(int opcode, char *message) {
     if (opcode == LOGENTRY) {
 	sendbuffer[82] = '\0';
 
-	lan_send(sendbuffer);
+	lan_seq_send(sendbuffer);	/* numbered, see lan_seq.c */
     }
 
     if (opcode == TLFSPOT) {
@@ -312,16 +370,16 @@ int send_lan_message(int opcode, char *message) {
     if (opcode == QTCRENTRY) {
 	strcat(sendbuffer, "\n");
 	sendbuffer[94] = '\0';
-	lan_send(sendbuffer);
+	lan_seq_send(sendbuffer);
     }
     if (opcode == QTCSENTRY) {
 	strcat(sendbuffer, "\n");
 	sendbuffer[100] = '\0';
-	lan_send(sendbuffer);
+	lan_seq_send(sendbuffer);
     }
     if (opcode == QTCFLAG) {
 	strcat(sendbuffer, "\n");
-	lan_send(sendbuffer);
+	lan_seq_send(sendbuffer);
     }
 
     return 0;
@@ -33,14 +33,31 @@
 #define QTCRENTRY 56
 #define QTCSENTRY 57
 #define QTCFLAG 58
+#define SEQENTRY 59	/* numbered LOGENTRY or QTC message, see lan_seq.c */
+#define SEQSTATUS 60
+#define SEQREQUEST 61
+
+#define LAN_MSG_SIZE 256
+#define LAN_RECV_BATCH 16	/* max. number of datagrams read at once */
+
+#include <stdbool.h>
 
 #include <hamlib/rig.h>
 
+/* message received from another node */
+typedef struct {
+    char node;			/* id of the sending node */
+    char opcode;
+    char data[LAN_MSG_SIZE];	/* rest of the message */
+    bool catchup;		/* resent message which may predate our
+				   start, so it could be known already */
+} lan_message_t;
+
 extern char bc_hostaddress[MAXNODES][16];
 extern char bc_hostservice[MAXNODES][16];
 extern char talkarray[5][62];
 extern char thisnode;
-extern char lan_message[256];
+extern int lan_socket_descriptor;
 extern int recv_error;
 extern freq_t node_frequencies[MAXNODES];
 extern int recv_packets;
@@ -49,9 +66,10 @@ extern int send_error[MAXNODES];
 
 int lan_recv_init(void);
 int lan_recv_close(void);
-int lan_recv(void);
+int lan_recv(lan_message_t *msgs, int max);
 int lan_send_init(void);
 int lan_send_close(void);
+int lan_send(char *lanbuffer);
 int send_lan_message(int opcode, char *message);
 void talk(void);
 int send_freq(freq_t freq);
@@ -0,0 +1,140 @@
+/*
+ * Tlf - contest logging program for amateur radio operators
+ * Copyright (C) 2026 The Tlf developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+/* ------------------------------------------------------------
+ *        Substring index over the calls in the log
+ *
+ *   Indexes the calls of all QSOs in qso_array, the id of a call in
+ *   the index is its position in qso_array. New QSOs are added by
+ *   log_to_disk() as they get logged, locally or via LAN. If QSOs get
+ *   replaced or removed (see qso_array_changed()) the index is rebuilt
+ *   on next use.
+ *
+ *   Along with it a set of the QSOs in the log is kept, to find out
+ *   quickly if a QSO received from another node is known already.
+ *
+ *--------------------------------------------------------------*/
+
+
+#include <pthread.h>
+
+#include "call_index.h"
+#include "globalvars.h"
+#include "log_index.h"
+#include "log_utils.h"
+
+static pthread_mutex_t index_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static call_index_t *calls = NULL;
+static GStringChunk *call_strings = NULL;	/* copies of indexed calls */
+static GHashTable *qso_keys = NULL;	/* qso_key() of all QSOs */
+static unsigned int generation;		/* of qso_array when indexed */
+
+
+/* key identifying a QSO, made of the fields rescoring does not change,
+ * free with g_free() */
+static char *qso_key(const struct qso_t *qso) {
+    if (qso->is_comment || qso->call == NULL) {
+	/* lines from other nodes may be marked in column 80 */
+	return g_strndup(qso->logline, 79);
+    }
+    return g_strdup_printf("%d %d %ld %d %s", qso->bandindex, qso->mode,
+			   (long)qso->timestamp, qso->qso_nr, qso->call);
+}
+
+
+/* add QSOs appended to qso_array since last call, needs index_mutex */
+static void update(void) {
+    if (calls == NULL) {
+	calls = call_index_new();
+	call_strings = g_string_chunk_new(4096);
+	qso_keys = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+	generation = qso_array_generation() - 1;
+    }
+
+    if (qso_array == NULL) {
+	return;
+    }
+
+    if (generation != qso_array_generation()
+	    || call_index_size(calls) > NR_QSOS) {
+	call_index_clear(calls);
+	g_string_chunk_clear(call_strings);
+	g_hash_table_remove_all(qso_keys);
+	generation = qso_array_generation();
+    }
+
+    for (guint i = call_index_size(calls); i < NR_QSOS; i++) {
+	struct qso_t *qso = g_ptr_array_index(qso_array, i);
+
+	/* comment lines get an empty entry to keep the ids in sync */
+	const char *call = (qso->is_comment || qso->call == NULL) ?
+			   "" : qso->call;
+	call_index_add(calls, g_string_chunk_insert_const(call_strings, call));
+	g_hash_table_add(qso_keys, qso_key(qso));
+    }
+}
+
+/** index QSOs added to the log since last call */
+void log_index_update(void) {
+    pthread_mutex_lock(&index_mutex);
+    update();
+    pthread_mutex_unlock(&index_mutex);
+}
+
+/** append index in qso_array of all QSOs with a call containing 'part'
+ *  to 'qso_indexes', in log order
+ */
+void log_index_find(const char *part, GArray *qso_indexes) {
+    pthread_mutex_lock(&index_mutex);
+    update();
+    call_index_find(calls, part, qso_indexes);
+    pthread_mutex_unlock(&index_mutex);
+}
+
+/** append index in qso_array of all QSOs with a call one character
+ *  wrong, missing or extra compared to 'call' to 'qso_indexes', in log order
+ */
+void log_index_near(const char *call, GArray *qso_indexes) {
+    pthread_mutex_lock(&index_mutex);
+    update();
+    call_index_near(calls, call, qso_indexes);
+    pthread_mutex_unlock(&index_mutex);
+}
+
+/** check if a line received from another node is in the log already
+ *
+ * Compares the fields identifying the QSO, as the copy in the log may
+ * have been changed by rescoring.
+ */
+bool log_index_has_line(const char *line) {
+    char *buffer = g_strdup(line);	/* parse_qso() splits its argument */
+    struct qso_t *qso = parse_qso(buffer);
+    char *key = qso_key(qso);
+
+    pthread_mutex_lock(&index_mutex);
+    update();
+    bool found = g_hash_table_contains(qso_keys, key);
+    pthread_mutex_unlock(&index_mutex);
+
+    g_free(key);
+    free_qso(qso);
+    g_free(buffer);
+    return found;
+}
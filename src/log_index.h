@@ -0,0 +1,33 @@
+/*
+ * Tlf - contest logging program for amateur radio operators
+ * Copyright (C) 2026 The Tlf developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+
+#ifndef LOG_INDEX_H
+#define LOG_INDEX_H
+
+#include <stdbool.h>
+
+#include <glib.h>
+
+void log_index_update(void);
+void log_index_find(const char *part, GArray *qso_indexes);
+void log_index_near(const char *call, GArray *qso_indexes);
+bool log_index_has_line(const char *line);
+
+#endif /* LOG_INDEX_H */
@@ -34,10 +34,14 @@
 #include "gettxinfo.h"
 #include "globalvars.h"		// Includes glib.h and tlf.h
 #include "lancode.h"
+#include "log_index.h"
 #include "log_utils.h"
 #include "makelogline.h"
+#include "redraw.h"
 #include "scroll_log.h"
 #include "score.h"
+#include "score_checkpoint.h"
+#include "score_journal.h"
 #include "store_qso.h"
 #include "setcontest.h"
 #include "tlf_curses.h"
@@ -65,9 +69,12 @@ void restart_band_timer(void) {
  * Logs one record to disk which may come from different sources
  * (direct from tlf or from other instance via LAN)
  *
- * \param from_lan true - Log lanmessage, false - normal message
+ * \param lan_msg - LOGENTRY message from other node,
+ *                  NULL for a QSO from this node
  */
-void log_to_disk(int from_lan) {
+void log_to_disk(const lan_message_t *lan_msg) {
+
+    bool from_lan = (lan_msg != NULL);
 
     pthread_mutex_lock(&disk_mutex);
 
@@ -84,15 +91,19 @@ void log_to_disk(int from_lan) {
 	restart_band_timer();
 
 	struct qso_t *qso = collect_qso_data(); //TODO: move this after store_qso() call below
+	journal_begin(qso);
 	addcall(qso);		/* add call to dupe list */
 
 	score_qso(qso);
+	journal_end();
 	char *logline = makelogline(qso);
 	qso->logline = logline; /* remember formatted line in qso entry */
 
 	store_qso(logfile, logline);
         //TODO: create a copy of current_qso
 	g_ptr_array_add(qso_array, qso);
+	log_index_update();
+	checkpoint_qso_logged(logline);
 
 	// send qso to other nodes......
 	send_lan_message(LOGENTRY, logline);
@@ -106,23 +117,33 @@ void log_to_disk(int from_lan) {
     } else {			/* qso from lan */
 
 	/* LOGENTRY contains 82 characters (node,command and logline */
-	g_strlcpy(lan_logline, lan_message + 2, 81);
+	g_strlcpy(lan_logline, lan_msg->data, 81);
 	char *fill = g_strnfill(80 - strlen(lan_logline), ' ');
 	g_strlcat(lan_logline, fill, 81);    /* fill with spaces if needed */
 
 	if (cqwwm2) {	    /* mark as coming from other station */
-	    if (lan_message[0] != thisnode)
+	    if (lan_msg->node != thisnode)
 		lan_logline[79] = '*';
 	}
 
-	total = total + score2(lan_logline);
+	int points = score2(lan_logline);
+
+	/* parse_qso() splits its argument, keep lan_logline intact */
+	char *line = g_strdup(lan_logline);
+	struct qso_t *qso = parse_qso(line);
+	g_free(line);
 
-	struct qso_t *qso = parse_qso(lan_logline);
+	journal_begin(qso);
+	JOURNAL(total);
+	total = total + points;
 
 	addcall2();
+	journal_end();
 
 	store_qso(logfile, lan_logline);
 	g_ptr_array_add(qso_array, qso);
+	log_index_update();
+	checkpoint_unsynced();	/* score2() differs from rescoring */
     }
 
 
@@ -148,7 +169,7 @@ void log_to_disk(int from_lan) {
     }
     mvaddstr(10, 0, logline3);
     mvaddstr(11, 0, logline4);
-    refreshp();
+    redraw_request(REDRAW_LOG);
 
     attron(COLOR_PAIR(C_WINDOW));
 
@@ -162,8 +183,6 @@ void log_to_disk(int from_lan) {
 	mvaddstr(12, 49, recvd_rst);
     }
 
-    sync();
-
     if (rit) {
 	set_outfreq(RESETRIT);
     }
@@ -21,7 +21,9 @@
 #ifndef LOG_TO_DISK_H
 #define LOG_TO_DISK_H
 
+#include "lancode.h"
+
 void restart_band_timer(void);
-void log_to_disk(int from_lan);
+void log_to_disk(const lan_message_t *lan_msg);
 
 #endif /*  LOG_TO_DISK_H */
@@ -33,6 +33,7 @@
 
 #include "bands.h"
 #include "get_time.h"
+#include "log_utils.h"
 #include "setcontest.h"
 #include "tlf.h"
 
@@ -174,6 +175,9 @@ void free_qso(struct qso_t *ptr) {
 	g_free(ptr->callupdate);
 	g_free(ptr->normalized_comment);
 	g_free(ptr->section);
+	if (ptr->journal != NULL) {
+	    g_array_free(ptr->journal, TRUE);
+	}
 	g_free(ptr);
     }
 }
@@ -194,5 +198,22 @@ void free_qso_array() {
 void init_qso_array() {
     free_qso_array();
     qso_array = g_ptr_array_new_with_free_func(qso_free);
+    qso_array_changed();
+}
+
+static unsigned int qso_array_gen = 0;
+
+/** mark qso_array as changed
+ *
+ * Has to be called if entries in qso_array got replaced or removed.
+ * Appending QSOs needs no call.
+ */
+void qso_array_changed(void) {
+    qso_array_gen++;
+}
+
+/** \return counter which changes with each qso_array_changed() call */
+unsigned int qso_array_generation(void) {
+    return qso_array_gen;
 }
 
@@ -33,5 +33,7 @@ struct qso_t *parse_qso(char * buffer);
 void free_qso(struct qso_t *ptr);
 void free_qso_array();
 void init_qso_array();
+void qso_array_changed(void);
+unsigned int qso_array_generation(void);
 
 #endif
@@ -0,0 +1,341 @@
+/*
+ * Tlf - contest logging program for amateur radio operators
+ * Copyright (C) 2026 The Tlf developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+/* ------------------------------------------------------------
+ *        log writer
+ *
+ *   Appends log lines from a separate thread, so that logging a QSO
+ *   never waits for the disk. The log file is kept open between
+ *   writes and only the log file itself gets synced to disk,
+ *   according to the LOG_SYNC setting.
+ *
+ *   Code which reads, truncates or replaces the log file has to call
+ *   log_writer_flush() first.
+ *
+ *   Errors are not reported by the writer thread itself, the user
+ *   interface fetches them via log_writer_take_error().
+ *
+ *--------------------------------------------------------------*/
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <glib.h>
+
+#include "globalvars.h"		// Includes glib.h and tlf.h
+#include "log_writer.h"
+
+#define LOG_QUEUE_SIZE 64
+
+typedef struct {
+    char *file;
+    char *line;
+} log_request_t;
+
+static pthread_mutex_t writer_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t queue_changed = PTHREAD_COND_INITIALIZER;	/* to writer */
+static pthread_cond_t writer_done = PTHREAD_COND_INITIALIZER;	/* from writer */
+
+/* protected by writer_mutex */
+static log_request_t queue[LOG_QUEUE_SIZE];
+static int queue_head = 0;	/* oldest queued request */
+static int queue_len = 0;
+static bool running = false;
+static bool stop_requested = false;
+static bool close_requested = false;
+
+
+/* last error of the writer thread, protected by writer_mutex */
+static int error_count = 0;	/* all failures so far */
+static int error_errno = 0;	/* 0 if reported already */
+static char *error_file = NULL;
+static int lost_lines = 0;	/* lines not written since last report */
+
+static pthread_t writer_thread;
+
+/* only used by the writer thread */
+static int log_fd = -1;
+static char *open_file = NULL;
+static bool unsynced = false;
+static struct timespec sync_deadline;
+
+
+/* remember a failure for log_writer_take_error() */
+static void record_error(const char *file, int err, bool line_lost) {
+    pthread_mutex_lock(&writer_mutex);
+    error_count++;
+    error_errno = err;
+    g_free(error_file);
+    error_file = g_strdup(file);
+    if (line_lost) {
+	lost_lines++;
+    }
+    pthread_mutex_unlock(&writer_mutex);
+}
+
+static void sync_fd(void) {
+    if (fdatasync(log_fd) < 0) {
+	record_error(open_file, errno, false);
+    }
+}
+
+static void close_log(void) {
+    if (log_fd < 0) {
+	return;
+    }
+    if (unsynced) {
+	sync_fd();
+	unsynced = false;
+    }
+    close(log_fd);
+    log_fd = -1;
+    FREE_DYNAMIC_STRING(open_file);
+}
+
+static void sync_log(void) {
+    if (log_fd >= 0 && unsynced) {
+	sync_fd();
+    }
+    unsynced = false;
+}
+
+/* \return false if the file could not be opened */
+static bool open_log(const char *file) {
+    close_log();
+
+    log_fd = open(file, O_WRONLY | O_APPEND | O_CREAT, 0664);
+    if (log_fd < 0) {
+	return false;
+    }
+    open_file = g_strdup(file);
+    return true;
+}
+
+static void write_line(log_request_t *request) {
+    if (open_file == NULL || strcmp(open_file, request->file) != 0) {
+	if (!open_log(request->file)) {
+	    record_error(request->file, errno, true);
+	    return;
+	}
+    }
+
+    char *buffer = g_strconcat(request->line, "\n", NULL);
+    size_t len = strlen(buffer);
+    size_t done = 0;
+
+    while (done < len) {
+	ssize_t rc = write(log_fd, buffer + done, len - done);
+	if (rc < 0) {
+	    if (errno == EINTR) {
+		continue;
+	    }
+	    record_error(open_file, errno, true);
+	    break;
+	}
+	done += rc;
+    }
+    g_free(buffer);
+
+    if (!unsynced && log_sync_mode == LOG_SYNC_INTERVAL) {
+	clock_gettime(CLOCK_REALTIME, &sync_deadline);
+	sync_deadline.tv_sec += log_sync_interval / 1000;
+	sync_deadline.tv_nsec += (log_sync_interval % 1000) * 1000000L;
+	if (sync_deadline.tv_nsec >= 1000000000L) {
+	    sync_deadline.tv_sec++;
+	    sync_deadline.tv_nsec -= 1000000000L;
+	}
+    }
+    unsynced = true;
+}
+
+static void *writer_main(void *arg) {
+    log_request_t batch[LOG_QUEUE_SIZE];
+
+    pthread_mutex_lock(&writer_mutex);
+
+    while (true) {
+	if (queue_len == 0) {
+	    if (close_requested || stop_requested) {
+		pthread_mutex_unlock(&writer_mutex);
+		close_log();
+		pthread_mutex_lock(&writer_mutex);
+
+		close_requested = false;
+		pthread_cond_broadcast(&writer_done);
+		if (stop_requested) {
+		    break;
+		}
+	    } else if (unsynced && log_sync_mode == LOG_SYNC_IDLE) {
+		pthread_mutex_unlock(&writer_mutex);
+		sync_log();
+		pthread_mutex_lock(&writer_mutex);
+	    } else if (unsynced && log_sync_mode == LOG_SYNC_INTERVAL) {
+		if (pthread_cond_timedwait(&queue_changed, &writer_mutex,
+					   &sync_deadline) == ETIMEDOUT) {
+		    pthread_mutex_unlock(&writer_mutex);
+		    sync_log();
+		    pthread_mutex_lock(&writer_mutex);
+		}
+	    } else {
+		pthread_cond_wait(&queue_changed, &writer_mutex);
+	    }
+	    continue;
+	}
+
+	/* take over all queued lines and write them without the lock */
+	int n = queue_len;
+	for (int i = 0; i < n; i++) {
+	    batch[i] = queue[(queue_head + i) % LOG_QUEUE_SIZE];
+	}
+	queue_head = (queue_head + n) % LOG_QUEUE_SIZE;
+	queue_len = 0;
+	pthread_cond_broadcast(&writer_done);	/* room in queue */
+	pthread_mutex_unlock(&writer_mutex);
+
+	for (int i = 0; i < n; i++) {
+	    write_line(&batch[i]);
+	    g_free(batch[i].file);
+	    g_free(batch[i].line);
+	}
+	if (log_sync_mode == LOG_SYNC_QSO) {
+	    sync_log();
+	}
+
+	pthread_mutex_lock(&writer_mutex);
+    }
+
+    pthread_mutex_unlock(&writer_mutex);
+    return NULL;
+}
+
+/** start the log writer thread
+ *
+ * Until it is started store_qso() writes directly to the file. */
+void log_writer_start(void) {
+    pthread_mutex_lock(&writer_mutex);
+    if (!running) {
+	stop_requested = false;
+	if (pthread_create(&writer_thread, NULL, writer_main, NULL) == 0) {
+	    running = true;
+	} else {
+	    perror("pthread_create: log writer");
+	}
+    }
+    pthread_mutex_unlock(&writer_mutex);
+}
+
+/** write out all queued lines, sync and close the log file
+ *  and stop the log writer thread */
+void log_writer_stop(void) {
+    pthread_mutex_lock(&writer_mutex);
+    if (!running || pthread_equal(pthread_self(), writer_thread)) {
+	pthread_mutex_unlock(&writer_mutex);
+	return;
+    }
+    stop_requested = true;
+    pthread_cond_signal(&queue_changed);
+    pthread_mutex_unlock(&writer_mutex);
+
+    pthread_join(writer_thread, NULL);
+
+    pthread_mutex_lock(&writer_mutex);
+    running = false;
+    pthread_mutex_unlock(&writer_mutex);
+}
+
+/** queue a line for appending to file
+ *
+ * Only waits if the queue is full.
+ * \return false if the log writer is not running
+ */
+bool log_writer_append(const char *file, const char *line) {
+    pthread_mutex_lock(&writer_mutex);
+    if (!running || stop_requested) {
+	pthread_mutex_unlock(&writer_mutex);
+	return false;
+    }
+
+    while (queue_len == LOG_QUEUE_SIZE) {
+	pthread_cond_wait(&writer_done, &writer_mutex);
+    }
+
+    log_request_t *request =
+	&queue[(queue_head + queue_len) % LOG_QUEUE_SIZE];
+    request->file = g_strdup(file);
+    request->line = g_strdup(line);
+    queue_len++;
+
+    pthread_cond_signal(&queue_changed);
+    pthread_mutex_unlock(&writer_mutex);
+    return true;
+}
+
+/** write out all queued lines, sync and close the log file
+ *
+ * Afterwards the file can be read or replaced. The next appended line
+ * opens it again.
+ */
+void log_writer_flush(void) {
+    pthread_mutex_lock(&writer_mutex);
+    if (!running || pthread_equal(pthread_self(), writer_thread)) {
+	pthread_mutex_unlock(&writer_mutex);
+	return;
+    }
+
+    close_requested = true;
+    pthread_cond_signal(&queue_changed);
+    while (close_requested) {
+	pthread_cond_wait(&writer_done, &writer_mutex);
+    }
+    pthread_mutex_unlock(&writer_mutex);
+}
+
+/** \return number of failures of the log writer so far */
+int log_writer_errors(void) {
+    pthread_mutex_lock(&writer_mutex);
+    int n = error_count;
+    pthread_mutex_unlock(&writer_mutex);
+    return n;
+}
+
+/** take over the last error of the log writer, if not done already
+ *
+ * \param file	set to the file name, to be freed by the caller
+ * \param lost	set to the number of lines lost since the last call
+ * \return errno of the failure, 0 if none happened since the last call
+ */
+int log_writer_take_error(char **file, int *lost) {
+    pthread_mutex_lock(&writer_mutex);
+    int err = error_errno;
+    *file = error_file;
+    *lost = lost_lines;
+    error_errno = 0;
+    error_file = NULL;
+    lost_lines = 0;
+    pthread_mutex_unlock(&writer_mutex);
+
+    return err;
+}
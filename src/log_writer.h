@@ -0,0 +1,36 @@
+/*
+ * Tlf - contest logging program for amateur radio operators
+ * Copyright (C) 2026 The Tlf developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+
+#ifndef LOG_WRITER_H
+#define LOG_WRITER_H
+
+#include <stdbool.h>
+
+#define LOG_SYNC_INTERVAL_MIN	10
+#define LOG_SYNC_INTERVAL_MAX	60000
+
+void log_writer_start(void);
+void log_writer_stop(void);
+bool log_writer_append(const char *file, const char *line);
+void log_writer_flush(void);
+int log_writer_errors(void);
+int log_writer_take_error(char **file, int *lost);
+
+#endif /* LOG_WRITER_H */
@@ -27,6 +27,7 @@
 
 #include "clear_display.h"
 #include "ignore_unused.h"
+#include "log_writer.h"
 #include "tlf.h"
 #include "tlf_curses.h"
 
@@ -40,6 +41,7 @@ int logview(void) {
     strcat(comstr,  "less  +G ");
     strcat(comstr,  logfile);
 
+    log_writer_flush();
     endwin();
     IGNORE(system(comstr));;
     refreshp();
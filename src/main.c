@@ -34,19 +34,24 @@
 #include "audio.h"
 #include "background_process.h"
 #include "bandmap.h"
+#include "cat_stats.h"
 #include "change_rst.h"
 #include "clear_display.h"
+#include "cluster_spots.h"
 #include "checklogfile.h"
 #include "checkqtclogfile.h"
 #include "cw_utils.h"
 #include "fldigixmlrpc.h"
 #include "getmessages.h"
+#include "gettxinfo.h"
 #include "getwwv.h"
 #include "globalvars.h"		// Includes glib.h and tlf.h
 #include "hamlib_keyer.h"
 #include "initial_exchange.h"
+#include "lan_seq.h"
 #include "lancode.h"
 #include "logit.h"
+#include "log_writer.h"
 #include "netkeyer.h"
 #include "parse_logcfg.h"
 #include "plugin.h"
@@ -54,8 +59,10 @@
 #include "readctydata.h"
 #include "readcalls.h"
 #include "readqtccalls.h"
+#include "redraw.h"
 #include "rtty.h"
 #include "rules.h"
+#include "score_checkpoint.h"
 #include "scroll_log.h"
 #include "searchlog.h"		// Includes glib.h
 #include "sendqrg.h"
@@ -66,6 +73,7 @@
 #include "tlf_panel.h"
 #include "readcabrillo.h"
 #include "ui_utils.h"
+#include "write_keyer.h"
 
 #include <config.h>
 
@@ -180,6 +188,8 @@ char recvd_rst[4] = "599";
 int shortqsonr = LONGCW;	/* 1  =  short  cw char in exchange */
 int cluster = NOCLUSTER;	/* 0 = OFF, 1 = FOLLOW, 2  = spots  3 = all */
 bool clusterlog = false;	/* clusterlog on/off */
+int cluster_spots_capacity = CLUSTER_SPOTS_DEFAULT;
+int frame_rate = FRAME_RATE_DEFAULT;	/* max. redraws per second */
 bool searchflg = false;		/* display search  window */
 bool show_time = false;
 cqmode_t cqmode = CQ;
@@ -191,7 +201,10 @@ int defer_store = 0;
 mystation_t my;			/* all info about me */
 
 char logfile[120] = "general.log";
+int log_sync_mode = LOG_SYNC_QSO;
+int log_sync_interval = 1000;	/* ms, for LOG_SYNC_INTERVAL */
 char *cabrillo = NULL;		/**< Name of the Cabrillo format definition */
+char *cat_stats_file = NULL;	/**< CAT statistics are written here on exit */
 char synclogfile[120];
 char markerfile[120] = "";
 int xplanet = MARKER_NONE;
@@ -317,8 +330,6 @@ char modem_mode[8];
 int commentfield = 0;		/* 1 if we are in comment/exchange input */
 
 /*-------------------------------------packet-------------------------------*/
-char spot_ptr[MAX_SPOTS][82];		/* Array of cluster spot lines */
-int nr_of_spots;			/* Anzahl Lines in spot_ptr array */
 int packetinterface = 0;
 int fdSertnc = 0;
 char tncportname[40];
@@ -353,14 +364,14 @@ GPtrArray *qso_array;
 
 /*------------------------------dupe array---------------------------------*/
 int nr_worked = 0;		/**< number of calls in worked[] */
-worked_t worked[MAX_CALLS]; 	/**< worked stations */
+worked_t *worked = NULL; 	/**< worked stations */
 
 /*----------------------statistic of worked countries,zones ... -----------*/
 int countries[MAX_DATALINES];	/* per country field with worked bands set */
 int zones[MAX_ZONES];		/* same for cq zones or itu zones;
 				   using 1 - 40 or 1 - 90 */
 
-mults_t multis[MAX_MULTS]; 	/**< worked multis */
+mults_t *multis = NULL; 	/**< worked multis */
 int nr_multis = 0;		/**< number of multis in multis[] */
 
 int multlist = 0;
@@ -540,6 +551,7 @@ static void ui_init() {
 
     InitSearchPanel();	/* at least one panel has to be defined
 				   for refreshp() to work */
+    redraw_init();	/* this is the user interface thread */
 
     getmaxyx(stdscr, ymax, xmax);
     if ((ymax < 22) || (xmax < 80)) {
@@ -800,6 +812,8 @@ static void lan_init() {
 	    showmsg("LAN send init failed");
 	else
 	    showmsg("LAN send initialized");
+
+	lan_seq_init();		/* new session for numbered messages */
     }
 }
 
@@ -950,6 +964,10 @@ static void tlf_cleanup() {
 	pthread_join(background_thread, NULL);
     }
 
+    checkpoint_flush();
+    log_writer_stop();
+    keyer_thread_stop();
+
     cleanup_telnet();
 
     if (trxmode == CWMODE && cwkeyer == NET_KEYER)
@@ -957,6 +975,13 @@ static void tlf_cleanup() {
     else
 	deinit_controller();
 
+    rig_thread_stop();
+
+    if (cat_stats_file != NULL) {
+	if (!cat_stats_dump(cat_stats_file))
+	    perror("CAT statistics");
+    }
+
     if (my_rig) {
 	close_tlf_rig(my_rig);
     }
@@ -1102,6 +1127,16 @@ int main(int argc, char *argv[]) {
     }
     atexit(tlf_cleanup); 	/* register cleanup function */
 
+    log_writer_start();
+
+    if (trx_control)
+	rig_thread_start();
+
+    if (!keyer_thread_start()) {
+	endwin();
+	exit(EXIT_FAILURE);
+    }
+
     /* Create the background thread */
     ret = pthread_create(&background_thread, NULL, background_process, NULL);
     if (ret) {
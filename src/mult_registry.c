@@ -0,0 +1,185 @@
+/*
+ * Tlf - contest logging program for amateur radio operators
+ * Copyright (C) 2026 The Tlf developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+/* ------------------------------------------------------------
+ *        Hashed registry of worked multipliers
+ *
+ *   Open addressing hash table over an array of mults_t. Neither the
+ *   table nor the array are covered by the score journal, only the
+ *   entries and the entry count are. So undoing the scoring of a QSO
+ *   can leave slots behind which point to entries beyond the count or
+ *   to entries reused for another name. Lookups skip them and they are
+ *   dropped when the table gets rebuilt.
+ *
+ *   Readers do not lock. Arrays and tables replaced by larger ones
+ *   stay allocated, as a reader may still be using them. Due to the
+ *   doubling they take less memory than the current ones.
+ *
+ *--------------------------------------------------------------*/
+
+
+#include <string.h>
+
+#include "mult_registry.h"
+#include "score_journal.h"
+
+#define INITIAL_SIZE	256	/* entries, the table gets 4 times as many slots */
+
+struct slot_table {
+    guint mask;			/* number of slots - 1 */
+    guint used;			/* occupied slots including stale ones */
+    gint slots[];		/* index + 1 into the entries, 0 if empty */
+};
+
+
+static slot_table_t *new_table(guint nr_slots) {
+    slot_table_t *table =
+	g_malloc0(sizeof(slot_table_t) + nr_slots * sizeof(gint));
+    table->mask = nr_slots - 1;
+    return table;
+}
+
+static void put_slot(slot_table_t *table, const char *name, int index) {
+    guint i = g_str_hash(name) & table->mask;
+
+    while (table->slots[i] != 0) {
+	i = (i + 1) & table->mask;
+    }
+    g_atomic_int_set(&table->slots[i], index + 1);
+    table->used++;
+}
+
+static void retire(mult_registry_t *reg, gpointer old) {
+    if (old != NULL) {
+	reg->retired = g_slist_prepend(reg->retired, old);
+    }
+}
+
+/* replace the table by one with 'nr_slots' slots without stale ones */
+static void rehash(mult_registry_t *reg, guint nr_slots) {
+    slot_table_t *table = new_table(nr_slots);
+
+    for (int i = 0; i < *reg->count; i++) {
+	put_slot(table, (*reg->entries)[i].name, i);
+    }
+    retire(reg, reg->table);
+    g_atomic_pointer_set(&reg->table, table);
+}
+
+static void grow_entries(mult_registry_t *reg) {
+    int size = reg->size * 2;
+    mults_t *entries = g_new0(mults_t, size);
+
+    memcpy(entries, *reg->entries, reg->size * sizeof(mults_t));
+    retire(reg, *reg->entries);
+    g_atomic_pointer_set(reg->entries, entries);
+    reg->size = size;
+}
+
+
+/** remove all entries */
+void mult_registry_clear(mult_registry_t *reg) {
+    if (reg->table == NULL) {
+	reg->size = INITIAL_SIZE;
+	*reg->entries = g_new0(mults_t, reg->size);
+	reg->table = new_table(4 * INITIAL_SIZE);
+    } else {
+	memset(reg->table->slots, 0,
+	       (reg->table->mask + 1) * sizeof(gint));
+	reg->table->used = 0;
+	memset(*reg->entries, 0, reg->size * sizeof(mults_t));
+    }
+    *reg->count = 0;
+}
+
+
+/** lookup 'name'
+ *
+ * Safe to call while another thread adds entries.
+ * \return index of the entry or -1 if not found
+ */
+int mult_registry_find(mult_registry_t *reg, const char *name) {
+    /* read the count first, the entries grow before it does */
+    int count = g_atomic_int_get(reg->count);
+    mults_t *entries = g_atomic_pointer_get(reg->entries);
+    slot_table_t *table = g_atomic_pointer_get(&reg->table);
+
+    if (table == NULL) {
+	return -1;
+    }
+
+    for (guint i = g_str_hash(name) & table->mask; ;
+	    i = (i + 1) & table->mask) {
+	int index = g_atomic_int_get(&table->slots[i]) - 1;
+	if (index < 0) {
+	    return -1;
+	}
+	if (index < count && strcmp(entries[index].name, name) == 0) {
+	    return index;
+	}
+    }
+}
+
+
+/** append a new entry for 'name' which is not worked on any band yet
+ *
+ * Journals the change.
+ * \return index of the new entry
+ */
+int mult_registry_add(mult_registry_t *reg, const char *name) {
+    if (reg->table == NULL) {
+	mult_registry_clear(reg);
+    }
+
+    int index = *reg->count;
+    if (index >= reg->size) {
+	grow_entries(reg);
+    }
+
+    /* keep the load below one half */
+    if (2 * (reg->table->used + 1) > reg->table->mask + 1) {
+	guint nr_slots = reg->table->mask + 1;
+	while (4 * (index + 1) > nr_slots) {
+	    nr_slots *= 2;
+	}
+	rehash(reg, nr_slots);
+    }
+
+    mults_t *entry = &(*reg->entries)[index];
+    journal_save_in(reg->entries, entry, sizeof(*entry));
+    JOURNAL(*reg->count);
+    memset(entry, 0, sizeof(*entry));
+    g_strlcpy(entry->name, name, sizeof(entry->name));
+
+    put_slot(reg->table, entry->name, index);
+    g_atomic_int_inc(reg->count);
+
+    return index;
+}
+
+
+/** mark entry 'index' as worked on 'bands' in addition
+ *
+ * Journals the change. */
+void mult_registry_add_bands(mult_registry_t *reg, int index, int bands) {
+    mults_t *entry = &(*reg->entries)[index];
+
+    journal_save_in(reg->entries, &entry->band, sizeof(entry->band));
+    g_atomic_int_or((guint *)&entry->band, bands);
+}
@@ -0,0 +1,53 @@
+/*
+ * Tlf - contest logging program for amateur radio operators
+ * Copyright (C) 2026 The Tlf developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+
+#ifndef MULT_REGISTRY_H
+#define MULT_REGISTRY_H
+
+#include <glib.h>
+
+#include "tlf.h"
+
+/** hashed collection of worked multipliers (or prefixes)
+ *
+ * The entries live in a heap array which is referenced by the global
+ * variables given to MULT_REGISTRY(). Entries are added at the end and
+ * keep their index. Lookups take no lock and may run concurrently to a
+ * single writer; writers have to be serialized by the caller.
+ */
+typedef struct slot_table slot_table_t;
+
+typedef struct {
+    mults_t **entries;		/* address of the entry array */
+    int *count;			/* address of the number of entries */
+    int size;			/* allocated entries */
+    slot_table_t *table;	/* hash table: name -> index + 1 */
+    GSList *retired;		/* replaced arrays, see grow_entries() */
+} mult_registry_t;
+
+#define MULT_REGISTRY(array_var, count_var) \
+    { .entries = &(array_var), .count = &(count_var) }
+
+void mult_registry_clear(mult_registry_t *reg);
+int mult_registry_find(mult_registry_t *reg, const char *name);
+int mult_registry_add(mult_registry_t *reg, const char *name);
+void mult_registry_add_bands(mult_registry_t *reg, int index, int bands);
+
+#endif /* MULT_REGISTRY_H */
@@ -30,6 +30,7 @@
 #include "globalvars.h"		// Includes glib.h and tlf.h
 #include "log_utils.h"
 #include "nicebox.h"		// Includes curses.h
+#include "score_checkpoint.h"
 #include "scroll_log.h"
 #include "store_qso.h"
 
@@ -69,6 +70,7 @@ void include_note(void) {
 
 	struct qso_t *qso = parse_qso(buffer2);
 	g_ptr_array_add(qso_array, qso);
+	checkpoint_qso_logged(qso->logline);	/* log stays in sync */
 
 	scroll_log();
 	clear_display();
@@ -34,6 +34,7 @@
 #include "bandmap.h"
 #include "cabrillo_utils.h"
 #include "change_rst.h"
+#include "cluster_spots.h"
 #include "cw_utils.h"
 #include "fldigixmlrpc.h"
 #include "globalvars.h"
@@ -43,9 +44,11 @@
 #include "getwwv.h"
 #include "ignore_unused.h"
 #include "lancode.h"
+#include "log_writer.h"
 #include "utils.h"
 #include "parse_logcfg.h"
 #include "qtcvars.h"		// Includes globalvars.h
+#include "redraw.h"
 #include "setcontest.h"
 #include "set_tone.h"
 #include "startmsg.h"
@@ -1126,6 +1129,30 @@ static int cfg_resend_call(const cfg_arg_t arg) {
     return PARSE_OK;
 }
 
+static int cfg_log_sync(const cfg_arg_t arg) {
+    char *str = g_ascii_strup(parameter, -1);
+    g_strstrip(str);
+
+    if (strcmp(str, "QSO") == 0) {
+	log_sync_mode = LOG_SYNC_QSO;
+    } else if (strcmp(str, "IDLE") == 0) {
+	log_sync_mode = LOG_SYNC_IDLE;
+    } else {
+	g_free(str);
+	/* otherwise sync interval in ms */
+	int rc = cfg_integer((cfg_arg_t) {.int_p = &log_sync_interval,
+	    .min = LOG_SYNC_INTERVAL_MIN, .max = LOG_SYNC_INTERVAL_MAX});
+	if (rc != PARSE_OK) {
+	    return rc;
+	}
+	log_sync_mode = LOG_SYNC_INTERVAL;
+	return PARSE_OK;
+    }
+
+    g_free(str);
+    return PARSE_OK;
+}
+
 static config_t logcfg_configs[] = {
     {"CONTEST_MODE",        CFG_BOOL(iscontest)},
     {"MIXED",               CFG_BOOL(mixedmode)},
@@ -1215,6 +1242,9 @@ static config_t logcfg_configs[] = {
     {"TNCSPEED",        CFG_INT(tnc_serial_rate, 0, INT32_MAX)},
     {"RIGSPEED",        CFG_INT(serial_rate, 0, INT32_MAX)},
     {"CQDELAY",         CFG_INT(cqdelay, 3, 60)},
+    {"CLUSTER_SPOTS",   CFG_INT(cluster_spots_capacity,
+				CLUSTER_SPOTS_MIN, CLUSTER_SPOTS_MAX)},
+    {"FRAME_RATE",      CFG_INT(frame_rate, FRAME_RATE_MIN, FRAME_RATE_MAX)},
     {"SSBPOINTS",       CFG_INT(ssbpoints, 0, INT32_MAX)},
     {"CWPOINTS",        CFG_INT(cwpoints, 0, INT32_MAX)},
     {"WEIGHT",          CFG_INT(weight, -50, 50)},
@@ -1248,6 +1278,7 @@ static config_t logcfg_configs[] = {
     {"FKEY-HEADER",     CFG_STRING_STATIC(fkey_header, sizeof(fkey_header))},
 
     {"CABRILLO",    CFG_STRING(cabrillo)},
+    {"CAT_STATS_FILE",  CFG_STRING(cat_stats_file)},
     {"CALLMASTER",  CFG_STRING(callmaster_filename)},
     {"EDITOR",      CFG_STRING(editor_cmd)},
     {"VK_PLAY_COMMAND",	    	CFG_STRING(vk_play_cmd)},
@@ -1301,6 +1332,7 @@ static config_t logcfg_configs[] = {
     {"CABRILLO-(.+)",       OPTIONAL_PARAM, cfg_cabrillo_field},
     {"RESEND_CALL",         NEED_PARAM, cfg_resend_call},
     {"GENERIC_MULT",        NEED_PARAM, cfg_generic_mult},
+    {"LOG_SYNC",            NEED_PARAM, cfg_log_sync},
 
     {NULL}  // end marker
 };
@@ -24,6 +24,7 @@
 
 
 #include "globalvars.h"
+#include "redraw.h"
 #include "tlf.h"
 #include "tlf_curses.h"
 #include "ui_utils.h"
@@ -44,7 +45,7 @@ void printcall(void) {
     if ((cqmode == CQ) && (cwstart > 0))
 	mvchgat(12, 29 + cwstart, 12 - cwstart,
 		attrib | A_UNDERLINE, C_INPUT, NULL);
-    refreshp();
+    redraw_request(REDRAW_CALL);
 
     miniterm = currentterm;
 }
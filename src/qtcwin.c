@@ -753,7 +753,6 @@ void qtc_main_panel(int direction) {
 
 			}
 			keyer_append(tmess);
-			write_keyer();
 			wattrset(qtcwin, LINE_INVERTED);
 			mvwaddstr(qtcwin, 2, 11, "CTRL+S to SAVE!");
 			refreshp();
@@ -33,6 +33,7 @@
 #include <unistd.h>
 #include <ctype.h>
 #include <time.h>
+#include <pthread.h>
 
 #include "addcall.h"
 #include "addpfx.h"
@@ -43,10 +44,14 @@
 #include "globalvars.h"		// Includes glib.h and tlf.h
 #include "ignore_unused.h"
 #include "log_utils.h"
+#include "log_writer.h"
 #include "makelogline.h"
 #include "readqtccalls.h"
+#include "redraw.h"
 #include "plugin.h"
 #include "score.h"
+#include "score_checkpoint.h"
+#include "score_journal.h"
 #include "searchcallarray.h"
 #include "startmsg.h"
 #include "store_qso.h"
@@ -55,6 +60,8 @@
 
 /* Backup original logfile and write a new one from internal database */
 void do_backup(const char *logfile, bool interactive) {
+	    log_writer_flush();
+
 	    // save a backup
 	    char prefix[40];
 	    format_time(prefix, sizeof(prefix), "%Y%m%d_%H%M%S");
@@ -71,11 +78,18 @@ void do_backup(const char *logfile, bool interactive) {
 	    g_free(backup);
 }
 
-void init_scoring(void) {
+#define RESCORE_CHUNK	256	/* log lines per work item of the pipeline */
+
+/* leading QSOs in qso_array restored from a checkpoint, they have
+ * no journal */
+static int unjournaled = 0;
+
+/* reset the scoring state, keep the QSOs */
+static void init_score_state(void) {
     /* reset counter and score anew */
+    score_generation_next();
     total = 0;
 
-    init_qso_array();
     init_worked();
 
     for (int i = 1; i <= MAX_DATALINES - 1; i++)
@@ -108,22 +122,254 @@ void init_scoring(void) {
     }
 }
 
+void init_scoring(void) {
+    init_qso_array();
+    unjournaled = 0;
+    init_score_state();
+}
+
 static void show_progress(int linenr) {
     if (linenr == 1) {
 	printw("  ");  // leading separator after log file name
-	refreshp();
+	redraw_request(REDRAW_PROGRESS);
     }
     if (((linenr + 1) % 100) == 0) {
 	printw("*");
-	refreshp();
+	redraw_request(REDRAW_PROGRESS);
+    }
+}
+
+/* QSO with the parts of its scoring which do not depend on other QSOs */
+typedef struct {
+    struct qso_t *qso;
+    int pfx_index;		/* see getpfxindex() */
+    char normalized_call[CALL_BUFFER_SIZE];
+} classified_qso_t;
+
+/* look up country and check exchange
+ *
+ * Does not touch any global state, so it may run in a worker thread */
+static void classify_qso(classified_qso_t *c) {
+    if (c->qso->is_comment) {
+	return;
+    }
+
+    c->pfx_index = getpfxindex(c->qso->call, c->normalized_call);
+    checkexchange(c->qso, false);
+}
+
+/** score a classified QSO and record its contribution in the QSO's journal
+ *
+ * \return true if the log line changed due to rescoring
+ */
+static bool score_classified_qso(classified_qso_t *c) {
+    struct qso_t *qso = c->qso;
+    bool changed = false;
+
+    if (qso->is_comment) {
+	return false;		/* skip further processing for note entry */
+    }
+
+    journal_begin(qso);
+
+    /* set the country data, not known at this point */
+    countrynr = getctydata_by_index(c->pfx_index, c->normalized_call);
+    if (qso->normalized_comment != NULL && strlen(qso->normalized_comment) > 0) {
+	strcpy(qso->comment, qso->normalized_comment);
+    }
+    dupe = is_dupe(qso->call, qso->bandindex, qso->mode);
+
+    addcall(qso);
+    score_qso(qso);
+
+    journal_end();
+
+    char *logline = makelogline(qso);
+
+    if (strcmp(logline, qso->logline) != 0) {
+	// different: update log line and mark change
+	g_free(qso->logline);
+	qso->logline = g_strdup(logline);
+	changed = true;
+    }
+
+    g_free(logline);
+
+    // drop transient fields
+    FREE_DYNAMIC_STRING(qso->callupdate);
+    FREE_DYNAMIC_STRING(qso->normalized_comment);
+    FREE_DYNAMIC_STRING(qso->section);
+
+    return changed;
+}
+
+/** score a parsed QSO and record its contribution in the QSO's journal
+ *
+ * \return true if the log line changed due to rescoring
+ */
+static bool score_logged_qso(struct qso_t *qso) {
+    classified_qso_t c = { .qso = qso };
+
+    classify_qso(&c);
+    return score_classified_qso(&c);
+}
+
+/* score all QSOs from 'index' to the end of qso_array
+ * \return true if a log line changed due to rescoring */
+static bool score_qsos(int index) {
+    bool changed = false;
+
+    for (int i = index; i < NR_QSOS; i++) {
+	if (score_logged_qso(g_ptr_array_index(qso_array, i))) {
+	    changed = true;
+	}
+    }
+    return changed;
+}
+
+/* Rescoring the whole log is done as a pipeline: worker threads parse
+ * and classify the log lines in chunks, the calling thread takes the
+ * chunks in log order and does the scoring which depends on the QSOs
+ * before. While waiting for a chunk it works on the next free one. */
+typedef struct {
+    GPtrArray *lines;
+    int first_scored;		/* lines before are restored from checkpoint */
+    classified_qso_t *qsos;
+    int nr_chunks;
+    int next_chunk;		/* next chunk to be processed */
+    bool *done;			/* chunk is parsed and classified */
+    pthread_mutex_t mutex;
+    pthread_cond_t chunk_done;
+} pipeline_t;
+
+static int rescore_workers = -1;
+
+/** set number of worker threads for rescoring the log,
+ * -1 for one less than the number of processors */
+void set_rescore_workers(int n) {
+    rescore_workers = n;
+}
+
+static void process_chunk(pipeline_t *p, int chunk) {
+    int end = MIN((chunk + 1) * RESCORE_CHUNK, p->lines->len);
+
+    for (int i = chunk * RESCORE_CHUNK; i < end; i++) {
+	classified_qso_t *c = &p->qsos[i];
+	c->qso = parse_qso(g_ptr_array_index(p->lines, i));
+	if (i >= p->first_scored) {
+	    classify_qso(c);
+	}
+    }
+}
+
+/* process next free chunk, has to be called with mutex locked
+ * \return false if there is none left */
+static bool work_on_next_chunk(pipeline_t *p) {
+    if (p->next_chunk >= p->nr_chunks) {
+	return false;
+    }
+
+    int chunk = p->next_chunk++;
+    pthread_mutex_unlock(&p->mutex);
+    process_chunk(p, chunk);
+    pthread_mutex_lock(&p->mutex);
+
+    p->done[chunk] = true;
+    pthread_cond_broadcast(&p->chunk_done);
+    return true;
+}
+
+static void *pipeline_worker(void *arg) {
+    pipeline_t *p = arg;
+
+    pthread_mutex_lock(&p->mutex);
+    while (work_on_next_chunk(p))
+	;
+    pthread_mutex_unlock(&p->mutex);
+
+    return NULL;
+}
+
+static void wait_for_chunk(pipeline_t *p, int chunk) {
+    pthread_mutex_lock(&p->mutex);
+    while (!p->done[chunk]) {
+	if (!work_on_next_chunk(p)) {
+	    pthread_cond_wait(&p->chunk_done, &p->mutex);
+	}
+    }
+    pthread_mutex_unlock(&p->mutex);
+}
+
+static int nr_of_workers(int nr_chunks) {
+    if (plugin_has_check_exchange()) {
+	return 0;		/* python plugin has to run in this thread */
+    }
+
+    int n = rescore_workers;
+    if (n < 0) {
+	n = g_get_num_processors() - 1;
     }
+    return CLAMP(n, 0, nr_chunks - 1);
+}
+
+/* parse all log lines into qso_array and score them from 'first_scored' on
+ * \return true if a log line changed due to rescoring */
+static bool score_lines(GPtrArray *lines, int first_scored, bool interactive) {
+    pipeline_t p = {
+	.lines = lines,
+	.first_scored = first_scored,
+	.nr_chunks = (lines->len + RESCORE_CHUNK - 1) / RESCORE_CHUNK,
+    };
+    bool changed = false;
+
+    p.qsos = g_new0(classified_qso_t, lines->len);
+    p.done = g_new0(bool, p.nr_chunks);
+    pthread_mutex_init(&p.mutex, NULL);
+    pthread_cond_init(&p.chunk_done, NULL);
+
+    int nr_workers = nr_of_workers(p.nr_chunks);
+    pthread_t *workers = g_new(pthread_t, MAX(nr_workers, 1));
+    int started = 0;
+    while (started < nr_workers
+	    && pthread_create(&workers[started], NULL, pipeline_worker, &p) == 0) {
+	started++;
+    }
+
+    for (int chunk = 0; chunk < p.nr_chunks; chunk++) {
+	wait_for_chunk(&p, chunk);
+
+	int end = MIN((chunk + 1) * RESCORE_CHUNK, lines->len);
+	for (int i = chunk * RESCORE_CHUNK; i < end; i++) {
+	    if (interactive) {
+		show_progress(i + 1);
+	    }
+
+	    g_ptr_array_add(qso_array, p.qsos[i].qso);
+	    if (i >= first_scored && score_classified_qso(&p.qsos[i])) {
+		changed = true;
+	    }
+	}
+    }
+
+    for (int i = 0; i < started; i++) {
+	pthread_join(workers[i], NULL);
+    }
+
+    g_free(workers);
+    pthread_cond_destroy(&p.chunk_done);
+    pthread_mutex_destroy(&p.mutex);
+    g_free(p.done);
+    g_free(p.qsos);
+
+    return changed;
 }
 
 int readcalls(const char *logfile, bool interactive) {
 
     char inputbuffer[LOGLINELEN + 1];
-    struct qso_t *qso;
-    int linenr = 0;
+    int restored = 0;		/* lines scored by restoring a checkpoint */
+    uint64_t hash = CHECKPOINT_HASH_INIT;
+    size_t offset = 0;
 
     FILE *fp;
 
@@ -133,64 +379,49 @@ int readcalls(const char *logfile, bool interactive) {
 
     init_scoring();
 
+    log_writer_flush();
     if ((fp = fopen(logfile, "r")) == NULL) {
 	showmsg("Error opening logfile ");
 	sleep(2);
 	exit(1);
     }
 
-    bool log_changed = false;
+    checkpoint_t *chk = checkpoint_open(logfile);
+    GPtrArray *lines = g_ptr_array_new_with_free_func(g_free);
 
     while (fgets(inputbuffer, sizeof(inputbuffer), fp) != NULL) {
 
+	size_t len = strlen(inputbuffer);
+	hash = checkpoint_hash(hash, inputbuffer, len);
+	offset += len;
+
 	// drop trailing newline
 	inputbuffer[LOGLINELEN - 1] = '\0';
 
-	linenr++;
-
-	if (interactive) {
-	    show_progress(linenr);
-	}
-
-	qso = parse_qso(inputbuffer);
-
-	if (qso->is_comment) {
-	    g_ptr_array_add(qso_array, qso);
-	    continue;		/* skip further processing for note entry */
-	}
-
-	/* get the country number, not known at this point */
-	countrynr = getctydata(qso->call);
-	checkexchange(qso, false);
-	if (qso->normalized_comment != NULL && strlen(qso->normalized_comment) > 0) {
-	    strcpy(qso->comment, qso->normalized_comment);
-	}
-	dupe = is_dupe(qso->call, qso->bandindex, qso->mode);
-
-	addcall(qso);
-	score_qso(qso);
-
-	char *logline = makelogline(qso);
+	g_ptr_array_add(lines, g_strdup(inputbuffer));
+	checkpoint_line_hashed(lines->len - 1, offset, hash);
 
-	if (strcmp(logline, qso->logline) != 0) {
-	    // different: update log line and mark change
-	    g_free(qso->logline);
-	    qso->logline = g_strdup(logline);
-	    log_changed = true;
+	/* restore the scoring state if the log still starts with the
+	 * lines the checkpoint was taken from */
+	if (chk != NULL && offset >= checkpoint_offset(chk)) {
+	    if (checkpoint_restore(chk, offset, lines->len, hash)) {
+		restored = lines->len;
+	    }
+	    checkpoint_free(chk);
+	    chk = NULL;
 	}
-
-	g_free(logline);
-
-	// drop transient fields
-	FREE_DYNAMIC_STRING(qso->callupdate);
-	FREE_DYNAMIC_STRING(qso->normalized_comment);
-	FREE_DYNAMIC_STRING(qso->section);
-
-	g_ptr_array_add(qso_array, qso);
     }
 
     fclose(fp);
+    checkpoint_free(chk);
+
+    bool log_changed = score_lines(lines, restored, interactive);
+    unjournaled = restored;
 
+    int linenr = lines->len;
+    g_ptr_array_free(lines, TRUE);
+
+    bool in_sync = true;
     if (log_changed) {
 	bool ok = false;
 	if (interactive) {
@@ -202,9 +433,18 @@ int readcalls(const char *logfile, bool interactive) {
 
 	if (ok) {
 	    do_backup(logfile, interactive);
+	    hash = checkpoint_hash_qsos(0, &offset);
+	} else {
+	    in_sync = false;
 	}
     }
 
+    if (in_sync) {
+	checkpoint_synced(logfile, NR_QSOS - unjournaled, offset, hash);
+    } else {
+	checkpoint_unsynced();
+    }
+
     return linenr;			// nr of lines in log
 }
 
@@ -218,6 +458,140 @@ int log_read_n_score() {
     return nr_qsolines;
 }
 
+/** take back the scoring of all QSOs from 'index' to the end of the log
+ *
+ * QSOs restored from a checkpoint have no journal. If one of them is
+ * affected the scoring starts anew.
+ * \return index of first QSO to be scored again
+ */
+static int unscore_from(int index) {
+    if (index < unjournaled) {
+	for (int i = 0; i < NR_QSOS; i++) {
+	    journal_free(g_ptr_array_index(qso_array, i));
+	}
+	init_score_state();
+	unjournaled = 0;
+	return 0;
+    }
+
+    for (int i = NR_QSOS - 1; i >= index; i--) {
+	journal_undo(g_ptr_array_index(qso_array, i));
+    }
+    return index;
+}
+
+/* parse the log lines from 'index' on again, so that the QSOs start from
+ * the same state as in readcalls() */
+static void reparse_from(int index) {
+    for (int i = index; i < NR_QSOS; i++) {
+	struct qso_t *old_qso = g_ptr_array_index(qso_array, i);
+	char *line = g_strdup(old_qso->logline);
+	g_ptr_array_index(qso_array, i) = parse_qso(line);
+	g_free(line);
+	free_qso(old_qso);
+    }
+    qso_array_changed();
+}
+
+/* score all QSOs from 'index' to the end of the log
+ * and rewrite the log file if some line changed */
+static void score_from(int index) {
+    size_t offset;
+
+    if (score_qsos(index)) {
+	do_backup(logfile, false);
+    }
+    /* lines from 'index' on may have changed, take them from memory */
+    uint64_t hash = checkpoint_hash_qsos(index, &offset);
+    checkpoint_synced(logfile, NR_QSOS - index, offset, hash);
+
+    if (qtcdirection > 0) {
+	readqtccalls();
+    }
+}
+
+/** rescore the log after the QSOs starting at 'index' have been changed
+ *
+ * The changed entries in qso_array have to keep the journal from their
+ * last scoring. Only the QSOs from 'index' to the end of the log get
+ * scored again.
+ */
+void rescore_from(int index) {
+    if (index < 0 || index >= NR_QSOS) {
+	return;
+    }
+    index = unscore_from(index);
+    reparse_from(index);
+    score_from(index);
+}
+
+/** remove QSO at 'index' from the log data and from the score
+ *
+ * Only the QSOs following the removed one get scored again.
+ * The log file is only rewritten if one of these QSOs changes.
+ */
+void rescore_remove_qso(int index) {
+    if (index < 0 || index >= NR_QSOS) {
+	return;
+    }
+    int first = unscore_from(index);
+    g_ptr_array_remove_index(qso_array, index);
+    qso_array_changed();
+    reparse_from(first);
+    score_from(first);
+}
+
+/** reread the log file after it was changed outside of tlf
+ *
+ * Compares the file with the log lines in memory and rescores only
+ * from the first changed line on.
+ * \return number of lines in log
+ */
+int log_reread_n_score() {
+    char inputbuffer[LOGLINELEN + 1];
+    GPtrArray *lines;
+    FILE *fp;
+    int first;
+
+    log_writer_flush();
+    if ((fp = fopen(logfile, "r")) == NULL) {
+	return log_read_n_score();
+    }
+
+    lines = g_ptr_array_new_with_free_func(g_free);
+    while (fgets(inputbuffer, sizeof(inputbuffer), fp) != NULL) {
+	// drop trailing newline
+	inputbuffer[LOGLINELEN - 1] = '\0';
+	g_ptr_array_add(lines, g_strdup(inputbuffer));
+    }
+    fclose(fp);
+
+    /* find first line which differs */
+    for (first = 0; first < lines->len && first < NR_QSOS; first++) {
+	if (strcmp(g_ptr_array_index(lines, first), QSOS(first)) != 0) {
+	    break;
+	}
+    }
+
+    if (first < NR_QSOS || first < lines->len) {
+	int start = unscore_from(first);
+	g_ptr_array_remove_range(qso_array, first, NR_QSOS - first);
+	qso_array_changed();
+	reparse_from(start);
+
+	for (int i = first; i < lines->len; i++) {
+	    g_ptr_array_add(qso_array, parse_qso(g_ptr_array_index(lines, i)));
+	}
+	score_from(start);
+    } else if (qtcdirection > 0) {
+	readqtccalls();
+    }
+
+    g_ptr_array_free(lines, TRUE);
+
+    return NR_QSOS;
+}
+
 //------------------------------------------------------------------------
 
 int synclog(char *synclogfile) {
@@ -227,6 +601,8 @@ int synclog(char *synclogfile) {
 
     format_time(date_buf, sizeof(date_buf), "%d%H%M");
 
+    log_writer_flush();
+
     if (strlen(synclogfile) < 80)
 	strcat(wgetcmd, synclogfile);
     else {
@@ -27,7 +27,11 @@
 
 int lookup_country_in_pfxnummult_array(int n);
 int readcalls(const char *logfile, bool interactive);
+void set_rescore_workers(int n);
 int log_read_n_score();
+int log_reread_n_score();
+void rescore_from(int index);
+void rescore_remove_qso(int index);
 int synclog(char *synclogfile);
 
 #endif /* READCALLS_H */
@@ -39,8 +39,13 @@
 void readctydata(void) {
 
     gchar *filename = find_available("cty.dat");;
+    gchar *cachefile = g_build_filename(g_get_user_cache_dir(), "tlf",
+					"cty.bin", NULL);
 
-    if (load_ctydata(filename) == -1) {
+    int result = load_ctydata_cached(filename, cachefile);
+    g_free(cachefile);
+
+    if (result == -1) {
 	g_free(filename);
 	mvaddstr(4, 0, "Error opening cty.dat file.\n");
 	refreshp();
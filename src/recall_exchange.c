@@ -23,6 +23,7 @@
 
 #include "globalvars.h"
 #include "initial_exchange.h"
+#include "searchcallarray.h"
 #include "tlf.h"
 #include "tlf_curses.h"
 #include "setcontest.h"
@@ -38,29 +39,19 @@
 //TODO: use qso argument
 int get_proposed_exchange(void) {
 
-    int i, l;
+    worked_t entry;
     int found = -1;
-    char *loc, *loc2;
-    struct ie_list *current_ie;
 
     proposed_exchange[0] = 0;   // default: empty (nothing found)
 
     if (strlen(current_qso.call) == 0)
 	return 0;
 
-    l = strlen(current_qso.call);
-
-    /* search backwards through list of worked stations */
-    for (i = nr_worked - 1; i >= 0; i--) {
-
-	/* first search call in already worked stations */
-	/* call has to be exact -> la/dl1jbe/p must be the same again */
-	if ((strstr(worked[i].call, current_qso.call) == worked[i].call) &&
-		(*(worked[i].call + l) == '\0' || *(worked[i].call + l) == ' ')) {
-	    found = 1;
-	    strcpy(proposed_exchange, worked[i].exchange);
-	    break;
-	}
+    /* first search call in already worked stations */
+    /* call has to be exact -> la/dl1jbe/p must be the same again */
+    if (copy_worked(current_qso.call, &entry)) {
+	found = 1;
+	strcpy(proposed_exchange, entry.exchange);
     }
 
     if (found == -1) {
@@ -69,23 +60,11 @@ int get_proposed_exchange(void) {
 	 * search initial exchange list (if available) */
 	if (strlen(current_qso.comment) == 0 && main_ie_list != NULL) {
 
-	    current_ie = main_ie_list;
-
-	    while (current_ie) {
-		/* call from IE_List has to be a substring of current_qso.call
-		 * but must be delimited on both sides by '/' or eos */
-		if ((loc = strstr(current_qso.call, current_ie->call)) != NULL) {
-
-		    loc2 = loc + strlen(current_ie->call);
-		    if (((loc == current_qso.call) || (*(loc - 1) == '/')) &&
-			    ((*loc2 == '\0') || (*loc2 == '/'))) {
-
-			found = 1;
-			strcpy(proposed_exchange, current_ie->exchange);
-			break;
-		    }
-		}
-		current_ie = current_ie->next;
+	    const char *exchange =
+		ie_lookup_portable(main_ie_list, current_qso.call);
+	    if (exchange != NULL) {
+		found = 1;
+		strcpy(proposed_exchange, exchange);
 	    }
 	}
 
@@ -0,0 +1,216 @@
+/*
+ * Tlf - contest logging program for amateur radio operators
+ * Copyright (C) 2026 The Tlf developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+/* ------------------------------------------------------------
+ *      Redraw scheduler
+ *
+ * Output which may change many times a second (frequency display,
+ * cluster and bandmap window, log lines, ...) asks for a redraw with
+ * redraw_request() instead of calling refreshp() itself. The request
+ * marks the area dirty and draws a frame only if the last one is at
+ * least 1/FRAME_RATE s ago.
+ *
+ * Areas marked by the user interface thread are drawn only from there,
+ * by the input loop (time_update()) and before waiting for a key, as
+ * that thread may be in the middle of drawing them. Areas marked by
+ * other threads (cluster, LAN) are in addition drawn by a timer of the
+ * background process.
+ *
+ *--------------------------------------------------------------*/
+
+
+#include <pthread.h>
+#include <glib.h>
+
+#include "background_process.h"
+#include "globalvars.h"
+#include "redraw.h"
+#include "ui_utils.h"
+
+static const char *area_names[REDRAW_AREA_COUNT] = {
+    [REDRAW_FREQ] = "freq",
+    [REDRAW_CLUSTER] = "cluster",
+    [REDRAW_BANDMAP] = "bandmap",
+    [REDRAW_CALL] = "call",
+    [REDRAW_LOG] = "log",
+    [REDRAW_SEARCH] = "search",
+    [REDRAW_PACKET] = "packet",
+    [REDRAW_PROGRESS] = "progress",
+};
+
+static pthread_mutex_t redraw_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static unsigned int dirty_ui = 0;	/* bit mask of redraw_area_t */
+static unsigned int dirty_bg = 0;	/* same for other threads */
+static gint64 last_frame = 0;		/* us, monotonic clock */
+
+static pthread_t ui_thread;
+static bool ui_thread_known = false;
+
+static int requests[REDRAW_AREA_COUNT];	/* redraw_request() calls */
+static int drawn[REDRAW_AREA_COUNT];	/* frames the area was part of */
+static int frames = 0;
+
+
+/** minimal time between two frames in ms */
+int redraw_interval(void) {
+    return 1000 / CLAMP(frame_rate, FRAME_RATE_MIN, FRAME_RATE_MAX);
+}
+
+/** remember the calling thread as the user interface thread
+ *
+ * Without it every thread is taken as the user interface one. */
+void redraw_init(void) {
+    pthread_mutex_lock(&redraw_mutex);
+    ui_thread = pthread_self();
+    ui_thread_known = true;
+    pthread_mutex_unlock(&redraw_mutex);
+}
+
+static bool on_ui_thread(void) {
+    return !ui_thread_known || pthread_equal(pthread_self(), ui_thread);
+}
+
+/* draw a frame if an area is dirty and, unless 'force' is set,
+ * the frame interval has passed. Only the user interface thread ('ui')
+ * draws the areas it has marked itself. */
+static bool draw_frame(bool ui, bool force) {
+    pthread_mutex_lock(&redraw_mutex);
+
+    gint64 now = g_get_monotonic_time();
+    unsigned int dirty = ui ? (dirty_ui | dirty_bg) : dirty_bg;
+    if (dirty == 0
+	    || (!force && now - last_frame < redraw_interval() * 1000)) {
+	pthread_mutex_unlock(&redraw_mutex);
+	return false;
+    }
+
+    for (int i = 0; i < REDRAW_AREA_COUNT; i++) {
+	if (dirty & (1u << i))
+	    drawn[i]++;
+    }
+    frames++;
+    if (ui)
+	dirty_ui = 0;
+    dirty_bg = 0;
+    last_frame = now;
+
+    pthread_mutex_unlock(&redraw_mutex);
+
+    refreshp();
+    return true;
+}
+
+/** mark 'area' as changed, draw a frame if one is due */
+void redraw_request(redraw_area_t area) {
+    bool ui = on_ui_thread();
+
+    pthread_mutex_lock(&redraw_mutex);
+    bool was_pending = (dirty_bg != 0);
+    if (ui)
+	dirty_ui |= 1u << area;
+    else
+	dirty_bg |= 1u << area;
+    requests[area]++;
+    pthread_mutex_unlock(&redraw_mutex);
+
+    if (!draw_frame(ui, false) && !ui && !was_pending) {
+	background_wakeup();	/* start the redraw timer */
+    }
+}
+
+/** draw a pending frame if the frame interval has passed
+ *
+ * To be called from the user interface loop.
+ * \return true if a frame was drawn */
+bool redraw_flush(void) {
+    return draw_frame(true, false);
+}
+
+/** draw a pending frame at once
+ *
+ * To be used before waiting for user input. */
+bool redraw_now(void) {
+    return draw_frame(true, true);
+}
+
+/** draw areas marked by other threads if the frame interval has passed
+ *
+ * To be called from the redraw timer of the background process.
+ * \return true if a frame was drawn */
+bool redraw_flush_background(void) {
+    return draw_frame(false, false);
+}
+
+bool redraw_pending(void) {
+    pthread_mutex_lock(&redraw_mutex);
+    bool pending = (dirty_ui != 0 || dirty_bg != 0);
+    pthread_mutex_unlock(&redraw_mutex);
+    return pending;
+}
+
+/** \return true if areas marked by other threads wait for a frame */
+bool redraw_background_pending(void) {
+    pthread_mutex_lock(&redraw_mutex);
+    bool pending = (dirty_bg != 0);
+    pthread_mutex_unlock(&redraw_mutex);
+    return pending;
+}
+
+
+const char *redraw_area_name(redraw_area_t area) {
+    return area_names[area];
+}
+
+/** \return number of redraw requests from 'area' */
+int redraw_requests(redraw_area_t area) {
+    pthread_mutex_lock(&redraw_mutex);
+    int n = requests[area];
+    pthread_mutex_unlock(&redraw_mutex);
+    return n;
+}
+
+/** \return number of frames drawn for 'area' */
+int redraw_count(redraw_area_t area) {
+    pthread_mutex_lock(&redraw_mutex);
+    int n = drawn[area];
+    pthread_mutex_unlock(&redraw_mutex);
+    return n;
+}
+
+/** \return number of frames drawn by the scheduler */
+int redraw_frames(void) {
+    pthread_mutex_lock(&redraw_mutex);
+    int n = frames;
+    pthread_mutex_unlock(&redraw_mutex);
+    return n;
+}
+
+void redraw_reset(void) {
+    pthread_mutex_lock(&redraw_mutex);
+    dirty_ui = 0;
+    dirty_bg = 0;
+    last_frame = 0;
+    frames = 0;
+    for (int i = 0; i < REDRAW_AREA_COUNT; i++) {
+	requests[i] = 0;
+	drawn[i] = 0;
+    }
+    pthread_mutex_unlock(&redraw_mutex);
+}
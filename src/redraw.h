@@ -0,0 +1,58 @@
+/*
+ * Tlf - contest logging program for amateur radio operators
+ * Copyright (C) 2026 The Tlf developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+
+#ifndef REDRAW_H
+#define REDRAW_H
+
+#include <stdbool.h>
+
+/* screen areas which ask for a redraw */
+typedef enum {
+    REDRAW_FREQ,	/* TRX and MEM frequency */
+    REDRAW_CLUSTER,	/* cluster and frequency window */
+    REDRAW_BANDMAP,
+    REDRAW_CALL,	/* call input field */
+    REDRAW_LOG,		/* last QSOs */
+    REDRAW_SEARCH,	/* worked window */
+    REDRAW_PACKET,	/* packet window */
+    REDRAW_PROGRESS,	/* log file reading */
+    REDRAW_AREA_COUNT
+} redraw_area_t;
+
+#define FRAME_RATE_MIN		1
+#define FRAME_RATE_MAX		100
+#define FRAME_RATE_DEFAULT	25
+
+void redraw_init(void);
+void redraw_request(redraw_area_t area);
+bool redraw_flush(void);
+bool redraw_now(void);
+bool redraw_flush_background(void);
+bool redraw_pending(void);
+bool redraw_background_pending(void);
+int redraw_interval(void);
+
+const char *redraw_area_name(redraw_area_t area);
+int redraw_requests(redraw_area_t area);
+int redraw_count(redraw_area_t area);
+int redraw_frames(void);
+void redraw_reset(void);
+
+#endif /* REDRAW_H */
@@ -81,6 +81,11 @@ int init_controller() {
 }
 
 /* ------------------------- deinit controller -------------------------- */
+/* file descriptor of the controller or -1 */
+int controller_fd() {
+    return (fdcont > 0 ? fdcont : -1);
+}
+
 void deinit_controller() {
     if (fdcont) {
 	close(fdcont);
@@ -28,6 +28,7 @@
 
 int init_controller() ;
 void deinit_controller();
+int controller_fd();
 void  rx_rtty();
 void show_rtty(void);
 
@@ -39,6 +39,7 @@
 #include "getctydata.h"
 #include "qrb.h"
 #include "plugin.h"
+#include "score_journal.h"
 #include "setcontest.h"
 #include "tlf.h"
 
@@ -377,6 +378,7 @@ int score(struct qso_t *qso) {
 /* score QSO and add to total points */
 void score_qso(struct qso_t *qso) {
     qso_points = score(qso);		/* update qso's per band and score */
+    JOURNAL(total);
     total = total + qso_points;
 }
 
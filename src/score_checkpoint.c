@@ -0,0 +1,637 @@
+/*
+ * Tlf - contest logging program for amateur radio operators
+ * Copyright (C) 2026 The Tlf developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+/* ------------------------------------------------------------
+ *   checkpoints of the scoring state
+ *
+ *   Scoring a long log at startup takes time. A checkpoint stores
+ *   the scoring state (worked stations, countries, zones, multis,
+ *   prefixes and points) together with the number of bytes and lines
+ *   of the log it results from and a hash over these bytes.
+ *   readcalls() restores the state if the log still starts with the
+ *   same bytes and scores only the lines appended after it.
+ *
+ *   A checkpoint is only written while the scoring state is the
+ *   result of scoring the log file, that is after readcalls() and
+ *   rescoring and as long as only QSOs of this node get logged.
+ *
+ *--------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "addmult.h"
+#include "addpfx.h"
+#include "dxcc.h"
+#include "globalvars.h"
+#include "log_writer.h"
+#include "plugin.h"
+#include "score_checkpoint.h"
+#include "score_journal.h"
+#include "searchcallarray.h"
+#include "utils.h"
+
+#define CHECKPOINT_MAGIC	"TLFSCORE"
+/* to be bumped whenever the saved state or checkpoint_hash() changes,
+ * so that the format check rejects older checkpoints */
+#define CHECKPOINT_FORMAT	3
+
+typedef struct {
+    char magic[8];
+    uint32_t format;
+    /* sizes of the saved records, must match the running program */
+    uint32_t worked_size;
+    uint32_t mults_size;
+    uint32_t pfxnummulti_size;
+    uint32_t nbands;
+    uint32_t max_datalines;
+    uint32_t max_zones;
+    uint32_t reserved;
+    uint64_t config_hash;	/* see config_hash() */
+    /* part of the log the state results from */
+    uint64_t log_offset;
+    uint64_t log_hash;
+    uint32_t log_lines;
+    uint32_t body_size;
+    uint64_t body_hash;
+} checkpoint_header;
+
+struct checkpoint {
+    checkpoint_header header;
+    char *contents;		/* whole file */
+    const char *body;		/* saved state behind the header */
+};
+
+/* worked station, followed by the non-zero entries of its qsotime[][] */
+typedef struct {
+    char call[20];
+    char exchange[24];
+    int32_t band;
+    uint64_t times_set;		/* bit set for non-zero qsotime entry */
+} worked_record_t;
+
+#define NR_QSOTIMES	(3 * NBANDS)
+
+typedef struct {
+    const char *data;
+    size_t left;
+} reader_t;
+
+static char *synced_log = NULL;	/* log file the scoring state results from */
+static size_t synced_offset = 0;	/* its size, */
+static uint64_t synced_hash = 0;	/* hash */
+static int synced_lines = 0;	/* and number of lines */
+static int unsaved = 0;		/* QSOs scored since last checkpoint */
+
+/* size and hash of the log up to and including line i, so that after
+ * changing line i only the lines from there on have to be hashed */
+typedef struct {
+    size_t offset;
+    uint64_t hash;
+} log_prefix_t;
+
+static GArray *prefixes = NULL;
+
+
+/** hash over 'len' bytes, start with CHECKPOINT_HASH_INIT
+ *
+ * FNV-1a taking eight bytes at a time. Results depend on how the data
+ * is split into calls, so the log has to be hashed line by line.
+ */
+uint64_t checkpoint_hash(uint64_t hash, const void *data, size_t len) {
+    const unsigned char *p = data;
+    uint64_t word;
+
+    for (; len >= sizeof(word); p += sizeof(word), len -= sizeof(word)) {
+	memcpy(&word, p, sizeof(word));
+	hash = (hash ^ word) * 0x100000001b3ULL;
+	hash ^= hash >> 29;
+    }
+    for (; len > 0; p++, len--) {
+	hash = (hash ^ *p) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+/* add a log line as store_qso() writes it to the hash of the log */
+static uint64_t hash_line(uint64_t hash, const char *line, size_t *offset) {
+    char buffer[LOGLINELEN + 1];
+
+    /* one call per line, like the fgets() loop in readcalls() */
+    snprintf(buffer, sizeof(buffer), "%s\n", line);
+    size_t len = strlen(buffer);
+    *offset += len;
+    return checkpoint_hash(hash, buffer, len);
+}
+
+/** remember size and hash of the log up to and including 'line'
+ *
+ * Prefixes of the following lines are dropped.
+ */
+void checkpoint_line_hashed(int line, size_t offset, uint64_t hash) {
+    log_prefix_t prefix = { offset, hash };
+
+    if (prefixes == NULL) {
+	prefixes = g_array_new(FALSE, FALSE, sizeof(log_prefix_t));
+    }
+    if (line < prefixes->len) {
+	g_array_set_size(prefixes, line);
+    }
+    if (line == prefixes->len) {
+	g_array_append_val(prefixes, prefix);
+    }
+}
+
+/** hash over the log as rewritten from the QSOs in qso_array
+ *
+ * Only the lines from 'from' on are hashed, the ones before have to be
+ * unchanged since they were hashed last.
+ * \param offset - returns the size of the log
+ */
+uint64_t checkpoint_hash_qsos(int from, size_t *offset) {
+    uint64_t hash = CHECKPOINT_HASH_INIT;
+    int i = 0;
+
+    *offset = 0;
+    if (prefixes != NULL && from > 0) {
+	i = MIN(from, prefixes->len);
+	if (i > 0) {
+	    log_prefix_t *prefix = &g_array_index(prefixes, log_prefix_t, i - 1);
+	    *offset = prefix->offset;
+	    hash = prefix->hash;
+	}
+    }
+    for (; i < NR_QSOS; i++) {
+	hash = hash_line(hash, QSOS(i), offset);
+	checkpoint_line_hashed(i, *offset, hash);
+    }
+    return hash;
+}
+
+/** name of the checkpoint file for 'logfile', to be freed by caller */
+char *checkpoint_filename(const char *logfile) {
+    return g_strconcat(logfile, ".score", NULL);
+}
+
+/* plugins may keep scoring state of their own which we can not save */
+static bool checkpoint_usable(void) {
+    return !plugin_has_setup() && !plugin_has_score()
+	   && !plugin_has_check_exchange();
+}
+
+static uint64_t hash_string(uint64_t hash, const char *str) {
+    return checkpoint_hash(hash, str, strlen(str) + 1);
+}
+
+static uint64_t hash_file(uint64_t hash, const char *filename) {
+    gchar *contents;
+    gsize len;
+
+    if (filename != NULL && *filename != '\0'
+	    && g_file_get_contents(filename, &contents, &len, NULL)) {
+	hash = checkpoint_hash(hash, contents, len);
+	g_free(contents);
+    }
+    return hash;
+}
+
+/* hash over the setup the scoring depends on besides the log itself */
+static uint64_t config_hash(void) {
+    uint64_t hash = CHECKPOINT_HASH_INIT;
+    int counts[] = {
+	dxcc_count(), prefix_count(), pfxnummultinr, get_mult_count()
+    };
+
+    hash = hash_string(hash, whichcontest);
+    hash = hash_string(hash, my.call);
+    hash = hash_string(hash, cty_dat_version);
+    hash = checkpoint_hash(hash, counts, sizeof(counts));
+    for (int i = 0; i < get_mult_count(); i++) {
+	hash = hash_string(hash, get_mult(i));
+    }
+
+    hash = hash_file(hash, config_file);
+    char *rules = g_strconcat("rules", G_DIR_SEPARATOR_S, whichcontest, NULL);
+    char *path = find_available(rules);
+    hash = hash_file(hash, path);
+    g_free(path);
+    g_free(rules);
+
+    return hash;
+}
+
+/* fill in the fields describing the running program */
+static void init_header(checkpoint_header *header) {
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, CHECKPOINT_MAGIC, sizeof(header->magic));
+    header->format = CHECKPOINT_FORMAT;
+    header->worked_size = sizeof(worked_record_t);
+    header->mults_size = sizeof(mults_t);
+    header->pfxnummulti_size = sizeof(pfxnummulti_t);
+    header->nbands = NBANDS;
+    header->max_datalines = MAX_DATALINES;
+    header->max_zones = MAX_ZONES;
+    header->config_hash = config_hash();
+}
+
+
+/** read checkpoint for 'logfile'
+ *
+ * \return NULL if there is none or it does not fit the program
+ *         and its configuration
+ */
+checkpoint_t *checkpoint_open(const char *logfile) {
+    checkpoint_header expected;
+    gchar *contents;
+    gsize len;
+
+    if (!checkpoint_usable()) {
+	return NULL;
+    }
+
+    char *filename = checkpoint_filename(logfile);
+    bool ok = g_file_get_contents(filename, &contents, &len, NULL);
+    g_free(filename);
+    if (!ok) {
+	return NULL;
+    }
+
+    checkpoint_t *chk = g_new0(checkpoint_t, 1);
+    chk->contents = contents;
+    chk->body = contents + sizeof(checkpoint_header);
+
+    init_header(&expected);
+    if (len < sizeof(checkpoint_header)) {
+	checkpoint_free(chk);
+	return NULL;
+    }
+    memcpy(&chk->header, contents, sizeof(checkpoint_header));
+
+    if (memcmp(&chk->header, &expected,
+	       offsetof(checkpoint_header, log_offset)) != 0
+	    || chk->header.body_size != len - sizeof(checkpoint_header)
+	    || chk->header.body_hash != checkpoint_hash(CHECKPOINT_HASH_INIT,
+		    chk->body, chk->header.body_size)) {
+	checkpoint_free(chk);
+	return NULL;
+    }
+
+    return chk;
+}
+
+/** number of log file bytes covered by the checkpoint */
+size_t checkpoint_offset(const checkpoint_t *chk) {
+    return chk->header.log_offset;
+}
+
+void checkpoint_free(checkpoint_t *chk) {
+    if (chk != NULL) {
+	g_free(chk->contents);
+	g_free(chk);
+    }
+}
+
+
+static bool get(reader_t *in, void *dest, size_t len, bool apply) {
+    if (len > in->left) {
+	return false;
+    }
+    if (apply) {
+	memcpy(dest, in->data, len);
+    }
+    in->data += len;
+    in->left -= len;
+    return true;
+}
+
+static bool get_count(reader_t *in, int32_t *count, int max) {
+    return get(in, count, sizeof(*count), true) && *count >= 0
+	   && *count <= max;
+}
+
+/* read the scoring state from the checkpoint body
+ *
+ * With 'apply' false it only checks that the saved state is complete
+ * and fits into the tables, so that nothing gets changed on failure.
+ */
+static bool read_state(const checkpoint_t *chk, bool apply) {
+    reader_t in = { chk->body, chk->header.body_size };
+    int32_t count;
+
+    if (!get(&in, &total, sizeof(total), apply)
+	    || !get(&in, qsos_per_band, sizeof(qsos_per_band), apply)
+	    || !get(&in, countryscore, sizeof(countryscore), apply)
+	    || !get(&in, zonescore, sizeof(zonescore), apply)
+	    || !get(&in, multscore, sizeof(multscore), apply)
+	    || !get(&in, countries, sizeof(countries), apply)
+	    || !get(&in, zones, sizeof(zones), apply)) {
+	return false;
+    }
+
+    if (!get_count(&in, &count, MAXPFXNUMMULT) || count != pfxnummultinr) {
+	return false;
+    }
+    for (int i = 0; i < count; i++) {
+	pfxnummulti_t entry;
+	if (!get(&in, &entry, sizeof(entry), true)
+		|| entry.countrynr != pfxnummulti[i].countrynr) {
+	    return false;
+	}
+	if (apply) {
+	    memcpy(pfxnummulti[i].qsos, entry.qsos, sizeof(entry.qsos));
+	}
+    }
+
+    if (!get_count(&in, &count, INT32_MAX)) {
+	return false;
+    }
+    for (int i = 0; i < count; i++) {
+	mults_t entry;
+	if (!get(&in, &entry, sizeof(entry), true)
+		|| memchr(entry.name, '\0', sizeof(entry.name)) == NULL) {
+	    return false;
+	}
+	if (apply) {
+	    restore_multi(entry.name, entry.band);
+	}
+    }
+
+    if (!get_count(&in, &count, INT32_MAX)) {
+	return false;
+    }
+    for (int i = 0; i < count; i++) {
+	mults_t entry;
+	if (!get(&in, &entry, sizeof(entry), true)
+		|| memchr(entry.name, '\0', sizeof(entry.name)) == NULL) {
+	    return false;
+	}
+	if (apply) {
+	    restore_worked_pfx(entry.name, entry.band);
+	}
+    }
+
+    if (!get_count(&in, &count, INT32_MAX)) {
+	return false;
+    }
+    for (int i = 0; i < count; i++) {
+	worked_record_t record;
+	long qsotime[NR_QSOTIMES];
+	if (!get(&in, &record, sizeof(record), true)
+		|| memchr(record.call, '\0', sizeof(record.call)) == NULL
+		|| memchr(record.exchange, '\0', sizeof(record.exchange)) == NULL) {
+	    return false;
+	}
+	for (int t = 0; t < NR_QSOTIMES; t++) {
+	    int64_t value = 0;
+	    if ((record.times_set & (1ULL << t))
+		    && !get(&in, &value, sizeof(value), true)) {
+		return false;
+	    }
+	    qsotime[t] = value;
+	}
+	if (apply) {
+	    /* adds the entry and looks up its country again */
+	    int station = lookup_or_add_worked(record.call);
+	    memcpy(worked[station].exchange, record.exchange,
+		   sizeof(record.exchange));
+	    worked[station].band = record.band;
+	    memcpy(worked[station].qsotime, qsotime, sizeof(qsotime));
+	}
+    }
+
+    return in.left == 0;
+}
+
+/** restore the scoring state from the checkpoint
+ *
+ * The scoring state has to be freshly initialized. Nothing is restored
+ * unless the checkpoint results from the first 'nr_lines' lines of the
+ * log with 'offset' bytes and 'hash'.
+ * \return true if state was restored
+ */
+bool checkpoint_restore(const checkpoint_t *chk,
+			size_t offset, int nr_lines, uint64_t hash) {
+    if (offset != chk->header.log_offset
+	    || nr_lines != chk->header.log_lines
+	    || hash != chk->header.log_hash
+	    || !read_state(chk, false)) {
+	return false;
+    }
+
+    read_state(chk, true);
+    score_generation_next();
+    return true;
+}
+
+
+static void put(GString *body, const void *data, size_t len) {
+    g_string_append_len(body, data, len);
+}
+
+static void put_count(GString *body, int32_t count) {
+    put(body, &count, sizeof(count));
+}
+
+static GString *write_state(void) {
+    GString *body = g_string_new(NULL);
+
+    put(body, &total, sizeof(total));
+    put(body, qsos_per_band, sizeof(qsos_per_band));
+    put(body, countryscore, sizeof(countryscore));
+    put(body, zonescore, sizeof(zonescore));
+    put(body, multscore, sizeof(multscore));
+    put(body, countries, sizeof(countries));
+    put(body, zones, sizeof(zones));
+
+    put_count(body, pfxnummultinr);
+    put(body, pfxnummulti, pfxnummultinr * sizeof(pfxnummulti_t));
+
+    put_count(body, nr_multis);
+    put(body, multis, nr_multis * sizeof(mults_t));
+
+    put_count(body, GetNrOfPfx_once());
+    for (int i = 0; i < GetNrOfPfx_once(); i++) {
+	mults_t entry;
+	memset(&entry, 0, sizeof(entry));
+	g_strlcpy(entry.name, get_worked_pfx(i, &entry.band),
+		  sizeof(entry.name));
+	put(body, &entry, sizeof(entry));
+    }
+
+    put_count(body, nr_worked);
+    for (int i = 0; i < nr_worked; i++) {
+	worked_record_t record;
+	const long *qsotime = &worked[i].qsotime[0][0];
+
+	memset(&record, 0, sizeof(record));
+	g_strlcpy(record.call, worked[i].call, sizeof(record.call));
+	g_strlcpy(record.exchange, worked[i].exchange, sizeof(record.exchange));
+	record.band = worked[i].band;
+	for (int t = 0; t < NR_QSOTIMES; t++) {
+	    if (qsotime[t] != 0) {
+		record.times_set |= 1ULL << t;
+	    }
+	}
+	put(body, &record, sizeof(record));
+	for (int t = 0; t < NR_QSOTIMES; t++) {
+	    int64_t value = qsotime[t];
+	    if (value != 0) {
+		put(body, &value, sizeof(value));
+	    }
+	}
+    }
+
+    return body;
+}
+
+/** write checkpoint of the scoring state for 'logfile'
+ *
+ * The scoring state has to result from the log file, see
+ * checkpoint_synced(). The log is not read again, only its size is
+ * checked against the one expected from the QSOs logged since.
+ * \return 0 on success, -1 otherwise
+ */
+int checkpoint_save(const char *logfile) {
+    checkpoint_header header;
+    struct stat st;
+    FILE *fp;
+
+    if (!checkpoint_usable() || qso_array == NULL || NR_QSOS == 0
+	    || synced_log == NULL || strcmp(synced_log, logfile) != 0) {
+	return -1;
+    }
+
+    log_writer_flush();
+    if (g_stat(logfile, &st) != 0 || (size_t)st.st_size != synced_offset
+	    || synced_lines != NR_QSOS) {
+	return -1;		/* log file differs from QSOs in memory */
+    }
+
+    init_header(&header);
+    header.log_offset = synced_offset;
+    header.log_hash = synced_hash;
+    header.log_lines = synced_lines;
+
+    GString *body = write_state();
+    header.body_size = body->len;
+    header.body_hash = checkpoint_hash(CHECKPOINT_HASH_INIT,
+				       body->str, body->len);
+
+    /* write to temporary file and rename it, so a crash never leaves
+     * a partly written checkpoint */
+    char *filename = checkpoint_filename(logfile);
+    char *tmpfile = g_strconcat(filename, ".tmp", NULL);
+    int result = -1;
+
+    if ((fp = g_fopen(tmpfile, "wb")) != NULL) {
+	bool ok = fwrite(&header, sizeof(header), 1, fp) == 1
+		  && fwrite(body->str, 1, body->len, fp) == body->len;
+	ok = (fclose(fp) == 0) && ok;
+	if (ok && g_rename(tmpfile, filename) == 0) {
+	    result = 0;
+	} else {
+	    g_unlink(tmpfile);
+	}
+    }
+
+    g_free(tmpfile);
+    g_free(filename);
+    g_string_free(body, TRUE);
+
+    return result;
+}
+
+
+static void save_synced(void) {
+    if (checkpoint_save(synced_log) == 0) {
+	unsaved = 0;
+    } else {
+	checkpoint_unsynced();	/* do not try again on every QSO */
+    }
+}
+
+/** the scoring state results from scoring 'logfile'
+ *
+ * The log has to hold the QSOs in qso_array.
+ * \param scored - number of QSOs scored since the last checkpoint
+ * \param offset - size of the log
+ * \param hash - hash over the log, see checkpoint_hash_qsos()
+ */
+void checkpoint_synced(const char *logfile, int scored,
+		       size_t offset, uint64_t hash) {
+    if (synced_log == NULL || strcmp(synced_log, logfile) != 0) {
+	g_free(synced_log);
+	synced_log = g_strdup(logfile);
+	unsaved = 0;
+    }
+    unsaved += scored;
+    synced_offset = offset;
+    synced_hash = hash;
+    synced_lines = NR_QSOS;
+
+    if (unsaved >= CHECKPOINT_INTERVAL) {
+	save_synced();
+    }
+}
+
+/** the scoring state differs from what scoring the log would give,
+ * e.g. after a QSO from the LAN was added by score2() */
+void checkpoint_unsynced(void) {
+    g_free(synced_log);
+    synced_log = NULL;
+    unsaved = 0;
+}
+
+/** a QSO of this node was scored and 'logline' appended to the log
+ * and to qso_array */
+void checkpoint_qso_logged(const char *logline) {
+    if (prefixes != NULL && prefixes->len == NR_QSOS - 1) {
+	size_t offset = 0;
+	uint64_t hash = CHECKPOINT_HASH_INIT;
+	if (prefixes->len > 0) {
+	    log_prefix_t *last = &g_array_index(prefixes, log_prefix_t,
+						prefixes->len - 1);
+	    offset = last->offset;
+	    hash = last->hash;
+	}
+	hash = hash_line(hash, logline, &offset);
+	checkpoint_line_hashed(prefixes->len, offset, hash);
+    }
+
+    if (synced_log == NULL) {
+	return;
+    }
+
+    synced_hash = hash_line(synced_hash, logline, &synced_offset);
+    synced_lines++;
+    unsaved++;
+    if (unsaved >= CHECKPOINT_INTERVAL) {
+	save_synced();
+    }
+}
+
+/** write a checkpoint if QSOs were scored since the last one */
+void checkpoint_flush(void) {
+    if (synced_log != NULL && unsaved > 0) {
+	save_synced();
+    }
+}
@@ -0,0 +1,54 @@
+/*
+ * Tlf - contest logging program for amateur radio operators
+ * Copyright (C) 2026 The Tlf developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+/* ------------------------------------------------------------
+ *   checkpoints of the scoring state
+ *
+ *--------------------------------------------------------------*/
+
+#ifndef SCORE_CHECKPOINT_H
+#define SCORE_CHECKPOINT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define CHECKPOINT_HASH_INIT	0xcbf29ce484222325ULL
+#define CHECKPOINT_INTERVAL	100	/* QSOs logged between checkpoints */
+
+typedef struct checkpoint checkpoint_t;
+
+uint64_t checkpoint_hash(uint64_t hash, const void *data, size_t len);
+void checkpoint_line_hashed(int line, size_t offset, uint64_t hash);
+uint64_t checkpoint_hash_qsos(int from, size_t *offset);
+char *checkpoint_filename(const char *logfile);
+
+checkpoint_t *checkpoint_open(const char *logfile);
+size_t checkpoint_offset(const checkpoint_t *chk);
+bool checkpoint_restore(const checkpoint_t *chk,
+			size_t offset, int nr_lines, uint64_t hash);
+void checkpoint_free(checkpoint_t *chk);
+int checkpoint_save(const char *logfile);
+
+void checkpoint_synced(const char *logfile, int scored,
+		       size_t offset, uint64_t hash);
+void checkpoint_unsynced(void);
+void checkpoint_qso_logged(const char *logline);
+void checkpoint_flush(void);
+
+#endif /* SCORE_CHECKPOINT_H */
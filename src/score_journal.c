@@ -0,0 +1,149 @@
+/*
+ * Tlf - contest logging program for amateur radio operators
+ * Copyright (C) 2026 The Tlf developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+/* ------------------------------------------------------------
+ *   journal of scoring contributions of single QSOs
+ *
+ *   While a QSO gets scored every change to the scoring state
+ *   (worked stations, countries, zones, prefixes, multis, points...)
+ *   saves the old value of the changed variable in the QSO's journal.
+ *   Undoing the journals of the last QSOs in reverse log order
+ *   restores the scoring state from before these QSOs, so that a
+ *   deleted or changed QSO can be rescored without replaying the
+ *   whole log.
+ *
+ *--------------------------------------------------------------*/
+
+#include <string.h>
+
+#include <glib.h>
+
+#include "score_journal.h"
+#include "tlf.h"
+
+#define JOURNAL_DATA_SIZE 24
+
+typedef struct {
+    void **base;	/* heap block holding the data or NULL */
+    size_t offset;	/* offset into *base or address of data */
+    size_t len;
+    char data[JOURNAL_DATA_SIZE];	/* old value */
+} journal_entry_t;
+
+static GArray **current = NULL;	/* journal we are recording to */
+
+static gint generation = 1;	/* see score_generation() */
+
+
+/** number which changes with every change of the scoring state
+ *
+ * Lets users of the scoring state (e.g. the bandmap) find out if their
+ * cached results are still valid. All changes are recorded by
+ * JOURNAL() before they are done, so counting the saves is sufficient.
+ */
+unsigned int score_generation(void) {
+    return g_atomic_int_get(&generation);
+}
+
+/** announce a change of the scoring state which is not journaled */
+void score_generation_next(void) {
+    g_atomic_int_inc(&generation);
+}
+
+
+/** start recording scoring changes for qso
+ *
+ * Drops the old journal of the qso if there is any */
+void journal_begin(struct qso_t *qso) {
+    journal_free(qso);
+    qso->journal = g_array_new(FALSE, FALSE, sizeof(journal_entry_t));
+    current = &qso->journal;
+}
+
+/** stop recording scoring changes */
+void journal_end(void) {
+    current = NULL;
+}
+
+static void *entry_address(journal_entry_t *entry) {
+    if (entry->base == NULL) {
+	return (void *)entry->offset;
+    }
+    return (char *)*entry->base + entry->offset;
+}
+
+static void save(void **base, size_t offset, size_t len) {
+    journal_entry_t entry;
+
+    g_assert(len <= JOURNAL_DATA_SIZE);
+
+    entry.base = base;
+    entry.offset = offset;
+    entry.len = len;
+    memcpy(entry.data, entry_address(&entry), len);
+    g_array_append_val(*current, entry);
+}
+
+/** save old value of a variable with static storage */
+void journal_save(void *addr, size_t len) {
+    score_generation_next();
+    if (current == NULL) {
+	return;
+    }
+    save(NULL, (size_t)addr, len);
+}
+
+/** save old value of a variable inside a heap block
+ *
+ * The block may be moved by later reallocations, so only its offset
+ * is remembered.
+ * \param base - address of the pointer to the heap block
+ */
+void journal_save_in(void *base, void *addr, size_t len) {
+    score_generation_next();
+    if (current == NULL) {
+	return;
+    }
+    save((void **)base, (char *)addr - *(char **)base, len);
+}
+
+/** restore the scoring state from before the qso was scored
+ *
+ * Must be applied in reverse log order to all QSOs scored after it. */
+void journal_undo(struct qso_t *qso) {
+    if (qso->journal == NULL) {
+	return;
+    }
+
+    score_generation_next();
+    for (int i = qso->journal->len - 1; i >= 0; i--) {
+	journal_entry_t *entry =
+	    &g_array_index(qso->journal, journal_entry_t, i);
+	memcpy(entry_address(entry), entry->data, entry->len);
+    }
+
+    journal_free(qso);
+}
+
+/** drop the journal of the qso */
+void journal_free(struct qso_t *qso) {
+    if (qso->journal != NULL) {
+	g_array_free(qso->journal, TRUE);
+	qso->journal = NULL;
+    }
+}
@@ -0,0 +1,45 @@
+/*
+ * Tlf - contest logging program for amateur radio operators
+ * Copyright (C) 2026 The Tlf developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+/* ------------------------------------------------------------
+ *   journal of scoring contributions of single QSOs
+ *
+ *--------------------------------------------------------------*/
+
+#ifndef SCORE_JOURNAL_H
+#define SCORE_JOURNAL_H
+
+#include <stddef.h>
+
+#include "tlf.h"
+
+void journal_begin(struct qso_t *qso);
+void journal_end(void);
+void journal_save(void *addr, size_t len);
+void journal_save_in(void *base, void *addr, size_t len);
+void journal_undo(struct qso_t *qso);
+void journal_free(struct qso_t *qso);
+unsigned int score_generation(void);
+void score_generation_next(void);
+
+/* remember old value of a variable before it gets changed */
+#define JOURNAL(x) 	  journal_save(&(x), sizeof(x))
+/* same for a variable inside the dynamically allocated worked[] array */
+#define JOURNAL_WORKED(x) journal_save_in(&worked, &(x), sizeof(x))
+
+#endif /* SCORE_JOURNAL_H */
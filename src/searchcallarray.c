@@ -22,54 +22,143 @@
  *
  *--------------------------------------------------------------*/
 
+#include <pthread.h>
 #include <stdbool.h>
 #include <string.h>
 
+#include <glib.h>
+
 #include "bands.h"
 #include "get_time.h"
 #include "getctydata.h"
 #include "globalvars.h"
+#include "score_journal.h"
 #include "tlf.h"
 
+#define WORKED_INITIAL_SIZE 1024
+
+static int worked_size = 0;		/* allocated entries in worked[] */
+static GHashTable *worked_index = NULL;	/* call -> index in worked[] + 1 */
+
+/* guards worked, worked_size and worked_index against the background
+ * thread, which looks up spotted calls while the table may be growing */
+static pthread_mutex_t worked_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 /**	\brief empty collection of worked stations
  */
 void init_worked(void) {
-    memset(worked, 0, sizeof(worked));
+    pthread_mutex_lock(&worked_mutex);
+    if (worked_index != NULL) {
+	g_hash_table_remove_all(worked_index);
+    } else {
+	worked_index = g_hash_table_new_full(g_str_hash, g_str_equal,
+					     g_free, NULL);
+    }
+
+    if (worked_size != WORKED_INITIAL_SIZE) {
+	g_free(worked);
+	worked = g_new0(worked_t, WORKED_INITIAL_SIZE);
+	worked_size = WORKED_INITIAL_SIZE;
+    } else {
+	memset(worked, 0, worked_size * sizeof(worked_t));
+    }
     nr_worked = 0;
+    pthread_mutex_unlock(&worked_mutex);
+}
+
+/* same as lookup_worked(), caller has to hold worked_mutex */
+static int lookup_worked_locked(char *call) {
+
+    if (worked_index == NULL)
+	return -1;
+
+    /* index is stored with an offset of 1 as NULL means 'not found' */
+    int index = GPOINTER_TO_INT(g_hash_table_lookup(worked_index, call)) - 1;
+
+    /* entry may be stale if adding the station was undone meanwhile */
+    if (index < 0 || index >= nr_worked
+	    || strcmp(worked[index].call, call) != 0)
+	return -1;
+
+    return index;
 }
 
 /**	\brief lookup 'hiscall' in array of worked stations
  *
- * 	See if 'hiscall' was already worked by looking it up in worked[]
+ * 	See if 'hiscall' was already worked by looking it up in the index
+ * 	of worked[]
  * 	\param hiscall 	callsign to lookup
  *      \return index in callarray where hiscall was found (-1 if not found)
  */
 int lookup_worked(char *call) {
+    pthread_mutex_lock(&worked_mutex);
+    int index = lookup_worked_locked(call);
+    pthread_mutex_unlock(&worked_mutex);
 
-    int found = -1;
-    int i;
+    return index;
+}
 
-    for (i = 0; i < nr_worked; i++) {
+/**	\brief get a copy of the worked[] entry for 'call'
+ *
+ * 	To be used by all readers outside of the scoring, as a QSO from
+ * 	the LAN may get worked[] reallocated as soon as lookup_worked()
+ * 	returns.
+ * 	\param call 	callsign to lookup
+ * 	\param entry	filled with the entry if found
+ *      \return true if call was found
+ */
+bool copy_worked(char *call, worked_t *entry) {
+    pthread_mutex_lock(&worked_mutex);
+    int index = lookup_worked_locked(call);
+    if (index >= 0) {
+	*entry = worked[index];
+    }
+    pthread_mutex_unlock(&worked_mutex);
+
+    return index >= 0;
+}
 
-	if (strcmp(worked[i].call, call) == 0) {
-	    found = i;
-	    break;
-	}
+/**	\brief get a copy of worked[index], see copy_worked()
+ *
+ *      \return false if there is no such entry
+ */
+bool copy_worked_at(int index, worked_t *entry) {
+    pthread_mutex_lock(&worked_mutex);
+    bool found = (index >= 0 && index < nr_worked);
+    if (found) {
+	*entry = worked[index];
     }
-    return (found);
+    pthread_mutex_unlock(&worked_mutex);
+
+    return found;
 }
 
 
 /* add a new entry for call to the collection */
 static int add_new(char *call) {
+    if (worked_index == NULL)
+	init_worked();
+
+    prefix_data *ctyinfo = getctyinfo(call);
+
+    pthread_mutex_lock(&worked_mutex);
     int i = nr_worked;
 
+    if (nr_worked >= worked_size) {
+	worked = g_renew(worked_t, worked, 2 * worked_size);
+	worked_size *= 2;
+    }
+
     memset(&worked[i], 0, sizeof(worked_t));
     g_strlcpy(worked[i].call, call, sizeof(worked[0].call));
-    worked[i].ctyinfo = getctyinfo(call);
+    worked[i].ctyinfo = ctyinfo;
+    g_hash_table_insert(worked_index, g_strdup(worked[i].call),
+			GINT_TO_POINTER(i + 1));
+    JOURNAL(nr_worked);
     nr_worked++;
+    pthread_mutex_unlock(&worked_mutex);
 
-    return nr_worked - 1;
+    return i;
 }
 
 
@@ -92,38 +181,44 @@ int lookup_or_add_worked(char *call) {
 /* check if station was worked in the current minitest period
  * it takes into account actual mode/band info
  */
-bool worked_in_current_minitest_period(int found) {
+bool entry_in_current_minitest_period(const worked_t *entry) {
 
-    if (found < 0) {
-	return false;
-    }
     if (!minitest) {
 	return true;    // minitest is off, so the answer is yes
     }
 
     long currtime = get_time();
     long period_start = (currtime / minitest) * minitest;
-    return worked[found].qsotime[trxmode][bandinx] >= period_start;
+    return entry->qsotime[trxmode][bandinx] >= period_start;
+}
+
+/* same as above for 'call' */
+bool worked_in_current_minitest_period(char *call) {
+    worked_t entry;
+
+    if (!copy_worked(call, &entry)) {
+	return false;
+    }
+    return entry_in_current_minitest_period(&entry);
 }
 
 
 bool is_dupe(char *call, int bandindex, int mode) {
 
-    int index;
+    worked_t entry;
 
-    index = lookup_worked(call);
-    if (index == -1)	/* new station */
+    if (!copy_worked(call, &entry))	/* new station */
 	return false;
 
     if (!qso_once	/* check band only if qso_once not set */
-	    && ((worked[index].band & inxes[bandindex]) == 0))
+	    && ((entry.band & inxes[bandindex]) == 0))
 	return false;
 
     if (mixedmode	/* check mode only if MIXED is allowed */
-	    && (worked[index].qsotime[mode][bandindex] == 0))
+	    && (entry.qsotime[mode][bandindex] == 0))
 	return false;
 
-    if (!worked_in_current_minitest_period(index))
+    if (!entry_in_current_minitest_period(&entry))
 	return false;
 
     return true;
@@ -133,10 +228,12 @@ bool is_dupe(char *call, int bandindex, int mode) {
 /* update exchange and last worked time for given station */
 void update_worked(int station, struct qso_t *qso) {
     if (strlen(qso->comment) > 0) {
+	JOURNAL_WORKED(worked[station].exchange);
 	g_strlcpy(worked[station].exchange, qso->comment,
 		sizeof(worked[0].exchange));
 	g_strchomp(worked[station].exchange);
     }
+    JOURNAL_WORKED(worked[station].qsotime[qso->mode][qso->bandindex]);
     worked[station].qsotime[qso->mode][qso->bandindex] = qso->timestamp;
 }
 
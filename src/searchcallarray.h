@@ -27,8 +27,11 @@
 
 void init_worked(void);
 int lookup_worked(char *call);
+bool copy_worked(char *call, worked_t *entry);
+bool copy_worked_at(int index, worked_t *entry);
 int lookup_or_add_worked(char *call);
-bool worked_in_current_minitest_period(int found);
+bool worked_in_current_minitest_period(char *call);
+bool entry_in_current_minitest_period(const worked_t *entry);
 bool is_dupe(char *call, int bandindex, int mode);
 void update_worked(int station, struct qso_t *qso);
 
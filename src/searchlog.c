@@ -33,16 +33,20 @@
 #include <string.h>
 #include <unistd.h>
 
+#include "call_index.h"
 #include "dxcc.h"
 #include "err_utils.h"
 #include "getctydata.h"
 #include "getpx.h"
 #include "globalvars.h"
+#include "log_index.h"
 #include "log_utils.h"
 #include "nicebox.h"		// Includes curses.h
 #include "printcall.h"
+#include "qsonr_to_str.h"
 #include "qtcutil.h"
 #include "qtcvars.h"		// Includes globalvars.h
+#include "redraw.h"
 #include "searchlog.h"		// Includes glib.h
 #include "string.h"
 #include "tlf_panel.h"
@@ -61,9 +65,10 @@
 char *callmaster_filename = NULL;
 GPtrArray *callmaster = NULL;
 char callmaster_version[12];   // VERyyyymmdd
+static call_index_t *callmaster_index = NULL;
 
-char searchresult[MAX_CALLS][82];
-char result[MAX_CALLS][82];
+struct qso_t *searchresult[MAX_CALLS];	/* QSOs matching the call */
+char result[MAX_CALLS][82];		/* and their lines in Worked window */
 int srch_index = 0;
 
 char qtcflags[6] = {' ', ' ', ' ', ' ', ' ', ' '};
@@ -74,7 +79,6 @@ static int initialized = 0;
 int nr_bands;
 
 void show_needed_sections(void);
-static bool is_current_mode(const char *line);
 
 /** Check for all band mode
  *
@@ -173,7 +177,7 @@ void displayCallInfo(dxcc_data *dx, char *pxstr) {
 //
 // return: true if display is full
 //
-static bool show_partial(int *row, int *col, char *call,
+static bool show_partial(int *row, int *col, const char *call,
 			 GHashTable *callset,
 			 int *nr_suggested, char *suggested_call) {
 
@@ -190,7 +194,7 @@ static bool show_partial(int *row, int *col, char *call,
 	return true;    // display full
     }
 
-    if (!g_hash_table_add(callset, call)) {
+    if (!g_hash_table_add(callset, (gpointer)call)) {
 	return false;   // already shown
     }
 
@@ -207,11 +211,60 @@ static bool show_partial(int *row, int *col, char *call,
     return false;   // assume it's not full yet
 }
 
+/* state of the partials display for call_index_lookup() */
+struct partials {
+    int row, col;
+    GHashTable *callset;
+    int nr_suggested;
+    char *suggested_call;
+    bool full;
+};
+
+static bool show_master_partial(const char *call, guint id, gpointer data) {
+    struct partials *p = data;
+
+    p->full = show_partial(&p->row, &p->col, call, p->callset,
+			   &p->nr_suggested, p->suggested_call);
+    return p->full;
+}
+
+/* show calls from log and callmaster which have one character wrong,
+ * missing or extra compared to current_qso.call
+ *
+ * They are not counted as suggestions for auto-completion.
+ */
+static void show_near_misses(struct partials *p) {
+    GArray *ids = g_array_new(FALSE, FALSE, sizeof(guint));
+    char near_call[LOGLINELEN + 1];
+    int nr_near = 0;
+
+    log_index_near(current_qso.call, ids);
+    for (guint i = 0; i < ids->len && !p->full; i++) {
+	struct qso_t *qso = g_ptr_array_index(qso_array,
+					      g_array_index(ids, guint, i));
+	if (qso->is_comment) {
+	    continue;
+	}
+	p->full = show_partial(&p->row, &p->col, qso->call, p->callset,
+			       &nr_near, near_call);
+    }
+
+    g_array_set_size(ids, 0);
+    if (callmaster_index != NULL) {
+	call_index_near(callmaster_index, current_qso.call, ids);
+    }
+    for (guint i = 0; i < ids->len && !p->full; i++) {
+	p->full = show_partial(&p->row, &p->col,
+			       CALLMASTERARRAY(g_array_index(ids, guint, i)),
+			       p->callset, &nr_near, near_call);
+    }
+
+    g_array_free(ids, TRUE);
+}
+
 int displayPartials(char *suggested_call) {
 
     int row, col, k;
-    char *loc;
-    char printres[14] = "";
     int suggested = 0;
 
     const int hislen = strlen(current_qso.call);
@@ -254,22 +307,11 @@ int displayPartials(char *suggested_call) {
     int full = 0;
 
     for (k = 0; k < srch_index && !full; k++) {
-	if (strlen(searchresult[k]) <= 2) {
-	    continue;   // too short (unlikely)
-	}
-	if (strstr(searchresult[k], current_qso.call) == NULL) {
+	if (strstr(searchresult[k]->call, current_qso.call) == NULL) {
 	    continue;   // not matching
 	}
 
-	printres[0] = '\0';
-	strncat(printres, searchresult[k] + 29, 12);
-
-	/* cut string just at first space after call */
-	loc = strchr(printres, ' ');
-	if (loc)
-	    *loc = '\0';
-
-	full = show_partial(&row, &col, printres, callset,
+	full = show_partial(&row, &col, searchresult[k]->call, callset,
 			    &suggested, suggested_call);
 
     }
@@ -281,29 +323,26 @@ int displayPartials(char *suggested_call) {
 
     attron(modify_attr(COLOR_PAIR(C_LOG) | A_STANDOUT));
 
-    // make 2 runs: fist look for calls starting with
-    // then the ones containing 'current_qso.call'
-    for (int run = 1; run <= 2; run++) {
-	for (k = 0; k < callmaster->len && !full; k++) {
-
-	    char *mastercall = CALLMASTERARRAY(k);
-
-	    int match;
-	    if (run == 1) { // starts with
-		match = (strncmp(mastercall, current_qso.call, hislen) == 0);
-	    } else {        // contains
-		match = (strstr(mastercall, current_qso.call) != NULL);
-	    }
+    struct partials p = {
+	.row = row, .col = col,
+	.callset = callset,
+	.nr_suggested = suggested,
+	.suggested_call = suggested_call,
+	.full = full,
+    };
+
+    // calls starting with 'current_qso.call' come first,
+    // then the ones containing it
+    if (!p.full && callmaster_index != NULL) {
+	call_index_lookup(callmaster_index, current_qso.call,
+			  show_master_partial, &p);
+    }
+    suggested = p.nr_suggested;
 
-	    if (!match) {
-		continue;   // not matching
-	    }
+    /* and near misses in the rest of the space */
+    attron(modify_attr(COLOR_PAIR(C_HEADER) | A_STANDOUT));
 
-	    full = show_partial(&row, &col, mastercall, callset,
-				&suggested, suggested_call);
-
-	}
-    }
+    show_near_misses(&p);
 
     g_hash_table_destroy(callset);
 
@@ -332,18 +371,22 @@ void handlePartials(void) {
 }
 
 
-/* Parses searchresult and prepare string for searchwindow display from it */
+/* prepare string for searchwindow display from QSO in searchresult */
 void extractData(int index) {
+    struct qso_t *qso = searchresult[index];
+    char timenr[6];
+
+    if (show_time) {	// show qso time
+	sprintf(timenr, "%02d:%02d", qso->hour, qso->min);
+    } else {		// show qso number
+	timenr[0] = ' ';
+	qsonr_to_str(timenr + 1, qso->qso_nr);
+    }
 
-    g_strlcpy(result[index], searchresult[index], 7);    /* band + mode */
-
-    if (show_time) 	// show qso time
-	strncat(result[index], searchresult[index] + 17, 5);
-    else                // show qso number
-	strncat(result[index], searchresult[index] + 22, 5);
-
-    strncat(result[index], searchresult[index] + 28, 12); /* call */
-    strncat(result[index], searchresult[index] + 52, 16); /* exch */
+    snprintf(result[index], sizeof(result[0]), "%s%s%s %-11.11s  %-14.14s",
+	     band[qso->bandindex],
+	     (qso->mode == CWMODE ? "CW " : qso->mode == SSBMODE ? "SSB" : "DIG"),
+	     timenr, qso->call, qso->comment);
 }
 
 
@@ -386,15 +429,20 @@ static bool qso_has_current_mode(const struct qso_t *qso) {
 
 
 /* search complete Log for 'call' as substring in callsign field and
- * copy found QSO to 'searchresults'. Extract relevant data to 'result'.
+ * remember found QSOs in 'searchresult'. Extract relevant data to 'result'.
  */
 void filterLog(const char *call) {
+    GArray *found = g_array_new(FALSE, FALSE, sizeof(guint));
 
     srch_index = 0;
 
-    for (int qso_index = 0; qso_index < NR_QSOS; qso_index++) {
+    log_index_find(call, found);
+
+    for (guint i = 0; i < found->len && srch_index < MAX_CALLS; i++) {
+
+	struct qso_t *qso = g_ptr_array_index(qso_array,
+					      g_array_index(found, guint, i));
 
-	struct qso_t *qso = g_ptr_array_index(qso_array, qso_index);
 	if (qso->is_comment) {
 	    continue;
 	}
@@ -403,56 +451,22 @@ void filterLog(const char *call) {
 	    continue;	// different mode
 	}
 
-	if (strstr(qso->call, call) == 0) {
-	    continue;   // no match
-	}
-
-	g_strlcpy(searchresult[srch_index], QSOS(qso_index), 81);
+	searchresult[srch_index] = qso;
 	extractData(srch_index);
-
-	if (srch_index++ > MAX_CALLS - 1) {
-	    break;
-	}
+	srch_index++;
     }
-}
-
-
-/* helper functions to check filtered lines for match with
- * current_qso.call or actual band */
-static bool call_matches(const char *line) {
-    char buffer[20];
-
-    g_strlcpy(buffer,  line + 12, 20);
-    *strchrnul(buffer, ' ') = '\0';
 
-    return (strcmp(buffer, current_qso.call) == 0);
+    g_array_free(found, TRUE);
 }
 
-static bool band_matches(const char *line) {
-    return log_get_band(line) == bandinx;
-}
 
-//
-// return true if the qso was in the same mode as the current one
-//
-static bool is_current_mode(const char *line) {
-
-    if (!mixedmode) {
-	return true;    // always true if not in mixed mode
-    }
-
-    return log_get_mode(line) == trxmode;
-}
+static bool qso_matches_actual_qso(const struct qso_t *qso) {
 
+    if (strcmp(qso->call, current_qso.call) == 0
+	    && (qso->bandindex == bandinx || qso_once)
+	    && qso_has_current_mode(qso)) {
 
-static bool line_matches_actual_qso(const char *line) {
-
-    if (call_matches(line)
-	    && (band_matches(line) || qso_once)
-	    && is_current_mode(line)) {
-
-	int found = lookup_worked(current_qso.call);
-	if (worked_in_current_minitest_period(found)) {
+	if (worked_in_current_minitest_period(current_qso.call)) {
 	    return true;
 	}
     }
@@ -464,8 +478,7 @@ void displaySearchResults(void) {
 
     int r_index;
     char buffer[LOGLINELEN + 1] = "";
-    char qtccall[15];	// temp str for qtc search
-    int z, l, j;
+    int j;
     struct t_qtc_store_obj *qtc_temp_ptr;
 
 
@@ -473,17 +486,19 @@ void displaySearchResults(void) {
 
     /* print resulting call in line according to band in check window */
     for (r_index = 0; r_index < srch_index; r_index++) {
+	struct qso_t *qso = searchresult[r_index];
+
 	g_strlcpy(buffer, result[r_index], 38);
 
 	wattrset(search_win, COLOR_PAIR(C_WINDOW) | A_STANDOUT);
-	if (!ignoredupe && line_matches_actual_qso(buffer)) {
+	if (!ignoredupe && qso_matches_actual_qso(qso)) {
 	    wattrset(search_win, COLOR_PAIR(C_DUPE));
 	    dupe = ISDUPE;
 	    beep();
 	}
 
 	/* display line in search window */
-	j = bandstr2line(buffer);
+	j = bandstr2line(band[qso->bandindex]);
 
 	if ((j < 7) || IsAllBand()) {
 	    mvwaddstr(search_win, j, 1, buffer);
@@ -492,21 +507,10 @@ void displaySearchResults(void) {
 
 	if ((j > 0) && (j < 7)) {  /* no WARC band */
 	    if (qtcdirection > 0) {
-		qtccall[0] = '\0';
-		z = 12;	// first pos of callsign
-		l = 0;
-		do {
-		    qtccall[l] = buffer[z];
-		    z++; l++;
-		} while (buffer[z] != ' ');
-		qtccall[l] = '\0';
-
-		qtc_temp_ptr = qtc_get(qtccall);
+		qtc_temp_ptr = qtc_get(qso->call);
 		qtcflags[j - 1] = qtc_get_value(qtc_temp_ptr);
 	    }
 	}
-
-	buffer[0] = '\0';
     }
 }
 
@@ -706,7 +710,7 @@ void searchlog() {
 	zone = zone_nr(proposed_exchange); //TODO is this correct?
 	displayWorkedZonesCountries(zone);
 
-	refreshp();
+	redraw_request(REDRAW_SEARCH);
 
 
 	if (partials) {
@@ -738,6 +742,12 @@ static void init_callmaster(void) {
 	g_ptr_array_free(callmaster, TRUE);
     }
     callmaster = g_ptr_array_new_full(CALLMASTER_SIZE, g_free);
+
+    if (callmaster_index) {
+	call_index_clear(callmaster_index);
+    } else {
+	callmaster_index = call_index_new();
+    }
 }
 
 /** loads callmaster database from file
@@ -797,6 +807,7 @@ int load_callmaster(void) {
 	g_hash_table_add(callset, call);
 
 	g_ptr_array_add(callmaster, call);
+	call_index_add(callmaster_index, call);
     }
 
     g_hash_table_destroy(callset);
@@ -857,7 +868,7 @@ void show_needed_sections(void) {
     }
 
     wnicebox(search_win, 0, 0, 6, 37, "Needed Sections");
-    refreshp();
+    redraw_request(REDRAW_SEARCH);
 
 }
 
@@ -24,6 +24,7 @@
 #include <assert.h>
 
 #include "bands.h"
+#include "cat_stats.h"
 #include "cw_utils.h"
 #include "err_utils.h"
 #include "hamlib_keyer.h"
@@ -150,8 +151,11 @@ int init_tlf_rig(void) {
     rigfreq = 0.0;
 
     retcode = rig_get_vfo(my_rig, &vfo); 	/* initialize RIG_VFO_CURR */
-    if (retcode == RIG_OK || retcode == -RIG_ENIMPL || retcode == -RIG_ENAVAIL)
+    if (retcode == RIG_OK || retcode == -RIG_ENIMPL || retcode == -RIG_ENAVAIL) {
+	double start = cat_stats_start();
 	retcode = rig_get_freq(my_rig, RIG_VFO_CURR, &rigfreq);
+	cat_stats_record(CAT_GET_FREQ, start, retcode);
+    }
 
     if (retcode != RIG_OK) {
 	TLF_LOG_WARN("Problem with rig link: %s", rigerror(retcode));
@@ -255,7 +259,9 @@ static void debug_tlf_rig() {
     sleep(10);
 
     pthread_mutex_lock(&rig_lock);
+    double start = cat_stats_start();
     retcode = rig_get_freq(my_rig, RIG_VFO_CURR, &rigfreq);
+    cat_stats_record(CAT_GET_FREQ, start, retcode);
     pthread_mutex_unlock(&rig_lock);
 
     if (retcode != RIG_OK) {
@@ -268,7 +274,9 @@ static void debug_tlf_rig() {
     const freq_t testfreq = 14000000;	// test set frequency
 
     pthread_mutex_lock(&rig_lock);
+    start = cat_stats_start();
     retcode = rig_set_freq(my_rig, RIG_VFO_CURR, testfreq);
+    cat_stats_record(CAT_SET_FREQ, start, retcode);
     pthread_mutex_unlock(&rig_lock);
 
     if (retcode != RIG_OK) {
@@ -278,7 +286,9 @@ static void debug_tlf_rig() {
     }
 
     pthread_mutex_lock(&rig_lock);
+    start = cat_stats_start();
     retcode = rig_get_freq(my_rig, RIG_VFO_CURR, &rigfreq);	// read qrg
+    cat_stats_record(CAT_GET_FREQ, start, retcode);
     pthread_mutex_unlock(&rig_lock);
 
     if (retcode != RIG_OK) {
@@ -52,13 +52,23 @@ void set_tone(void) {
 }
 
 void write_tone(void) {
-
-    if (netkeyer(K_TONE, tonestr) < 0) {
+    if (!send_tone(tonestr)) {
 	TLF_LOG_INFO("keyer not active; switching to SSB");
 	trxmode = SSBMODE;
     }
+}
+
+/** send the sidetone frequency 'tone' to the keyer
+ *
+ * Also used by the keyer thread, so it leaves reporting a failure
+ * to the caller.
+ * \return false if the keyer did not accept the tone
+ */
+bool send_tone(const char *tone) {
+
+    bool ok = (netkeyer(K_TONE, (char *) tone) >= 0);
 
-    if (atoi(tonestr) != 0) {
+    if (atoi(tone) != 0) {
 	/* work around bugs in cwdaemon:
 	 * cwdaemon < 0.9.6 always set volume to 70% at change of tone freq
 	 * cwdaemon >=0.9.6 do not set volume at all after change of freq,
@@ -72,4 +82,5 @@ void write_tone(void) {
 	    netkeyer(K_STVOLUME, "70");
     }
 
+    return ok;
 }
@@ -21,10 +21,13 @@
 #ifndef SET_TONE_H
 #define SET_TONE_H
 
+#include <stdbool.h>
+
 extern char tonestr[];
 
 void set_tone(void);
 void write_tone(void);
+bool send_tone(const char *tone);
 
 
 #endif /* end of include guard: SET_TONE_H */
@@ -29,40 +29,22 @@
 #include "cw_utils.h"
 #include "err_utils.h"
 #include "globalvars.h"
-#include "hamlib_keyer.h"
 #include "netkeyer.h"
 #include "sendbuf.h"
 #include "tlf.h"
 #include "tlf_curses.h"
+#include "write_keyer.h"
 
 
 void setspeed(void) {
 
-    int retval = 0;
     char buff[3];
     int cwspeed = GetCWSpeed();
 
     snprintf(buff, 3, "%2u", cwspeed);
 
-    if (cwkeyer == NET_KEYER) {
-
-	retval = netkeyer(K_SPEED, buff);
-
-	if (retval < 0) {
-	    TLF_LOG_WARN("keyer not active");
-//                      trxmode = SSBMODE;
-	    clear_display();
-	}
-    }
-
-    if (cwkeyer == HAMLIB_KEYER) {
-
-	retval = hamlib_keyer_set_speed(cwspeed);
-
-	if (retval < 0) {
-	    TLF_LOG_WARN("Could not set CW speed: %s", rigerror(retval));
-	    clear_display();
-	}
+    if (cwkeyer == NET_KEYER || cwkeyer == HAMLIB_KEYER) {
+	keyer_set_speed(cwspeed);
     }
 
     if (cwkeyer == MFJ1278_KEYER) {
@@ -27,6 +27,7 @@
 
 #define VERSIONSPLIT "V1.4.1 5/18/96 - N2RJT"
 
+#include <errno.h>
 #include <fcntl.h>
 #include <pthread.h>
 #include <stdlib.h>
@@ -40,12 +41,14 @@
 
 #include "bandmap.h"
 #include "clear_display.h"
+#include "cluster_spots.h"
 #include "globalvars.h"
 #include "get_time.h"
 #include "getwwv.h"
 #include "globalvars.h"		// Includes glib.h and tlf.h
 #include "ignore_unused.h"
 #include "lancode.h"
+#include "redraw.h"
 #include "sockserv.h"
 #include "tlf_curses.h"
 #include "tlf_panel.h"
@@ -60,8 +63,6 @@ struct tln_logline {
 } ;
 
 
-pthread_mutex_t spot_ptr_mutex = PTHREAD_MUTEX_INITIALIZER;
-
 int prsock = 0;
 int fdFIFO = 0;
 
@@ -97,15 +98,17 @@ void addlog(char *s) {
     int len;
     FILE *fp;
     struct tln_logline *temp;
-
-    pthread_mutex_lock(&spot_ptr_mutex);
+    cluster_spot_t spot, first;
 
     for (len = 0; len < strlen(s); len += 80) {
 
-	strncpy(spot_ptr[nr_of_spots], s + len, 82);
-	if (strlen(spot_ptr[nr_of_spots]) > 5) {
+	cluster_spots_add(s + len, &spot);
+	if (len == 0)
+	    first = spot;
+
+	if (strlen(spot.line) > 5) {
 	    lastmsg[0] = '\0';
-	    strncat(lastmsg, spot_ptr[nr_of_spots], 82);
+	    strncat(lastmsg, spot.line, 82);
 	}
 
 	if (clusterlog) {
@@ -121,22 +124,10 @@ void addlog(char *s) {
 	    }
 
 	}
-	nr_of_spots++;
-
-	if (nr_of_spots > MAX_SPOTS - 1) {
-	    int idx;
-	    for (idx = 10; idx <= MAX_SPOTS - 1; idx++)
-		strncpy(spot_ptr[idx - 10], spot_ptr[idx], 82);
-	    for (idx = MAX_SPOTS - 1; idx >= MAX_SPOTS - 11; idx--)
-		spot_ptr[idx][0] = '\0';
-	    nr_of_spots = MAX_SPOTS - 10;
-	}
     }
 
-    pthread_mutex_unlock(&spot_ptr_mutex);
-
-    // \todo drop it later tb mar11
-    bm_add(s);
+    if (len > 0 && first.is_spot)
+	bandmap_addspot(first.call, first.freq, first.node);
 
     wwv_add(s);
 
@@ -646,7 +637,7 @@ void addtext(char *s) {
 	    mvaddstr(LINES - 1, 0, dxtext);
 	    mvaddstr(12, 29, current_qso.call);
 	}
-	refreshp();
+	redraw_request(REDRAW_PACKET);
 
 	spotpointer = strchr(dxtext, ':');
 
@@ -741,7 +732,6 @@ void addtext(char *s) {
 int init_packet(void) {
     struct termios termattribs;
 
-    int iptr = 0;
     mode_t mode = 0666;
 
     tln_input_buffer[0] = '\0';
@@ -891,10 +881,7 @@ int init_packet(void) {
     wprintw(sclwin, "\n Use \":\" to go to tlf !! \n");
     wrefresh(sclwin);
 
-    pthread_mutex_lock(&spot_ptr_mutex);
-    for (iptr = 0; iptr < MAX_SPOTS; iptr++)
-	spot_ptr[iptr][0] = '\0';
-    pthread_mutex_unlock(&spot_ptr_mutex);
+    cluster_spots_clear();
 
     return (0);
 }
@@ -1104,9 +1091,36 @@ int packet() {
 ========================================================
 */
 
+/** file descriptor to wait on for cluster data
+ *
+ * \return -1 if there is none or the packet client reads it itself
+ */
+int packet_fd(void) {
+    int fd = 0;
+
+    if (in_packetclient == 1)
+	return -1;
+
+    if (packetinterface == TELNET_INTERFACE)
+	fd = prsock;
+    else if (packetinterface == TNC_INTERFACE)
+	fd = fdSertnc;
+    else if (packetinterface == FIFO_INTERFACE)
+	fd = fdFIFO;
+
+    return (fd > 0 ? fd : -1);
+}
+
+/** read data from cluster and show it
+ *
+ * \return 1 if a line was read from the telnet connection (more lines
+ *          may be buffered), 0 otherwise, -1 if the connection was closed
+ *          or reading from the TNC or FIFO failed
+ */
 int receive_packet(void) {
     char line[BUFFERSIZE];
     int i = 0;
+    int got_line = 0;
 
     if (in_packetclient == 1)
 	return (0);
@@ -1123,7 +1137,7 @@ int receive_packet(void) {
 		line[i] = '\0';
 		sanitize(line);
 		addtext(line);
-
+		got_line = 1;
 	    }
 	}
     } else if (packetinterface == TNC_INTERFACE) {
@@ -1137,6 +1151,8 @@ int receive_packet(void) {
 		sanitize(line);
 		addtext(line);
 
+	    } else if (i < 0 && errno != EAGAIN && errno != EINTR) {
+		return -1;
 	    }
 	}
     } else if (packetinterface == FIFO_INTERFACE) {
@@ -1149,13 +1165,14 @@ int receive_packet(void) {
 		line[i] = '\0';
 		sanitize(line);
 		addtext(line);
+	    } else if (i < 0 && errno != EAGAIN && errno != EINTR) {
+		return -1;
 	    }
 
 	}
     }
 
-    return (0);
-
+    return got_line;
 }
 
 /* ======================================================
@@ -23,13 +23,13 @@
 #include <stdbool.h>
 
 extern bool lanspotflg;
-extern pthread_mutex_t spot_ptr_mutex;
 
 int init_packet(void) ;
 void cleanup_telnet(void);
 int packet(void);
 void send_to_cluster(char *line);
 void addtext(char *s);
+int packet_fd(void);
 int receive_packet(void);
 void refresh_splitlayout();
 
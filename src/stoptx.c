@@ -22,15 +22,10 @@
 *--------------------------------------------------------------*/
 
 
-#include <hamlib/rig.h>
 #include "audio.h"
-#include "clear_display.h"
-#include "err_utils.h"
 #include "globalvars.h"
-#include "hamlib_keyer.h"
-#include "netkeyer.h"
 #include "tlf.h"
-#include "tlf_curses.h"
+#include "write_keyer.h"
 
 #include "fldigixmlrpc.h"
 
@@ -39,23 +34,7 @@ int stoptx(void) {
     if (digikeyer == FLDIGI && trxmode == DIGIMODE) {
 	fldigi_to_rx();
     } else if (trxmode == CWMODE) {
-	if (cwkeyer == NET_KEYER) {
-
-	    if (netkeyer(K_ABORT, NULL) < 0) {
-
-		TLF_LOG_WARN("keyer not active; switching to SSB");
-		trxmode = SSBMODE;
-		clear_display();
-
-	    }
-	} else if (cwkeyer == HAMLIB_KEYER) {
-
-	    int error = hamlib_keyer_stop();
-	    if (error != RIG_OK) {
-		TLF_LOG_WARN("CW stop error: %s", rigerror(error));
-
-	    }
-	}
+	keyer_abort();
     } else if (trxmode == SSBMODE) {
 	vk_stop();
 	return 0;
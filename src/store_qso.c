@@ -28,12 +28,18 @@
 #include <unistd.h>
 
 #include "globalvars.h"		// Includes glib.h and tlf.h
+#include "log_writer.h"
 #include "tlf_curses.h"
 
 
 void store_qso(const char *file, char *loglineptr) {
     FILE *fp;
 
+    /* append in background if the log writer is running */
+    if (log_writer_append(file, loglineptr)) {
+	return;
+    }
+
     if ((fp = fopen(file, "a"))  == NULL) {
 	fprintf(stdout,  "store_qso.c: Error opening file.\n");
 	sleep(1);
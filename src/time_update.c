@@ -30,18 +30,24 @@
 
 #include "bandmap.h"
 #include "clusterinfo.h"
+#include "err_utils.h"
 #include "freq_display.h"
 #include "get_time.h"
 #include "getwwv.h"
 #include "globalvars.h"		// Includes glib.h and tlf.h
+#include "lan_seq.h"
 #include "lancode.h"
+#include "log_writer.h"
 #include "printcall.h"
+#include "redraw.h"
 #include "setcontest.h"
 #include "showscore.h"
 #include "showinfo.h"
 #include "tlf_curses.h"
 #include "trx_memory.h"
+#include "trx_state.h"
 #include "ui_utils.h"
+#include "write_keyer.h"
 
 /** broadcast to LAN
  *
@@ -53,6 +59,9 @@ void broadcast_lan(void) {
 
     frcounter++;
 
+    if (lan_active && frcounter % 3 == 0)
+	lan_seq_announce();	/* let other nodes find missing messages */
+
     if (frcounter >= 60) {	// every 60 calls
 	frcounter = 0;
 	if (lan_active) {
@@ -85,7 +94,9 @@ void show_freq(void) {
     freq_t memfreq = 0;
 
     if (trx_control) {
-	mvprintw(13, 67, FREQ_DISPLAY_FORMAT, "TRX", freq / 1000.0);
+	trx_state_t trx;
+	trx_state_get(&trx);
+	mvprintw(13, 67, FREQ_DISPLAY_FORMAT, "TRX", trx.freq / 1000.0);
 	memfreq = memory_get_freq();
     } else {
 	mvaddstr(13, 67, spaces(80 - 67));
@@ -97,9 +108,23 @@ void show_freq(void) {
 	mvaddstr(14, 67, spaces(80 - 67));
     }
 
+    redraw_request(REDRAW_FREQ);
 }
 
 
+/* show failures of the log writer thread */
+static void report_log_errors(void) {
+    char *file;
+    int lost;
+
+    int err = log_writer_take_error(&file, &lost);
+    if (err != 0) {
+	TLF_LOG_WARN("Can not write %s: %s, %d lines lost",
+		     file, strerror(err), lost);
+    }
+    g_free(file);
+}
+
 void time_update(void) {
 
     static int s = 0;
@@ -110,11 +135,16 @@ void time_update(void) {
     time_t now = format_time(time_buf, sizeof(time_buf), DATE_TIME_FORMAT);
     int this_second = now % 60;		/* seconds */
 
+    keyer_report_errors();	/* failures of the keyer thread */
+    report_log_errors();	/* and of the log writer */
+
     // force frequency display if it has changed (don't wait until next second)
     static freq_t old_freq = 0;
-    if (freq > 0 && fabs(freq - old_freq) >= 100) {
+    trx_state_t trx;
+    trx_state_get(&trx);
+    if (trx.freq > 0 && fabs(trx.freq - old_freq) >= 100) {
 	force_show_freq = true;
-	old_freq = freq;
+	old_freq = trx.freq;
     }
 
     if (force_show_freq) {
@@ -124,6 +154,7 @@ void time_update(void) {
 
     if (this_second == oldsecs) {   // still in the same second, no action
 	force_show_freq = false;
+	redraw_flush();
 	return;
     }
 
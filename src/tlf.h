@@ -118,9 +118,7 @@ enum {
 #define MAX_CALL_LENGTH 13
 #define MAX_QSOS 20000          /* internal qso array */
 #define MAX_DATALINES 1000      /* from ctydb.dat  */
-#define MAX_CALLS 5000          /* max nr of calls in dupe array */
-#define MAX_MULTS 1000          /* max nr of mults in mults array */
-#define	MAX_SPOTS 200		/* max nr. of spots in spotarray */
+#define MAX_CALLS 5000          /* max nr of calls in search arrays */
 #define CQ_ZONES 40
 #define ITU_ZONES 90
 #define MAX_ZONES (ITU_ZONES + 1) /* size of zones array */
@@ -220,6 +218,7 @@ struct qso_t {
     char *callupdate;           // transient field, used in checkexchange
     char *normalized_comment;   // transient field
     char *section;              // transient field
+    GArray *journal;            // scoring changes, see score_journal.c
 };
 
 
@@ -302,6 +301,13 @@ enum {
     RESEND_FULL,		/* Resend full call again */
 };
 
+/* durability levels for LOG_SYNC */
+enum {
+    LOG_SYNC_QSO,		/* fdatasync after each logged line */
+    LOG_SYNC_INTERVAL,		/* at most every log_sync_interval ms */
+    LOG_SYNC_IDLE,		/* when no more lines are queued */
+};
+
 #define FREE_DYNAMIC_STRING(p)  if (p != NULL) {g_free(p); p = NULL;}
 
 #define LEN(array) (sizeof(array) / sizeof(array[0]))
@@ -0,0 +1,48 @@
+/*
+ * Tlf - contest logging program for amateur radio operators
+ * Copyright (C) 2026 The Tlf developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+/* ------------------------------------------------------------
+ *  Rig state shared between the rig control thread and the
+ *  display.
+ *
+ *  The rig thread publishes a complete record after each read-out,
+ *  readers always get a consistent copy and never wait for the rig.
+ *--------------------------------------------------------------*/
+
+
+#include <pthread.h>
+
+#include "trx_state.h"
+
+
+static pthread_mutex_t state_mutex = PTHREAD_MUTEX_INITIALIZER;
+static trx_state_t current = { .mode = RIG_MODE_NONE };
+
+
+void trx_state_publish(const trx_state_t *state) {
+    pthread_mutex_lock(&state_mutex);
+    current = *state;
+    pthread_mutex_unlock(&state_mutex);
+}
+
+void trx_state_get(trx_state_t *state) {
+    pthread_mutex_lock(&state_mutex);
+    *state = current;
+    pthread_mutex_unlock(&state_mutex);
+}
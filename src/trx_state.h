@@ -0,0 +1,39 @@
+/*
+ * Tlf - contest logging program for amateur radio operators
+ * Copyright (C) 2026 The Tlf developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+
+#ifndef TRX_STATE_H
+#define TRX_STATE_H
+
+#include <stdbool.h>
+
+#include <hamlib/rig.h>
+
+/** state of the rig as last read by the rig control thread */
+typedef struct {
+    freq_t freq;		/* Hz, 0 if unknown */
+    rmode_t mode;
+    int bandinx;
+    bool ptt;			/* CAT PTT active */
+} trx_state_t;
+
+void trx_state_publish(const trx_state_t *state);
+void trx_state_get(trx_state_t *state);
+
+#endif /* TRX_STATE_H */
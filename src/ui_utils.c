@@ -28,6 +28,7 @@
 #include "clusterinfo.h"
 #include "globalvars.h"
 #include "keystroke_names.h"
+#include "redraw.h"
 #include "stoptx.h"
 #include "tlf_panel.h"
 #include "startmsg.h"
@@ -144,6 +145,9 @@ int key_poll() {
 static int getkey(int wait) {
     int x = 0;
 
+    if (wait)
+	redraw_now();	/* nothing may stay pending while we wait */
+
     nodelay(stdscr, wait ? FALSE : TRUE);
 
     x = onechar();
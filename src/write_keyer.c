@@ -18,11 +18,14 @@
  */
 
 
+#include <errno.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <pthread.h>
+#include <sys/eventfd.h>
 #include <glib.h>
 #include <hamlib/rig.h>
 
@@ -32,22 +35,115 @@
 #include "globalvars.h"
 #include "hamlib_keyer.h"
 #include "netkeyer.h"
+#include "set_tone.h"
 #include "tlf.h"
 #include "tlf_curses.h"
+#include "write_keyer.h"
 
 #include "fldigixmlrpc.h"
 
-char wkeyerbuffer[400] = "";
-int data_ready = 0;
+/*
+ * Keyer commands are passed to the keyer thread through a ring buffer.
+ * 'head' is only advanced by the producers, 'tail' only by the keyer
+ * thread, so the keyer side never has to lock. Both count up without
+ * wrapping to the ring size, the slot is the index modulo the size.
+ *
+ * The producers (user interface and cw simulator) serialize among
+ * themselves with 'producer_mutex' which is never held by the keyer.
+ *
+ * Abort and flush do not use a slot: they record the current head as
+ * 'discard_mark' and bump a sequence counter. The keyer thread checks
+ * the counters before each command and drops everything up to the mark.
+ */
+#define KEYER_QUEUE_SIZE    256
+#define KEYER_CHUNK	    400	    /* max. text sent to the keyer at once */
 
-pthread_mutex_t keybuffer_mutex = PTHREAD_MUTEX_INITIALIZER;
+typedef struct {
+    keyer_cmd_type_t type;
+    int value;		/* speed, seconds or mode the text is sent in */
+    char *text;
+} keyer_cmd_t;
+
+static keyer_cmd_t queue[KEYER_QUEUE_SIZE];
+static gint head = 0;
+static gint tail = 0;
+static gint overflows = 0;
+
+static gint discard_mark = 0;
+static gint discard_seq = 0;
+static gint abort_seq = 0;
+
+static pthread_mutex_t producer_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+ * The keyer thread must not touch curses or 'trxmode', text is sent in
+ * the mode it was queued in. The keyer thread records the
+ * last failure in 'error_kind' and 'error_code' and the user interface
+ * reports it from keyer_report_errors().
+ */
+typedef enum {
+    KEYER_ERR_NONE,
+    KEYER_ERR_STOP_NET,		/* netkeyer abort failed, go to SSB */
+    KEYER_ERR_STOP_HAMLIB,
+    KEYER_ERR_SPEED_NET,
+    KEYER_ERR_SPEED_HAMLIB,
+    KEYER_ERR_SEND_HAMLIB,
+    KEYER_ERR_MFJ1278,		/* controller port not writable, go to SSB */
+    KEYER_ERR_NO_MODEM_FILE,
+    KEYER_ERR_TONE_NET,		/* netkeyer tone change failed, go to SSB */
+} keyer_error_t;
+
+static gint error_kind = KEYER_ERR_NONE;
+static gint error_code = 0;
+static gint error_count = 0;
+
+static int wakeup_fd = -1;
+static pthread_t keyer_thread;
+static bool running = false;
+static gint stop_requested = 0;
+
+
+static void keyer_wakeup(void) {
+    if (wakeup_fd >= 0) {
+	uint64_t one = 1;
+	IGNORE(write(wakeup_fd, &one, sizeof(one)));
+    }
+}
+
+/** queue a command for the keyer thread, count it if the queue is full */
+static void keyer_push(keyer_cmd_type_t type, int value, const char *text) {
+    pthread_mutex_lock(&producer_mutex);
+    guint h = (guint) g_atomic_int_get(&head);
+    guint t = (guint) g_atomic_int_get(&tail);
+    if (h - t < KEYER_QUEUE_SIZE) {
+	keyer_cmd_t *cmd = &queue[h % KEYER_QUEUE_SIZE];
+	cmd->type = type;
+	cmd->value = value;
+	cmd->text = g_strdup(text);
+	g_atomic_int_set(&head, (gint)(h + 1));
+    } else {
+	g_atomic_int_inc(&overflows);
+    }
+    pthread_mutex_unlock(&producer_mutex);
+
+    keyer_wakeup();
+}
+
+/** drop everything queued so far, optionally stop sending */
+static void keyer_discard(bool stop) {
+    pthread_mutex_lock(&producer_mutex);
+    g_atomic_int_set(&discard_mark, g_atomic_int_get(&head));
+    g_atomic_int_inc(&discard_seq);
+    if (stop)
+	g_atomic_int_inc(&abort_seq);
+    pthread_mutex_unlock(&producer_mutex);
+
+    keyer_wakeup();
+}
 
 /** append string to key buffer*/
 void keyer_append(const char *string) {
-    pthread_mutex_lock(&keybuffer_mutex);
-    g_strlcat(wkeyerbuffer, string, sizeof(wkeyerbuffer));
-    data_ready = 1;
-    pthread_mutex_unlock(&keybuffer_mutex);
+    keyer_push(KEYER_TEXT, trxmode, string);
 }
 
 /** append char to key buffer*/
@@ -56,42 +152,167 @@ void keyer_append_char(const char c) {
     keyer_append(buf);
 }
 
+/** change CW speed after the text queued so far */
+void keyer_set_speed(int wpm) {
+    keyer_push(KEYER_SPEED, wpm, NULL);
+}
+
+/** change sidetone frequency after the text queued so far */
+void keyer_set_tone(const char *tone) {
+    keyer_push(KEYER_TONE, 0, tone);
+}
+
+/** key the transmitter for 'seconds' */
+void keyer_tune(int seconds) {
+    keyer_push(KEYER_TUNE, seconds, NULL);
+}
+
+/** stop sending at once, pending commands are dropped */
+void keyer_abort(void) {
+    keyer_discard(true);
+}
+
 /** flush key buffer */
 void keyer_flush() {
-    pthread_mutex_lock(&keybuffer_mutex);
-    wkeyerbuffer[0] = '\0';
-    data_ready = 0;
-    pthread_mutex_unlock(&keybuffer_mutex);
+    keyer_discard(false);
 }
 
+/** \return number of commands dropped because the queue was full */
+int keyer_overflows(void) {
+    return g_atomic_int_get(&overflows);
+}
 
-/** write key buffer to keying device
- *
- * should be called periodically from the background task */
-void write_keyer(void) {
+/** \return number of failures reported by the keyer thread */
+int keyer_errors(void) {
+    return g_atomic_int_get(&error_count);
+}
 
-    FILE *bfp = NULL;
-    char outstring[420] =
-	"";	// this was only 120 char length, but wkeyerbuffer is 400
-    char *tosend = NULL;
+/** report the last failure of the keyer thread, if any
+ *
+ * To be called from the user interface loop. */
+void keyer_report_errors(void) {
+    gint kind = g_atomic_int_get(&error_kind);
 
-    if (trxmode != CWMODE && trxmode != DIGIMODE)
+    if (kind == KEYER_ERR_NONE
+	    || !g_atomic_int_compare_and_exchange(&error_kind, kind,
+		    KEYER_ERR_NONE))
 	return;
 
-    pthread_mutex_lock(&keybuffer_mutex);
-    if (data_ready && wkeyerbuffer[0] != 0) {
-	/* allocate a copy of the data and clear the buffer */
-	tosend = g_strdup(wkeyerbuffer);
-	wkeyerbuffer[0] = '\0';
+    int code = g_atomic_int_get(&error_code);
+
+    switch (kind) {
+	case KEYER_ERR_STOP_NET:
+	    TLF_LOG_WARN("keyer not active; switching to SSB");
+	    trxmode = SSBMODE;
+	    clear_display();
+	    break;
+	case KEYER_ERR_STOP_HAMLIB:
+	    TLF_LOG_WARN("CW stop error: %s", rigerror(code));
+	    break;
+	case KEYER_ERR_SPEED_NET:
+	    TLF_LOG_WARN("keyer not active");
+	    clear_display();
+	    break;
+	case KEYER_ERR_SPEED_HAMLIB:
+	    TLF_LOG_WARN("Could not set CW speed: %s", rigerror(code));
+	    clear_display();
+	    break;
+	case KEYER_ERR_SEND_HAMLIB:
+	    TLF_LOG_WARN("CW send error: %s", rigerror(code));
+	    break;
+	case KEYER_ERR_MFJ1278:
+	    TLF_LOG_WARN("1278 not active. Switching to SSB mode.");
+	    trxmode = SSBMODE;
+	    clear_display();
+	    break;
+	case KEYER_ERR_NO_MODEM_FILE:
+	    TLF_LOG_WARN("No modem file specified!");
+	    break;
+	case KEYER_ERR_TONE_NET:
+	    TLF_LOG_INFO("keyer not active; switching to SSB");
+	    trxmode = SSBMODE;
+	    break;
+	default:
+	    break;
+    }
+}
+
+/* called by the keyer thread, the last failure wins */
+static void keyer_error(keyer_error_t kind, int code) {
+    g_atomic_int_set(&error_code, code);
+    g_atomic_int_set(&error_kind, kind);
+    g_atomic_int_inc(&error_count);
+}
+
+
+static bool keyer_pop(keyer_cmd_t *cmd) {
+    guint t = (guint) g_atomic_int_get(&tail);
+    if (t == (guint) g_atomic_int_get(&head))
+	return false;
+    *cmd = queue[t % KEYER_QUEUE_SIZE];
+    g_atomic_int_set(&tail, (gint)(t + 1));
+    return true;
+}
+
+/* \return true if commands were discarded since the last call */
+static bool drop_discarded(void) {
+    static gint discard_seen = 0;
+    keyer_cmd_t cmd;
+
+    gint seq = g_atomic_int_get(&discard_seq);
+    if (seq == discard_seen)
+	return false;
+    discard_seen = seq;
+
+    guint mark = (guint) g_atomic_int_get(&discard_mark);
+    while ((gint)(mark - (guint) g_atomic_int_get(&tail)) > 0
+	    && keyer_pop(&cmd)) {
+	g_free(cmd.text);
+    }
+    return true;
+}
+
+static void stop_keyer(void) {
+    if (cwkeyer == NET_KEYER) {
+	if (netkeyer(K_ABORT, NULL) < 0) {
+	    keyer_error(KEYER_ERR_STOP_NET, 0);
+	}
+    } else if (cwkeyer == HAMLIB_KEYER) {
+	int error = hamlib_keyer_stop();
+	if (error != RIG_OK) {
+	    keyer_error(KEYER_ERR_STOP_HAMLIB, error);
+	}
     }
-    data_ready = 0;
-    pthread_mutex_unlock(&keybuffer_mutex);
+}
+
+static void set_keyer_speed(int wpm) {
+    int retval;
 
-    if (tosend == NULL) {
-	return;     // nothing to do
+    if (cwkeyer == NET_KEYER) {
+	char buff[3];
+	snprintf(buff, sizeof(buff), "%2u", wpm);
+	retval = netkeyer(K_SPEED, buff);
+	if (retval < 0) {
+	    keyer_error(KEYER_ERR_SPEED_NET, retval);
+	}
+    } else if (cwkeyer == HAMLIB_KEYER) {
+	retval = hamlib_keyer_set_speed(wpm);
+	if (retval < 0) {
+	    keyer_error(KEYER_ERR_SPEED_HAMLIB, retval);
+	}
     }
+}
+
+/** send text to the keying device, 'mode' is trxmode when it was queued */
+static void send_text(char *tosend, int mode) {
+
+    FILE *bfp = NULL;
+    char outstring[KEYER_CHUNK + 20] = "";
 
-    if (digikeyer == FLDIGI && trxmode == DIGIMODE) {
+    if (mode != CWMODE && mode != DIGIMODE)
+	return;
+
+    if (digikeyer == FLDIGI && mode == DIGIMODE) {
 	fldigi_send_text(tosend);
     } else if (cwkeyer == NET_KEYER) {
 	netkeyer(K_MESSAGE, tosend);
@@ -107,13 +328,11 @@ void write_keyer(void) {
 
 	int error = hamlib_keyer_send(tosend);
 	if (error != RIG_OK) {
-	    TLF_LOG_WARN("CW send error: %s", rigerror(error));
+	    keyer_error(KEYER_ERR_SEND_HAMLIB, error);
 	}
     } else if (cwkeyer == MFJ1278_KEYER || digikeyer == MFJ1278_KEYER) {
 	if ((bfp = fopen(controllerport, "a")) == NULL) {
-	    TLF_LOG_WARN("1278 not active. Switching to SSB mode.");
-	    trxmode = SSBMODE;
-	    clear_display();
+	    keyer_error(KEYER_ERR_MFJ1278, 0);
 	} else {
 	    fputs(tosend, bfp);
 	    fclose(bfp);
@@ -121,16 +340,138 @@ void write_keyer(void) {
 
     } else if (digikeyer == GMFSK) {
 	if (strlen(rttyoutput) < 2) {
-	    TLF_LOG_WARN("No modem file specified!");
+	    keyer_error(KEYER_ERR_NO_MODEM_FILE, 0);
 	}
 	// when GMFSK used (possible Fldigi interface), the trailing \n doesn't need
 	if (tosend[strlen(tosend) - 1] == '\n') {
 	    tosend[strlen(tosend) - 1] = '\0';
 	}
-	sprintf(outstring, "echo -n \"\n%s\" >> %s",
-		tosend, rttyoutput);
+	snprintf(outstring, sizeof(outstring), "echo -n \"\n%s\" >> %s",
+		 tosend, rttyoutput);
 	IGNORE(system(outstring));;
     }
+}
+
+static void flush_text(GString *text, int mode) {
+    if (text->len > 0) {
+	send_text(text->str, mode);
+	g_string_truncate(text, 0);
+    }
+}
+
+/** execute all queued keyer commands
+ *
+ * Runs in the keyer thread. Consecutive text commands are sent to the
+ * keying device in one go. */
+void write_keyer(void) {
+    static gint abort_seen = 0;
+    GString *text = g_string_new(NULL);
+    int text_mode = CWMODE;
+    keyer_cmd_t cmd;
+
+    while (true) {
+	gint seq = g_atomic_int_get(&abort_seq);
+	if (seq != abort_seen) {
+	    abort_seen = seq;
+	    g_string_truncate(text, 0);
+	    stop_keyer();
+	}
+	if (drop_discarded()) {
+	    /* text collected so far was queued before the flush */
+	    g_string_truncate(text, 0);
+	}
+
+	if (!keyer_pop(&cmd))
+	    break;
+
+	if (cmd.type == KEYER_TEXT) {
+	    if (text->len + strlen(cmd.text) > KEYER_CHUNK
+		    || cmd.value != text_mode)
+		flush_text(text, text_mode);
+	    text_mode = cmd.value;
+	    g_string_append(text, cmd.text);
+	    g_free(cmd.text);
+	    continue;
+	}
+
+	flush_text(text, text_mode);
+
+	switch (cmd.type) {
+	    case KEYER_SPEED:
+		set_keyer_speed(cmd.value);
+		break;
+	    case KEYER_TONE:
+		if (!send_tone(cmd.text)) {
+		    keyer_error(KEYER_ERR_TONE_NET, 0);
+		}
+		break;
+	    case KEYER_TUNE: {
+		char buff[8];
+		snprintf(buff, sizeof(buff), "%d", cmd.value);
+		netkeyer(K_TUNE, buff);
+		break;
+	    }
+	    default:
+		break;
+	}
+	g_free(cmd.text);
+    }
+
+    flush_text(text, text_mode);
+    g_string_free(text, TRUE);
+}
+
+
+static void *keyer_thread_main(void *arg) {
+    uint64_t count;
+
+    while (!g_atomic_int_get(&stop_requested)) {
+	if (read(wakeup_fd, &count, sizeof(count)) < 0 && errno != EINTR) {
+	    perror("keyer wakeup");
+	    break;
+	}
+	if (g_atomic_int_get(&stop_requested))
+	    break;
+
+	write_keyer();
+    }
+    return NULL;
+}
+
+/** start the keyer thread
+ *
+ * \return false if the thread could not be started */
+bool keyer_thread_start(void) {
+    if (running)
+	return true;
+
+    wakeup_fd = eventfd(0, EFD_CLOEXEC);
+    if (wakeup_fd < 0) {
+	perror("eventfd: keyer");
+	return false;
+    }
+
+    g_atomic_int_set(&stop_requested, 0);
+    if (pthread_create(&keyer_thread, NULL, keyer_thread_main, NULL) != 0) {
+	perror("pthread_create: keyer");
+	close(wakeup_fd);
+	wakeup_fd = -1;
+	return false;
+    }
+    running = true;
+    return true;
+}
+
+/** stop the keyer thread, text not yet sent is dropped */
+void keyer_thread_stop(void) {
+    if (!running || pthread_equal(pthread_self(), keyer_thread))
+	return;
+
+    g_atomic_int_set(&stop_requested, 1);
+    keyer_wakeup();
+    pthread_join(keyer_thread, NULL);
+    running = false;
 
-    g_free(tosend);
+    close(wakeup_fd);
+    wakeup_fd = -1;
 }
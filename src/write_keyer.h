@@ -21,9 +21,28 @@
 #ifndef WRITE_KEYER_H
 #define WRITE_KEYER_H
 
+#include <stdbool.h>
+
+typedef enum {
+    KEYER_TEXT,		/* send text */
+    KEYER_SPEED,	/* change CW speed */
+    KEYER_TONE,		/* change sidetone frequency */
+    KEYER_TUNE,		/* key the transmitter for some seconds */
+} keyer_cmd_type_t;
+
 void keyer_append(const char *string);
 void keyer_append_char(const char c);
+void keyer_set_speed(int wpm);
+void keyer_set_tone(const char *tone);
+void keyer_tune(int seconds);
+void keyer_abort(void);
 void keyer_flush();
+int keyer_overflows(void);
+int keyer_errors(void);
+void keyer_report_errors(void);
 void write_keyer(void);
 
+bool keyer_thread_start(void);
+void keyer_thread_stop(void);
+
 #endif /* WRITE_KEYER_H */
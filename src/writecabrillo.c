@@ -36,6 +36,7 @@
 #include "globalvars.h"
 #include "get_time.h"
 #include "log_utils.h"
+#include "log_writer.h"
 #include "tlf_curses.h"
 #include "ui_utils.h"
 #include "utils.h"
@@ -522,6 +523,7 @@ int write_cabrillo(void) {
     }
 
     /* open logfile and create a Cabrillo file */
+    log_writer_flush();
     if ((fp1 = fopen(logfile, "r")) == NULL) {
 	info("Can't open logfile.");
 	sleep(2);
@@ -779,6 +781,7 @@ int write_adif(void) {
 
     FILE *fp1, *fp2;
 
+    log_writer_flush();
     if ((fp1 = fopen(logfile, "r")) == NULL) {
 	info("Opening logfile not possible.");
 	sleep(2);
@@ -0,0 +1,273 @@
+/*
+ * Tlf - contest logging program for amateur radio operators
+ * Copyright (C) 2026 The Tlf developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+/* ------------------------------------------------------------
+ *        bandmap ingestion benchmark
+ *
+ *   Feeds synthetic skimmer "DX de" lines through bm_add() against a
+ *   preloaded CQWW log, ages the bandmap every simulated second and
+ *   filters it like the display does. Reports throughput, latency
+ *   per spot and the time bm_mutex was held.
+ *
+ *   usage: bench_bandmap [-n spots] [-r spots/s] [-q qsos] [-s seed]
+ *
+ *--------------------------------------------------------------*/
+
+#include "test.h"
+
+#include <getopt.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../src/bandmap.h"
+#include "../src/bands.h"
+#include "../src/dxcc.h"
+#include "../src/getctydata.h"
+#include "../src/globalvars.h"
+#include "../src/searchcallarray.h"
+#include "../src/setcontest.h"
+
+/* linked like the test groups, see Makefile.am */
+void filter_spots();
+extern GPtrArray *spots;
+extern GSequence *allspots;
+extern pthread_mutex_t bm_mutex;
+
+/* not needed for CQWW and without display */
+void checkexchange(struct qso_t *qso, bool interactive) {}
+int check_mult(struct qso_t *qso) { return -1; }
+int pacc_pa(void) { return 0; }
+void clear_display() {}
+void background_wakeup(void) {}
+struct t_qtc_store_obj *qtc_get(char callsign[15]) { return NULL; }
+char qtc_get_value(struct t_qtc_store_obj *qtc_obj) { return '\0'; }
+int modify_attr(int attr) { return attr; }
+char thisnode = 'A';
+bool grab_up = true;
+
+#define NR_ACTIVE 3000		/* stations active on the bands */
+
+static const char *prefixes[] = {
+    "DL", "G", "F", "I", "EA", "OK", "SP", "HA", "YO", "LZ", "OH", "SM",
+    "K", "W", "N", "VE", "JA", "VK", "ZS", "PY", "LU", "UA", "UA9", "4X",
+};
+#define NR_PREFIXES (sizeof(prefixes) / sizeof(prefixes[0]))
+
+static const int cw_bands[] = {
+    BANDINDEX_160, BANDINDEX_80, BANDINDEX_40, BANDINDEX_20,
+    BANDINDEX_15, BANDINDEX_10
+};
+#define NR_BANDS (sizeof(cw_bands) / sizeof(cw_bands[0]))
+
+typedef struct {
+    char call[16];
+    int band;
+    int freq;
+} station_t;
+
+static station_t stations[NR_ACTIVE];
+
+/* time spent holding bm_mutex, measured by wrapping pthread_mutex_* */
+static struct timespec lock_start;
+static double locked_total = 0;
+static double locked_max = 0;
+
+int __real_pthread_mutex_lock(pthread_mutex_t *mutex);
+int __real_pthread_mutex_unlock(pthread_mutex_t *mutex);
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int __wrap_pthread_mutex_lock(pthread_mutex_t *mutex) {
+    int rc = __real_pthread_mutex_lock(mutex);
+    if (mutex == &bm_mutex)
+	clock_gettime(CLOCK_MONOTONIC, &lock_start);
+    return rc;
+}
+
+int __wrap_pthread_mutex_unlock(pthread_mutex_t *mutex) {
+    if (mutex == &bm_mutex) {
+	double held = now() - (lock_start.tv_sec + lock_start.tv_nsec / 1e9);
+	locked_total += held;
+	if (held > locked_max)
+	    locked_max = held;
+    }
+    return __real_pthread_mutex_unlock(mutex);
+}
+
+static void make_call(char *call, GRand *rand) {
+    sprintf(call, "%s%d%c%c%c",
+	    prefixes[g_rand_int_range(rand, 0, NR_PREFIXES)],
+	    g_rand_int_range(rand, 0, 10),
+	    'A' + g_rand_int_range(rand, 0, 26),
+	    'A' + g_rand_int_range(rand, 0, 26),
+	    'A' + g_rand_int_range(rand, 0, 26));
+}
+
+static int random_freq(int band, GRand *rand) {
+    /* somewhere in the lower 40 kHz, the CW part of the band */
+    return bandcorner[band][0] + g_rand_int_range(rand, 1000, 40000);
+}
+
+/* score part of the active stations as worked */
+static void preload_log(int nr_qsos, GRand *rand) {
+    init_worked();
+
+    for (int i = 0; i < nr_qsos; i++) {
+	station_t *st = &stations[g_rand_int_range(rand, 0, NR_ACTIVE)];
+	int band = cw_bands[g_rand_int_range(rand, 0, NR_BANDS)];
+	int index = lookup_or_add_worked(st->call);
+	int cty = getctynr(st->call);
+
+	worked[index].band |= inxes[band];
+	countries[cty] |= inxes[band];
+	zones[dxcc_by_index(cty)->cq] |= inxes[band];
+    }
+}
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void usage(void) {
+    fprintf(stderr,
+	    "usage: bench_bandmap [-n spots] [-r spots/s] [-q qsos] [-s seed]\n");
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char **argv) {
+    int nr_spots = 50000;
+    int rate = 0;		/* as fast as possible */
+    int nr_qsos = 5000;
+    int seed = 1;
+    int c;
+
+    while ((c = getopt(argc, argv, "n:r:q:s:")) != -1) {
+	switch (c) {
+	    case 'n':
+		nr_spots = atoi(optarg);
+		break;
+	    case 'r':
+		rate = atoi(optarg);
+		break;
+	    case 'q':
+		nr_qsos = atoi(optarg);
+		break;
+	    case 's':
+		seed = atoi(optarg);
+		break;
+	    default:
+		usage();
+	}
+    }
+    if (nr_spots <= 0 || rate < 0 || nr_qsos < 0)
+	usage();
+
+    if (load_ctydata(TOP_SRCDIR "/share/cty.dat") != 0) {
+	fprintf(stderr, "can not load cty.dat\n");
+	return EXIT_FAILURE;
+    }
+    setcontest("CQWW");
+    bm_config.lifetime = 900;
+    bm_config.allband = 1;
+    bm_config.allmode = 1;
+    bm_config.showdupes = 1;
+
+    GRand *rand = g_rand_new_with_seed(seed);
+    for (int i = 0; i < NR_ACTIVE; i++) {
+	make_call(stations[i].call, rand);
+	stations[i].band = cw_bands[g_rand_int_range(rand, 0, NR_BANDS)];
+	stations[i].freq = random_freq(stations[i].band, rand);
+    }
+    preload_log(nr_qsos, rand);
+
+    /* one simulated second per 'rate' spots, or per 100 spots */
+    int per_second = (rate > 0 ? rate : 100);
+    double *latency = g_new(double, nr_spots);
+    char line[100];
+
+    locked_total = locked_max = 0;
+    double start = now();
+    double busy = 0;
+
+    for (int i = 0; i < nr_spots; i++) {
+	station_t *st = &stations[g_rand_int_range(rand, 0, NR_ACTIVE)];
+
+	/* most spots are respots, some stations QSY */
+	if (g_rand_int_range(rand, 0, 20) == 0)
+	    st->freq = random_freq(st->band, rand);
+	int freq = st->freq + g_rand_int_range(rand, -50, 51);
+
+	snprintf(line, sizeof(line),
+		 "DX de %-9.9s %8.1f  %-12s CW %2d dB %2d WPM CQ      %04dZ",
+		 "SKIMMER-#:", freq / 1000.0, st->call,
+		 g_rand_int_range(rand, 3, 40), g_rand_int_range(rand, 18, 40),
+		 i % 2400);
+
+	if (rate > 0) {
+	    double due = start + (double)i / rate;
+	    double wait = due - now();
+	    if (wait > 0)
+		g_usleep(wait * 1e6);
+	}
+
+	double t0 = now();
+	bm_add(line);
+	latency[i] = now() - t0;
+	busy += latency[i];
+
+	if ((i + 1) % per_second == 0) {
+	    double t1 = now();
+	    bandmap_age();
+	    filter_spots();
+	    busy += now() - t1;
+	}
+    }
+    double elapsed = now() - start;
+    double locked = locked_total;
+
+    filter_spots();
+    qsort(latency, nr_spots, sizeof(double), cmp_double);
+
+    if (rate > 0)
+	printf("bandmap: %d spots, %d QSOs in log, rate %d/s\n",
+	       nr_spots, nr_qsos, rate);
+    else
+	printf("bandmap: %d spots, %d QSOs in log, rate unlimited\n",
+	       nr_spots, nr_qsos);
+    printf("  throughput      %10.0f spots/s\n", nr_spots / busy);
+    printf("  latency p50     %10.2f us\n", latency[nr_spots / 2] * 1e6);
+    printf("  latency p99     %10.2f us\n",
+	   latency[(int)(nr_spots * 0.99)] * 1e6);
+    printf("  latency max     %10.2f us\n", latency[nr_spots - 1] * 1e6);
+    printf("  bm_mutex held   %10.2f ms (%.1f%% of %.2f s), max %.2f ms\n",
+	   locked * 1e3, 100 * locked / elapsed, elapsed,
+	   locked_max * 1e3);
+    printf("  spots           %10d in bandmap, %d shown\n",
+	   g_sequence_get_length(allspots), spots->len);
+
+    g_free(latency);
+    g_rand_free(rand);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,127 @@
+/*
+ * Tlf - contest logging program for amateur radio operators
+ * Copyright (C) 2026 The Tlf developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+/* ------------------------------------------------------------
+ *        country lookup benchmark
+ *
+ *   Looks up a mix of plain and portable calls, as seen in logs and
+ *   spots, with getctynr() and getctydata() and reports lookups per
+ *   second. Also reports the time to load cty.dat from text and from
+ *   the binary cache.
+ *
+ *   usage: bench_getctydata [-n lookups]
+ *
+ *--------------------------------------------------------------*/
+
+#include "test.h"
+
+#include <getopt.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../src/dxcc.h"
+#include "../src/getctydata.h"
+#include "../src/globalvars.h"
+#include "../src/readctydata.h"
+#include "../src/setcontest.h"
+
+void checkexchange(struct qso_t *qso, bool interactive) {}
+int check_mult(struct qso_t *qso) { return -1; }
+int pacc_pa(void) { return 0; }
+void clear_display() {}
+
+static const char *calls[] = {
+    "DL1ABC", "K1ABC", "JA1XYZ", "VK2ABC", "PY2AAA", "EA8XYZ", "4U1UN",
+    "LA3BB/P", "DL1ABC/QRP", "W1AW/4", "G4ABC/M", "LA3BB/MM", "K1ABC/AM",
+    "PA/DJ0LN/P", "DJ/PA3LM", "DL1ABC/PA", "R3A/PA", "K32A/4", "KL7ND",
+    "9A70DP/KA", "OH0/DL1ABC", "F/ON4XYZ/P", "VP2E/W1ABC", "DJ0LN/PA/P",
+};
+#define NR_CALLS (sizeof(calls) / sizeof(calls[0]))
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void run(const char *name, int (*lookup)(char *), int n) {
+    char call[20];
+    int found = 0;
+
+    double start = now();
+    for (int i = 0; i < n; i++) {
+	strcpy(call, calls[i % NR_CALLS]);
+	if (lookup(call) > 0)
+	    found++;
+    }
+    double elapsed = now() - start;
+
+    printf("  %-12s %10.0f lookups/s (%d of %d found)\n",
+	   name, n / elapsed, found, n);
+}
+
+int main(int argc, char **argv) {
+    int n = 1000000;
+    int c;
+
+    while ((c = getopt(argc, argv, "n:")) != -1) {
+	switch (c) {
+	    case 'n':
+		n = atoi(optarg);
+		break;
+	    default:
+		fprintf(stderr, "usage: bench_getctydata [-n lookups]\n");
+		return EXIT_FAILURE;
+	}
+    }
+
+    char cachefile[] = "/tmp/bench_cty_XXXXXX";
+    int fd = mkstemp(cachefile);
+    if (fd < 0) {
+	perror("mkstemp");
+	return EXIT_FAILURE;
+    }
+    close(fd);
+
+    double start = now();
+    if (load_ctydata(TOP_SRCDIR "/share/cty.dat") != 0) {
+	fprintf(stderr, "can not load cty.dat\n");
+	return EXIT_FAILURE;
+    }
+    double text = now() - start;
+
+    load_ctydata_cached(TOP_SRCDIR "/share/cty.dat", cachefile);  // write
+    start = now();
+    load_ctydata_cached(TOP_SRCDIR "/share/cty.dat", cachefile);
+    double cached = now() - start;
+    bool used_cache = dxcc_cached();
+    unlink(cachefile);
+
+    printf("cty.dat load: text %.2f ms, cache %.2f ms%s\n",
+	   text * 1e3, cached * 1e3, used_cache ? "" : " (cache not used!)");
+
+    setcontest("qso");
+
+    printf("country lookup: %d lookups over %d calls\n", n, (int)NR_CALLS);
+    run("getctynr", getctynr, n);
+    run("getctydata", getctydata, n);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,201 @@
+/*
+ * Tlf - contest logging program for amateur radio operators
+ * Copyright (C) 2026 The Tlf developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+/* ------------------------------------------------------------
+ *        partials and near miss benchmark
+ *
+ *   Indexes the calls from share/callmaster and looks up calls with
+ *   one random character changed, dropped or added. Reports the time
+ *   per near miss lookup with the index, for checking every call with
+ *   the edit distance kernel and for the partials lookup.
+ *
+ *   usage: bench_partials [-n lookups] [-s seed] [-f callmaster]
+ *
+ *--------------------------------------------------------------*/
+
+#include "test.h"
+
+#include <getopt.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../src/call_index.h"
+
+void checkexchange(struct qso_t *qso, bool interactive) {}
+int check_mult(struct qso_t *qso) { return -1; }
+int pacc_pa(void) { return 0; }
+void clear_display() {}
+
+static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static GPtrArray *read_calls(const char *filename) {
+    char buffer[100];
+    FILE *fp = fopen(filename, "r");
+
+    if (fp == NULL) {
+	return NULL;
+    }
+
+    GPtrArray *calls = g_ptr_array_new_with_free_func(g_free);
+    while (fgets(buffer, sizeof(buffer), fp) != NULL) {
+	g_strstrip(buffer);
+	if (buffer[0] == '#' || strlen(buffer) < 3) {
+	    continue;
+	}
+	g_ptr_array_add(calls, g_ascii_strup(buffer, 11));
+    }
+    fclose(fp);
+
+    return calls;
+}
+
+/* copy call with one character changed, dropped or added */
+static void bust(char *out, const char *call, GRand *rand) {
+    int len = strlen(call);
+    int pos = g_rand_int_range(rand, 0, len);
+    char c = alphabet[g_rand_int_range(rand, 0, sizeof(alphabet) - 1)];
+
+    switch (g_rand_int_range(rand, 0, 3)) {
+	case 0:		/* changed */
+	    strcpy(out, call);
+	    out[pos] = c;
+	    break;
+	case 1:		/* dropped */
+	    memcpy(out, call, pos);
+	    strcpy(out + pos, call + pos + 1);
+	    break;
+	default:	/* added */
+	    memcpy(out, call, pos);
+	    out[pos] = c;
+	    strcpy(out + pos + 1, call + pos);
+	    break;
+    }
+}
+
+static bool count_partial(const char *call, guint id, gpointer data) {
+    (*(int *)data)++;
+    return false;
+}
+
+int main(int argc, char **argv) {
+    const char *filename = TOP_SRCDIR "/share/callmaster";
+    int n = 2000;
+    guint32 seed = 1;
+    int c;
+
+    while ((c = getopt(argc, argv, "n:s:f:")) != -1) {
+	switch (c) {
+	    case 'n':
+		n = atoi(optarg);
+		break;
+	    case 's':
+		seed = atoi(optarg);
+		break;
+	    case 'f':
+		filename = optarg;
+		break;
+	    default:
+		fprintf(stderr,
+			"usage: bench_partials [-n lookups] [-s seed] [-f callmaster]\n");
+		return EXIT_FAILURE;
+	}
+    }
+
+    GPtrArray *calls = read_calls(filename);
+    if (calls == NULL) {
+	fprintf(stderr, "can not read %s\n", filename);
+	return EXIT_FAILURE;
+    }
+
+    double start = now();
+    call_index_t *index = call_index_new();
+    for (guint i = 0; i < calls->len; i++) {
+	call_index_add(index, g_ptr_array_index(calls, i));
+    }
+    double build = now() - start;
+
+    /* busted calls to look up */
+    GRand *rand = g_rand_new_with_seed(seed);
+    char (*busted)[16] = g_malloc(n * sizeof(*busted));
+    for (int i = 0; i < n; i++) {
+	const char *call = g_ptr_array_index(calls,
+					     g_rand_int_range(rand, 0, calls->len));
+	bust(busted[i], call, rand);
+    }
+
+    GArray *ids = g_array_new(FALSE, FALSE, sizeof(guint));
+    long found = 0;
+
+    start = now();
+    for (int i = 0; i < n; i++) {
+	g_array_set_size(ids, 0);
+	call_index_near(index, busted[i], ids);
+	found += ids->len;
+    }
+    double indexed = now() - start;
+
+    long found_scan = 0;
+    start = now();
+    for (int i = 0; i < n; i++) {
+	int len = strlen(busted[i]);
+	if (len < NEAR_MIN_LEN) {
+	    continue;
+	}
+	for (guint k = 0; k < calls->len; k++) {
+	    const char *call = g_ptr_array_index(calls, k);
+	    int d = strlen(call) - len;
+	    if (d >= -1 && d <= 1 && call_distance(busted[i], call) == 1) {
+		found_scan++;
+	    }
+	}
+    }
+    double scan = now() - start;
+
+    int partials = 0;
+    start = now();
+    for (int i = 0; i < n; i++) {
+	char part[4];
+	g_strlcpy(part, busted[i], sizeof(part));
+	call_index_lookup(index, part, count_partial, &partials);
+    }
+    double partial = now() - start;
+
+    printf("partials: %u calls from %s, index built in %.1f ms\n",
+	   calls->len, filename, build * 1e3);
+    printf("  near miss, index  %8.2f us/lookup (%ld found)\n",
+	   indexed / n * 1e6, found);
+    printf("  near miss, scan   %8.2f us/lookup (%ld found)\n",
+	   scan / n * 1e6, found_scan);
+    printf("  partials (3 chr)  %8.2f us/lookup (%d found)\n",
+	   partial / n * 1e6, partials);
+
+    g_array_free(ids, TRUE);
+    g_free(busted);
+    g_rand_free(rand);
+    call_index_free(index);
+    g_ptr_array_free(calls, TRUE);
+
+    return (found == found_scan ? EXIT_SUCCESS : EXIT_FAILURE);
+}
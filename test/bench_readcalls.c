@@ -0,0 +1,216 @@
+/*
+ * Tlf - contest logging program for amateur radio operators
+ * Copyright (C) 2026 The Tlf developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+/* ------------------------------------------------------------
+ *        log rescoring benchmark
+ *
+ *   Writes a synthetic CQWW log with calls from the callmaster file
+ *   and reports the time readcalls() takes to score it with different
+ *   numbers of worker threads and with a checkpoint of the first part.
+ *
+ *   usage: bench_readcalls [-n qsos]
+ *
+ *--------------------------------------------------------------*/
+
+#include "test.h"
+
+#include <getopt.h>
+#include <glob.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../src/dxcc.h"
+#include "../src/globalvars.h"
+#include "../src/log_utils.h"
+#include "../src/readcalls.h"
+#include "../src/score_checkpoint.h"
+#include "../src/setcontest.h"
+#include "../src/showscore.h"
+
+char thisnode = 'A';
+bool lan_active = false;
+
+void readqtccalls() {}
+void clear_display(void) {}
+void OnLowerSearchPanel(int x, char *str) {}
+int recall_exchange() { return -1; }
+void refresh_comment() {}
+void time_update() {}
+void show_rtty() {}
+void keyer() {}
+void send_standard_message(int msg) {}
+void send_standard_message_prev_qso(int msg) {}
+void stoptx() {}
+void background_wakeup(void) {}
+void qtc_main_panel(int direction) {}
+void add_local_spot() {}
+void sendmessage(const char *msg) {}
+void printcall(const char *msg) {}
+unsigned int GetCWSpeed() { return 10; }
+int speedup() { return 12; }
+int speeddown() { return 8; }
+void rst_recv_up() {}
+void rst_recv_down() {}
+void vk_play_file(char *audiofile) {}
+int send_lan_message(int opcode, char *message) { return 0; }
+void cleanup_comment() {}
+void restore_comment() {}
+void cleanup_hiscall() {}
+void rst_reset() {}
+void shownr(char *msg, int x) {}
+void clusterinfo(void) {}
+void refresh_splitlayout() {}
+int last10() { return 0; }
+int pacc_pa(void) { return 0; }
+
+#define LOGFILE	"bench_readcalls.log"
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static GPtrArray *read_calls(void) {
+    GPtrArray *calls = g_ptr_array_new_with_free_func(g_free);
+    char line[80];
+
+    FILE *fp = fopen(TOP_SRCDIR "/share/callmaster", "r");
+    if (fp == NULL) {
+	return calls;
+    }
+    while (fgets(line, sizeof(line), fp) != NULL) {
+	g_strstrip(line);
+	if (line[0] != '#' && line[0] != '\0') {
+	    g_ptr_array_add(calls, g_strdup(line));
+	}
+    }
+    fclose(fp);
+    return calls;
+}
+
+/* about every 3rd call gets worked again, some of them on the same band */
+static void write_log(GPtrArray *calls, int n) {
+    static const int bands[] = { 160, 80, 40, 20, 15, 10 };
+    char line[100];
+
+    FILE *fp = fopen(LOGFILE, "w");
+    for (int i = 0; i < n; i++) {
+	const char *call = g_ptr_array_index(calls,
+					     (i * 7919) % (calls->len * 2 / 3 + 1));
+	sprintf(line, "%3dCW  12-Jan-18 %02d:%02d %04d  %-15s599  599  %-2d",
+		bands[i / 50 % 6], i / 60 % 24, i % 60, i % 10000, call,
+		1 + i % 40);
+	fprintf(fp, "%-80s%7.1f\n", line, 14025.0);
+    }
+    fclose(fp);
+}
+
+/* drop backups made when readcalls() rewrote the log */
+static void remove_backups(void) {
+    glob_t globbuf;
+
+    if (glob("2*_" LOGFILE, 0, NULL, &globbuf) == 0) {
+	for (int i = 0; i < globbuf.gl_pathc; i++) {
+	    unlink(globbuf.gl_pathv[i]);
+	}
+    }
+    globfree(&globbuf);
+}
+
+static void run(const char *name, int workers, int n) {
+    set_rescore_workers(workers);
+
+    double start = now();
+    readcalls(LOGFILE, false);
+    double elapsed = now() - start;
+
+    printf("  %-24s %8.1f ms %10.0f QSOs/s  (%d points, %d mults)\n",
+	   name, elapsed * 1e3, n / elapsed,
+	   get_nr_of_points(), get_nr_of_mults());
+}
+
+int main(int argc, char **argv) {
+    int n = 50000;
+    int c;
+
+    while ((c = getopt(argc, argv, "n:")) != -1) {
+	switch (c) {
+	    case 'n':
+		n = atoi(optarg);
+		break;
+	    default:
+		fprintf(stderr, "usage: bench_readcalls [-n qsos]\n");
+		return EXIT_FAILURE;
+	}
+    }
+
+    if (load_ctydata(TOP_SRCDIR "/share/cty.dat") != 0) {
+	fprintf(stderr, "can not load cty.dat\n");
+	return EXIT_FAILURE;
+    }
+    setcontest("CQWW");
+    strcpy(my.continent, "EU");
+    strcpy(logfile, LOGFILE);
+
+    GPtrArray *calls = read_calls();
+    if (calls->len == 0) {
+	fprintf(stderr, "can not read callmaster\n");
+	return EXIT_FAILURE;
+    }
+
+    char *checkpoint = checkpoint_filename(LOGFILE);
+    unlink(checkpoint);
+
+    /* let readcalls() rewrite the lines as scored, so the runs below
+     * do not have to */
+    write_log(calls, n);
+    readcalls(LOGFILE, false);
+
+    printf("rescoring a log of %d QSOs, %d processors\n",
+	   n, g_get_num_processors());
+    run("serial", 0, n);
+    run("1 worker", 1, n);
+    run("3 workers", 3, n);
+    run("all processors", -1, n);
+
+    /* checkpoint of the first 90% of the log */
+    gchar *contents;
+    gsize len;
+    g_file_get_contents(LOGFILE, &contents, &len, NULL);
+    const char *tail = contents;
+    for (int i = 0; i < n - n / 10; i++) {
+	tail = strchr(tail, '\n') + 1;
+    }
+    g_file_set_contents(LOGFILE, contents, tail - contents, NULL);
+    readcalls(LOGFILE, false);
+    checkpoint_save(LOGFILE);
+    g_file_set_contents(LOGFILE, contents, len, NULL);
+    g_free(contents);
+    run("checkpoint + 10% tail", -1, n);
+
+    unlink(checkpoint);
+    unlink(LOGFILE);
+    remove_backups();
+    g_free(checkpoint);
+    g_ptr_array_free(calls, TRUE);
+
+    return EXIT_SUCCESS;
+}
@@ -22,6 +22,8 @@
 #include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
+#include "../src/cluster_spots.h"
+#include "../src/redraw.h"
 #include "../src/globalvars.h"
 #include "../src/setcontest.h"
 #include "../src/tlf.h"
@@ -143,6 +145,8 @@ char recvd_rst[4] = "599";
 int shortqsonr = LONGCW;	/* 1  =  short  cw char in exchange */
 int cluster = NOCLUSTER;	/* 0 = OFF, 1 = FOLLOW, 2  = spots  3 = all */
 bool clusterlog = false;		/* clusterlog on/off */
+int cluster_spots_capacity = CLUSTER_SPOTS_DEFAULT;
+int frame_rate = FRAME_RATE_DEFAULT;	/* max. redraws per second */
 bool searchflg = false;		/* display search  window */
 bool show_time = false;
 cqmode_t cqmode = CQ;
@@ -153,7 +157,10 @@ int change_rst = 0;
 int defer_store = 0;
 mystation_t my;
 char logfile[120] = "general.log";
+int log_sync_mode = LOG_SYNC_QSO;
+int log_sync_interval = 1000;	/* ms, for LOG_SYNC_INTERVAL */
 char *cabrillo = NULL;		/*< Name of the cabrillo format definition */
+char *cat_stats_file = NULL;
 char synclogfile[120];
 char markerfile[120] = "";
 int xplanet = MARKER_NONE;
@@ -277,8 +284,6 @@ int weight = 0;
 char weightbuf[4];
 char tonestr[5] = "600";
 int cqdelay = 8;
-char wkeyerbuffer[400];
-int data_ready = 0;
 char keyer_device[10] = "";	// ttyS0, ttyS1, lp0-2
 bool keyer_backspace = false;
 int k_pin14;
@@ -289,8 +294,6 @@ char modem_mode[8];
 int commentfield = 0;		/* 1 if we are in comment/exchange input */
 
 /*-------------------------------------packet-------------------------------*/
-char spot_ptr[MAX_SPOTS][82];		/* Array of cluster spot lines */
-int nr_of_spots;			/* Anzahl Lines in spot_ptr array */
 int packetinterface = 0;
 int fdSertnc = 0;
 int fdFIFO = 0;
@@ -330,14 +333,12 @@ GPtrArray *qso_array;
 
 /*------------------------------dupe array---------------------------------*/
 int nr_worked = 0;		/*< number of calls in worked[] */
-worked_t worked[MAX_CALLS]; 	/*< worked stations */
+worked_t *worked = NULL; 	/*< worked stations */
 
 /*----------------------statistic of worked countries,zones ... -----------*/
 int countries[MAX_DATALINES];	/* per country bit fieldwith worked bands set */
 int zones[MAX_ZONES];		/* same for cq zones or itu zones;
 				   using 1 - 40 or 1 - 90 */
-char mults[MAX_MULTS][12];
-int mult_bands[MAX_MULTS];
 int multarray_nr = 0;
 
 int multlist = 0;
@@ -398,7 +399,7 @@ bool nopacket = false;		/* set if tlf is called with '-n' */
 int bandweight_points[NBANDS] = {1, 1, 1, 1, 1, 1, 1, 1, 1, 1};
 int bandweight_multis[NBANDS] = {1, 1, 1, 1, 1, 1, 1, 1, 1, 1};
 
-mults_t multis[MAX_MULTS]; 	/**< worked multis */
+mults_t *multis = NULL; 	/**< worked multis */
 int nr_multis = 0;      	/**< number of multis in multis[] */
 
 int unique_call_multi = MULT_NONE;  /* do we count calls as multiplier */
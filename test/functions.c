@@ -31,6 +31,12 @@ void __wrap_refreshp() {
 int sendto_call_count = 0;
 char *sendto_last_message = NULL;
 int sendto_last_len = 0;
+bool sendto_forward = false;
+bool (*sendto_drop)(const char *buf, size_t len) = NULL;
+int sendto_dropped = 0;
+
+ssize_t __real_sendto(int sockfd, const void *buf, size_t len, int flags,
+		      const struct sockaddr *dest_addr, socklen_t addrlen);
 
 ssize_t __wrap_sendto(int sockfd, const void *buf, size_t len, int flags,
 		      const struct sockaddr *dest_addr, socklen_t addrlen) {
@@ -40,6 +46,14 @@ ssize_t __wrap_sendto(int sockfd, const void *buf, size_t len, int flags,
     sendto_last_len = len;
     ++sendto_call_count;
 
+    if (sendto_forward) {
+	if (sendto_drop != NULL && sendto_drop(buf, len)) {
+	    ++sendto_dropped;
+	    return len;		/* lost on the way */
+	}
+	return __real_sendto(sockfd, buf, len, flags, dest_addr, addrlen);
+    }
+
     return len;
 }
 
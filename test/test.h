@@ -47,6 +47,11 @@ extern void clear_mvprintw_history();
 extern int sendto_call_count;
 extern char *sendto_last_message;
 extern int sendto_last_len;
+// packet-drop shim: if sendto_forward is set datagrams are really sent,
+// unless sendto_drop returns true for them
+extern bool sendto_forward;
+extern bool (*sendto_drop)(const char *buf, size_t len);
+extern int sendto_dropped;
 
 
 #endif
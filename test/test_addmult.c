@@ -8,15 +8,19 @@
 #include "../src/bands.h"
 #include "../src/setcontest.h"
 #include "../src/log_utils.h"
+#include "../src/score_journal.h"
 
 // OBJECT ../src/addmult.o
+// OBJECT ../src/alias_matcher.o
 // OBJECT ../src/addpfx.o
+// OBJECT ../src/mult_registry.o
 // OBJECT ../src/bands.o
 // OBJECT ../src/dxcc.o
 // OBJECT ../src/getpx.o
 // OBJECT ../src/plugin.o
 // OBJECT ../src/qrb.o
 // OBJECT ../src/log_utils.o
+// OBJECT ../src/score_journal.o
 // OBJECT ../src/setcontest.o
 // OBJECT ../src/score.o
 // OBJECT ../src/utils.o
@@ -171,6 +175,48 @@ void test_remember_mult_same_2x_newband(void **state) {
     assert_int_equal(multscore[BANDINDEX_160], 1);
 }
 
+/* no fixed limit on the number of mults */
+void test_remember_mult_many(void **state) {
+    char name[MULT_SIZE];
+
+    for (int i = 0; i < 5000; i++) {
+	sprintf(name, "M%d", i);
+	assert_int_equal(remember_multi(name, BANDINDEX_80, MULT_ALL, false), i);
+    }
+    assert_int_equal(nr_multis, 5000);
+    assert_int_equal(multscore[BANDINDEX_80], 5000);
+
+    for (int i = 0; i < 5000; i++) {
+	sprintf(name, "M%d", i);
+	assert_string_equal(multis[i].name, name);
+	assert_int_equal(remember_multi(name, BANDINDEX_80, MULT_BAND, false), -1);
+    }
+}
+
+/* undoing a QSO forgets its new mult, its entry gets reused */
+void test_remember_mult_undone(void **state) {
+    struct qso_t qso = { 0 };
+
+    remember_multi("abc", BANDINDEX_80, MULT_BAND, false);
+    journal_begin(&qso);
+    remember_multi("def", BANDINDEX_80, MULT_BAND, false);
+    remember_multi("abc", BANDINDEX_160, MULT_BAND, false);
+    journal_end();
+    journal_undo(&qso);
+
+    assert_int_equal(nr_multis, 1);
+    assert_int_equal(multis[0].band, inxes[BANDINDEX_80]);
+    assert_int_equal(multscore[BANDINDEX_80], 1);
+    assert_int_equal(multscore[BANDINDEX_160], 0);
+
+    assert_int_equal(remember_multi("ghi", BANDINDEX_80, MULT_ALL, false), 1);
+    assert_int_equal(remember_multi("def", BANDINDEX_80, MULT_ALL, true), 2);
+    assert_int_equal(remember_multi("def", BANDINDEX_80, MULT_ALL, false), 2);
+    assert_int_equal(remember_multi("ghi", BANDINDEX_80, MULT_ALL, false), -1);
+    assert_string_equal(multis[1].name, "ghi");
+    assert_string_equal(multis[2].name, "def");
+}
+
 /* check_only mode */
 void test_remember_check_mult_one(void **state) {
     assert_int_equal(remember_multi("abc", BANDINDEX_80, MULT_ALL, true), 0);
@@ -324,6 +370,127 @@ void test_match_length_match_alias2(void **state) {
     assert_int_equal(get_matching_length("12aAAC2", 0), 3);
 }
 
+void test_match_length_other_mult(void **state) {
+    setup_multis("AB:ZHX\nZH:NHA,ZDL,AA,AAC\n");
+    assert_int_equal(get_matching_length("12aZHXc", 0), 3);
+    assert_int_equal(get_matching_length("12aZHXc", 1), 2);
+    assert_int_equal(get_matching_length("NHAAC", 0), 0);
+    assert_int_equal(get_matching_length("NHAAC", 1), 3);
+}
+
+void test_exact_mult_index(void **state) {
+    setup_multis("ZH:NHA,ZDL,AA,AAC\nAB:AA,X\n");
+    assert_int_equal(get_exact_mult_index("ZH"), 1);
+    assert_int_equal(get_exact_mult_index("AB"), 0);
+    assert_int_equal(get_exact_mult_index("ZDL"), 1);
+    assert_int_equal(get_exact_mult_index("AA"), 0);	/* alias of both */
+    assert_int_equal(get_exact_mult_index("AAC"), 1);
+    assert_int_equal(get_exact_mult_index("ZD"), -1);
+    assert_int_equal(get_exact_mult_index("XAA"), -1);
+    assert_int_equal(get_exact_mult_index(""), -1);
+    assert_int_equal(get_exact_mult_index(NULL), -1);
+}
+
+void test_best_mult_index(void **state) {
+    unsigned int len;
+
+    setup_multis("ZH:NHA,ZDL,AA,AAC\nAB:AA,X\nKL\n");
+    assert_int_equal(get_best_mult_index("12 AAC 3", &len), 2);
+    assert_int_equal(len, 3);
+    assert_int_equal(get_best_mult_index("12 AA 3", &len), 0);
+    assert_int_equal(len, 2);
+    assert_int_equal(get_best_mult_index("KL AA", &len), 0);
+    assert_int_equal(len, 2);
+    assert_int_equal(get_best_mult_index("123", &len), -1);
+    assert_int_equal(len, 0);
+}
+
+/* longest name or alias of mult 'n' in 'str' by plain search */
+static unsigned int plain_matching_length(char *str, int n) {
+    unsigned int len = 0;
+
+    if (strstr(str, get_mult(n)) != NULL) {
+	len = strlen(get_mult(n));
+    }
+    for (GSList *l = get_aliases(n); l != NULL; l = l->next) {
+	if (strstr(str, l->data) != NULL && strlen(l->data) > len) {
+	    len = strlen(l->data);
+	}
+    }
+    return len;
+}
+
+static void check_against_plain_search(char *str) {
+    unsigned int best = 0, len;
+    int best_index = -1, exact = -1;
+
+    for (int i = 0; i < get_mult_count(); i++) {
+	unsigned int expected = plain_matching_length(str, i);
+	assert_int_equal(get_matching_length(str, i), expected);
+	if (expected > best) {
+	    best = expected;
+	    best_index = i;
+	}
+	if (exact < 0 && *str != '\0' && expected == strlen(str)) {
+	    exact = i;
+	}
+    }
+    assert_int_equal(get_best_mult_index(str, &len), best_index);
+    assert_int_equal(len, best);
+    assert_int_equal(get_exact_mult_index(str), exact);
+}
+
+/* random mults and aliases over a small alphabet to get many overlaps */
+void test_match_aliases_cross_check(void **state) {
+    GString *multfile = g_string_new(NULL);
+    char str[12];
+
+    srand(42);
+    for (int i = 0; i < 40; i++) {
+	g_string_append_printf(multfile, "M%02d:", i);
+	for (int a = rand() % 8; a > 0; a--) {
+	    for (int k = 1 + rand() % 4; k > 0; k--) {
+		g_string_append_c(multfile, "ABC"[rand() % 3]);
+	    }
+	    g_string_append_c(multfile, a > 1 ? ',' : '\n');
+	}
+	if (multfile->str[multfile->len - 1] != '\n') {
+	    g_string_append_c(multfile, '\n');
+	}
+    }
+    setup_multis(multfile->str);
+    g_string_free(multfile, TRUE);
+
+    for (int n = 0; n < 500; n++) {
+	int len = rand() % (sizeof(str) - 1);
+	for (int k = 0; k < len; k++) {
+	    str[k] = "ABCDM0"[rand() % 6];
+	}
+	str[len] = '\0';
+	check_against_plain_search(str);
+    }
+}
+
+/* compare with a plain search for each mult */
+void test_match_length_cross_check(void **state) {
+    const char *exchanges[] = {
+	"", "E", "EB", "EMA", "SFL", "NFL", "WMA", "ENY", "NNY", "NLI",
+	"5NNJ", "12ABEMA", "ORG", "SDGSDG", "STX NTX", "WWA EWA", "XYZ",
+	"NT", "QC", "ONE", "ONSONN", "PAC", "WCF", "LAX", "SCV", "SC",
+    };
+    const char *file = TOP_SRCDIR "/share/arrlsections";
+    gchar *contents;
+
+    assert_true(g_file_get_contents(file, &contents, NULL, NULL));
+    setup_multis(contents);
+    g_free(contents);
+    assert_true(get_mult_count() > 50);
+
+    for (int e = 0; e < G_N_ELEMENTS(exchanges); e++) {
+	check_against_plain_search((char *)exchanges[e]);
+    }
+}
+
 
 /* addmult tests */
 void test_wysiwyg_once(void **state) {
@@ -1,10 +1,14 @@
 #include "test.h"
 
 #include "../src/addpfx.h"
+#include "../src/bands.h"
+#include "../src/score_journal.h"
 #include "../src/tlf.h"
 
 // OBJECT ../src/addpfx.o
+// OBJECT ../src/mult_registry.o
 // OBJECT ../src/bands.o
+// OBJECT ../src/score_journal.o
 
 extern int pfxmultab;
 
@@ -132,3 +136,52 @@ void test_addKnownMultiband(void **state) {
     assert_int_equal(add_pfx("DL0", BANDINDEX_80), 0);
 }
 
+
+/* no fixed limit on the number of prefixes */
+void test_addMany(void **state) {
+    char pfx[8];
+
+    for (int i = 0; i < 20000; i++) {
+	sprintf(pfx, "P%d", i);
+	add_pfx(pfx, BANDINDEX_40);
+    }
+    assert_int_equal(GetNrOfPfx_once(), 20000);
+    assert_int_equal(GetNrOfPfx_OnBand(BANDINDEX_40), 20000);
+
+    for (int i = 0; i < 20000; i++) {
+	int bands;
+	sprintf(pfx, "P%d", i);
+	assert_false(pfx_is_new(pfx));
+	assert_string_equal(get_worked_pfx(i, &bands), pfx);
+	assert_int_equal(bands, inxes[BANDINDEX_40]);
+    }
+    assert_true(pfx_is_new("P20000"));
+}
+
+/* undoing a QSO forgets the prefix, its entry gets reused */
+void test_addUndone(void **state) {
+    struct qso_t qso = { 0 };
+    int bands;
+
+    add_pfx("DL0", BANDINDEX_80);
+    journal_begin(&qso);
+    add_pfx("UA3", BANDINDEX_80);
+    add_pfx("DL0", BANDINDEX_20);
+    journal_end();
+    journal_undo(&qso);
+
+    assert_true(pfx_is_new("UA3"));
+    assert_true(pfx_is_new_on("DL0", BANDINDEX_20));
+    assert_int_equal(GetNrOfPfx_once(), 1);
+    assert_int_equal(GetNrOfPfx_multiband(), 1);
+
+    add_pfx("OE3", BANDINDEX_40);
+    assert_true(pfx_is_new("UA3"));
+    assert_false(pfx_is_new("OE3"));
+    assert_string_equal(get_worked_pfx(1, &bands), "OE3");
+    assert_int_equal(bands, inxes[BANDINDEX_40]);
+
+    add_pfx("UA3", BANDINDEX_40);
+    assert_false(pfx_is_new("UA3"));
+    assert_int_equal(GetNrOfPfx_once(), 3);
+}
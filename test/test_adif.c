@@ -5,6 +5,7 @@
 #include "../src/globalvars.h"
 #include "../src/cqww_simulator.h"
 
+// OBJECT ../src/log_writer.o
 // OBJECT ../src/writecabrillo.o
 // OBJECT ../src/cabrillo_utils.o
 // OBJECT ../src/log_utils.o
@@ -0,0 +1,259 @@
+#include "test.h"
+
+#include "../src/bandmap.h"
+#include "../src/bands.h"
+#include "../src/getctydata.h"
+#include "../src/globalvars.h"
+#include "../src/qtcutil.h"
+#include "../src/score_journal.h"
+
+// OBJECT ../src/bandmap.o
+// OBJECT ../src/cluster_spots.o
+// OBJECT ../src/initial_exchange.o
+// OBJECT ../src/bands.o
+// OBJECT ../src/dxcc.o
+// OBJECT ../src/score_journal.o
+// OBJECT ../src/searchcallarray.o
+// OBJECT ../src/redraw.o
+
+extern GSequence *allspots;
+extern GPtrArray *spots;
+
+void filter_spots();
+
+char thisnode = 'A';
+bool grab_up = true;
+
+void background_wakeup(void) {}
+
+int getctynr(char *checkcall) {
+    return 0;
+}
+
+prefix_data *getctyinfo(char *call) {
+    return NULL;
+}
+
+time_t get_time() {
+    return 0;
+}
+
+bool general_ismulti(spot *data) {
+    return false;
+}
+
+struct t_qtc_store_obj *qtc_get(char callsign[15]) {
+    return NULL;
+}
+
+char qtc_get_value(struct t_qtc_store_obj *qtc_obj) {
+    return '\0';
+}
+
+int modify_attr(int attr) {
+    return attr;
+}
+
+static int multi_calls;
+
+static bool count_multi(spot *data) {
+    multi_calls++;
+    return strcmp(data->call, "DL1AAA") == 0;
+}
+
+static contest_config_t config_test = {
+    .id = QSO,
+    .name = QSO_MODE,
+    .is_multi = count_multi,
+};
+
+int setup_default(void **state) {
+    contest = &config_test;
+    bm_config.lifetime = 900;
+    bm_config.allband = 1;
+    bm_config.allmode = 1;
+    bm_config.onlymults = 0;
+    multi_calls = 0;
+    return 0;
+}
+
+/* let all spots expire */
+int teardown_default(void **state) {
+    GSequenceIter *iter;
+
+    if (allspots == NULL)
+	return 0;
+
+    for (iter = g_sequence_get_begin_iter(allspots);
+	    !g_sequence_iter_is_end(iter);
+	    iter = g_sequence_iter_next(iter)) {
+	((spot *)g_sequence_get(iter))->timeout = 1;
+    }
+    bandmap_age();
+    return 0;
+}
+
+static spot *spot_at(int index) {
+    return g_sequence_get(g_sequence_get_iter_at_pos(allspots, index));
+}
+
+void test_sorted_by_freq(void **state) {
+    bandmap_addspot("DL1AAA", 14020000, ' ');
+    bandmap_addspot("DL2BBB", 14005000, ' ');
+    bandmap_addspot("DL3CCC", 14012000, ' ');
+
+    assert_int_equal(g_sequence_get_length(allspots), 3);
+    assert_string_equal(spot_at(0)->call, "DL2BBB");
+    assert_string_equal(spot_at(1)->call, "DL3CCC");
+    assert_string_equal(spot_at(2)->call, "DL1AAA");
+}
+
+void test_respot_moves_spot(void **state) {
+    bandmap_addspot("DL1AAA", 14020000, ' ');
+    bandmap_addspot("DL2BBB", 14005000, ' ');
+    bandmap_addspot("DL1AAA", 14001000, 'B');
+
+    assert_int_equal(g_sequence_get_length(allspots), 2);
+    assert_string_equal(spot_at(0)->call, "DL1AAA");
+    assert_int_equal(spot_at(0)->freq, 14001000);
+    assert_int_equal(spot_at(0)->node, 'B');
+}
+
+void test_respot_small_change_keeps_freq(void **state) {
+    bandmap_addspot("DL1AAA", 14020000, ' ');
+    spot_at(0)->timeout = 10;
+    bandmap_addspot("DL1AAA", 14020050, ' ');
+
+    assert_int_equal(g_sequence_get_length(allspots), 1);
+    assert_int_equal(spot_at(0)->freq, 14020000);
+    assert_int_equal(spot_at(0)->timeout, SPOT_NEW);
+}
+
+void test_other_band_and_mode_kept(void **state) {
+    bandmap_addspot("DL1AAA", 14020000, ' ');
+    bandmap_addspot("DL1AAA", 14250000, ' ');
+    bandmap_addspot("DL1AAA", 7010000, ' ');
+
+    assert_int_equal(g_sequence_get_length(allspots), 3);
+}
+
+void test_same_qrg_replaces_neighbours(void **state) {
+    bandmap_addspot("DL1AAA", 14020000, ' ');
+    bandmap_addspot("DL2BBB", 14020300, ' ');
+    bandmap_addspot("DL3CCC", 14020150, ' ');
+    bandmap_addspot("DL4DDD", 14020080, ' ');
+
+    /* DL4DDD replaces DL1AAA below and DL3CCC above */
+    assert_int_equal(g_sequence_get_length(allspots), 2);
+    assert_string_equal(spot_at(0)->call, "DL4DDD");
+    assert_string_equal(spot_at(1)->call, "DL2BBB");
+}
+
+void test_age_drops_spots(void **state) {
+    bm_config.lifetime = 2;
+    bandmap_addspot("DL1AAA", 14020000, ' ');
+    bandmap_addspot("DL2BBB", 14030000, ' ');
+    bandmap_age();
+    bandmap_addspot("DL2BBB", 14030000, ' ');
+    bandmap_age();
+
+    assert_int_equal(g_sequence_get_length(allspots), 1);
+    assert_string_equal(spot_at(0)->call, "DL2BBB");
+
+    /* dropped spot can be added again */
+    bandmap_addspot("DL1AAA", 14020000, ' ');
+    assert_int_equal(g_sequence_get_length(allspots), 2);
+}
+
+static spot *view_at(int index) {
+    return g_ptr_array_index(spots, index);
+}
+
+/* make spots known as countries, so that multi state gets checked */
+static void add_spot(char *call, int freq) {
+    bandmap_addspot(call, freq, ' ');
+
+    GSequenceIter *iter;
+    for (iter = g_sequence_get_begin_iter(allspots);
+	    !g_sequence_iter_is_end(iter);
+	    iter = g_sequence_iter_next(iter)) {
+	spot *data = g_sequence_get(iter);
+	data->ctynr = 1;
+	data->cqzone = 1;
+    }
+}
+
+void test_view_shares_spots(void **state) {
+    add_spot("DL1AAA", 14020000);
+    add_spot("DL2BBB", 14005000);
+    filter_spots();
+
+    assert_int_equal(spots->len, 2);
+    assert_ptr_equal(view_at(0), spot_at(0));
+    assert_ptr_equal(view_at(1), spot_at(1));
+    assert_int_equal(view_at(0)->refs, 2);
+}
+
+void test_view_updated_incrementally(void **state) {
+    add_spot("DL1AAA", 14020000);
+    add_spot("DL2BBB", 14005000);
+    filter_spots();
+
+    add_spot("DL3CCC", 14010000);
+    bandmap_addspot("DL2BBB", 14030000, ' ');	/* moves up */
+    filter_spots();
+
+    assert_int_equal(spots->len, 3);
+    assert_string_equal(view_at(0)->call, "DL3CCC");
+    assert_string_equal(view_at(1)->call, "DL1AAA");
+    assert_string_equal(view_at(2)->call, "DL2BBB");
+
+    /* expired spots leave the view */
+    spot_at(0)->timeout = 1;
+    bandmap_age();
+    filter_spots();
+    assert_int_equal(spots->len, 2);
+    assert_string_equal(view_at(0)->call, "DL1AAA");
+}
+
+void test_view_follows_filter(void **state) {
+    add_spot("DL1AAA", 14020000);
+    add_spot("DL2BBB", 7005000);
+    filter_spots();
+    assert_int_equal(spots->len, 2);
+
+    bm_config.allband = 0;
+    bandinx = BANDINDEX_40;
+    filter_spots();
+    assert_int_equal(spots->len, 1);
+    assert_string_equal(view_at(0)->call, "DL2BBB");
+
+    /* only DL1AAA is a multi */
+    bm_config.allband = 1;
+    bm_config.onlymults = 1;
+    filter_spots();
+    assert_int_equal(spots->len, 1);
+    assert_string_equal(view_at(0)->call, "DL1AAA");
+    assert_true(view_at(0)->multi);
+}
+
+void test_multi_cached(void **state) {
+    add_spot("DL1AAA", 14020000);
+    add_spot("DL2BBB", 14005000);
+    filter_spots();
+    assert_int_equal(multi_calls, 2);
+
+    /* nothing changed */
+    filter_spots();
+    assert_int_equal(multi_calls, 2);
+
+    /* only the new spot gets checked */
+    add_spot("DL3CCC", 14010000);
+    filter_spots();
+    assert_int_equal(multi_calls, 3);
+
+    /* scoring has changed, check all again */
+    score_generation_next();
+    filter_spots();
+    assert_int_equal(multi_calls, 6);
+}
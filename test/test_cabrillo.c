@@ -7,7 +7,9 @@
 #include "../src/log_utils.h"
 
 // OBJECT ../src/cabrillo_utils.o
+// OBJECT ../src/log_writer.o
 // OBJECT ../src/readcabrillo.o
+// OBJECT ../src/score_journal.o
 // OBJECT ../src/writecabrillo.o
 // OBJECT ../src/bands.o
 // OBJECT ../src/searchcallarray.o
@@ -0,0 +1,172 @@
+#include "test.h"
+
+#include "../src/call_index.h"
+
+// OBJECT ../src/call_index.o
+
+static call_index_t *calls_index;
+static GString *found;
+
+/* collect all matches as "CALL:id " */
+static bool collect(const char *call, guint id, gpointer data) {
+    g_string_append_printf(found, "%s:%u ", call, id);
+    return false;
+}
+
+/* stop after first match */
+static bool first_only(const char *call, guint id, gpointer data) {
+    g_string_append_printf(found, "%s ", call);
+    return true;
+}
+
+static const char *lookup(const char *part) {
+    g_string_truncate(found, 0);
+    call_index_lookup(calls_index, part, collect, NULL);
+    return found->str;
+}
+
+int setup_default(void **state) {
+    static const char *calls[] = {
+	"DL1ABC", "K1ABC", "ABC1X", "PA3ABCD", "W1AW", "AA1AA", "A"
+    };
+
+    calls_index = call_index_new();
+    for (int i = 0; i < G_N_ELEMENTS(calls); i++) {
+	call_index_add(calls_index, calls[i]);
+    }
+    found = g_string_new(NULL);
+    return 0;
+}
+
+int teardown_default(void **state) {
+    call_index_free(calls_index);
+    g_string_free(found, TRUE);
+    return 0;
+}
+
+void test_size(void **state) {
+    assert_int_equal(call_index_size(calls_index), 7);
+}
+
+void test_starts_with_first(void **state) {
+    assert_string_equal(lookup("ABC"), "ABC1X:2 DL1ABC:0 K1ABC:1 PA3ABCD:3 ");
+}
+
+void test_two_chars(void **state) {
+    assert_string_equal(lookup("AA"), "AA1AA:5 ");
+    assert_string_equal(lookup("1A"), "DL1ABC:0 K1ABC:1 W1AW:4 AA1AA:5 ");
+}
+
+void test_long_part(void **state) {
+    assert_string_equal(lookup("3ABCD"), "PA3ABCD:3 ");
+    assert_string_equal(lookup("PA3ABCD"), "PA3ABCD:3 ");
+    assert_string_equal(lookup("ABCX"), "");
+}
+
+void test_no_match(void **state) {
+    assert_string_equal(lookup("QQ"), "");
+    assert_string_equal(lookup("DL1ABCD"), "");
+}
+
+void test_single_char(void **state) {
+    assert_string_equal(lookup("X"), "ABC1X:2 ");
+    assert_string_equal(lookup("W"), "W1AW:4 ");
+}
+
+void test_stop(void **state) {
+    g_string_truncate(found, 0);
+    call_index_lookup(calls_index, "ABC", first_only, NULL);
+    assert_string_equal(found->str, "ABC1X ");
+}
+
+static const char *find(const char *part) {
+    GArray *ids = g_array_new(FALSE, FALSE, sizeof(guint));
+
+    call_index_find(calls_index, part, ids);
+    g_string_truncate(found, 0);
+    for (int i = 0; i < ids->len; i++) {
+	g_string_append_printf(found, "%u ", g_array_index(ids, guint, i));
+    }
+    g_array_free(ids, TRUE);
+    return found->str;
+}
+
+void test_find_in_order(void **state) {
+    assert_string_equal(find("ABC"), "0 1 2 3 ");
+    assert_string_equal(find("1A"), "0 1 4 5 ");
+    assert_string_equal(find("X"), "2 ");
+    assert_string_equal(find("QQQ"), "");
+}
+
+static const char *near(const char *call) {
+    GArray *ids = g_array_new(FALSE, FALSE, sizeof(guint));
+
+    call_index_near(calls_index, call, ids);
+    g_string_truncate(found, 0);
+    for (int i = 0; i < ids->len; i++) {
+	g_string_append_printf(found, "%u ", g_array_index(ids, guint, i));
+    }
+    g_array_free(ids, TRUE);
+    return found->str;
+}
+
+void test_distance(void **state) {
+    assert_int_equal(call_distance("DL1ABC", "DL1ABC"), 0);
+    assert_int_equal(call_distance("DL1ABC", "DL1ABD"), 1);
+    assert_int_equal(call_distance("DL1ABC", "DL1AB"), 1);
+    assert_int_equal(call_distance("DL1ABC", "DL1XABC"), 1);
+    assert_int_equal(call_distance("DL1ABC", "L1ABC"), 1);
+    assert_int_equal(call_distance("DL1ABC", "K1ABC"), 2);
+    assert_int_equal(call_distance("DL1ABC", ""), 6);
+    assert_int_equal(call_distance("", "K1A"), 3);
+}
+
+/* plain dynamic programming for comparison */
+static int dp_distance(const char *a, const char *b) {
+    int m = strlen(a), n = strlen(b);
+    int d[NEAR_MAX_LEN + 2][NEAR_MAX_LEN + 2];
+
+    for (int i = 0; i <= m; i++) d[i][0] = i;
+    for (int j = 0; j <= n; j++) d[0][j] = j;
+    for (int i = 1; i <= m; i++) {
+	for (int j = 1; j <= n; j++) {
+	    int sub = d[i - 1][j - 1] + (a[i - 1] != b[j - 1]);
+	    d[i][j] = MIN(sub, MIN(d[i - 1][j], d[i][j - 1]) + 1);
+	}
+    }
+    return d[m][n];
+}
+
+void test_distance_random(void **state) {
+    char a[NEAR_MAX_LEN + 1], b[NEAR_MAX_LEN + 1];
+    GRand *rand = g_rand_new_with_seed(42);
+
+    for (int k = 0; k < 10000; k++) {
+	int m = g_rand_int_range(rand, 1, 13);
+	int n = g_rand_int_range(rand, 0, 13);
+	for (int i = 0; i < m; i++) a[i] = "AB1/"[g_rand_int_range(rand, 0, 4)];
+	for (int i = 0; i < n; i++) b[i] = "AB1/"[g_rand_int_range(rand, 0, 4)];
+	a[m] = b[n] = '\0';
+	assert_int_equal(call_distance(a, b), dp_distance(a, b));
+    }
+    g_rand_free(rand);
+}
+
+void test_near(void **state) {
+    assert_string_equal(near("K1ABCD"), "1 ");
+    assert_string_equal(near("K1ABC"), "");	/* exact match is no near miss */
+    assert_string_equal(near("DL1ABD"), "0 ");
+    assert_string_equal(near("DL1AC"), "0 ");
+    assert_string_equal(near("AA1A"), "5 ");
+    assert_string_equal(near("PA3ABCE"), "3 ");
+    assert_string_equal(near("W1A"), "");	/* too short */
+}
+
+void test_clear(void **state) {
+    call_index_clear(calls_index);
+    assert_int_equal(call_index_size(calls_index), 0);
+    assert_string_equal(lookup("ABC"), "");
+
+    assert_int_equal(call_index_add(calls_index, "ZZ9ABC"), 0);
+    assert_string_equal(lookup("ABC"), "ZZ9ABC:0 ");
+}
@@ -0,0 +1,121 @@
+#include "test.h"
+
+#include <hamlib/rig.h>
+
+#include "../src/cat_stats.h"
+
+// OBJECT ../src/cat_stats.o
+
+int setup_default(void **state) {
+    cat_stats_reset();
+    return 0;
+}
+
+void test_empty(void **state) {
+    cat_op_stats_t s;
+
+    cat_stats_get(CAT_GET_FREQ, &s);
+    assert_int_equal(s.calls, 0);
+    assert_int_equal(s.errors, 0);
+    assert_int_equal(s.timeouts, 0);
+    assert_true(cat_stats_poll_rate() == 0.0);
+}
+
+void test_buckets(void **state) {
+    cat_op_stats_t s;
+
+    cat_stats_add(CAT_SET_FREQ, 0.3, RIG_OK);	// < 1 ms
+    cat_stats_add(CAT_SET_FREQ, 1.0, RIG_OK);	// < 2 ms
+    cat_stats_add(CAT_SET_FREQ, 150, RIG_OK);	// < 200 ms
+    cat_stats_add(CAT_SET_FREQ, 999, RIG_OK);	// < 1 s
+    cat_stats_add(CAT_SET_FREQ, 2500, RIG_OK);	// more
+
+    cat_stats_get(CAT_SET_FREQ, &s);
+    assert_int_equal(s.calls, 5);
+    assert_int_equal(s.buckets[0], 1);
+    assert_int_equal(s.buckets[1], 1);
+    assert_int_equal(s.buckets[7], 1);
+    assert_int_equal(s.buckets[9], 1);
+    assert_int_equal(s.buckets[CAT_BUCKETS - 1], 1);
+    assert_true(s.max_ms == 2500);
+    assert_true(s.total_ms > 3650 && s.total_ms < 3651);
+
+    // other operations are not affected
+    cat_stats_get(CAT_GET_FREQ, &s);
+    assert_int_equal(s.calls, 0);
+}
+
+void test_errors(void **state) {
+    cat_op_stats_t s;
+
+    cat_stats_add(CAT_SET_PTT, 5, RIG_OK);
+    cat_stats_add(CAT_SET_PTT, 5, -RIG_EIO);
+    cat_stats_add(CAT_SET_PTT, 5, -RIG_ETIMEOUT);
+    cat_stats_add(CAT_SET_PTT, 5, -RIG_ETIMEOUT);
+
+    cat_stats_get(CAT_SET_PTT, &s);
+    assert_int_equal(s.calls, 4);
+    assert_int_equal(s.errors, 1);
+    assert_int_equal(s.timeouts, 2);
+}
+
+void test_record(void **state) {
+    cat_op_stats_t s;
+
+    double start = cat_stats_start();
+    usleep(3000);
+    cat_stats_record(CAT_GET_MODE, start, RIG_OK);
+
+    cat_stats_get(CAT_GET_MODE, &s);
+    assert_int_equal(s.calls, 1);
+    assert_true(s.max_ms >= 3.0);
+    assert_int_equal(s.buckets[0] + s.buckets[1], 0);
+}
+
+void test_poll_rate(void **state) {
+    for (int i = 0; i < 3; i++) {
+	cat_stats_poll();
+	usleep(20000);
+    }
+    cat_stats_poll();
+
+    double rate = cat_stats_poll_rate();
+    assert_true(rate > 5.0 && rate <= 50.0);
+}
+
+void test_report(void **state) {
+    cat_stats_add(CAT_GET_FREQ, 12, RIG_OK);
+    cat_stats_add(CAT_GET_FREQ, 14, -RIG_ETIMEOUT);
+
+    char **lines = cat_stats_report();
+    assert_string_equal(lines[0], "Rig polls: 0, 0.0 per second");
+    assert_string_equal(lines[2],
+			"operation      calls  errors timeouts   avg ms   max ms");
+    assert_string_equal(lines[3],
+			"get_freq           2       0        1     13.0     14.0");
+    assert_string_equal(lines[9],
+			"latency ms    <1    <2    <5   <10   <20   <50  <100  <200  <500   <1s  more");
+    assert_string_equal(lines[10],
+			"get_freq       0     0     0     0     2     0     0     0     0     0     0");
+    for (int i = 0; lines[i] != NULL; i++)
+	assert_true(strlen(lines[i]) < 80);
+    g_strfreev(lines);
+}
+
+void test_dump(void **state) {
+    char filename[] = "/tmp/tlf_cat_XXXXXX";
+    int fd = mkstemp(filename);
+    assert_true(fd >= 0);
+    close(fd);
+
+    cat_stats_add(CAT_SET_MODE, 7, RIG_OK);
+    assert_true(cat_stats_dump(filename));
+
+    gchar *content;
+    assert_true(g_file_get_contents(filename, &content, NULL, NULL));
+    assert_non_null(strstr(content, "\nset_mode           1       0        0      7.0      7.0\n"));
+    g_free(content);
+    unlink(filename);
+
+    assert_false(cat_stats_dump("/nonexistent/dir/file"));
+}
@@ -0,0 +1,151 @@
+#include "test.h"
+
+#include "../src/cluster_spots.h"
+#include "../src/globalvars.h"
+
+// OBJECT ../src/cluster_spots.o
+// OBJECT ../src/bands.o
+
+#define DX_LINE \
+    "DX de DL1ABC:    14025.0  OH2XYZ       CQ test                        1234Z"
+
+int setup_default(void **state) {
+    strcpy(my.call, "N0CALL");
+    cluster_spots_capacity = CLUSTER_SPOTS_DEFAULT;
+    cluster_spots_clear();
+    return 0;
+}
+
+static void add_numbered(int i) {
+    char line[CLUSTER_LINE_SIZE];
+    cluster_spot_t spot;
+
+    sprintf(line, "WWV de Q0QQ:  SFI=68,A=12,K=3, line %d", i);
+    cluster_spots_add(line, &spot);
+}
+
+static int line_number(const cluster_spot_t *spot) {
+    return atoi(strstr(spot->line, "line ") + 5);
+}
+
+void test_parse_dx(void **state) {
+    cluster_spot_t spot;
+
+    assert_true(parse_cluster_line(DX_LINE, &spot));
+    assert_true(spot.is_spot);
+    assert_int_equal(spot.kind, CLUSTER_DX);
+    assert_string_equal(spot.line, DX_LINE);
+    assert_string_equal(spot.call, "OH2XYZ");
+    assert_string_equal(spot.spotter, "DL1ABC");
+    assert_string_equal(spot.comment, "CQ test");
+    assert_int_equal(spot.freq, 14025000);
+    assert_int_equal(spot.band, BANDINDEX_20);
+    assert_int_equal(spot.minutes, 12 * 60 + 34);
+    assert_int_equal(spot.node, ' ');
+}
+
+void test_parse_dx_short(void **state) {
+    cluster_spot_t spot;
+
+    assert_true(parse_cluster_line("DX de TLF-B:      7010.0  K1AB", &spot));
+    assert_string_equal(spot.call, "K1AB");
+    assert_string_equal(spot.spotter, "TLF-B");
+    assert_int_equal(spot.node, 'B');
+    assert_int_equal(spot.band, BANDINDEX_40);
+    assert_string_equal(spot.comment, "");
+    assert_int_equal(spot.minutes, -1);
+}
+
+void test_parse_kinds(void **state) {
+    cluster_spot_t spot;
+
+    assert_false(parse_cluster_line("To ALL de QQ3QQQ: hello all", &spot));
+    assert_int_equal(spot.kind, CLUSTER_ANNOUNCE);
+    assert_false(parse_cluster_line("To N0CALL de QQ3QQQ: hello", &spot));
+    assert_int_equal(spot.kind, CLUSTER_TALK);
+    assert_false(parse_cluster_line("WWV de Q0QQ:  SFI=68,A=12,K=3", &spot));
+    assert_int_equal(spot.kind, CLUSTER_OTHER);
+    assert_false(parse_cluster_line("short line", &spot));
+    assert_int_equal(spot.kind, CLUSTER_SHORT);
+    assert_false(spot.is_spot);
+    assert_int_equal(spot.band, BANDINDEX_OOB);
+}
+
+void test_add_returns_parsed(void **state) {
+    cluster_spot_t spot;
+
+    cluster_spots_add(DX_LINE, &spot);
+    assert_true(spot.is_spot);
+    assert_string_equal(spot.call, "OH2XYZ");
+    assert_int_equal(cluster_spots_count(), 1);
+}
+
+void test_ring_keeps_latest(void **state) {
+    cluster_spot_t spots[3];
+
+    cluster_spots_capacity = CLUSTER_SPOTS_MIN;
+    for (int i = 0; i < CLUSTER_SPOTS_MIN + 50; i++)
+	add_numbered(i);
+    assert_int_equal(cluster_spots_count(), CLUSTER_SPOTS_MIN);
+
+    // newest entries come back in arrival order
+    assert_int_equal(cluster_spots_select(NULL, NULL, spots, 3), 3);
+    assert_int_equal(line_number(&spots[0]), CLUSTER_SPOTS_MIN + 47);
+    assert_int_equal(line_number(&spots[2]), CLUSTER_SPOTS_MIN + 49);
+}
+
+void test_ring_drops_oldest(void **state) {
+    cluster_spot_t *spots = g_new(cluster_spot_t, CLUSTER_SPOTS_MIN + 1);
+
+    cluster_spots_capacity = CLUSTER_SPOTS_MIN;
+    for (int i = 0; i < CLUSTER_SPOTS_MIN + 50; i++)
+	add_numbered(i);
+
+    assert_int_equal(cluster_spots_select(NULL, NULL, spots,
+					  CLUSTER_SPOTS_MIN + 1),
+		     CLUSTER_SPOTS_MIN);
+    assert_int_equal(line_number(&spots[0]), 50);
+    g_free(spots);
+}
+
+void test_capacity_limited(void **state) {
+    cluster_spots_capacity = 10;
+    for (int i = 0; i < CLUSTER_SPOTS_MIN + 1; i++)
+	add_numbered(i);
+    assert_int_equal(cluster_spots_count(), CLUSTER_SPOTS_MIN);
+}
+
+void test_capacity_default(void **state) {
+    for (int i = 0; i < 2 * CLUSTER_SPOTS_DEFAULT; i++)
+	add_numbered(i);
+    assert_int_equal(cluster_spots_count(), CLUSTER_SPOTS_DEFAULT);
+}
+
+static bool keep_odd(const cluster_spot_t *spot, void *data) {
+    int *calls = data;
+    (*calls)++;
+    return line_number(spot) % 2 == 1;
+}
+
+void test_select_filtered(void **state) {
+    cluster_spot_t spots[4];
+    int calls = 0;
+
+    for (int i = 0; i < 20; i++)
+	add_numbered(i);
+
+    assert_int_equal(cluster_spots_select(keep_odd, &calls, spots, 4), 4);
+    assert_int_equal(line_number(&spots[0]), 13);
+    assert_int_equal(line_number(&spots[3]), 19);
+    // stops as soon as enough entries are found
+    assert_int_equal(calls, 7);
+}
+
+void test_clear(void **state) {
+    cluster_spot_t spots[1];
+
+    add_numbered(1);
+    cluster_spots_clear();
+    assert_int_equal(cluster_spots_count(), 0);
+    assert_int_equal(cluster_spots_select(NULL, NULL, spots, 1), 0);
+}
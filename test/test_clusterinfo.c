@@ -2,15 +2,20 @@
 #include <stdio.h>
 
 #include "../src/clusterinfo.h"
+#include "../src/cluster_spots.h"
 #include "../src/globalvars.h"
 #include "../src/bandmap.h"
 #include "../src/lancode.h"
 #include "../src/dxcc.h"
+#include "../src/trx_state.h"
 
 // OBJECT ../src/clusterinfo.o
+// OBJECT ../src/cluster_spots.o
 // OBJECT ../src/bands.o
 // OBJECT ../src/get_time.o
 // OBJECT ../src/err_utils.o
+// OBJECT ../src/trx_state.o
+// OBJECT ../src/redraw.o
 
 
 int LINES = 25; /* test for 25 lines */
@@ -22,16 +27,17 @@ void clear_line(int row) {
     mvaddstr(row, 0, backgrnd_str);
 }
 
+void background_wakeup(void) {}
+
 char thisnode = 'A';
 freq_t node_frequencies[MAXNODES];
 
 #include <pthread.h>
-pthread_mutex_t spot_ptr_mutex = PTHREAD_MUTEX_INITIALIZER;
 pthread_mutex_t bm_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 bm_config_t bm_config = { .lifetime = 900 };
 
-GList *allspots = NULL; // not used yet
+GSequence *allspots = NULL; // not used yet
 
 /* mockups */
 static char nicebox_boxname[100];
@@ -71,6 +77,14 @@ dxcc_data *dxcc_by_index(unsigned int index) {
 
 /* setup/teardown */
 
+#define NR_LINES 25
+static char lines[NR_LINES][CLUSTER_LINE_SIZE];
+
+static void add_line(const char *line) {
+    cluster_spot_t spot;
+    cluster_spots_add(line, &spot);
+}
+
 static void put_dx_line(char *p, int index) {
     sprintf(p,
 	    "DX de QQ3QQQ:    %2d010.0  AA%dAAA      COMMENT                        12%02dZ",
@@ -106,14 +120,10 @@ int setup_default(void **state) {
     clear_mvprintw_history();
 
     // generate 25 various cluster spots
-    nr_of_spots = 25;
+    cluster_spots_clear();
 
-    for (int i = 0; i < MAX_SPOTS; ++i) {
-	char *spot = spot_ptr[i];
-	if (i >= nr_of_spots) {
-	    spot[0] = 0;
-	    continue;
-	}
+    for (int i = 0; i < NR_LINES; ++i) {
+	char *spot = lines[i];
 
 	if (i == 17) {
 	    put_short_line(spot, i);
@@ -127,10 +137,12 @@ int setup_default(void **state) {
 	    put_dx_line(spot, i);
 	}
 
+	add_line(spot);
     }
 
     trx_control = 1;
-    freq = 7123800.0;   // Hz
+    trx_state_t trx = { .freq = 7123800.0 };   // Hz
+    trx_state_publish(&trx);
 
     nicebox_boxname[0] = 0;
     printcall_called = 0;
@@ -155,18 +167,18 @@ void test_cluster_show_dx(void **state) {
     clusterinfo();
 
     // check that only DX spots are shown
-    check_mvprintw_output(7, 15, 1, spot_ptr[13]);
-    check_mvprintw_output(6, 16, 1, spot_ptr[14]);
-    check_mvprintw_output(5, 17, 1, spot_ptr[15]);
-    check_mvprintw_output(4, 18, 1, spot_ptr[16]);
+    check_mvprintw_output(7, 15, 1, lines[13]);
+    check_mvprintw_output(6, 16, 1, lines[14]);
+    check_mvprintw_output(5, 17, 1, lines[15]);
+    check_mvprintw_output(4, 18, 1, lines[16]);
     // #17 missing (short)
-    check_mvprintw_output(3, 19, 1, spot_ptr[18]);
+    check_mvprintw_output(3, 19, 1, lines[18]);
     // #19 missing (talk)
-    check_mvprintw_output(2, 20, 1, spot_ptr[20]);
+    check_mvprintw_output(2, 20, 1, lines[20]);
     // #21 missing (announcement)
-    check_mvprintw_output(1, 21, 1, spot_ptr[22]);
+    check_mvprintw_output(1, 21, 1, lines[22]);
     // #23 missing (WWV)
-    check_mvprintw_output(0, 22, 1, spot_ptr[24]);
+    check_mvprintw_output(0, 22, 1, lines[24]);
 
     assert_string_equal(nicebox_boxname, "Cluster");
 
@@ -183,17 +195,17 @@ void test_cluster_show_talk(void **state) {
     clusterinfo();
 
     // check that DX spots + talk message are shown
-    check_mvprintw_output(7, 15, 1, spot_ptr[14]);
-    check_mvprintw_output(6, 16, 1, spot_ptr[15]);
-    check_mvprintw_output(5, 17, 1, spot_ptr[16]);
+    check_mvprintw_output(7, 15, 1, lines[14]);
+    check_mvprintw_output(6, 16, 1, lines[15]);
+    check_mvprintw_output(5, 17, 1, lines[16]);
     // #17 missing (short)
-    check_mvprintw_output(4, 18, 1, spot_ptr[18]);
-    check_mvprintw_output(3, 19, 1, spot_ptr[19]);
-    check_mvprintw_output(2, 20, 1, spot_ptr[20]);
+    check_mvprintw_output(4, 18, 1, lines[18]);
+    check_mvprintw_output(3, 19, 1, lines[19]);
+    check_mvprintw_output(2, 20, 1, lines[20]);
     // #21 missing (announcement)
-    check_mvprintw_output(1, 21, 1, spot_ptr[22]);
+    check_mvprintw_output(1, 21, 1, lines[22]);
     // #23 missing (WWV)
-    check_mvprintw_output(0, 22, 1, spot_ptr[24]);
+    check_mvprintw_output(0, 22, 1, lines[24]);
 
     assert_string_equal(nicebox_boxname, "Cluster");
 
@@ -209,16 +221,16 @@ void test_cluster_show_ann(void **state) {
     clusterinfo();
 
     // check that DX spots + announcements are shown
-    check_mvprintw_output(7, 15, 1, spot_ptr[15]);
-    check_mvprintw_output(6, 16, 1, spot_ptr[16]);
+    check_mvprintw_output(7, 15, 1, lines[15]);
+    check_mvprintw_output(6, 16, 1, lines[16]);
     // #17 missing (short)
-    check_mvprintw_output(5, 17, 1, spot_ptr[18]);
-    check_mvprintw_output(4, 18, 1, spot_ptr[19]);
-    check_mvprintw_output(3, 19, 1, spot_ptr[20]);
-    check_mvprintw_output(2, 20, 1, spot_ptr[21]);
-    check_mvprintw_output(1, 21, 1, spot_ptr[22]);
+    check_mvprintw_output(5, 17, 1, lines[18]);
+    check_mvprintw_output(4, 18, 1, lines[19]);
+    check_mvprintw_output(3, 19, 1, lines[20]);
+    check_mvprintw_output(2, 20, 1, lines[21]);
+    check_mvprintw_output(1, 21, 1, lines[22]);
     // #23 missing (WWV)
-    check_mvprintw_output(0, 22, 1, spot_ptr[24]);
+    check_mvprintw_output(0, 22, 1, lines[24]);
 
     assert_string_equal(nicebox_boxname, "Cluster");
 
@@ -234,15 +246,15 @@ void test_cluster_show_all(void **state) {
     clusterinfo();
 
     // check that all spots are shown except the too short one
-    check_mvprintw_output(7, 15, 1, spot_ptr[16]);
+    check_mvprintw_output(7, 15, 1, lines[16]);
     // #17 missing (short)
-    check_mvprintw_output(6, 16, 1, spot_ptr[18]);
-    check_mvprintw_output(5, 17, 1, spot_ptr[19]);
-    check_mvprintw_output(4, 18, 1, spot_ptr[20]);
-    check_mvprintw_output(3, 19, 1, spot_ptr[21]);
-    check_mvprintw_output(2, 20, 1, spot_ptr[22]);
-    check_mvprintw_output(1, 21, 1, spot_ptr[23]);
-    check_mvprintw_output(0, 22, 1, spot_ptr[24]);
+    check_mvprintw_output(6, 16, 1, lines[18]);
+    check_mvprintw_output(5, 17, 1, lines[19]);
+    check_mvprintw_output(4, 18, 1, lines[20]);
+    check_mvprintw_output(3, 19, 1, lines[21]);
+    check_mvprintw_output(2, 20, 1, lines[22]);
+    check_mvprintw_output(1, 21, 1, lines[23]);
+    check_mvprintw_output(0, 22, 1, lines[24]);
 
     assert_string_equal(nicebox_boxname, "Cluster");
 
@@ -255,17 +267,19 @@ void test_cluster_show_all_6(void **state) {
     cluster = CLUSTER;
     announcefilter = FILTER_ALL;
 
-    nr_of_spots = 6;
+    cluster_spots_clear();
+    for (int i = 0; i < 6; ++i)
+	add_line(lines[i]);
 
     clusterinfo();
 
     // check that all 6 spots are shown
-    check_mvprintw_output(5, 15, 1, spot_ptr[0]);
-    check_mvprintw_output(4, 16, 1, spot_ptr[1]);
-    check_mvprintw_output(3, 17, 1, spot_ptr[2]);
-    check_mvprintw_output(2, 18, 1, spot_ptr[3]);
-    check_mvprintw_output(1, 19, 1, spot_ptr[4]);
-    check_mvprintw_output(0, 20, 1, spot_ptr[5]);
+    check_mvprintw_output(5, 15, 1, lines[0]);
+    check_mvprintw_output(4, 16, 1, lines[1]);
+    check_mvprintw_output(3, 17, 1, lines[2]);
+    check_mvprintw_output(2, 18, 1, lines[3]);
+    check_mvprintw_output(1, 19, 1, lines[4]);
+    check_mvprintw_output(0, 20, 1, lines[5]);
     // lines 21 and 22 are empty
 
     assert_string_equal(nicebox_boxname, "Cluster");
@@ -273,6 +287,23 @@ void test_cluster_show_all_6(void **state) {
     assert_true(printcall_called);
 }
 
+/* test CLUSTER mode on a terminal without room for the cluster window */
+void test_cluster_small_terminal(void **state) {
+
+    cluster = CLUSTER;
+    announcefilter = FILTER_ALL;
+
+    LINES = 16;
+    clusterinfo();
+    LINES = 25;
+
+    // nothing shown
+    assert_string_equal(mvprintw_history[0], "");
+    assert_string_equal(nicebox_boxname, "");
+
+    assert_true(printcall_called);
+}
+
 /* test FREQWINDOW mode */
 void test_freqwindow(void **state) {
 
@@ -6,9 +6,11 @@
 
 
 // OBJECT ../src/addpfx.o
+// OBJECT ../src/mult_registry.o
 // OBJECT ../src/bands.o
 // OBJECT ../src/dxcc.o
 // OBJECT ../src/getpx.o
+// OBJECT ../src/score_journal.o
 // OBJECT ../src/setcontest.o
 // OBJECT ../src/score.o
 // OBJECT ../src/plugin.o
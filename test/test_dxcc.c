@@ -1,5 +1,8 @@
 #include "test.h"
 
+#include <ctype.h>
+#include <utime.h>
+
 #include "../src/tlf.h"
 #include "../src/dxcc.h"
 
@@ -81,6 +84,120 @@ void test_add_prefix_check_defaults(void **state) {
     assert_float_equal(pfx->timezone, mydx->timezone, 1e-6);
 }
 
+#define CTY_DAT     TOP_SRCDIR "/share/cty.dat"
+#define CTY_CACHE   "cty_test.bin"
+
+/* compare loaded tables with the ones from parsing the text file */
+static void check_same_as_text(void) {
+    int nr_dxcc = dxcc_count(), nr_prefix = prefix_count();
+    dxcc_data *dx = g_new(dxcc_data, nr_dxcc);
+    prefix_data *pfx = g_new(prefix_data, nr_prefix);
+    char version[12];
+
+    for (int i = 0; i < nr_dxcc; i++) {
+	dx[i] = *dxcc_by_index(i);
+	dx[i].countryname = g_strdup(dx[i].countryname);
+    }
+    for (int i = 0; i < nr_prefix; i++) {
+	pfx[i] = *prefix_by_index(i);
+	pfx[i].pfx = g_strdup(pfx[i].pfx);
+    }
+    strcpy(version, cty_dat_version);
+    int dl = find_best_match("DL1ABC");
+    int ov = find_full_match("OH0/DL1ABC");
+
+    assert_int_equal(load_ctydata(CTY_DAT), 0);
+
+    assert_int_equal(dxcc_count(), nr_dxcc);
+    assert_int_equal(prefix_count(), nr_prefix);
+    assert_string_equal(cty_dat_version, version);
+    for (int i = 0; i < nr_dxcc; i++) {
+	assert_string_equal(dxcc_by_index(i)->countryname, dx[i].countryname);
+	assert_int_equal(dxcc_by_index(i)->cq, dx[i].cq);
+	g_free(dx[i].countryname);
+    }
+    for (int i = 0; i < nr_prefix; i++) {
+	assert_string_equal(prefix_by_index(i)->pfx, pfx[i].pfx);
+	assert_int_equal(prefix_by_index(i)->dxcc_ctynr, pfx[i].dxcc_ctynr);
+	assert_int_equal(prefix_by_index(i)->exact, pfx[i].exact);
+	g_free(pfx[i].pfx);
+    }
+    assert_int_equal(find_best_match("DL1ABC"), dl);
+    assert_int_equal(find_full_match("OH0/DL1ABC"), ov);
+
+    g_free(dx);
+    g_free(pfx);
+}
+
+void test_cache_written_and_used(void **state) {
+    unlink(CTY_CACHE);
+
+    assert_int_equal(load_ctydata_cached(CTY_DAT, CTY_CACHE), 0);
+    assert_false(dxcc_cached());
+    assert_int_equal(access(CTY_CACHE, R_OK), 0);
+
+    assert_int_equal(load_ctydata_cached(CTY_DAT, CTY_CACHE), 0);
+    assert_true(dxcc_cached());
+    assert_int_not_equal(prefix_count(), 0);
+    check_same_as_text();
+
+    unlink(CTY_CACHE);
+}
+
+static const char *country_of(const char *call) {
+    prefix_data *pfx = prefix_by_index(find_best_match(call));
+    return dxcc_by_index(pfx->dxcc_ctynr)->countryname;
+}
+
+void test_cache_stale(void **state) {
+    char *cty = "cty_test.dat";
+    char *content;
+    gsize len;
+    struct utimbuf times = { 1000000000, 1000000000 };
+
+    assert_true(g_file_get_contents(CTY_DAT, &content, &len, NULL));
+    assert_true(g_file_set_contents(cty, content, len, NULL));
+    utime(cty, &times);
+    unlink(CTY_CACHE);
+
+    assert_int_equal(load_ctydata_cached(cty, CTY_CACHE), 0);
+    assert_string_equal(country_of("DL1ABC"), "Fed. Rep. of Germany");
+
+    /* cty.dat got updated, same size and time */
+    char *name = strstr(content, "Germany");
+    assert_non_null(name);
+    name[6] = 'Y';
+    assert_true(g_file_set_contents(cty, content, len, NULL));
+    utime(cty, &times);
+    g_free(content);
+
+    assert_int_equal(load_ctydata_cached(cty, CTY_CACHE), 0);
+    assert_false(dxcc_cached());
+    assert_string_equal(country_of("DL1ABC"), "Fed. Rep. of GermanY");
+    assert_int_equal(load_ctydata_cached(cty, CTY_CACHE), 0);
+    assert_true(dxcc_cached());
+    assert_string_equal(country_of("DL1ABC"), "Fed. Rep. of GermanY");
+
+    unlink(cty);
+    unlink(CTY_CACHE);
+}
+
+void test_cache_broken(void **state) {
+    unlink(CTY_CACHE);
+    assert_int_equal(load_ctydata_cached(CTY_DAT, CTY_CACHE), 0);
+    assert_int_equal(truncate(CTY_CACHE, 8000), 0);
+
+    assert_int_equal(load_ctydata_cached(CTY_DAT, CTY_CACHE), 0);
+    assert_false(dxcc_cached());
+    assert_int_not_equal(prefix_count(), 0);
+
+    unlink(CTY_CACHE);
+}
+
+void test_cache_no_cty(void **state) {
+    assert_int_equal(load_ctydata_cached("no_such_cty.dat", CTY_CACHE), -1);
+}
+
 void test_add_prefix_check_overrides(void **state) {
     prefix_data *pfx;
     // NOTE: overrides must be in the order below
@@ -98,3 +215,134 @@ void test_add_prefix_check_overrides(void **state) {
     assert_float_equal(pfx->timezone, 5.5, 1e-6);
 }
 
+
+/* longest prefix match as done by stepwise shortening of the call */
+extern int two_char_prefix_index[36 * 36];
+
+static int base36(char c) {
+    if (isdigit(c)) {
+	return c - '0';
+    }
+    if (isupper(c)) {
+	return 10 + c - 'A';
+    }
+    return 0;
+}
+
+static int reference_best_match(const char *call) {
+    int w;
+
+    if (strlen(call) >= 2) {
+	w = two_char_prefix_index[base36(call[0]) + 36 * base36(call[1])];
+	if (w >= 0) {
+	    return w;
+	}
+    }
+
+    w = find_full_match(call);
+    if (w >= 0) {
+	return w;
+    }
+
+    char *temp = g_strdup(call);
+    for (int len = strlen(call) - 1; len >= 1; len--) {
+	temp[len] = 0;
+	int idx = find_full_match(temp);
+	if (idx >= 0 && !prefix_by_index(idx)->exact) {
+	    w = idx;
+	    break;
+	}
+    }
+    g_free(temp);
+
+    return w;
+}
+
+static void check_best_match(const char *call) {
+    int expected = reference_best_match(call);
+    int found = find_best_match(call);
+    if (found != expected) {
+	fail_msg("%s: found %d, expected %d", call, found, expected);
+    }
+}
+
+/* check all prefixes in cty.dat, their extensions and truncations */
+static void check_best_match_all(void) {
+    static const char *suffixes[] = {
+	"", "1ABC", "0", "A", "/P", "/MM", "/DL", "ZZ9"
+    };
+
+    for (int i = 0; i < prefix_count(); i++) {
+	const char *pfx = prefix_by_index(i)->pfx;
+
+	for (int j = 0; j < G_N_ELEMENTS(suffixes); j++) {
+	    char *call = g_strconcat(pfx, suffixes[j], NULL);
+	    check_best_match(call);
+	    g_free(call);
+	}
+
+	char *part = g_strdup(pfx);
+	for (int len = strlen(pfx) - 1; len >= 0; len--) {
+	    part[len] = '\0';
+	    check_best_match(part);
+	}
+	g_free(part);
+    }
+}
+
+void test_best_match_cty(void **state) {
+    assert_int_equal(load_ctydata(CTY_DAT), 0);
+    assert_true(prefix_count() > 5000);
+    check_best_match_all();
+}
+
+void test_best_match_cty_cached(void **state) {
+    unlink(CTY_CACHE);
+    assert_int_equal(load_ctydata_cached(CTY_DAT, CTY_CACHE), 0);
+    assert_int_equal(load_ctydata_cached(CTY_DAT, CTY_CACHE), 0);
+    assert_true(dxcc_cached());
+    check_best_match_all();
+    unlink(CTY_CACHE);
+}
+
+void test_best_match_callmaster(void **state) {
+    char line[80];
+
+    assert_int_equal(load_ctydata(CTY_DAT), 0);
+    FILE *fp = fopen(TOP_SRCDIR "/share/callmaster", "r");
+    assert_non_null(fp);
+    int n = 0;
+    while (fgets(line, sizeof(line), fp) != NULL) {
+	g_strstrip(line);
+	if (line[0] == '#' || line[0] == '\0') {
+	    continue;
+	}
+	check_best_match(line);
+	n++;
+    }
+    fclose(fp);
+    assert_true(n > 30000);
+}
+
+void test_best_match_other_chars(void **state) {
+    /* prefixes outside of A-Z0-9/ use the hashed lookup */
+    prefix_add("F");
+    prefix_add("FX");
+    prefix_add("FX-Y");
+    assert_int_equal(find_best_match("FX-Y1"), 2);
+    assert_int_equal(find_best_match("FX-1"), 1);
+    assert_int_equal(find_best_match("FXA"), 1);
+    assert_int_equal(find_best_match("F"), 0);
+}
+
+void test_best_match_exact(void **state) {
+    prefix_add("F");
+    prefix_add("=F1AB");
+    prefix_add("F1");
+    assert_int_equal(find_best_match("F1AB"), 1);
+    assert_int_equal(find_best_match("F1ABC"), 2);
+    assert_int_equal(find_best_match("F1A"), 2);
+    assert_int_equal(find_best_match("F2"), 0);
+    assert_int_equal(find_best_match("X"), -1);
+    assert_int_equal(find_best_match(""), -1);
+}
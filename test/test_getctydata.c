@@ -10,10 +10,12 @@
 #include "../src/getctydata.h"
 
 // OBJECT ../src/addpfx.o
+// OBJECT ../src/mult_registry.o
 // OBJECT ../src/bands.o
 // OBJECT ../src/dxcc.o
 // OBJECT ../src/getctydata.o
 // OBJECT ../src/getpx.o
+// OBJECT ../src/score_journal.o
 // OBJECT ../src/setcontest.o
 // OBJECT ../src/score.o
 // OBJECT ../src/plugin.o
@@ -23,7 +25,7 @@
 
 /* export internal function */
 int location_unknown(char *call);
-int getpfxindex(char *checkcallptr, char **normalized_call);
+int getpfxindex(char *checkcallptr, char *normalized_call);
 int find_full_match(const char *call);
 int find_best_match(const char *call);
 void checkexchange(struct qso_t *qso, bool interactive) {}
@@ -195,6 +197,25 @@ void test_someidea(void **data) {
     assert_int_not_equal(getpfxindex("DJ/PA3LM", NULL), -1);
 }
 
+#define check_normalized(x, y) \
+    (getpfxindex(x, normalized), assert_string_equal(normalized, y))
+
+void test_normalized_call(void **data) {
+    char normalized[CALL_BUFFER_SIZE];
+
+    check_normalized("DJ0LN", "DJ0LN");
+    check_normalized("DJ0LN/P", "DJ0LN");
+    check_normalized("DJ0LN/QRP", "DJ0LN");
+    check_normalized("LA3BB/MM", "");
+    check_normalized("LA3BB/AM/QRP", "");
+    check_normalized("K2ND/4", "K4ND");
+    check_normalized("PA/DJ0LN/P", "PA");
+    check_normalized("DJ0LN/PA", "PA");
+    check_normalized("DJ/PA3LM", "DJ");
+    check_normalized("R3A/PA", "PA");
+    check_normalized("DL1ABCDEFGHIJKLMNOP", "DL1ABCDEFGHIJKLM");
+}
+
 #define check(x) (assert_int_equal(getctynr(x), getctydata(x)))
 
 void test_same_result(void **data) {
@@ -10,13 +10,19 @@
 
 // OBJECT ../src/getexchange.o
 // OBJECT ../src/addmult.o
+// OBJECT ../src/alias_matcher.o
 // OBJECT ../src/addpfx.o
+// OBJECT ../src/mult_registry.o
 // OBJECT ../src/dxcc.o
 // OBJECT ../src/printcall.o
+// OBJECT ../src/score_journal.o
+// OBJECT ../src/searchcallarray.o
 // OBJECT ../src/setcontest.o
 // OBJECT ../src/focm.o
+// OBJECT ../src/initial_exchange.o
 // OBJECT ../src/getctydata.o
 // OBJECT ../src/getpx.o
+// OBJECT ../src/get_time.o
 // OBJECT ../src/plugin.o
 // OBJECT ../src/qrb.o
 // OBJECT ../src/score.o
@@ -24,6 +30,7 @@
 // OBJECT ../src/log_utils.o
 // OBJECT ../src/ui_utils.o
 // OBJECT ../src/utils.o
+// OBJECT ../src/redraw.o
 
 bool lan_active = false;
 
@@ -45,6 +52,7 @@ void qtc_main_panel(int direction) {}
 void rst_recv_up() {}
 void rst_recv_down() {}
 void stoptx() {}
+void background_wakeup(void) {}
 void speedup() {}
 void speeddown() {}
 void vk_play_file() {}
@@ -0,0 +1,207 @@
+#include "test.h"
+
+#include <pthread.h>
+#include <hamlib/rig.h>
+
+#include "../src/bands.h"
+#include "../src/cat_stats.h"
+#include "../src/gettxinfo.h"
+#include "../src/globalvars.h"
+#include "../src/trx_state.h"
+
+// OBJECT ../src/gettxinfo.o
+// OBJECT ../src/cat_stats.o
+// OBJECT ../src/trx_state.o
+// OBJECT ../src/bands.o
+// OBJECT ../src/cw_utils.o
+// OBJECT ../src/err_utils.o
+
+pthread_mutex_t rig_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* mockups */
+void clear_line(int row) {
+}
+
+int fldigi_get_carrier(void) {
+    return 0;
+}
+
+int fldigi_get_shift_freq(void) {
+    return 0;
+}
+
+int hamlib_keyer_get_speed(int *cwspeed) {
+    return -RIG_ENIMPL;
+}
+
+static freq_t bandswitch_freq;
+void send_bandswitch(freq_t freq) {
+    bandswitch_freq = freq;
+}
+
+static freq_t rig_freq(void) {
+    freq_t f = 0;
+    assert_int_equal(rig_get_freq(my_rig, RIG_VFO_CURR, &f), RIG_OK);
+    return f;
+}
+
+static rmode_t rig_mode(void) {
+    rmode_t mode;
+    pbwidth_t width;
+    assert_int_equal(rig_get_mode(my_rig, RIG_VFO_CURR, &mode, &width),
+		     RIG_OK);
+    return mode;
+}
+
+int setup_default(void **state) {
+    rig_set_debug(RIG_DEBUG_NONE);
+    my_rig = rig_init(RIG_MODEL_DUMMY);
+    assert_non_null(my_rig);
+    assert_int_equal(rig_open(my_rig), RIG_OK);
+
+    trx_control = true;
+    trxmode = CWMODE;
+    cwkeyer = NET_KEYER;
+    digikeyer = NO_KEYER;
+    rigptt = 0;
+    bandswitch_freq = 0;
+
+    gettxinfo();	/* drop requests left over from the last test */
+    return 0;
+}
+
+int teardown_default(void **state) {
+    rig_thread_stop();
+    rig_close(my_rig);
+    rig_cleanup(my_rig);
+    my_rig = NULL;
+    return 0;
+}
+
+void test_qsy_publishes_state(void **state) {
+    trx_state_t trx;
+
+    set_outfreq(7010000);
+    gettxinfo();
+
+    assert_int_equal(rig_freq(), 7010000);
+    trx_state_get(&trx);
+    assert_int_equal(trx.freq, 7010000);
+    assert_int_equal(trx.bandinx, BANDINDEX_40);
+    assert_false(trx.ptt);
+    assert_int_equal(freq, 7010000);
+    assert_int_equal(bandinx, BANDINDEX_40);
+}
+
+void test_qsy_counted(void **state) {
+    cat_op_stats_t s;
+
+    cat_stats_reset();
+    set_outfreq(7010000);
+    gettxinfo();
+
+    cat_stats_get(CAT_SET_FREQ, &s);
+    assert_int_equal(s.calls, 1);
+    assert_int_equal(s.errors + s.timeouts, 0);
+    cat_stats_get(CAT_GET_FREQ, &s);
+    assert_int_equal(s.calls, 1);
+}
+
+void test_qsy_coalesced(void **state) {
+    int coalesced = get_coalesced_outfreq();
+
+    set_outfreq(14010000);
+    set_outfreq(14020000);
+    set_outfreq(14030000);
+    assert_int_equal(get_outfreq(), 14030000);
+    assert_int_equal(get_coalesced_outfreq(), coalesced + 2);
+
+    gettxinfo();
+    assert_int_equal(get_outfreq(), 0);
+    assert_int_equal(rig_freq(), 14030000);
+}
+
+void test_qsy_band_change(void **state) {
+    set_outfreq(7010000);
+    gettxinfo();
+    set_outfreq(21010000);
+    gettxinfo();
+    assert_int_equal(bandswitch_freq, 21010000);
+    assert_int_equal(rig_mode(), RIG_MODE_CW);
+}
+
+void test_no_trx_control(void **state) {
+    trx_control = false;
+    set_outfreq(14010000);
+    assert_int_equal(get_outfreq(), 0);
+}
+
+void test_mode_after_qsy(void **state) {
+    trxmode = SSBMODE;
+    set_outfreq(14010000);
+    gettxinfo();
+
+    // SSB mode is chosen for the new frequency
+    set_outfreq(7090000);
+    set_outfreq(SETSSBMODE);
+    gettxinfo();
+    assert_int_equal(rig_mode(), RIG_MODE_LSB);
+    assert_int_equal(rig_freq(), 7090000);
+}
+
+void test_mode_coalesced(void **state) {
+    set_outfreq(SETSSBMODE);
+    set_outfreq(SETCWMODE);
+    gettxinfo();
+    assert_int_equal(rig_mode(), RIG_MODE_CW);
+}
+
+void test_mode_keeps_qsy(void **state) {
+    set_outfreq(14025000);
+    set_outfreq(SETCWMODE);
+    assert_int_equal(get_outfreq(), 14025000);
+    gettxinfo();
+    assert_int_equal(rig_freq(), 14025000);
+}
+
+void test_ptt(void **state) {
+    trx_state_t trx;
+    ptt_t ptt;
+
+    rigptt = CAT_PTT_USE;
+    set_rig_ptt(true);
+    gettxinfo();
+    assert_int_equal(rigptt, CAT_PTT_USE | CAT_PTT_ACTIVE);
+    assert_int_equal(rig_get_ptt(my_rig, RIG_VFO_CURR, &ptt), RIG_OK);
+    assert_int_equal(ptt, RIG_PTT_ON);
+
+    set_outfreq(14010000);	// polls and publishes the PTT state
+    gettxinfo();
+    trx_state_get(&trx);
+    assert_true(trx.ptt);
+
+    set_rig_ptt(false);
+    gettxinfo();
+    assert_int_equal(rigptt, CAT_PTT_USE);
+    assert_int_equal(rig_get_ptt(my_rig, RIG_VFO_CURR, &ptt), RIG_OK);
+    assert_int_equal(ptt, RIG_PTT_OFF);
+}
+
+void test_thread(void **state) {
+    trx_state_t trx;
+
+    rig_thread_start();
+    set_outfreq(28010000);
+
+    for (int i = 0; i < 200; i++) {
+	trx_state_get(&trx);
+	if (trx.freq == 28010000)
+	    break;
+	usleep(10000);
+    }
+    assert_int_equal(trx.freq, 28010000);
+    assert_int_equal(trx.bandinx, BANDINDEX_10);
+
+    rig_thread_stop();
+    assert_int_equal(rig_freq(), 28010000);
+}
@@ -30,24 +30,14 @@ void test_no_file(void **state) {
 
 static void check_data(struct ie_list *data) {
     assert_non_null(data);
-    int size = 0;
-    struct ie_list *r[3];
-    struct ie_list *p = data;
-    while (p) {
-	if (size < 3) {
-	    r[size] = p;    // save result for later checks
-	}
-	++size;
-	p = p->next;
-    }
-    assert_int_equal(size, 3);
-    // note: order is reverse as in the file
-    assert_string_equal(r[0]->call, "YU5T");
-    assert_string_equal(r[0]->exchange, "43N22O");
-    assert_string_equal(r[1]->call, "2E0AAA");
-    assert_string_equal(r[1]->exchange, "51N3W");
-    assert_string_equal(r[2]->call, "2E0BBB");
-    assert_string_equal(r[2]->exchange, "51N00W");
+    assert_int_equal(ie_list_size(data), 3);
+    // entries are kept in file order
+    assert_string_equal(ie_list_entry(data, 0)->call, "2E0BBB");
+    assert_string_equal(ie_list_entry(data, 0)->exchange, "51N00W");
+    assert_string_equal(ie_list_entry(data, 1)->call, "2E0AAA");
+    assert_string_equal(ie_list_entry(data, 1)->exchange, "51N3W");
+    assert_string_equal(ie_list_entry(data, 2)->call, "YU5T");
+    assert_string_equal(ie_list_entry(data, 2)->exchange, "43N22O");
 }
 
 void test_ok(void **state) {
@@ -107,3 +97,55 @@ void test_ok_multi_column(void **state) {
     check_data(data);
 }
 
+
+void test_lookup_exchange(void **state) {
+    data = make_ie_list("data/ie_ok.txt");
+    assert_string_equal(ie_lookup_exchange(data, "2E0AAA"), "51N3W");
+    assert_string_equal(ie_lookup_exchange(data, "YU5T"), "43N22O");
+    assert_null(ie_lookup_exchange(data, "YU5"));
+    assert_null(ie_lookup_exchange(data, "YU5T/P"));
+    assert_null(ie_lookup_exchange(NULL, "YU5T"));
+}
+
+void test_lookup_portable(void **state) {
+    data = make_ie_list("data/ie_ok.txt");
+    assert_string_equal(ie_lookup_portable(data, "YU5T"), "43N22O");
+    assert_string_equal(ie_lookup_portable(data, "YU5T/P"), "43N22O");
+    assert_string_equal(ie_lookup_portable(data, "DL/2E0AAA"), "51N3W");
+    assert_string_equal(ie_lookup_portable(data, "DL/2E0AAA/QRP"), "51N3W");
+    assert_null(ie_lookup_portable(data, "YU5TA"));
+    assert_null(ie_lookup_portable(data, "AYU5T/P"));
+    assert_null(ie_lookup_portable(data, ""));
+}
+
+/* later lines win, as well as for the parts of portable calls */
+void test_lookup_last_entry_wins(void **state) {
+    FILE *fp = fopen("ie_dupes.txt", "w");
+    fputs("DL1ABC,1\nDL,2\nDL1ABC,3\nDL/DL1ABC,4\nP,5\n", fp);
+    fclose(fp);
+
+    data = make_ie_list("ie_dupes.txt");
+    unlink("ie_dupes.txt");
+    assert_int_equal(ie_list_size(data), 5);
+    assert_string_equal(ie_lookup_exchange(data, "DL1ABC"), "3");
+    assert_string_equal(ie_lookup_portable(data, "DL1ABC"), "3");
+    assert_string_equal(ie_lookup_portable(data, "DL1ABC/P"), "5");
+    assert_string_equal(ie_lookup_portable(data, "DL/DL1ABC"), "4");
+    assert_string_equal(ie_lookup_portable(data, "DL/DL1ABC/M"), "4");
+    assert_string_equal(ie_lookup_portable(data, "DL/OE1XYZ"), "2");
+}
+
+void test_large_file_reports_load_time(void **state) {
+    FILE *fp = fopen("ie_large.txt", "w");
+    for (int i = 0; i < 20000; i++) {
+	fprintf(fp, "K%dAA,%d\n", i, i % 100);
+    }
+    fclose(fp);
+
+    data = make_ie_list("ie_large.txt");
+    unlink("ie_large.txt");
+    assert_int_equal(ie_list_size(data), 20000);
+    assert_string_equal(ie_lookup_portable(data, "K12345AA/4"), "45");
+    assert_non_null(strstr(showmsg_spy,
+			   "20000 initial exchange entries loaded in"));
+}
@@ -0,0 +1,275 @@
+#include "test.h"
+
+#include <unistd.h>
+
+#include "../src/lan_seq.h"
+#include "../src/lancode.h"
+#include "../src/tlf.h"
+#include "../src/err_utils.h"
+
+#include "../src/globalvars.h"
+
+// OBJECT ../src/lan_seq.o
+// OBJECT ../src/lancode.o
+
+#define TEST_LAN_PORT 16789
+
+void handle_logging(enum log_lvl lvl, ...) {
+    // empty
+}
+
+time_t get_time() {
+    return 0;
+}
+void clear_line(int row) {
+}
+
+int setup_default(void **state) {
+
+    lan_active = true;
+    nodes = 1;
+    strcpy(bc_hostaddress[0], "127.0.0.1");
+    sprintf(bc_hostservice[0], "%d", TEST_LAN_PORT);
+    lan_port = TEST_LAN_PORT;
+    thisnode = 'A';
+
+    assert_int_equal(lan_recv_init(), 0);
+    assert_int_equal(lan_send_init(), 0);
+    lan_seq_init();
+
+    sendto_forward = true;
+    sendto_drop = NULL;
+    sendto_dropped = 0;
+
+    return 0;
+}
+
+int teardown_default(void **state) {
+
+    sendto_forward = false;
+    sendto_drop = NULL;
+    lan_seq_free();
+    lan_send_close();
+    lan_recv_close();
+    thisnode = 'A';
+
+    return 0;
+}
+
+/* all nodes share the loopback socket, act as 'node' on the pending
+ * messages from other nodes and collect the delivered ones */
+static int pump(char node, lan_message_t *delivered, int max) {
+    lan_message_t msgs[LAN_RECV_BATCH];
+    lan_message_t inner;
+    GArray *pending = g_array_new(FALSE, FALSE, sizeof(lan_message_t));
+    int count = 0;
+    int n;
+
+    /* read first, answers go to the next pump() */
+    while ((n = lan_recv(msgs, LAN_RECV_BATCH)) > 0)
+	g_array_append_vals(pending, msgs, n);
+
+    thisnode = node;
+    for (int i = 0; i < pending->len; i++) {
+	lan_message_t *msg = &g_array_index(pending, lan_message_t, i);
+	if (msg->node == node)
+	    continue;
+	if (lan_seq_receive(msg, &inner)) {
+	    assert_true(count < max);
+	    delivered[count++] = inner;
+	}
+    }
+    thisnode = 'A';
+
+    g_array_free(pending, TRUE);
+    return count;
+}
+
+static char *make_line(int nr) {
+    static char line[90];
+    sprintf(line, " 40CW  12-Jan-18 16:%02d %04d  DL%dABC          599  599  "
+	    "15                     1         ", nr % 60, nr, nr % 10);
+    return line;
+}
+
+/* log line as received by the old unnumbered LOGENTRY message */
+static char *received_line(int nr) {
+    static char line[90];
+    g_strlcpy(line, make_line(nr), 80);
+    return line;
+}
+
+static bool drop_second_entry(const char *buf, size_t len) {
+    static int entries = 0;
+    if (buf[1] != SEQENTRY)
+	return false;
+    return ++entries == 2;
+}
+
+static bool drop_entries(const char *buf, size_t len) {
+    return buf[1] == SEQENTRY;
+}
+
+void test_send_numbered(void **state) {
+
+    send_lan_message(LOGENTRY, make_line(1));
+
+    assert_int_equal(sendto_last_message[0], 'A');
+    assert_int_equal(sendto_last_message[1], SEQENTRY);
+    char *expected = g_strdup_printf(":1:%c%.80s\n", LOGENTRY, make_line(1));
+    assert_non_null(strstr(sendto_last_message, expected));
+    g_free(expected);
+}
+
+void test_receive_in_order(void **state) {
+    lan_message_t got[10];
+
+    for (int i = 1; i <= 3; i++)
+	send_lan_message(LOGENTRY, make_line(i));
+
+    assert_int_equal(pump('B', got, 10), 3);
+    for (int i = 0; i < 3; i++) {
+	assert_int_equal(got[i].node, 'A');
+	assert_int_equal(got[i].opcode, LOGENTRY);
+	assert_string_equal(got[i].data, received_line(i + 1));
+	assert_false(got[i].catchup);
+    }
+    assert_int_equal(lan_seq_missing('A'), 0);
+}
+
+void test_unnumbered_unchanged(void **state) {
+
+    send_lan_message(INCQSONUM, "123");
+
+    assert_string_equal(sendto_last_message, "A6123\n");
+}
+
+void test_duplicate_dropped(void **state) {
+    lan_message_t got[10];
+
+    send_lan_message(LOGENTRY, make_line(1));
+    char *again = g_strdup(sendto_last_message);
+
+    assert_int_equal(pump('B', got, 10), 1);
+
+    /* same datagram once more */
+    lan_send(again);
+    g_free(again);
+    assert_int_equal(pump('B', got, 10), 0);
+}
+
+void test_gap_is_requested(void **state) {
+    lan_message_t got[10];
+
+    sendto_drop = drop_second_entry;
+    for (int i = 1; i <= 3; i++)
+	send_lan_message(LOGENTRY, make_line(i));
+    assert_int_equal(sendto_dropped, 1);
+
+    /* B notices the gap with message 3 and asks for message 2 */
+    assert_int_equal(pump('B', got, 10), 2);
+    assert_string_equal(got[0].data, received_line(1));
+    assert_string_equal(got[1].data, received_line(3));
+    assert_int_equal(lan_seq_missing('A'), 1);
+    assert_int_equal(sendto_last_message[1], SEQREQUEST);
+
+    /* A resends message 2 */
+    assert_int_equal(pump('A', got, 10), 0);
+    assert_int_equal(pump('B', got, 10), 1);
+    assert_string_equal(got[0].data, received_line(2));
+    assert_false(got[0].catchup);
+    assert_int_equal(lan_seq_missing('A'), 0);
+}
+
+void test_rejoin_by_status(void **state) {
+    lan_message_t got[10];
+
+    /* B is not listening while A logs */
+    sendto_drop = drop_entries;
+    for (int i = 1; i <= 5; i++)
+	send_lan_message(LOGENTRY, make_line(i));
+    sendto_drop = NULL;
+
+    lan_seq_announce();
+    assert_int_equal(pump('B', got, 10), 0);
+    assert_int_equal(lan_seq_missing('A'), 5);
+
+    assert_int_equal(pump('A', got, 10), 0);
+    assert_int_equal(pump('B', got, 10), 5);
+    for (int i = 0; i < 5; i++) {
+	assert_string_equal(got[i].data, received_line(i + 1));
+	assert_true(got[i].catchup);	/* may be known from before */
+    }
+    assert_int_equal(lan_seq_missing('A'), 0);
+}
+
+void test_rejoin_skips_qtc(void **state) {
+    lan_message_t got[10];
+
+    sendto_drop = drop_entries;
+    send_lan_message(QTCRENTRY, "  3 CW  1 DL1AAA  1/10 1200 OK1XY 001\n");
+    send_lan_message(LOGENTRY, make_line(1));
+    sendto_drop = NULL;
+
+    lan_seq_announce();
+    pump('B', got, 10);
+    pump('A', got, 10);
+    assert_int_equal(pump('B', got, 10), 1);
+    assert_int_equal(got[0].opcode, LOGENTRY);
+    assert_int_equal(lan_seq_missing('A'), 0);
+}
+
+void test_large_catchup(void **state) {
+    lan_message_t got[LAN_CATCHUP_MAX + 1];
+    const int total = 2 * LAN_CATCHUP_MAX + 20;
+    int received = 0;
+
+    sendto_drop = drop_entries;
+    for (int i = 1; i <= total; i++)
+	send_lan_message(LOGENTRY, make_line(i));
+    sendto_drop = NULL;
+
+    lan_seq_announce();
+    pump('B', got, LAN_CATCHUP_MAX + 1);
+
+    /* the next chunk is requested as soon as one is complete */
+    for (int round = 0; round < 5 && received < total; round++) {
+	pump('A', got, LAN_CATCHUP_MAX + 1);
+	int n = pump('B', got, LAN_CATCHUP_MAX + 1);
+	for (int i = 0; i < n; i++) {
+	    received++;
+	    assert_string_equal(got[i].data, received_line(received));
+	}
+    }
+    assert_int_equal(received, total);
+    assert_int_equal(lan_seq_missing('A'), 0);
+}
+
+static lan_message_t entry(guint64 epoch, int seq, const char *line) {
+    lan_message_t msg;
+    msg.node = 'C';
+    msg.opcode = SEQENTRY;
+    msg.catchup = false;
+    sprintf(msg.data, "%" G_GINT64_MODIFIER "x:%d:%c%s", epoch, seq,
+	    LOGENTRY, line);
+    return msg;
+}
+
+void test_new_session(void **state) {
+    lan_message_t inner;
+    lan_message_t msg;
+
+    msg = entry(0x100, 1, "line1X");
+    assert_true(lan_seq_receive(&msg, &inner));
+    assert_string_equal(inner.data, "line1");
+
+    /* C restarted, numbering starts over */
+    msg = entry(0x200, 1, "line2X");
+    assert_true(lan_seq_receive(&msg, &inner));
+    assert_string_equal(inner.data, "line2");
+    assert_false(inner.catchup);
+
+    /* late message from the old session */
+    msg = entry(0x100, 2, "line3X");
+    assert_false(lan_seq_receive(&msg, &inner));
+}
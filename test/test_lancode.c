@@ -1,11 +1,17 @@
 #include "test.h"
 
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
 #include "../src/lancode.h"
 #include "../src/tlf.h"
 #include "../src/err_utils.h"
 
 #include "../src/globalvars.h"
 
+// OBJECT ../src/lan_seq.o
 // OBJECT ../src/lancode.o
 
 void handle_logging(enum log_lvl lvl, ...) {
@@ -71,3 +77,82 @@ void test_send_freq_10_notrx(void **state) {
     assert_non_null(sendto_last_message);
     assert_string_equal(sendto_last_message, "A5   10.0");
 }
+
+/* receiving */
+#define TEST_LAN_PORT 16788
+
+static int open_sender(void) {
+    struct sockaddr_in addr;
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    assert_true(fd >= 0);
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(TEST_LAN_PORT);
+    assert_int_equal(connect(fd, (struct sockaddr *)&addr, sizeof(addr)), 0);
+    return fd;
+}
+
+static void send_datagram(int fd, const char *msg) {
+    assert_int_equal(send(fd, msg, strlen(msg), 0), strlen(msg));
+}
+
+void test_recv_nothing(void **state) {
+    lan_message_t msgs[LAN_RECV_BATCH];
+
+    lan_port = TEST_LAN_PORT;
+    assert_int_equal(lan_recv_init(), 0);
+
+    assert_int_equal(lan_recv(msgs, LAN_RECV_BATCH), 0);
+
+    lan_recv_close();
+}
+
+void test_recv_message(void **state) {
+    lan_message_t msgs[LAN_RECV_BATCH];
+
+    lan_port = TEST_LAN_PORT;
+    assert_int_equal(lan_recv_init(), 0);
+    int fd = open_sender();
+
+    send_datagram(fd, "B6123\n");
+    assert_int_equal(lan_recv(msgs, LAN_RECV_BATCH), 1);
+    assert_int_equal(msgs[0].node, 'B');
+    assert_int_equal(msgs[0].opcode, INCQSONUM);
+    assert_string_equal(msgs[0].data, "123");
+
+    close(fd);
+    lan_recv_close();
+}
+
+/* a burst of messages is read in batches without losing any */
+void test_recv_burst(void **state) {
+    lan_message_t msgs[LAN_RECV_BATCH];
+    char buffer[20];
+    int received = 0;
+
+    lan_port = TEST_LAN_PORT;
+    assert_int_equal(lan_recv_init(), 0);
+    int fd = open_sender();
+
+    for (int i = 0; i < 3 * LAN_RECV_BATCH + 5; i++) {
+	sprintf(buffer, "C6%d\n", i);
+	send_datagram(fd, buffer);
+    }
+
+    int n;
+    while ((n = lan_recv(msgs, LAN_RECV_BATCH)) > 0) {
+	assert_true(n <= LAN_RECV_BATCH);
+	for (int i = 0; i < n; i++) {
+	    assert_int_equal(msgs[i].node, 'C');
+	    assert_int_equal(atoi(msgs[i].data), received);
+	    received++;
+	}
+    }
+    assert_int_equal(received, 3 * LAN_RECV_BATCH + 5);
+
+    close(fd);
+    lan_recv_close();
+}
+
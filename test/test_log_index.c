@@ -0,0 +1,73 @@
+#include "test.h"
+
+#include "../src/globalvars.h"
+#include "../src/log_index.h"
+#include "../src/log_utils.h"
+
+// OBJECT ../src/log_index.o
+// OBJECT ../src/call_index.o
+// OBJECT ../src/log_utils.o
+// OBJECT ../src/bands.o
+
+#define QSO1 " 40SSB 12-Jan-18 16:34 0006  SP9ABC         599  599  15                    10         "
+#define QSO2 " 20CW  12-Jan-18 16:40 0007  DL1ABC         599  599  15            DL       3  14025.0"
+#define NOTE "; Test note handling in logfile                                                 "
+
+static void add_logline(const char *line) {
+    char *buffer = g_strdup(line);
+    g_ptr_array_add(qso_array, parse_qso(buffer));
+    g_free(buffer);
+    log_index_update();
+}
+
+int setup_default(void **state) {
+    init_qso_array();
+    add_logline(QSO1);
+    add_logline(NOTE);
+    add_logline(QSO2);
+    return 0;
+}
+
+int teardown_default(void **state) {
+    free_qso_array();
+    return 0;
+}
+
+/* test looking up a line received from another node */
+void test_has_line(void **state) {
+    assert_true(log_index_has_line(QSO1));
+    assert_true(log_index_has_line(QSO2));
+    assert_true(log_index_has_line(NOTE));
+}
+
+void test_has_line_marked(void **state) {
+    char *line = g_strdup(QSO2);
+    line[79] = '*';		/* from another station */
+    assert_true(log_index_has_line(line));
+    g_free(line);
+}
+
+void test_has_line_rescored(void **state) {
+    char *line = g_strdup(QSO2);
+    memcpy(line + 68, "DL       4", 10);	/* other points */
+    assert_true(log_index_has_line(line));
+    g_free(line);
+}
+
+void test_has_not_line(void **state) {
+    char *line = g_strdup(QSO2);
+    memcpy(line + 29, "DL2ABC", 6);
+    assert_false(log_index_has_line(line));
+    memcpy(line + 29, "DL1ABC", 6);
+    memcpy(line + 17, "16:41", 5);
+    assert_false(log_index_has_line(line));
+    g_free(line);
+}
+
+/* index follows replaced QSOs */
+void test_has_line_after_change(void **state) {
+    g_ptr_array_remove_index(qso_array, 2);
+    qso_array_changed();
+    assert_false(log_index_has_line(QSO2));
+    assert_true(log_index_has_line(QSO1));
+}
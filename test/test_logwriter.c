@@ -0,0 +1,139 @@
+#include "test.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "../src/globalvars.h"
+#include "../src/log_writer.h"
+
+// OBJECT ../src/log_writer.o
+
+#define TESTLOG "logwriter_test.log"
+#define TESTLOG2 "logwriter_test2.log"
+
+#define LOGLINE " 20CW  18-Jan-14 16:04 0111  N0CALL         599  599  33            W        3  14025.0"
+
+static int count_lines(const char *file) {
+    char buffer[LOGLINELEN + 5];
+    int n = 0;
+
+    FILE *fp = fopen(file, "r");
+    if (fp == NULL) {
+	return -1;
+    }
+    while (fgets(buffer, sizeof(buffer), fp) != NULL) {
+	assert_string_equal(buffer, LOGLINE "\n");
+	n++;
+    }
+    fclose(fp);
+    return n;
+}
+
+int setup_default(void **state) {
+    unlink(TESTLOG);
+    unlink(TESTLOG2);
+    log_sync_mode = LOG_SYNC_QSO;
+    log_sync_interval = 1000;
+    return 0;
+}
+
+int teardown_default(void **state) {
+    log_writer_stop();
+    unlink(TESTLOG);
+    unlink(TESTLOG2);
+    return 0;
+}
+
+void test_not_running(void **state) {
+    assert_int_equal(log_writer_append(TESTLOG, LOGLINE), false);
+    log_writer_flush();     // no effect
+    assert_int_equal(count_lines(TESTLOG), -1);
+}
+
+void test_append_and_flush(void **state) {
+    log_writer_start();
+    for (int i = 0; i < 3; i++) {
+	assert_int_equal(log_writer_append(TESTLOG, LOGLINE), true);
+    }
+    log_writer_flush();
+    assert_int_equal(count_lines(TESTLOG), 3);
+}
+
+void test_more_than_queue_size(void **state) {
+    log_sync_mode = LOG_SYNC_IDLE;
+    log_writer_start();
+    for (int i = 0; i < 1000; i++) {
+	log_writer_append(TESTLOG, LOGLINE);
+    }
+    log_writer_flush();
+    assert_int_equal(count_lines(TESTLOG), 1000);
+}
+
+void test_interval(void **state) {
+    log_sync_mode = LOG_SYNC_INTERVAL;
+    log_sync_interval = 10;
+    log_writer_start();
+    log_writer_append(TESTLOG, LOGLINE);
+    log_writer_append(TESTLOG, LOGLINE);
+    log_writer_flush();
+    assert_int_equal(count_lines(TESTLOG), 2);
+}
+
+void test_stop_writes_queued_lines(void **state) {
+    log_writer_start();
+    for (int i = 0; i < 10; i++) {
+	log_writer_append(TESTLOG, LOGLINE);
+    }
+    log_writer_stop();
+    assert_int_equal(count_lines(TESTLOG), 10);
+    assert_int_equal(log_writer_append(TESTLOG, LOGLINE), false);
+}
+
+/* after flush the file may be replaced, next line goes to the new file */
+void test_reopen_after_flush(void **state) {
+    log_writer_start();
+    log_writer_append(TESTLOG, LOGLINE);
+    log_writer_flush();
+    assert_int_equal(rename(TESTLOG, TESTLOG2), 0);
+
+    log_writer_append(TESTLOG, LOGLINE);
+    log_writer_flush();
+    assert_int_equal(count_lines(TESTLOG), 1);
+    assert_int_equal(count_lines(TESTLOG2), 1);
+}
+
+void test_switch_file(void **state) {
+    log_writer_start();
+    log_writer_append(TESTLOG, LOGLINE);
+    log_writer_append(TESTLOG2, LOGLINE);
+    log_writer_append(TESTLOG, LOGLINE);
+    log_writer_flush();
+    assert_int_equal(count_lines(TESTLOG), 2);
+    assert_int_equal(count_lines(TESTLOG2), 1);
+}
+
+/* the writer keeps running after an error, it is reported once */
+void test_open_error_recorded(void **state) {
+    char *file;
+    int lost;
+    int before = log_writer_errors();
+
+    log_writer_start();
+    log_writer_append("no_such_dir/" TESTLOG, LOGLINE);
+    log_writer_append("no_such_dir/" TESTLOG, LOGLINE);
+    log_writer_append(TESTLOG, LOGLINE);
+    log_writer_flush();
+
+    assert_int_equal(log_writer_errors() - before, 2);
+    assert_int_equal(count_lines(TESTLOG), 1);
+
+    assert_int_equal(log_writer_take_error(&file, &lost), ENOENT);
+    assert_string_equal(file, "no_such_dir/" TESTLOG);
+    assert_int_equal(lost, 2);
+    g_free(file);
+
+    assert_int_equal(log_writer_take_error(&file, &lost), 0);
+    assert_null(file);
+    assert_int_equal(lost, 0);
+}
@@ -21,6 +21,7 @@
 
 // OBJECT ../src/audio.o
 // OBJECT ../src/addpfx.o
+// OBJECT ../src/mult_registry.o
 // OBJECT ../src/bands.o
 // OBJECT ../src/parse_logcfg.o
 // OBJECT ../src/get_time.o
@@ -29,6 +30,7 @@
 // OBJECT ../src/score.o
 // OBJECT ../src/plugin.o
 // OBJECT ../src/log_utils.o
+// OBJECT ../src/score_journal.o
 // OBJECT ../src/utils.o
 // OBJECT ../src/qrb.o
 // OBJECT ../src/setcontest.o
@@ -60,6 +62,7 @@ bool call_update = false;
 t_qtc_ry_line qtc_ry_lines[QTC_RY_LINE_NR];
 
 void checkexchange(struct qso_t *qso, bool interactive) {}
+void set_rig_ptt(bool on) {}
 int check_mult(struct qso_t *qso) { return -1; }
 dxcc_data *dxcc_by_index(unsigned int index) { return NULL; }
 
@@ -897,6 +900,34 @@ void test_cqdelay(void **state) {
     assert_int_equal(cqdelay, 12);
 }
 
+void test_cat_stats_file(void **state) {
+    int rc = call_parse_logcfg("CAT_STATS_FILE=cat.txt\n");
+    assert_int_equal(rc, PARSE_OK);
+    assert_string_equal(cat_stats_file, "cat.txt");
+}
+
+void test_cluster_spots(void **state) {
+    int rc = call_parse_logcfg("CLUSTER_SPOTS=5000\n");
+    assert_int_equal(rc, PARSE_OK);
+    assert_int_equal(cluster_spots_capacity, 5000);
+}
+
+void test_cluster_spots_too_small(void **state) {
+    int rc = call_parse_logcfg("CLUSTER_SPOTS=100\n");
+    assert_int_equal(rc, PARSE_ERROR);
+}
+
+void test_frame_rate(void **state) {
+    int rc = call_parse_logcfg("FRAME_RATE=10\n");
+    assert_int_equal(rc, PARSE_OK);
+    assert_int_equal(frame_rate, 10);
+}
+
+void test_frame_rate_too_high(void **state) {
+    int rc = call_parse_logcfg("FRAME_RATE=500\n");
+    assert_int_equal(rc, PARSE_ERROR);
+}
+
 void test_ssbpoints(void **state) {
     int rc = call_parse_logcfg("SSBPOINTS=2\n");
     assert_int_equal(rc, PARSE_OK);
@@ -1450,6 +1481,31 @@ void test_generic_mult_band(void **state) {
     assert_int_equal(generic_mult, MULT_BAND);
 }
 
+void test_log_sync_qso(void **state) {
+    log_sync_mode = LOG_SYNC_IDLE;
+    int rc = call_parse_logcfg("LOG_SYNC=QSO");
+    assert_int_equal(rc, PARSE_OK);
+    assert_int_equal(log_sync_mode, LOG_SYNC_QSO);
+}
+
+void test_log_sync_idle(void **state) {
+    int rc = call_parse_logcfg("LOG_SYNC=idle");
+    assert_int_equal(rc, PARSE_OK);
+    assert_int_equal(log_sync_mode, LOG_SYNC_IDLE);
+}
+
+void test_log_sync_interval(void **state) {
+    int rc = call_parse_logcfg("LOG_SYNC=500");
+    assert_int_equal(rc, PARSE_OK);
+    assert_int_equal(log_sync_mode, LOG_SYNC_INTERVAL);
+    assert_int_equal(log_sync_interval, 500);
+}
+
+void test_log_sync_wrong(void **state) {
+    int rc = call_parse_logcfg("LOG_SYNC=5");
+    assert_int_equal(rc, PARSE_ERROR);
+}
+
 void test_digi_rig_mode_usb(void **state) {
     int rc = call_parse_logcfg("DIGI_RIG_MODE=USB");
     assert_int_equal(rc, PARSE_OK);
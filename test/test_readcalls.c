@@ -2,6 +2,7 @@
 
 #include <stdbool.h>
 #include <glob.h>
+#include <sys/stat.h>
 
 #include "../src/tlf.h"
 #include "../src/dxcc.h"
@@ -11,22 +12,30 @@
 #include "../src/get_time.h"
 #include "../src/log_utils.h"
 #include "../src/readcalls.h"
+#include "../src/score_checkpoint.h"
+#include "../src/searchcallarray.h"
 #include "../src/setcontest.h"
 #include "../src/showscore.h"
+#include "../src/store_qso.h"
 
 // OBJECT ../src/log_utils.o
 // OBJECT ../src/addcall.o
 // OBJECT ../src/addmult.o
+// OBJECT ../src/alias_matcher.o
 // OBJECT ../src/addpfx.o
+// OBJECT ../src/mult_registry.o
 // OBJECT ../src/bands.o
 // OBJECT ../src/dxcc.o
 // OBJECT ../src/getctydata.o
 // OBJECT ../src/getexchange.o
 // OBJECT ../src/getpx.o
 // OBJECT ../src/get_time.o
+// OBJECT ../src/log_writer.o
 // OBJECT ../src/plugin.o
 // OBJECT ../src/qrb.o
 // OBJECT ../src/readcalls.o
+// OBJECT ../src/score_checkpoint.o
+// OBJECT ../src/score_journal.o
 // OBJECT ../src/searchcallarray.o
 // OBJECT ../src/setcontest.o
 // OBJECT ../src/score.o
@@ -38,6 +47,7 @@
 // OBJECT ../src/qsonr_to_str.o
 // OBJECT ../src/store_qso.o
 // OBJECT ../src/ui_utils.o
+// OBJECT ../src/redraw.o
 
 char thisnode = 'A';
 bool lan_active = false;
@@ -63,6 +73,7 @@ void keyer() {}
 void send_standard_message(int msg) {}
 void send_standard_message_prev_qso(int msg) {}
 void stoptx() {}
+void background_wakeup(void) {}
 void qtc_main_panel(int direction) {}
 void add_local_spot() {}
 void sendmessage(const char *msg) {}
@@ -96,9 +107,14 @@ int pacc_pa(void) {
 
 #define QSO1 " 80SSB 12-Jan-18 16:34 0006  PY9BBB         59   59   15            PY   15  3  14025.0\n"
 
+#define QSO2 " 80SSB 12-Jan-18 16:40 0007  PY2AAA         59   59   15                     3  14025.0\n"
+
+#define QSO3 " 80SSB 12-Jan-18 16:45 0008  DL1ABC         59   59   14                     3  14025.0\n"
+
 #define NOTE "; Test note handling in logfile                                                        \n"
 
 #define LOGFILE "test.log"
+#define CHECKPOINT "test.log.score"
 
 void append_log_line(char *logfile, char *line) {
     FILE *fp = fopen(logfile, "a");
@@ -169,6 +185,7 @@ int setup_default(void **state) {
 int teardown_default(void **state) {
     assert_int_equal(remove_backup_logs(), 0);
     unlink(LOGFILE);
+    unlink(CHECKPOINT);
 
     free_qso_array();
     return 0;
@@ -291,3 +308,298 @@ void test_add_to_worked_wpx(void **state) {
     assert_string_equal(showmsg_spy,
 			"Log changed due to rescoring. Do you want to save it? Y/(N)");
 }
+
+/* test incremental rescoring */
+void test_rescore_remove_last(void **state) {
+    strcpy(logfile, LOGFILE);
+    write_log(LOGFILE);
+    append_log_line(LOGFILE, QSO2);
+    readcalls(LOGFILE, false);
+    assert_int_equal(nr_worked, 2);
+    assert_int_equal(get_nr_of_points(), 6);
+
+    rescore_remove_qso(1);
+    assert_int_equal(NR_QSOS, 1);
+    assert_int_equal(nr_worked, 1);
+    assert_int_equal(lookup_worked("PY2AAA"), -1);
+    assert_int_equal(lookup_worked("PY9BBB"), 0);
+    assert_int_equal(get_nr_of_points(), 3);
+    assert_int_equal(get_nr_of_mults(), 2);
+    assert_int_equal(remove_backup_logs(), 0);  // log not rewritten
+}
+
+void test_rescore_remove_first_dupe(void **state) {
+    strcpy(logfile, LOGFILE);
+    write_log(LOGFILE);
+    append_log_line(LOGFILE, QSO1);     // dupe
+    readcalls(LOGFILE, false);
+    assert_int_equal(get_nr_of_points(), 3);
+    remove_backup_logs();
+
+    rescore_remove_qso(0);
+    assert_int_equal(NR_QSOS, 1);
+    assert_int_equal(nr_worked, 1);
+    assert_int_equal(get_nr_of_points(), 3);    // former dupe counts now
+    assert_int_equal(get_nr_of_mults(), 2);
+    assert_true(remove_backup_logs() > 0);      // log line has changed
+}
+
+void test_rescore_from_changed_qso(void **state) {
+    strcpy(logfile, LOGFILE);
+    write_log(LOGFILE);
+    append_log_line(LOGFILE, QSO2);
+    readcalls(LOGFILE, false);
+
+    /* change first QSO to PY2AAA, second one becomes a dupe */
+    struct qso_t *qso = g_ptr_array_index(qso_array, 0);
+    g_free(qso->logline);
+    qso->logline = g_strndup(QSO2, LOGLINELEN - 1);
+    rescore_from(0);
+
+    assert_int_equal(NR_QSOS, 2);
+    assert_int_equal(nr_worked, 1);
+    assert_int_equal(lookup_worked("PY9BBB"), -1);
+    assert_string_equal(worked[0].call, "PY2AAA");
+    assert_int_equal(get_nr_of_points(), 3);
+    assert_int_equal(get_nr_of_mults(), 2);
+    remove_backup_logs();
+}
+
+void test_reread_appended_qso(void **state) {
+    strcpy(logfile, LOGFILE);
+    write_log(LOGFILE);
+    readcalls(LOGFILE, false);
+    struct qso_t *first = g_ptr_array_index(qso_array, 0);
+
+    append_log_line(LOGFILE, QSO2);
+    assert_int_equal(log_reread_n_score(), 2);
+    assert_ptr_equal(g_ptr_array_index(qso_array, 0), first);   // kept
+    assert_int_equal(nr_worked, 2);
+    assert_int_equal(get_nr_of_points(), 6);
+    assert_int_equal(remove_backup_logs(), 0);
+}
+
+/* test scoring checkpoints */
+static bool restored(int index) {
+    struct qso_t *qso = g_ptr_array_index(qso_array, index);
+    return qso->journal == NULL;
+}
+
+void test_checkpoint_replays_tail(void **state) {
+    strcpy(logfile, LOGFILE);
+    write_log(LOGFILE);
+    append_log_line(LOGFILE, QSO2);
+    readcalls(LOGFILE, false);
+    assert_int_equal(checkpoint_save(LOGFILE), 0);
+
+    append_log_line(LOGFILE, QSO3);
+    assert_int_equal(readcalls(LOGFILE, false), 3);
+    assert_true(restored(0));
+    assert_true(restored(1));
+    assert_false(restored(2));
+    int points = get_nr_of_points();
+    int mults = get_nr_of_mults();
+    assert_int_equal(nr_worked, 3);
+    assert_int_equal(lookup_worked("PY2AAA"), 1);
+    assert_string_equal(worked[0].exchange, "15");
+
+    /* same result as scoring the whole log */
+    unlink(CHECKPOINT);
+    readcalls(LOGFILE, false);
+    assert_false(restored(0));
+    assert_int_equal(get_nr_of_points(), points);
+    assert_int_equal(get_nr_of_mults(), mults);
+    assert_int_equal(nr_worked, 3);
+    remove_backup_logs();
+}
+
+void test_checkpoint_changed_log(void **state) {
+    write_log(LOGFILE);
+    append_log_line(LOGFILE, QSO2);
+    readcalls(LOGFILE, false);
+    assert_int_equal(checkpoint_save(LOGFILE), 0);
+
+    /* replace first line */
+    FILE *fp = fopen(LOGFILE, "w");
+    assert_non_null(fp);
+    fclose(fp);
+    append_log_line(LOGFILE, QSO3);
+    append_log_line(LOGFILE, QSO2);
+
+    readcalls(LOGFILE, false);
+    assert_false(restored(0));
+    assert_int_equal(nr_worked, 2);
+    assert_int_equal(lookup_worked("PY9BBB"), -1);
+    remove_backup_logs();
+}
+
+void test_checkpoint_shorter_log(void **state) {
+    write_log(LOGFILE);
+    append_log_line(LOGFILE, QSO2);
+    readcalls(LOGFILE, false);
+    assert_int_equal(checkpoint_save(LOGFILE), 0);
+
+    write_log(LOGFILE);
+    readcalls(LOGFILE, false);
+    assert_false(restored(0));
+    assert_int_equal(nr_worked, 1);
+    assert_int_equal(get_nr_of_points(), 3);
+}
+
+void test_checkpoint_broken(void **state) {
+    write_log(LOGFILE);
+    readcalls(LOGFILE, false);
+    assert_int_equal(checkpoint_save(LOGFILE), 0);
+
+    FILE *fp = fopen(CHECKPOINT, "r+");
+    assert_non_null(fp);
+    fseek(fp, -1, SEEK_END);
+    fputc('x', fp);
+    fclose(fp);
+
+    readcalls(LOGFILE, false);
+    assert_false(restored(0));
+    assert_int_equal(nr_worked, 1);
+}
+
+/* checkpoints of an older format are rejected by the format check alone */
+void test_checkpoint_old_format(void **state) {
+    uint32_t format = 1;
+
+    write_log(LOGFILE);
+    readcalls(LOGFILE, false);
+    assert_int_equal(checkpoint_save(LOGFILE), 0);
+    checkpoint_t *chk = checkpoint_open(LOGFILE);
+    assert_non_null(chk);
+    checkpoint_free(chk);
+
+    FILE *fp = fopen(CHECKPOINT, "r+");
+    assert_non_null(fp);
+    fseek(fp, 8, SEEK_SET);	/* behind the magic */
+    fwrite(&format, sizeof(format), 1, fp);
+    fclose(fp);
+
+    assert_null(checkpoint_open(LOGFILE));
+    readcalls(LOGFILE, false);
+    assert_false(restored(0));
+    assert_int_equal(nr_worked, 1);
+}
+
+void test_checkpoint_not_in_sync(void **state) {
+    write_log(LOGFILE);
+    readcalls(LOGFILE, false);
+    append_log_line(LOGFILE, QSO2);     // not read
+    assert_int_equal(checkpoint_save(LOGFILE), -1);
+    assert_int_equal(access(CHECKPOINT, F_OK), -1);
+}
+
+/* hashing from a changed line on gives the same as hashing the whole log */
+void test_checkpoint_hash_from_line(void **state) {
+    size_t offset, full_offset;
+    struct stat st;
+
+    write_log(LOGFILE);
+    append_log_line(LOGFILE, QSO2);
+    append_log_line(LOGFILE, QSO3);
+    readcalls(LOGFILE, false);
+
+    uint64_t hash = checkpoint_hash_qsos(2, &offset);
+    uint64_t full_hash = checkpoint_hash_qsos(0, &full_offset);
+    assert_true(hash == full_hash);
+    assert_int_equal(offset, full_offset);
+    assert_int_equal(stat(LOGFILE, &st), 0);
+    assert_int_equal(offset, st.st_size);
+
+    /* prefixes are kept for the lines before */
+    assert_true(checkpoint_hash_qsos(1, &offset) == full_hash);
+    assert_int_equal(offset, full_offset);
+}
+
+/* QSOs logged after reading the log are covered without reading it again */
+void test_checkpoint_after_logged_qso(void **state) {
+    write_log(LOGFILE);
+    readcalls(LOGFILE, false);
+
+    char *line = g_strndup(QSO2, strlen(QSO2) - 1);
+    store_qso(LOGFILE, line);
+    g_ptr_array_add(qso_array, parse_qso(line));
+    g_free(line);
+    checkpoint_qso_logged(QSOS(1));
+    assert_int_equal(checkpoint_save(LOGFILE), 0);
+
+    readcalls(LOGFILE, false);
+    assert_int_equal(NR_QSOS, 2);
+    assert_true(restored(0));
+    assert_true(restored(1));
+}
+
+void test_checkpoint_rescore_restored_qso(void **state) {
+    strcpy(logfile, LOGFILE);
+    write_log(LOGFILE);
+    append_log_line(LOGFILE, QSO2);
+    readcalls(LOGFILE, false);
+    assert_int_equal(checkpoint_save(LOGFILE), 0);
+    readcalls(LOGFILE, false);
+    assert_true(restored(0));
+
+    /* QSO has no journal, so the whole log gets scored again */
+    rescore_remove_qso(0);
+    assert_int_equal(NR_QSOS, 1);
+    assert_int_equal(nr_worked, 1);
+    assert_int_equal(lookup_worked("PY9BBB"), -1);
+    assert_int_equal(lookup_worked("PY2AAA"), 0);
+    assert_int_equal(get_nr_of_points(), 3);
+    assert_false(restored(0));
+    remove_backup_logs();
+}
+
+/* test parallel rescoring */
+static void write_long_log(int n) {
+    static const char *calls[] = { "DL%dABC", "PY%dAAA", "K%dXYZ", "JA%dQQ",
+				   "G%dFFF", "VK%dKK", "OH%dXX"
+				 };
+    static const int bands[] = { 80, 40, 20, 15 };
+    char call[20], line[100];
+
+    FILE *fp = fopen(LOGFILE, "w");
+    assert_non_null(fp);
+    for (int i = 0; i < n; i++) {
+	sprintf(call, calls[i % 7], i % 10);
+	sprintf(line, "%3dSSB 12-Jan-18 %02d:%02d %04d  %-15s59   59   %-2d",
+		bands[(i / 7) % 4], i / 60 % 24, i % 60, i + 1, call, 14 + i % 7);
+	fprintf(fp, "%-80s%7.1f\n", line, 14025.0);
+    }
+    fclose(fp);
+}
+
+void test_readcalls_parallel(void **state) {
+    strcpy(logfile, LOGFILE);
+
+    write_long_log(1000);
+    set_rescore_workers(0);
+    assert_int_equal(readcalls(LOGFILE, false), 1000);
+    int points = get_nr_of_points();
+    int mults = get_nr_of_mults();
+    int stations = nr_worked;
+    GPtrArray *lines = g_ptr_array_new_with_free_func(g_free);
+    for (int i = 0; i < NR_QSOS; i++) {
+	g_ptr_array_add(lines, g_strdup(QSOS(i)));
+    }
+
+    write_long_log(1000);
+    set_rescore_workers(3);
+    assert_int_equal(readcalls(LOGFILE, false), 1000);
+    set_rescore_workers(-1);
+
+    assert_int_equal(get_nr_of_points(), points);
+    assert_int_equal(get_nr_of_mults(), mults);
+    assert_int_equal(nr_worked, stations);
+    assert_true(nr_worked > 1);
+    assert_true(points > 0);
+    for (int i = 0; i < NR_QSOS; i++) {
+	assert_string_equal(QSOS(i), g_ptr_array_index(lines, i));
+    }
+
+    g_ptr_array_free(lines, TRUE);
+    remove_backup_logs();
+}
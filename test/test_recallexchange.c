@@ -2,12 +2,17 @@
 
 #include "../src/recall_exchange.h"
 #include "../src/initial_exchange.h"
+#include "../src/searchcallarray.h"
 #include "../src/setcontest.h"
 #include "../src/globalvars.h"
 #include "../src/tlf.h"
 
 // OBJECT ../src/recall_exchange.o
 // OBJECT ../src/initial_exchange.o
+// OBJECT ../src/score_journal.o
+// OBJECT ../src/searchcallarray.o
+// OBJECT ../src/bands.o
+// OBJECT ../src/get_time.o
 
 contest_config_t config_any = {
     .id = 123,
@@ -15,6 +20,12 @@ contest_config_t config_any = {
     .exchange_width = 10
 };
 
+prefix_data pfx_dummy = { };
+
+prefix_data *getctyinfo(char *call) {
+    return &pfx_dummy;
+}
+
 int setup_default(void **state) {
     int result;
     current_qso.call = g_malloc0(CALL_SIZE);
@@ -22,9 +33,9 @@ int setup_default(void **state) {
     strcpy(current_qso.call, "N0ONE");
     strcpy(proposed_exchange, "");
 
-    strcpy(worked[0].call, "DL1ABC");
-    strcpy(worked[0].exchange, "51N13E");
-    nr_worked = 1;
+    init_worked();
+    int index = lookup_or_add_worked("DL1ABC");
+    strcpy(worked[index].exchange, "51N13E");
 
     main_ie_list = NULL;
     contest = &config_any;
@@ -65,3 +76,10 @@ void test_from_ielist(void **state) {
     assert_string_equal(current_qso.comment, "51N3W");
 }
 
+
+void test_from_ielist_portable(void **state) {
+    main_ie_list = make_ie_list("data/ie_ok.txt");
+    strcpy(current_qso.call, "DL/YU5T/P");
+    assert_int_equal(recall_exchange(), 1);
+    assert_string_equal(current_qso.comment, "43N22O");
+}
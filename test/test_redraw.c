@@ -0,0 +1,128 @@
+#include "test.h"
+
+#include <pthread.h>
+
+#include "../src/globalvars.h"
+#include "../src/redraw.h"
+
+// OBJECT ../src/redraw.o
+
+static int wakeups;
+
+void background_wakeup(void) {
+    wakeups++;
+}
+
+int setup_default(void **state) {
+    frame_rate = 10;		/* 100 ms between frames */
+    redraw_reset();
+    wakeups = 0;
+    return 0;
+}
+
+void test_interval(void **state) {
+    assert_int_equal(redraw_interval(), 100);
+    frame_rate = FRAME_RATE_MAX;
+    assert_int_equal(redraw_interval(), 10);
+    frame_rate = 0;		/* not from config, use the limit */
+    assert_int_equal(redraw_interval(), 1000);
+}
+
+void test_first_request_draws(void **state) {
+    redraw_request(REDRAW_FREQ);
+    assert_int_equal(redraw_frames(), 1);
+    assert_false(redraw_pending());
+    assert_int_equal(wakeups, 0);
+}
+
+void test_requests_coalesced(void **state) {
+    redraw_request(REDRAW_FREQ);
+    for (int i = 0; i < 20; i++) {
+	redraw_request(REDRAW_FREQ);
+	redraw_request(REDRAW_BANDMAP);
+    }
+    assert_int_equal(redraw_frames(), 1);
+    assert_true(redraw_pending());
+    assert_int_equal(wakeups, 0);	/* left to the input loop */
+
+    // not due yet
+    assert_false(redraw_flush());
+
+    assert_true(redraw_now());
+    assert_int_equal(redraw_frames(), 2);
+    assert_false(redraw_pending());
+
+    assert_int_equal(redraw_requests(REDRAW_FREQ), 21);
+    assert_int_equal(redraw_count(REDRAW_FREQ), 2);
+    assert_int_equal(redraw_requests(REDRAW_BANDMAP), 20);
+    assert_int_equal(redraw_count(REDRAW_BANDMAP), 1);
+    assert_int_equal(redraw_count(REDRAW_CLUSTER), 0);
+}
+
+void test_flush_when_due(void **state) {
+    frame_rate = FRAME_RATE_MAX;
+    redraw_request(REDRAW_LOG);
+    redraw_request(REDRAW_LOG);
+    assert_true(redraw_pending());
+
+    usleep(20000);
+    assert_true(redraw_flush());
+    assert_int_equal(redraw_frames(), 2);
+    assert_int_equal(redraw_count(REDRAW_LOG), 2);
+}
+
+/* redraw requests from a thread other than the user interface one */
+static void *request_packet(void *arg) {
+    redraw_request(REDRAW_PACKET);
+    redraw_request(REDRAW_PACKET);
+    return NULL;
+}
+
+static void request_from_other_thread(void) {
+    pthread_t thread;
+
+    assert_int_equal(pthread_create(&thread, NULL, request_packet, NULL), 0);
+    pthread_join(thread, NULL);
+}
+
+void test_background_timer_skips_ui_areas(void **state) {
+    frame_rate = FRAME_RATE_MAX;
+    redraw_init();
+    redraw_request(REDRAW_FREQ);	/* drawn at once */
+    redraw_request(REDRAW_CALL);
+    assert_true(redraw_pending());
+    assert_false(redraw_background_pending());
+    assert_int_equal(wakeups, 0);
+
+    usleep(20000);
+    assert_false(redraw_flush_background());
+
+    request_from_other_thread();
+    assert_int_equal(wakeups, 1);
+    assert_true(redraw_background_pending());
+
+    usleep(20000);
+    assert_true(redraw_flush_background());
+    assert_false(redraw_background_pending());
+    assert_true(redraw_pending());		/* call field still waits */
+    assert_int_equal(redraw_count(REDRAW_PACKET), 2);
+    assert_int_equal(redraw_count(REDRAW_CALL), 0);
+
+    assert_true(redraw_now());
+    assert_false(redraw_pending());
+    assert_int_equal(redraw_count(REDRAW_CALL), 1);
+}
+
+void test_nothing_to_draw(void **state) {
+    assert_false(redraw_flush());
+    assert_false(redraw_now());
+    assert_int_equal(redraw_frames(), 0);
+}
+
+void test_area_names(void **state) {
+    assert_string_equal(redraw_area_name(REDRAW_FREQ), "freq");
+    assert_string_equal(redraw_area_name(REDRAW_PROGRESS), "progress");
+    for (int i = 0; i < REDRAW_AREA_COUNT; i++) {
+	assert_non_null(redraw_area_name(i));
+    }
+}
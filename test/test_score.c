@@ -11,14 +11,20 @@
 // OBJECT ../src/addpfx.o
 // OBJECT ../src/score.o
 // OBJECT ../src/addmult.o
+// OBJECT ../src/alias_matcher.o
+// OBJECT ../src/mult_registry.o
 // OBJECT ../src/bands.o
 // OBJECT ../src/dxcc.o
 // OBJECT ../src/focm.o
+// OBJECT ../src/initial_exchange.o
 // OBJECT ../src/getctydata.o
 // OBJECT ../src/getpx.o
+// OBJECT ../src/get_time.o
 // OBJECT ../src/plugin.o
 // OBJECT ../src/log_utils.o
 // OBJECT ../src/qrb.o
+// OBJECT ../src/score_journal.o
+// OBJECT ../src/searchcallarray.o
 // OBJECT ../src/setcontest.o
 // OBJECT ../src/utils.o
 
@@ -11,24 +11,32 @@
 
 // OBJECT ../src/addpfx.o
 // OBJECT ../src/addmult.o
+// OBJECT ../src/alias_matcher.o
+// OBJECT ../src/mult_registry.o
+// OBJECT ../src/call_index.o
 // OBJECT ../src/bands.o
 // OBJECT ../src/get_time.o
 // OBJECT ../src/getpx.o
+// OBJECT ../src/log_index.o
 // OBJECT ../src/log_utils.o
+// OBJECT ../src/score_journal.o
 // OBJECT ../src/searchlog.o
 // OBJECT ../src/zone_nr.o
 // OBJECT ../src/searchcallarray.o
 // OBJECT ../src/nicebox.o
+// OBJECT ../src/qsonr_to_str.o
 // OBJECT ../src/qtcutil.o
 // OBJECT ../src/plugin.o
 // OBJECT ../src/qrb.o
 // OBJECT ../src/printcall.o
 // OBJECT ../src/recall_exchange.o
+// OBJECT ../src/initial_exchange.o
 // OBJECT ../src/setcontest.o
 // OBJECT ../src/err_utils.o
 // OBJECT ../src/ui_utils.o
 // OBJECT ../src/score.o
 // OBJECT ../src/utils.o
+// OBJECT ../src/redraw.o
 
 void checkexchange(struct qso_t *qso, bool interactive) {}
 
@@ -37,8 +45,9 @@ char section[8] = "";       // defined in getexchange.c
 extern WINDOW *search_win;
 extern PANEL *search_panel;
 extern int nr_bands;
-extern char searchresult[MAX_CALLS][82];
+extern struct qso_t *searchresult[MAX_CALLS];
 extern char result[MAX_CALLS][82];
+extern int srch_index;
 
 void handlePartials(void);
 void filterLog(const char * call);
@@ -53,6 +62,10 @@ int stoptx() {
     return 0;
 }
 
+// background_process.c
+void background_wakeup(void) {
+}
+
 // clear_display.c
 void clear_display() {
 }
@@ -134,7 +147,7 @@ static void write_qsos() {
 
 int setup_default(void **state) {
     for (int i = 0; i < MAX_CALLS; i++)
-	strcpy(searchresult[i], "");
+	searchresult[i] = NULL;
 
     showmsg_spy = showstring_spy1 = showstring_spy2 = STRING_NOT_SET;
 
@@ -147,6 +160,7 @@ int setup_default(void **state) {
     searchflg = true;
     trxmode = CWMODE;
     mixedmode = 0;
+    show_time = false;
 
     callmaster_filename = NULL;
 
@@ -261,16 +275,43 @@ void test_init_search_panel_dxped(void **state) {
 /* testing searchlog for refactoring */
 void test_searchlog_pickup_call(void **state) {
     filterLog("UA");
-    assert_int_equal(strncmp(searchresult[0], QSO3, 80), 0);
-    assert_int_equal(strncmp(searchresult[1], QSO4, 80), 0);
-    assert_int_equal(strncmp(searchresult[2], QSO5, 80), 0);
+    assert_int_equal(strncmp(searchresult[0]->logline, QSO3, 80), 0);
+    assert_int_equal(strncmp(searchresult[1]->logline, QSO4, 80), 0);
+    assert_int_equal(strncmp(searchresult[2]->logline, QSO5, 80), 0);
 }
 
 void test_searchlog_pickup_call_mixedmode(void **state) {
     mixedmode = 1;
     filterLog("UA");
-    assert_int_equal(strncmp(searchresult[0], QSO3, 80), 0);
-    assert_int_equal(strncmp(searchresult[1], QSO5, 80), 0);
+    assert_int_equal(strncmp(searchresult[0]->logline, QSO3, 80), 0);
+    assert_int_equal(strncmp(searchresult[1]->logline, QSO5, 80), 0);
+}
+
+void test_searchlog_new_qso(void **state) {
+    filterLog("UA");
+    assert_int_equal(srch_index, 3);
+
+    add_log(" 80CW  12-Jan-18 16:40 0011  RA3UAA         599  599  16            UA  16   1         ");
+    filterLog("UA");
+    assert_int_equal(srch_index, 4);
+    assert_string_equal(searchresult[3]->call, "RA3UAA");
+}
+
+void test_searchlog_changed_qso(void **state) {
+    filterLog("UA");
+    assert_int_equal(srch_index, 3);
+
+    /* replace OE3UAI */
+    struct qso_t *qso = g_ptr_array_index(qso_array, 2);
+    char *line = g_strdup(QSO1);
+    g_ptr_array_index(qso_array, 2) = parse_qso(line);
+    g_free(line);
+    free_qso(qso);
+    qso_array_changed();
+
+    filterLog("UA");
+    assert_int_equal(srch_index, 2);
+    assert_string_equal(searchresult[0]->call, "UA3JK");
 }
 
 void test_searchlog_extract_data(void **state) {
@@ -279,6 +320,12 @@ void test_searchlog_extract_data(void **state) {
     assert_string_equal(result[1], " 80SSB 0008 UA3JK        16            ");
 }
 
+void test_searchlog_extract_data_time(void **state) {
+    show_time = true;
+    filterLog("OE3");
+    assert_string_equal(result[0], " 40CW 16:34 OE3UAI       15            ");
+}
+
 void test_searchlog_extract_data_mixedmode(void **state) {
     mixedmode = 1;
     filterLog("UA");
@@ -362,6 +409,21 @@ void test_displayPartials_exact_callmaster(void **state) {
     check_mvprintw_output(0, 1, 13, " UA3JKB"); // third - from callmaster
 }
 
+/* test if near misses are shown but not used for auto-completion */
+void test_displayPartials_near_miss(void **state) {
+    write_callmaster("callmaster", "# data\nA1AA\nDL1ABC\nOE3UAJ\n");
+    load_callmaster();
+    use_part = true;
+    strcpy(current_qso.call, "OE3UAK");
+
+    filterLog(current_qso.call);
+    handlePartials();
+
+    check_mvprintw_output(1, 1, 1, "OE3UAI");   // from log
+    check_mvprintw_output(0, 1, 7, " OE3UAJ");  // from callmaster
+    assert_string_equal(current_qso.call, "OE3UAK");
+}
+
 /* test if partials display overflows */
 void test_displayPartials(void **state) {
     // add a bunch of UA QSOs so that they fill up available space
@@ -31,9 +31,7 @@ void replace_all(char *buf, int size, const char *what,
 /* break dependencies */
 
 extern char buffer[];
-extern char wkeyerbuffer[400];
 char *SPcall;
-extern int data_ready;
 
 void keyer_append(const char *string) { }
 int vk_play_file(char *file) { return 0; }
@@ -82,8 +80,6 @@ void check_ExpandMacro(const char *input, const char *exp) {
 int setup_default(void **state) {
     current_qso.call = g_malloc0(CALL_SIZE);
 
-    wkeyerbuffer[0] = '\0';
-    data_ready = 0;
     simulator = false;
     sending_call = false;
     trxmode = CWMODE;
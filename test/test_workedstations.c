@@ -1,5 +1,6 @@
 #include "test.h"
 
+#include <pthread.h>
 #include <time.h>
 
 #include "../src/dxcc.h"
@@ -8,6 +9,7 @@
 #include "../src/globalvars.h"
 
 // OBJECT ../src/dxcc.o
+// OBJECT ../src/score_journal.o
 // OBJECT ../src/searchcallarray.o
 // OBJECT ../src/bands.o
 
@@ -21,17 +23,16 @@ time_t get_time() {
     return (time_t)mock();
 }
 
-void fill_qsotime(long time) {
+void fill_qsotime(int index, long time) {
     for (int i = 0; i < 3; i++)
 	for (int j = 0; j < NBANDS; j++)
-	    worked[nr_worked].qsotime[i][j] = time + 10 * j + i;
+	    worked[index].qsotime[i][j] = time + 10 * j + i;
 }
 
 void insert_call(char *call, long time) {
-    strcpy(worked[nr_worked].call, call);
-    worked[nr_worked].band = inxes[BANDINDEX_40] | inxes[BANDINDEX_15];
-    fill_qsotime(time);
-    nr_worked ++;
+    int index = lookup_or_add_worked(call);
+    worked[index].band = inxes[BANDINDEX_40] | inxes[BANDINDEX_15];
+    fill_qsotime(index, time);
 }
 
 int setup_default(void **state) {
@@ -84,31 +85,106 @@ void test_lookup_and_add_not_found(void **state) {
     assert_int_equal(nr_worked, 2 + 1);
 }
 
+void test_lookup_after_init(void **state) {
+    init_worked();
+    assert_int_equal(lookup_worked("OE3XYZ"), -1);
+    assert_int_equal(lookup_or_add_worked("OE3XYZ"), 0);
+    assert_int_equal(lookup_worked("OE3XYZ"), 0);
+}
+
+void test_add_many(void **state) {
+    char call[20];
+
+    init_worked();
+    for (int i = 0; i < 3 * MAX_CALLS; i++) {
+	sprintf(call, "DL%dAA", i);
+	assert_int_equal(lookup_or_add_worked(call), i);
+    }
+    assert_int_equal(nr_worked, 3 * MAX_CALLS);
+
+    for (int i = 0; i < 3 * MAX_CALLS; i++) {
+	sprintf(call, "DL%dAA", i);
+	assert_int_equal(lookup_worked(call), i);
+	assert_string_equal(worked[i].call, call);
+    }
+    assert_int_equal(lookup_worked("DL1ABC"), -1);
+}
+
+/* background thread looking up calls while the main thread adds them */
+static volatile bool adding_done;
+
+static void *lookup_while_adding(void *arg) {
+    int *mismatches = arg;
+    worked_t entry;
+
+    /* cmocka asserts must not be used outside of the main thread */
+    while (!adding_done) {
+	if (copy_worked("DL0AA", &entry) && strcmp(entry.call, "DL0AA") != 0)
+	    (*mismatches)++;
+	if (lookup_worked("DL1ABC") != -1)
+	    (*mismatches)++;
+    }
+    return NULL;
+}
+
+void test_lookup_while_growing(void **state) {
+    char call[20];
+    pthread_t reader;
+    worked_t entry;
+    int mismatches = 0;
+
+    init_worked();
+    adding_done = false;
+    assert_int_equal(pthread_create(&reader, NULL, lookup_while_adding,
+				    &mismatches), 0);
+
+    for (int i = 0; i < 10 * MAX_CALLS; i++) {
+	sprintf(call, "DL%dAA", i);
+	assert_int_equal(lookup_or_add_worked(call), i);
+    }
+    adding_done = true;
+    pthread_join(reader, NULL);
+
+    assert_int_equal(mismatches, 0);
+    assert_int_equal(nr_worked, 10 * MAX_CALLS);
+    assert_true(copy_worked("DL0AA", &entry));
+    assert_string_equal(entry.call, "DL0AA");
+}
+
+
+/* test copy_worked_at */
+void test_copy_by_index(void **state) {
+    worked_t entry;
+
+    assert_true(copy_worked_at(1, &entry));
+    assert_string_equal(entry.call, "OE3XYZ");
+    assert_int_equal(entry.qsotime[CWMODE][BANDINDEX_40],
+		     worked[1].qsotime[CWMODE][BANDINDEX_40]);
+    assert_false(copy_worked_at(2, &entry));
+    assert_false(copy_worked_at(-1, &entry));
+}
 
 /* test worked_in_current_minitest_period */
 void test_not_found(void **state) {
-    assert_int_equal(worked_in_current_minitest_period(-1), false);
+    assert_int_equal(worked_in_current_minitest_period("DL1ABC"), false);
 }
 
 void test_no_minitest(void **state) {
-    int index = lookup_worked("OE3XYZ");
-    assert_int_equal(worked_in_current_minitest_period(index), true);
+    assert_int_equal(worked_in_current_minitest_period("OE3XYZ"), true);
 }
 
 void test_minitest_in_period(void **state) {
-    int index = lookup_worked("OE3XYZ");
     minitest = 500;
 
     will_return(get_time, 80500 + minitest - 1);
-    assert_int_equal(worked_in_current_minitest_period(index), true);
+    assert_int_equal(worked_in_current_minitest_period("OE3XYZ"), true);
 }
 
 void test_minitest_not_in_period(void **state) {
-    int index = lookup_worked("OE3XYZ");
     minitest = 500;
 
     will_return(get_time, 80500 + minitest);
-    assert_int_equal(worked_in_current_minitest_period(index), false);
+    assert_int_equal(worked_in_current_minitest_period("OE3XYZ"), false);
 }
 
 
@@ -0,0 +1,209 @@
+#include "test.h"
+
+#include <hamlib/rig.h>
+
+#include "../src/err_utils.h"
+#include "../src/globalvars.h"
+#include "../src/tlf.h"
+#include "../src/write_keyer.h"
+
+// OBJECT ../src/write_keyer.o
+
+/* keyer actions are recorded in 'sent', one per line */
+static GString *sent;
+
+static int stop_result;
+static bool tone_result;
+static bool flush_on_send;
+static int warnings;
+
+int hamlib_keyer_send(char *cwmessage) {
+    g_string_append_printf(sent, "%s\n", cwmessage);
+    if (flush_on_send) {
+	flush_on_send = false;
+	keyer_flush();
+    }
+    return RIG_OK;
+}
+
+int hamlib_keyer_stop() {
+    g_string_append(sent, "<stop>\n");
+    return stop_result;
+}
+
+int hamlib_keyer_set_speed(int cwspeed) {
+    g_string_append_printf(sent, "<speed %d>\n", cwspeed);
+    return RIG_OK;
+}
+
+bool send_tone(const char *tone) {
+    g_string_append_printf(sent, "<tone %s>\n", tone);
+    return tone_result;
+}
+
+int fldigi_send_text(char *line) {
+    return 0;
+}
+
+void clear_display() {}
+
+void handle_logging(enum log_lvl lvl, ...) {
+    warnings++;
+}
+
+
+int setup_default(void **state) {
+    trxmode = CWMODE;
+    cwkeyer = HAMLIB_KEYER;
+    digikeyer = NO_KEYER;
+
+    stop_result = RIG_OK;
+    tone_result = true;
+    flush_on_send = false;
+
+    keyer_flush();
+    write_keyer();
+    keyer_report_errors();
+    warnings = 0;
+
+    if (sent == NULL)
+	sent = g_string_new(NULL);
+    g_string_truncate(sent, 0);
+    return 0;
+}
+
+void test_empty(void **state) {
+    write_keyer();
+    assert_string_equal(sent->str, "");
+}
+
+void test_text_joined(void **state) {
+    keyer_append("CQ ");
+    keyer_append_char('D');
+    keyer_append("L1JBE");
+    write_keyer();
+    assert_string_equal(sent->str, "CQ DL1JBE\n");
+}
+
+void test_plus_minus_dropped(void **state) {
+    keyer_append("++TU--");
+    write_keyer();
+    assert_string_equal(sent->str, "TU\n");
+}
+
+void test_commands_in_order(void **state) {
+    keyer_append("5NN");
+    keyer_set_speed(32);
+    keyer_set_tone("700");
+    keyer_append("TU");
+    write_keyer();
+    assert_string_equal(sent->str, "5NN\n<speed 32>\n<tone 700>\nTU\n");
+}
+
+void test_abort_jumps_queue(void **state) {
+    keyer_append("CQ TEST");
+    keyer_set_speed(20);
+    keyer_abort();
+    keyer_append("TU");
+    write_keyer();
+    assert_string_equal(sent->str, "<stop>\nTU\n");
+}
+
+void test_flush(void **state) {
+    keyer_append("CQ TEST");
+    keyer_flush();
+    write_keyer();
+    assert_string_equal(sent->str, "");
+}
+
+void test_flush_drops_collected_text(void **state) {
+    char text[300];
+
+    memset(text, 'E', sizeof(text) - 1);
+    text[sizeof(text) - 1] = '\0';
+
+    /* the 2nd text does not fit into the chunk, so the 1st one is sent
+     * first and the flush arrives while the 2nd one is collected */
+    keyer_append(text);
+    keyer_append(text);
+    keyer_append("TU");
+    flush_on_send = true;
+    write_keyer();
+    assert_int_equal(sent->len, strlen(text) + 1);
+}
+
+void test_error_reported_by_ui(void **state) {
+    int before = keyer_errors();
+
+    stop_result = -RIG_ETIMEOUT;
+    keyer_abort();
+    write_keyer();
+    assert_string_equal(sent->str, "<stop>\n");
+    assert_int_equal(keyer_errors() - before, 1);
+    assert_int_equal(warnings, 0);
+
+    keyer_report_errors();
+    assert_int_equal(warnings, 1);
+
+    /* reported only once */
+    keyer_report_errors();
+    assert_int_equal(warnings, 1);
+}
+
+void test_not_sent_in_ssb(void **state) {
+    trxmode = SSBMODE;
+    keyer_append("CQ TEST");
+    write_keyer();
+    assert_string_equal(sent->str, "");
+}
+
+void test_tone_error_switches_mode_in_ui(void **state) {
+    tone_result = false;
+    keyer_set_tone("700");
+    write_keyer();
+    assert_string_equal(sent->str, "<tone 700>\n");
+    assert_int_equal(trxmode, CWMODE);
+
+    keyer_report_errors();
+    assert_int_equal(warnings, 1);
+    assert_int_equal(trxmode, SSBMODE);
+}
+
+void test_mode_taken_when_queued(void **state) {
+    keyer_append("CQ TEST");
+    trxmode = SSBMODE;		/* changed before the keyer gets to it */
+    keyer_append("TU");
+    write_keyer();
+    assert_string_equal(sent->str, "CQ TEST\n");
+}
+
+void test_overflow_counted(void **state) {
+    int before = keyer_overflows();
+
+    for (int i = 0; i < 300; i++) {
+	keyer_append_char('E');
+    }
+    assert_int_equal(keyer_overflows() - before, 300 - 256);
+
+    write_keyer();
+    assert_int_equal(sent->len, 256 + 1);
+
+    // there is room again
+    g_string_truncate(sent, 0);
+    keyer_append("T");
+    write_keyer();
+    assert_string_equal(sent->str, "T\n");
+    assert_int_equal(keyer_overflows() - before, 300 - 256);
+}
+
+void test_thread(void **state) {
+    assert_true(keyer_thread_start());
+
+    keyer_append("TEST");
+    for (int i = 0; i < 1000 && sent->len == 0; i++) {
+	usleep(1000);
+    }
+
+    keyer_thread_stop();
+    assert_string_equal(sent->str, "TEST\n");
+}